@@ -0,0 +1,47 @@
+local ffi = require("ffi")
+local vector_simd = require("vector_simd")
+
+-- Example chain for batch_exe: applies a fixed gain to every channel.
+-- batch_exe loads one copy of this script per worker thread.
+--
+--   batch_exe batch_chain.lua stems/*.wav
+
+local chain = {}
+
+local gain = 0.5
+
+--- Called before each file (or segment) is processed.
+-- @param sampleRate The sample rate of the file.
+-- @param channels The number of channels of the file.
+-- @param blockSize The maximum number of frames passed to process.
+function chain.init(sampleRate, channels, blockSize)
+end
+
+-- Channel vectors wrapped once per buffer layout, so the render loop allocates nothing per block.
+local wrapped = {}
+local boundBuffer, boundChannels, boundStride
+
+local function bind(buffer, channels, stride)
+    local base = ffi.cast("double*", buffer)
+    for c = 1, channels do
+        wrapped[c] = vector_simd.wrap_pointer(base + (c - 1) * stride)
+    end
+    boundBuffer, boundChannels, boundStride = buffer, channels, stride
+end
+
+--- Processes one block in place.
+-- @param buffer Light userdata pointing to the planar double channels.
+-- @param frames The number of valid frames per channel.
+-- @param channels The number of channels.
+-- @param stride The distance between two channels in doubles.
+function chain.process(buffer, frames, channels, stride)
+    if buffer ~= boundBuffer or channels ~= boundChannels or stride ~= boundStride then
+        bind(buffer, channels, stride)
+    end
+    local paddedN = vector_simd.simdRegisterPaddingSize(frames)
+    for c = 1, channels do
+        vector_simd.compute_a_plus_bx_into(0.0, gain, wrapped[c], wrapped[c], paddedN)
+    end
+end
+
+return chain
@@ -0,0 +1,713 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+extern double* allocate_aligned_memory(size_t n);
+extern void free_aligned_memory(double* ptr);
+
+// Offline batch renderer.
+//
+// Runs a list of WAV files through a LuaJIT processing chain on all cores. Every worker owns its
+// own lua_State with its own copy of the chain script, so scripts built on vector_simd.lua need no
+// locking. Files (or fixed size segments of files) are distributed as tasks over per worker deques,
+// idle workers steal from the other deques.
+//
+// The chain script has to return a table:
+//
+//   return {
+//       init    = function(sampleRate, channels, blockSize) end,  -- optional, called before each task
+//       process = function(buffer, frames, channels, stride) end, -- required, called per block
+//   }
+//
+// "buffer" is a light userdata pointing to "channels" planar double channels, channel c starts at
+// ffi.cast("double*", buffer) + c * stride. Each channel is aligned to 64 bytes and padded with
+// zeros up to a multiple of 4 samples, so it can be handed straight to the SIMD kernels.
+
+#define BATCH_DEFAULT_BLOCK 4096
+#define BATCH_MAX_PATH      1024
+#define BATCH_WAV_HEADER    58   // largest header written: 18 byte fmt chunk and a fact chunk
+
+typedef struct wav_info {
+    int format;          // 1 = integer PCM, 3 = IEEE float
+    int channels;
+    int sample_rate;
+    int bits_per_sample;
+    int block_align;     // bytes per frame
+    long data_offset;    // file offset of the first sample
+    size_t frames;
+} wav_info;
+
+typedef struct batch_file {
+    const char* in_path;
+    char out_path[BATCH_MAX_PATH];
+    wav_info info;
+    long out_data_offset;   // file offset of the first sample in the output file
+    int segments_left;
+    int failed;
+    double process_seconds;
+    pthread_mutex_t lock;
+} batch_file;
+
+typedef struct batch_task {
+    batch_file* file;
+    size_t start;        // first frame written by this task
+    size_t frames;       // number of frames written by this task
+} batch_task;
+
+// Fixed capacity deque. The owner pops from the tail, thieves take from the head.
+typedef struct task_deque {
+    batch_task** items;
+    size_t head;
+    size_t tail;
+    pthread_mutex_t lock;
+} task_deque;
+
+struct batch_context;
+
+typedef struct batch_worker {
+    int id;
+    pthread_t thread;
+    task_deque queue;
+    struct batch_context* ctx;
+    lua_State* L;
+    int chain_ref;
+    double* buffer;
+    unsigned char* io;
+    uint32_t rng;
+    size_t tasks_done;
+    size_t tasks_stolen;
+} batch_worker;
+
+typedef struct batch_context {
+    const char* script;
+    char script_dir[BATCH_MAX_PATH];
+    size_t block;
+    size_t stride;
+    int max_channels;
+    int max_block_align;
+    double preroll_seconds;
+    int num_workers;
+    batch_worker* workers;
+    pthread_mutex_t print_lock;
+} batch_context;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int default_worker_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+/*
+ * WAV file handling
+ */
+
+static uint32_t read_le(const unsigned char* p, int bytes) {
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static void write_le(unsigned char* p, uint32_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i, v >>= 8) {
+        p[i] = (unsigned char)(v & 0xFF);
+    }
+}
+
+/**
+ * Parses the header of a WAV file.
+ *
+ * @param path The file to inspect.
+ * @param info Receives the format and the location of the sample data.
+ * @return 0 on success, -1 if the file cannot be read or has an unsupported format.
+ */
+static int wav_read_info(const char* path, wav_info* info) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return -1;
+    }
+    unsigned char header[12];
+    int have_fmt = 0;
+    int result = -1;
+    memset(info, 0, sizeof(*info));
+    if (fread(header, 1, 12, f) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        fclose(f);
+        return -1;
+    }
+    for (;;) {
+        unsigned char chunk[8];
+        if (fread(chunk, 1, 8, f) != 8) {
+            break;
+        }
+        uint32_t size = read_le(chunk + 4, 4);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            unsigned char fmt[40] = {0};
+            size_t want = size < sizeof(fmt) ? size : sizeof(fmt);
+            if (size < 16 || fread(fmt, 1, want, f) != want) {
+                break;
+            }
+            info->format          = (int)read_le(fmt, 2);
+            info->channels        = (int)read_le(fmt + 2, 2);
+            info->sample_rate     = (int)read_le(fmt + 4, 4);
+            info->block_align     = (int)read_le(fmt + 12, 2);
+            info->bits_per_sample = (int)read_le(fmt + 14, 2);
+            if (info->format == 0xFFFE && size >= 26) {
+                info->format = (int)read_le(fmt + 24, 2); // WAVE_FORMAT_EXTENSIBLE sub format
+            }
+            fseek(f, (long)(size - want + (size & 1)), SEEK_CUR);
+            have_fmt = 1;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (have_fmt && info->block_align > 0) {
+                info->data_offset = ftell(f);
+                info->frames = size / (uint32_t)info->block_align;
+                result = 0;
+            }
+            break;
+        } else {
+            fseek(f, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+    fclose(f);
+
+    if (result == 0) {
+        const int bits = info->bits_per_sample;
+        const int pcm_ok   = info->format == 1 && (bits == 16 || bits == 24 || bits == 32);
+        const int float_ok = info->format == 3 && (bits == 32 || bits == 64);
+        if (!(pcm_ok || float_ok) || info->channels <= 0 || info->block_align != info->channels * bits / 8) {
+            result = -1;
+        }
+    }
+    return result;
+}
+
+/**
+ * Creates the output file with a canonical header and reserves space for all frames, so workers can
+ * write their segments at independent offsets. Integer PCM gets the plain 44 byte header, IEEE float
+ * an 18 byte fmt chunk and the fact chunk that strict readers require for non-PCM formats.
+ *
+ * @param path The file to create.
+ * @param info The format of the file, data_offset is updated to the start of the sample data.
+ * @return 0 on success, -1 on failure.
+ */
+static int wav_create(const char* path, wav_info* info) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    const uint32_t data_size = (uint32_t)(info->frames * (size_t)info->block_align);
+    const int is_float = info->format == 3;
+    const uint32_t fmt_size = is_float ? 18 : 16;
+    const size_t header = 20 + fmt_size + (is_float ? 12 : 0) + 8;
+    unsigned char h[BATCH_WAV_HEADER];
+    memset(h, 0, sizeof(h));
+    memcpy(h, "RIFF", 4);
+    write_le(h + 4, (uint32_t)(header - 8) + data_size, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    write_le(h + 16, fmt_size, 4);
+    write_le(h + 20, (uint32_t)info->format, 2);
+    write_le(h + 22, (uint32_t)info->channels, 2);
+    write_le(h + 24, (uint32_t)info->sample_rate, 4);
+    write_le(h + 28, (uint32_t)(info->sample_rate * info->block_align), 4);
+    write_le(h + 32, (uint32_t)info->block_align, 2);
+    write_le(h + 34, (uint32_t)info->bits_per_sample, 2);
+    unsigned char* p = h + 20 + fmt_size; // cbSize of the float fmt chunk stays 0
+    if (is_float) {
+        memcpy(p, "fact", 4);
+        write_le(p + 4, 4, 4);
+        write_le(p + 8, (uint32_t)info->frames, 4);
+        p += 12;
+    }
+    memcpy(p, "data", 4);
+    write_le(p + 4, data_size, 4);
+    int ok = fwrite(h, 1, header, f) == header;
+    if (ok && data_size > 0) {
+        ok = fseek(f, (long)(header + data_size - 1), SEEK_SET) == 0 && fputc(0, f) != EOF;
+    }
+    info->data_offset = (long)header;
+    return (fclose(f) == 0 && ok) ? 0 : -1;
+}
+
+// Converts interleaved file samples into planar doubles.
+static void decode_block(const wav_info* info, const unsigned char* raw, double* buffer, size_t stride, size_t frames) {
+    const int bytes = info->bits_per_sample / 8;
+    for (int c = 0; c < info->channels; ++c) {
+        double* out = buffer + (size_t)c * stride;
+        const unsigned char* p = raw + (size_t)c * bytes;
+        for (size_t i = 0; i < frames; ++i, p += info->block_align) {
+            if (info->format == 3) {
+                if (bytes == 4) {
+                    float v;
+                    memcpy(&v, p, sizeof(v));
+                    out[i] = v;
+                } else {
+                    memcpy(&out[i], p, sizeof(double));
+                }
+            } else if (bytes == 2) {
+                out[i] = (int16_t)read_le(p, 2) * (1.0 / 32768.0);
+            } else if (bytes == 3) {
+                out[i] = ((int32_t)(read_le(p, 3) << 8) >> 8) * (1.0 / 8388608.0);
+            } else {
+                out[i] = (int32_t)read_le(p, 4) * (1.0 / 2147483648.0);
+            }
+        }
+    }
+}
+
+static int32_t quantize(double v, double scale, double lo, double hi) {
+    double s = v * scale;
+    s = s < lo ? lo : (s > hi ? hi : s);
+    return (int32_t)(s < 0.0 ? s - 0.5 : s + 0.5);
+}
+
+// Converts planar doubles back into interleaved file samples, integer formats are saturated.
+static void encode_block(const wav_info* info, const double* buffer, size_t stride, unsigned char* raw, size_t frames) {
+    const int bytes = info->bits_per_sample / 8;
+    for (int c = 0; c < info->channels; ++c) {
+        const double* in = buffer + (size_t)c * stride;
+        unsigned char* p = raw + (size_t)c * bytes;
+        for (size_t i = 0; i < frames; ++i, p += info->block_align) {
+            if (info->format == 3) {
+                if (bytes == 4) {
+                    const float v = (float)in[i];
+                    memcpy(p, &v, sizeof(v));
+                } else {
+                    memcpy(p, &in[i], sizeof(double));
+                }
+            } else if (bytes == 2) {
+                write_le(p, (uint32_t)quantize(in[i], 32768.0, -32768.0, 32767.0), 2);
+            } else if (bytes == 3) {
+                write_le(p, (uint32_t)quantize(in[i], 8388608.0, -8388608.0, 8388607.0), 3);
+            } else {
+                write_le(p, (uint32_t)quantize(in[i], 2147483648.0, -2147483648.0, 2147483647.0), 4);
+            }
+        }
+    }
+}
+
+/*
+ * Work-stealing task queues
+ */
+
+static batch_task* deque_pop(task_deque* q) {
+    batch_task* task = NULL;
+    pthread_mutex_lock(&q->lock);
+    if (q->tail > q->head) {
+        task = q->items[--q->tail];
+    }
+    pthread_mutex_unlock(&q->lock);
+    return task;
+}
+
+static batch_task* deque_steal(task_deque* q) {
+    batch_task* task = NULL;
+    pthread_mutex_lock(&q->lock);
+    if (q->tail > q->head) {
+        task = q->items[q->head++];
+    }
+    pthread_mutex_unlock(&q->lock);
+    return task;
+}
+
+// Tries all other workers starting at a random victim. Returns NULL once every queue is empty,
+// no tasks are created after start up so that means the batch is done.
+static batch_task* steal_task(batch_worker* self) {
+    batch_context* ctx = self->ctx;
+    self->rng ^= self->rng << 13;
+    self->rng ^= self->rng >> 17;
+    self->rng ^= self->rng << 5;
+    const int first = (int)(self->rng % (uint32_t)ctx->num_workers);
+    for (int k = 0; k < ctx->num_workers; ++k) {
+        batch_worker* victim = &ctx->workers[(first + k) % ctx->num_workers];
+        if (victim == self) {
+            continue;
+        }
+        batch_task* task = deque_steal(&victim->queue);
+        if (task) {
+            self->tasks_stolen++;
+            return task;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Lua chain
+ */
+
+static int chain_load(batch_worker* w) {
+    batch_context* ctx = w->ctx;
+    w->L = luaL_newstate();
+    if (!w->L) {
+        return -1;
+    }
+    luaL_openlibs(w->L);
+
+    // make modules next to the script (e.g. vector_simd.lua) available to require
+    lua_getglobal(w->L, "package");
+    lua_getfield(w->L, -1, "path");
+    lua_pushfstring(w->L, "%s?.lua;%s", ctx->script_dir, lua_tostring(w->L, -1));
+    lua_setfield(w->L, -3, "path");
+    lua_pop(w->L, 2);
+
+    if (luaL_loadfile(w->L, ctx->script) != 0 || lua_pcall(w->L, 0, 1, 0) != 0) {
+        fprintf(stderr, "worker %d: %s\n", w->id, lua_tostring(w->L, -1));
+        return -1;
+    }
+    if (!lua_istable(w->L, -1)) {
+        fprintf(stderr, "worker %d: %s must return a table with a process function\n", w->id, ctx->script);
+        return -1;
+    }
+    w->chain_ref = luaL_ref(w->L, LUA_REGISTRYINDEX);
+    return 0;
+}
+
+static int chain_init(batch_worker* w, const wav_info* info) {
+    lua_rawgeti(w->L, LUA_REGISTRYINDEX, w->chain_ref);
+    lua_getfield(w->L, -1, "init");
+    if (!lua_isfunction(w->L, -1)) {
+        lua_pop(w->L, 2);
+        return 0;
+    }
+    lua_pushnumber(w->L, info->sample_rate);
+    lua_pushinteger(w->L, info->channels);
+    lua_pushinteger(w->L, (lua_Integer)w->ctx->block);
+    const int status = lua_pcall(w->L, 3, 0, 0);
+    if (status != 0) {
+        fprintf(stderr, "worker %d: init: %s\n", w->id, lua_tostring(w->L, -1));
+    }
+    lua_pop(w->L, status != 0 ? 2 : 1);
+    return status != 0 ? -1 : 0;
+}
+
+static int chain_process(batch_worker* w, size_t frames, int channels) {
+    lua_rawgeti(w->L, LUA_REGISTRYINDEX, w->chain_ref);
+    lua_getfield(w->L, -1, "process");
+    lua_pushlightuserdata(w->L, w->buffer);
+    lua_pushinteger(w->L, (lua_Integer)frames);
+    lua_pushinteger(w->L, channels);
+    lua_pushinteger(w->L, (lua_Integer)w->ctx->stride);
+    const int status = lua_pcall(w->L, 4, 0, 0);
+    if (status != 0) {
+        fprintf(stderr, "worker %d: process: %s\n", w->id, lua_tostring(w->L, -1));
+    }
+    lua_pop(w->L, status != 0 ? 2 : 1);
+    return status != 0 ? -1 : 0;
+}
+
+/*
+ * Task execution
+ */
+
+static int run_task(batch_worker* w, const batch_task* task) {
+    batch_context* ctx = w->ctx;
+    const wav_info* info = &task->file->info;
+    const size_t preroll_max = (size_t)(ctx->preroll_seconds * info->sample_rate);
+    const size_t preroll = task->start < preroll_max ? task->start : preroll_max;
+    int result = -1;
+
+    FILE* in  = fopen(task->file->in_path, "rb");
+    FILE* out = fopen(task->file->out_path, "r+b");
+    if (!in || !out) {
+        fprintf(stderr, "worker %d: cannot open %s\n", w->id, !in ? task->file->in_path : task->file->out_path);
+        goto done;
+    }
+    if (fseek(in, info->data_offset + (long)((task->start - preroll) * (size_t)info->block_align), SEEK_SET) != 0 ||
+        fseek(out, task->file->out_data_offset + (long)(task->start * (size_t)info->block_align), SEEK_SET) != 0) {
+        goto done;
+    }
+    if (chain_init(w, info) != 0) {
+        goto done;
+    }
+
+    // preroll frames warm up the chain state of a segment and are discarded
+    size_t skip = preroll;
+    size_t remaining = preroll + task->frames;
+    while (remaining > 0) {
+        const size_t frames = remaining < ctx->block ? remaining : ctx->block;
+        if (fread(w->io, (size_t)info->block_align, frames, in) != frames) {
+            fprintf(stderr, "worker %d: short read in %s\n", w->id, task->file->in_path);
+            goto done;
+        }
+        memset(w->buffer, 0, (size_t)info->channels * ctx->stride * sizeof(double));
+        decode_block(info, w->io, w->buffer, ctx->stride, frames);
+        if (chain_process(w, frames, info->channels) != 0) {
+            goto done;
+        }
+        const size_t drop = skip < frames ? skip : frames;
+        skip -= drop;
+        if (frames > drop) {
+            const size_t keep = frames - drop;
+            for (int c = 0; c < info->channels; ++c) {
+                memmove(w->buffer + (size_t)c * ctx->stride, w->buffer + (size_t)c * ctx->stride + drop, keep * sizeof(double));
+            }
+            encode_block(info, w->buffer, ctx->stride, w->io, keep);
+            if (fwrite(w->io, (size_t)info->block_align, keep, out) != keep) {
+                goto done;
+            }
+        }
+        remaining -= frames;
+    }
+    result = 0;
+
+done:
+    if (in) fclose(in);
+    if (out && fclose(out) != 0) result = -1;
+    return result;
+}
+
+static void report_file(batch_context* ctx, const batch_file* file) {
+    const double audio_seconds = (double)file->info.frames / file->info.sample_rate;
+    pthread_mutex_lock(&ctx->print_lock);
+    if (file->failed) {
+        printf("FAILED  %s\n", file->in_path);
+    } else {
+        printf("%8.2fs audio  %8.3fs cpu  RTF %8.1fx  %s\n", audio_seconds, file->process_seconds,
+               file->process_seconds > 0.0 ? audio_seconds / file->process_seconds : 0.0, file->out_path);
+    }
+    fflush(stdout);
+    pthread_mutex_unlock(&ctx->print_lock);
+}
+
+static void* worker_main(void* arg) {
+    batch_worker* w = (batch_worker*)arg;
+    batch_context* ctx = w->ctx;
+    const int have_chain = chain_load(w) == 0;
+
+    for (;;) {
+        batch_task* task = deque_pop(&w->queue);
+        if (!task) {
+            task = steal_task(w);
+        }
+        if (!task) {
+            break;
+        }
+        const double t0 = now_seconds();
+        const int ok = have_chain && run_task(w, task) == 0;
+        const double elapsed = now_seconds() - t0;
+        w->tasks_done++;
+
+        batch_file* file = task->file;
+        pthread_mutex_lock(&file->lock);
+        file->process_seconds += elapsed;
+        file->failed |= !ok;
+        const int last = --file->segments_left == 0;
+        pthread_mutex_unlock(&file->lock);
+        if (last) {
+            report_file(ctx, file);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Command line
+ */
+
+static void make_output_path(const batch_file* file, const char* out_dir, char* out, size_t size) {
+    const char* name = file->in_path;
+    for (const char* p = file->in_path; *p; ++p) {
+        if (*p == '/' || *p == '\\') {
+            name = p + 1;
+        }
+    }
+    if (out_dir) {
+        snprintf(out, size, "%s/%s", out_dir, name);
+    } else {
+        const char* dot = strrchr(name, '.');
+        const int stem = dot ? (int)(dot - file->in_path) : (int)strlen(file->in_path);
+        snprintf(out, size, "%.*s.out.wav", stem, file->in_path);
+    }
+}
+
+static int compare_task_size(const void* a, const void* b) {
+    const size_t fa = (*(const batch_task* const*)a)->frames;
+    const size_t fb = (*(const batch_task* const*)b)->frames;
+    return fa < fb ? -1 : (fa > fb ? 1 : 0);
+}
+
+static void usage(const char* exe) {
+    fprintf(stderr,
+            "usage: %s [options] chain.lua file.wav [file.wav ...]\n"
+            "  -j N     number of worker threads (default: number of cores)\n"
+            "  -b N     block size in frames (default: %d)\n"
+            "  -s SEC   split files into segments of SEC seconds (default: whole files)\n"
+            "  -p SEC   preroll processed and discarded before each segment (default: 0)\n"
+            "  -o DIR   output directory (default: <input>.out.wav next to the input)\n",
+            exe, BATCH_DEFAULT_BLOCK);
+}
+
+int main(int argc, char** argv) {
+    batch_context ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.block = BATCH_DEFAULT_BLOCK;
+    ctx.num_workers = default_worker_count();
+    double segment_seconds = 0.0;
+    const char* out_dir = NULL;
+
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0'; ++arg) {
+        if (arg + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        switch (argv[arg][1]) {
+            case 'j': ctx.num_workers = atoi(argv[++arg]); break;
+            case 'b': ctx.block = (size_t)atol(argv[++arg]); break;
+            case 's': segment_seconds = atof(argv[++arg]); break;
+            case 'p': ctx.preroll_seconds = atof(argv[++arg]); break;
+            case 'o': out_dir = argv[++arg]; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (argc - arg < 2 || ctx.num_workers < 1 || ctx.block < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    ctx.script = argv[arg++];
+    ctx.stride = (ctx.block + 7) & ~(size_t)7; // 8 doubles keep every channel 64 byte aligned
+
+    const char* sep = ctx.script;
+    for (const char* p = ctx.script; *p; ++p) {
+        if (*p == '/' || *p == '\\') {
+            sep = p + 1;
+        }
+    }
+    snprintf(ctx.script_dir, sizeof(ctx.script_dir), "%.*s", (int)(sep - ctx.script), ctx.script);
+    if (ctx.script_dir[0] == '\0') {
+        strcpy(ctx.script_dir, "./");
+    }
+
+    // inspect all inputs and create the outputs up front
+    const int num_files = argc - arg;
+    batch_file* files = (batch_file*)calloc((size_t)num_files, sizeof(batch_file));
+    size_t num_tasks = 0;
+    double total_audio_seconds = 0.0;
+    for (int i = 0; i < num_files; ++i) {
+        batch_file* file = &files[i];
+        file->in_path = argv[arg + i];
+        pthread_mutex_init(&file->lock, NULL);
+        make_output_path(file, out_dir, file->out_path, sizeof(file->out_path));
+        if (wav_read_info(file->in_path, &file->info) != 0) {
+            fprintf(stderr, "skipping %s: not a readable PCM or float WAV file\n", file->in_path);
+            file->failed = 1;
+            continue;
+        }
+        wav_info out_info = file->info;
+        if (wav_create(file->out_path, &out_info) != 0) {
+            fprintf(stderr, "skipping %s: cannot create %s\n", file->in_path, file->out_path);
+            file->failed = 1;
+            continue;
+        }
+        file->out_data_offset = out_info.data_offset;
+        const size_t segment = segment_seconds > 0.0 ? (size_t)(segment_seconds * file->info.sample_rate) : 0;
+        file->segments_left = (segment > 0 && file->info.frames > 0) ? (int)((file->info.frames + segment - 1) / segment) : 1;
+        num_tasks += (size_t)file->segments_left;
+        total_audio_seconds += (double)file->info.frames / file->info.sample_rate;
+        if (file->info.channels > ctx.max_channels) ctx.max_channels = file->info.channels;
+        if (file->info.block_align > ctx.max_block_align) ctx.max_block_align = file->info.block_align;
+    }
+
+    batch_task* tasks = (batch_task*)calloc(num_tasks > 0 ? num_tasks : 1, sizeof(batch_task));
+    batch_task** order = (batch_task**)calloc(num_tasks > 0 ? num_tasks : 1, sizeof(batch_task*));
+    size_t t = 0;
+    for (int i = 0; i < num_files; ++i) {
+        batch_file* file = &files[i];
+        if (file->failed) {
+            continue;
+        }
+        const size_t segment = file->segments_left > 1 ? (size_t)(segment_seconds * file->info.sample_rate) : file->info.frames;
+        for (int s = 0; s < file->segments_left; ++s, ++t) {
+            tasks[t].file = file;
+            tasks[t].start = (size_t)s * segment;
+            tasks[t].frames = (s == file->segments_left - 1) ? file->info.frames - tasks[t].start : segment;
+            order[t] = &tasks[t];
+        }
+    }
+
+    // deal the tasks out round robin in ascending size, owners then start with their largest tasks
+    // and thieves pick up the small leftovers at the end
+    qsort(order, num_tasks, sizeof(batch_task*), compare_task_size);
+    if (ctx.num_workers > (int)num_tasks) {
+        ctx.num_workers = num_tasks > 0 ? (int)num_tasks : 1;
+    }
+    ctx.workers = (batch_worker*)calloc((size_t)ctx.num_workers, sizeof(batch_worker));
+    pthread_mutex_init(&ctx.print_lock, NULL);
+    for (int i = 0; i < ctx.num_workers; ++i) {
+        batch_worker* w = &ctx.workers[i];
+        w->id = i;
+        w->ctx = &ctx;
+        w->rng = 0x9E3779B9u * (uint32_t)(i + 1);
+        w->queue.items = (batch_task**)calloc(num_tasks / (size_t)ctx.num_workers + 1, sizeof(batch_task*));
+        pthread_mutex_init(&w->queue.lock, NULL);
+        w->buffer = allocate_aligned_memory((size_t)(ctx.max_channels > 0 ? ctx.max_channels : 1) * ctx.stride);
+        w->io = (unsigned char*)malloc(ctx.block * (size_t)(ctx.max_block_align > 0 ? ctx.max_block_align : 1));
+    }
+    for (size_t i = 0; i < num_tasks; ++i) {
+        task_deque* q = &ctx.workers[i % (size_t)ctx.num_workers].queue;
+        q->items[q->tail++] = order[i];
+    }
+
+    const double t0 = now_seconds();
+    for (int i = 0; i < ctx.num_workers; ++i) {
+        pthread_create(&ctx.workers[i].thread, NULL, worker_main, &ctx.workers[i]);
+    }
+    size_t stolen = 0;
+    for (int i = 0; i < ctx.num_workers; ++i) {
+        pthread_join(ctx.workers[i].thread, NULL);
+        stolen += ctx.workers[i].tasks_stolen;
+    }
+    const double wall = now_seconds() - t0;
+
+    int failed = 0;
+    for (int i = 0; i < num_files; ++i) {
+        failed += files[i].failed;
+    }
+    printf("\n%d files, %zu tasks (%zu stolen), %d workers\n", num_files, num_tasks, stolen, ctx.num_workers);
+    printf("%.2fs audio in %.3fs wall: aggregate RTF %.1fx", total_audio_seconds, wall,
+           wall > 0.0 ? total_audio_seconds / wall : 0.0);
+    printf(failed ? ", %d failed\n" : "\n", failed);
+
+    for (int i = 0; i < ctx.num_workers; ++i) {
+        batch_worker* w = &ctx.workers[i];
+        if (w->L) lua_close(w->L);
+        free_aligned_memory(w->buffer);
+        free(w->io);
+        free(w->queue.items);
+        pthread_mutex_destroy(&w->queue.lock);
+    }
+    for (int i = 0; i < num_files; ++i) {
+        pthread_mutex_destroy(&files[i].lock);
+    }
+    pthread_mutex_destroy(&ctx.print_lock);
+    free(ctx.workers);
+    free(order);
+    free(tasks);
+    free(files);
+    return failed ? 2 : 0;
+}
@@ -197,3 +197,784 @@ end
 
 example_compute_a_plus_bx()
 
+
+
+local function example_streaming_store()
+    local n = 1024 * 1024
+    local x = vector_add.allocate_aligned_memory(n)
+    local result = vector_add.allocate_aligned_memory(n)
+
+    -- Initialize x with some values
+    local _x = x()
+    for i = 0, n - 1 do
+        _x[i] = i
+    end
+
+    -- Force streaming stores, the result is not read again soon and should not evict x from the cache
+    print(string.format("streaming store threshold: %d bytes", vector_add.get_streaming_store_threshold()))
+    vector_add.compute_a_plus_bx_into(1.0, 0.5, x, result, n, vector_add.STORE_STREAM)
+    local _result = result()
+
+    for i = n - 4, n - 1 do
+        print(string.format("compute_a_plus_bx streamed[%d] = %f", i, _result[i]))
+    end
+end
+
+example_streaming_store()
+
+local function example_mix_n_vectors()
+    local n = 8
+    local a = vector_add.allocate_aligned_memory(n)
+    local b = vector_add.allocate_aligned_memory(n)
+    local bus = vector_add.allocate_aligned_memory(n)
+
+    -- Initialize a and b with some values
+    local _a = a()
+    local _b = b()
+    for i = 0, n - 1 do
+        _a[i] = i
+        _b[i] = n - i
+    end
+
+    -- Mix both inputs into the bus in one pass, then add a send of a with another gain
+    vector_add.mix_n_vectors_into({ a, b }, { 0.5, 0.25 }, bus, n)
+    vector_add.accumulate_vector_into(a, 0.1, bus, n)
+    local _bus = bus()
+
+    for i = 0, n - 1 do
+        print(string.format("bus[%d] = %f", i, _bus[i]))
+    end
+end
+
+example_mix_n_vectors()
+
+local function example_gain_smoothing()
+    local n = 8
+    local x = vector_add.allocate_aligned_memory(n)
+    local result = vector_add.allocate_aligned_memory(n)
+    local smoothed = vector_add.allocate_aligned_memory(n)
+
+    -- Initialize x with a constant signal
+    local _x = x()
+    for i = 0, n - 1 do
+        _x[i] = 1.0
+    end
+
+    -- Fade in over the block, and glide a cutoff parameter to its new value
+    vector_add.apply_gain_ramp_into(x, result, 0.0, 1.0, n)
+    local bank = vector_add.smoother_bank_create(1, 48000, 0.05)
+    vector_add.smoother_bank_reset(bank, 0, 200.0)
+    vector_add.smoother_bank_set_target(bank, 0, 1000.0)
+    vector_add.smoother_bank_process_into(bank, smoothed, n, n)
+    local _result = result()
+    local _smoothed = smoothed()
+
+    for i = 0, n - 1 do
+        print(string.format("ramp[%d] = %f, cutoff[%d] = %f", i, _result[i], i, _smoothed[i]))
+    end
+end
+
+example_gain_smoothing()
+
+local function example_denormals()
+    local n = 8
+    local x = vector_add.allocate_aligned_memory(n)
+
+    -- Initialize x with a decaying tail that ends in subnormals
+    local _x = x()
+    for i = 0, n - 1 do
+        _x[i] = 10 ^ (-45 * i)
+    end
+
+    local subnormals, nans, infs = vector_add.count_fp_classes(x, n)
+    print(string.format("subnormals: %d, nans: %d, infs: %d", subnormals, nans, infs))
+    print(string.format("flushed: %d", vector_add.flush_denormals_inplace(x, n)))
+
+    -- Run a block of processing with FTZ/DAZ, the previous mode is restored afterwards
+    vector_add.with_ftz_daz(function()
+        print(string.format("FTZ/DAZ inside: %s", tostring(vector_add.get_ftz_daz())))
+    end)
+    print(string.format("FTZ/DAZ outside: %s", tostring(vector_add.get_ftz_daz())))
+end
+
+example_denormals()
+
+local function example_half_storage()
+    local n = 8
+    local x = vector_add.allocate_aligned_memory(n)
+    local dry = vector_add.allocate_aligned_memory(n)
+    local result = vector_add.allocate_aligned_memory(n)
+    local history = vector_add.allocate_half_memory(n)
+
+    -- Initialize x and dry with some values
+    local _x = x()
+    local _dry = dry()
+    for i = 0, n - 1 do
+        _x[i] = math.sin(0.3 * i)
+        _dry[i] = 1.0
+    end
+
+    -- Write a gained copy of x into the compressed history, then add it back onto the dry signal
+    vector_add.compute_a_plus_bx_compressed_into(0.0, 0.5, x, history, n, "f16")
+    vector_add.add_vectors_compressed_into(history, dry, result, n, "f16")
+    local _result = result()
+
+    for i = 0, n - 1 do
+        print(string.format("dry + 0.5 * x[%d] = %f (exact %f)", i, _result[i], 1.0 + 0.5 * _x[i]))
+    end
+end
+
+example_half_storage()
+
+local function example_pcm_dither()
+    local n = 8
+    local x = vector_add.allocate_aligned_memory(n)
+    local back = vector_add.allocate_aligned_memory(n)
+    local pcm = vector_add.allocate_pcm_memory(n, 24)
+    local rng = vector_add.rng_create(42)
+
+    -- Initialize x with some values
+    local _x = x()
+    for i = 0, n - 1 do
+        _x[i] = 0.9 * math.sin(0.5 * i)
+    end
+
+    -- Quantize to packed 24 bit with TPDF dither and read it back
+    vector_add.vector_to_pcm_into(x, pcm, n, 24, 1.0, rng)
+    vector_add.pcm_to_vector_into(pcm, back, n, 24)
+    local _back = back()
+
+    for i = 0, n - 1 do
+        print(string.format("x[%d] = %f, 24 bit = %f, error = %.2f LSB", i, _x[i], _back[i], (_back[i] - _x[i]) * 8388608))
+    end
+end
+
+example_pcm_dither()
+
+local function example_noise()
+    local n = 1024
+    local white = vector_add.allocate_aligned_memory(n)
+    local pink = vector_add.allocate_aligned_memory(n)
+    local rng = vector_add.rng_create(7)
+
+    -- The same seed always gives the same noise, handy for reproducible test signals
+    vector_add.noise_gaussian_into(rng, white, n, 0.0, 0.25)
+    vector_add.noise_pink_into(rng, pink, n, 0.5)
+    local _white = white()
+    local _pink = pink()
+
+    local whiteSum, pinkSum = 0.0, 0.0
+    for i = 0, n - 1 do
+        whiteSum = whiteSum + _white[i] * _white[i]
+        pinkSum = pinkSum + _pink[i] * _pink[i]
+    end
+    print(string.format("gaussian rms = %f, pink rms = %f", math.sqrt(whiteSum / n), math.sqrt(pinkSum / n)))
+    for i = 0, 3 do
+        print(string.format("white[%d] = %f, pink[%d] = %f", i, _white[i], i, _pink[i]))
+    end
+end
+
+example_noise()
+
+local function example_delay_line()
+    local n = 8
+    local x = vector_add.allocate_aligned_memory(n)
+    local delays = vector_add.allocate_aligned_memory(n)
+    local chorus = vector_add.allocate_aligned_memory(n)
+    local echoes = vector_add.allocate_aligned_memory(n)
+    local dl = vector_add.delay_line_create(64, n)
+
+    local _x = x()
+    local _delays = delays()
+    for block = 0, 7 do
+        -- Initialize x with the next block of a sine and a slowly modulated delay time
+        for i = 0, n - 1 do
+            local t = block * n + i
+            _x[i] = math.sin(0.2 * t)
+            _delays[i] = 10 + 3 * math.sin(0.05 * t)
+        end
+        vector_add.delay_line_write(dl, x, n)
+        vector_add.delay_line_read_into(dl, delays, chorus, n, vector_add.DELAY_LAGRANGE)
+        vector_add.delay_line_mix_taps_into(dl, { 7.5, 19.25, 40 }, { 0.5, 0.3, 0.2 }, echoes, n)
+    end
+
+    local _chorus = chorus()
+    local _echoes = echoes()
+    for i = 0, n - 1 do
+        print(string.format("x[%d] = %f, modulated = %f, echoes = %f", i, _x[i], _chorus[i], _echoes[i]))
+    end
+end
+
+example_delay_line()
+
+local function example_fdn_reverb()
+    local n = 512
+    local x = vector_add.allocate_aligned_memory(n)
+    local left = vector_add.allocate_aligned_memory(n)
+    local right = vector_add.allocate_aligned_memory(n)
+    local reverb = vector_add.fdn_reverb_create(8, 48000, 50)
+    vector_add.fdn_reverb_set_decay(reverb, 1.5, 7000)
+    vector_add.fdn_reverb_set_modulation(reverb, 4, 0.8)
+
+    -- Feed a short click, then let the tail ring out
+    local _x = x()
+    _x[0] = 1.0
+    for block = 1, 6 do
+        vector_add.fdn_reverb_process_into(reverb, x, nil, left, right, n)
+        _x[0] = 0.0
+        local _left, _right = left(), right()
+        local energy = 0.0
+        for i = 0, n - 1 do
+            energy = energy + _left[i] * _left[i] + _right[i] * _right[i]
+        end
+        print(string.format("block %d: tail energy %f", block, energy))
+    end
+end
+
+example_fdn_reverb()
+
+local function example_limiter()
+    local n = 256
+    local left = vector_add.allocate_aligned_memory(n)
+    local right = vector_add.allocate_aligned_memory(n)
+    local lim = vector_add.limiter_create(2, 48000, 1.5, n)
+    vector_add.limiter_set_ceiling(lim, 0.8)
+    vector_add.limiter_set_release(lim, 30)
+
+    local peak = 0.0
+    for block = 0, 3 do
+        -- Initialize a sine that gets louder with every block
+        local _left, _right = left(), right()
+        for i = 0, n - 1 do
+            local t = block * n + i
+            _left[i] = (0.5 + 0.5 * block) * math.sin(0.05 * t)
+            _right[i] = (0.5 + 0.5 * block) * math.cos(0.05 * t)
+        end
+        vector_add.limiter_process_inplace(lim, { left, right }, n)
+        for i = 0, n - 1 do
+            peak = math.max(peak, math.abs(_left[i]), math.abs(_right[i]))
+        end
+        print(string.format("block %d: gain %f", block, vector_add.limiter_get_gain(lim)))
+    end
+    print(string.format("latency %d samples, output peak %f", vector_add.limiter_get_latency(lim), peak))
+end
+
+example_limiter()
+
+local function example_sliding_windows()
+    local n = 64
+    local blockSize = 16
+    local x = vector_add.allocate_aligned_memory(n)
+    local peaks = vector_add.allocate_aligned_memory(n)
+    local held = vector_add.allocate_aligned_memory(n)
+    local block = vector_add.allocate_aligned_memory(blockSize)
+    local out = vector_add.allocate_aligned_memory(blockSize)
+
+    -- Initialize x with a few transients
+    local _x = x()
+    for i = 0, n - 1 do
+        _x[i] = (i % 13 == 0) and 1.0 or 0.1 * math.sin(i)
+    end
+
+    -- Whole buffer: moving maximum over 8 samples with a hop of 4
+    local _, count = vector_add.sliding_max_into(x, n, 8, 4, peaks)
+
+    -- The same windows from a stream of blocks, the state keeps the window in progress
+    local sw = vector_add.sliding_window_create(vector_add.WINDOW_MAX, 8, 4, blockSize)
+    local _block, _held = block(), held()
+    local streamed = 0
+    for offset = 0, n - 1, blockSize do
+        for i = 0, blockSize - 1 do
+            _block[i] = _x[offset + i]
+        end
+        local _, got = vector_add.sliding_window_process_into(sw, block, blockSize, out)
+        local _out = out()
+        for k = 0, got - 1 do
+            _held[streamed + k] = _out[k]
+        end
+        streamed = streamed + got
+    end
+
+    local _peaks = peaks()
+    for k = 0, count - 1 do
+        print(string.format("window %d: peak = %f, streamed = %f", k, _peaks[k], _held[k]))
+    end
+end
+
+example_sliding_windows()
+
+local function example_dynamics()
+    local n = 256
+    local channels, sidechain = {}, {}
+    for c = 1, 8 do
+        channels[c] = vector_add.allocate_aligned_memory(n)
+        sidechain[c] = vector_add.allocate_aligned_memory(n)
+    end
+
+    -- Eight channels (four stereo pairs) in the same SIMD lanes, ducked by a kick-like sidechain
+    local dyn = vector_add.dynamics_create(8, 48000, n)
+    vector_add.dynamics_set_detector(dyn, vector_add.DYN_DETECT_RMS, 5)
+    vector_add.dynamics_set_curve(dyn, -30, 6, 10)
+    vector_add.dynamics_set_times(dyn, 2, 80)
+    vector_add.dynamics_set_link(dyn, vector_add.DYN_LINK_PAIRS)
+
+    for c = 1, 8 do
+        local _x, _sc = channels[c](), sidechain[c]()
+        for i = 0, n - 1 do
+            _x[i] = 0.3 * math.sin(0.01 * c * i)
+            _sc[i] = (i < 64) and math.sin(0.2 * i) or 0.0
+        end
+    end
+    vector_add.dynamics_process_inplace(dyn, channels, n, sidechain)
+    for c = 1, 8, 2 do
+        print(string.format("pair %d: gain %f dB", (c + 1) / 2, vector_add.dynamics_get_gain_db(dyn, c)))
+    end
+
+    -- The same object as a gate: the release opens it again as the channels rise above -40 dB
+    vector_add.dynamics_reset(dyn)
+    vector_add.dynamics_set_mode(dyn, vector_add.DYN_GATE)
+    vector_add.dynamics_set_detector(dyn, vector_add.DYN_DETECT_PEAK)
+    vector_add.dynamics_set_curve(dyn, -40, 1, 0, 60)
+    vector_add.dynamics_process_inplace(dyn, channels, n)
+    print(string.format("gate: gain %f dB", vector_add.dynamics_get_gain_db(dyn, 1)))
+end
+
+example_dynamics()
+
+local function example_saturation()
+    local n = 1024
+    local x = vector_add.allocate_aligned_memory(n)
+    local plain = vector_add.allocate_aligned_memory(n)
+    local smooth = vector_add.allocate_aligned_memory(n)
+
+    -- A loud high sine: its odd harmonics fold back below Nyquist
+    local _x = x()
+    for i = 0, n - 1 do
+        _x[i] = math.sin(2 * math.pi * 0.19 * i)
+    end
+
+    -- Asymmetric tanh drive, once per sample and once with ADAA over two blocks
+    vector_add.saturate_vector_into(x, plain, n, vector_add.SAT_TANH, 8, 0.2)
+    local sat = vector_add.saturator_create(vector_add.SAT_TANH, 8, 0.2)
+    local half = n / 2
+    local _smooth = smooth()
+    local block = vector_add.allocate_aligned_memory(half)
+    local out = vector_add.allocate_aligned_memory(half)
+    for offset = 0, n - 1, half do
+        local _block, _out = block(), out()
+        for i = 0, half - 1 do
+            _block[i] = _x[offset + i]
+        end
+        vector_add.saturator_process_into(sat, block, out, half)
+        for i = 0, half - 1 do
+            _smooth[offset + i] = _out[i]
+        end
+    end
+
+    -- Energy of the sample to sample differences, dominated by the aliased high components
+    local _plain = plain()
+    local rough, soft = 0.0, 0.0
+    for i = 1, n - 1 do
+        rough = rough + (_plain[i] - _plain[i - 1]) ^ 2
+        soft = soft + (_smooth[i] - _smooth[i - 1]) ^ 2
+    end
+    print(string.format("difference energy: plain %f, ADAA %f", rough, soft))
+
+    -- Safety clipping of the driven signal
+    vector_add.clamp_vector_into(plain, plain, n, -0.9, 0.9)
+    local peak = 0.0
+    for i = 0, n - 1 do
+        peak = math.max(peak, math.abs(_plain[i]))
+    end
+    print(string.format("clipped peak %f", peak))
+end
+
+example_saturation()
+
+local function example_oversampling()
+    local n = 256
+    local left = vector_add.allocate_aligned_memory(n)
+    local right = vector_add.allocate_aligned_memory(n)
+    local os = vector_add.oversampler_create(2, 4, n)
+
+    for block = 0, 3 do
+        local _left, _right = left(), right()
+        for i = 0, n - 1 do
+            local t = block * n + i
+            _left[i] = math.sin(2 * math.pi * 0.21 * t)
+            _right[i] = math.sin(2 * math.pi * 0.013 * t)
+        end
+        -- Any elementwise stage can run at the oversampled rate, here a biased cubic shaper followed by a gain
+        vector_add.oversampler_process_inplace(os, { left, right }, n, function(buffer, nUp)
+            vector_add.saturate_vector_into(buffer, buffer, nUp, vector_add.SAT_CUBIC, 3, 0.1)
+            vector_add.scale_vector_inplace(buffer, 0.8, nUp)
+        end)
+        print(string.format("block %d: left[0] = %f, right[0] = %f", block, _left[0], _right[0]))
+    end
+    print(string.format("latency %f samples", vector_add.oversampler_get_latency(os)))
+
+    -- The built-in saturation path does the same without calling back into Lua
+    vector_add.oversampler_reset(os)
+    vector_add.oversampler_saturate_inplace(os, { left, right }, n, vector_add.SAT_TANH, 4)
+end
+
+example_oversampling()
+
+local function example_wavetable_bank()
+    local n = 256
+    local numVoices = 16
+    local mix = vector_add.allocate_aligned_memory(n)
+
+    -- Built-in shapes are cached per process, a second instance gets the same tables
+    local saw = vector_add.wavetable_acquire_shape(vector_add.WT_SAW)
+
+    -- A custom cycle, shared under its key
+    local cycleLength = 600
+    local cycle = vector_add.allocate_aligned_memory(cycleLength)
+    local _cycle = cycle()
+    for i = 0, cycleLength - 1 do
+        local t = i / cycleLength
+        _cycle[i] = math.sin(2 * math.pi * t) + 0.3 * math.sin(2 * math.pi * 5 * t) * (1 - t)
+    end
+    local custom = vector_add.wavetable_acquire("example:organ", cycle, cycleLength)
+
+    -- A 16 voice chord on the saw, four of them detuned copies of the custom wave
+    local bank = vector_add.wavetable_bank_create(saw, numVoices, 48000)
+    local pad = vector_add.wavetable_bank_create(custom, 4, 48000)
+    for v = 1, numVoices do
+        vector_add.wavetable_bank_set_frequency(bank, v, 110 * 2 ^ ((v - 1) * 5 / 12))
+        vector_add.wavetable_bank_set_gain(bank, v, 1 / numVoices)
+    end
+    for v = 1, 4 do
+        vector_add.wavetable_bank_set_frequency(pad, v, 220 * (1 + 0.003 * v))
+        vector_add.wavetable_bank_set_phase(pad, v, v / 4)
+    end
+
+    vector_add.wavetable_bank_process_mix_into(bank, mix, n)
+    local padRows = vector_add.allocate_aligned_memory(4 * n)
+    vector_add.wavetable_bank_process_into(pad, padRows, n, n)
+
+    local _mix, _pad = mix(), padRows()
+    for i = 0, 7 do
+        print(string.format("mix[%d] = %f, pad voice 1 = %f, pad voice 4 = %f", i, _mix[i], _pad[i], _pad[3 * n + i]))
+    end
+end
+
+example_wavetable_bank()
+
+local function example_additive()
+    local n = 512
+    local numPartials = 256
+    local result = vector_add.allocate_aligned_memory(n)
+    local frequencies = vector_add.allocate_aligned_memory(numPartials)
+    local amplitudes = vector_add.allocate_aligned_memory(numPartials)
+    local bank = vector_add.additive_bank_create(numPartials, 48000)
+
+    -- A slightly stretched saw-like spectrum on 55 Hz
+    local _f, _a = frequencies(), amplitudes()
+    for k = 0, numPartials - 1 do
+        local h = k + 1
+        _f[k] = 55 * h * (1 + 0.0004 * h)
+        _a[k] = 0.5 / h
+    end
+    vector_add.additive_bank_set_partials(bank, frequencies, amplitudes, numPartials)
+    vector_add.additive_bank_reset(bank)
+
+    for block = 0, 3 do
+        vector_add.zero_vector_into(result, n)
+        vector_add.additive_bank_process_into(bank, result, n)
+        local _r = result()
+        local peak = 0.0
+        for i = 0, n - 1 do
+            peak = math.max(peak, math.abs(_r[i]))
+        end
+        print(string.format("block %d: peak %f", block, peak))
+
+        -- Glide up a fifth and darken the spectrum, both ramp smoothly over the next block
+        for k = 0, numPartials - 1 do
+            _f[k] = _f[k] * 2 ^ (7 / 12 / 4)
+            _a[k] = _a[k] * (1 - 0.002 * k)
+        end
+        vector_add.additive_bank_set_partials(bank, frequencies, amplitudes, numPartials)
+    end
+end
+
+example_additive()
+
+local function example_blep_bank()
+    local n = 256
+    local numVoices = 8
+    local rows = vector_add.allocate_aligned_memory(numVoices * n)
+    local mix = vector_add.allocate_aligned_memory(n)
+
+    -- Eight detuned saws for a supersaw, and a second bank with a swept hard synced pulse
+    local saws = vector_add.blep_bank_create(numVoices, 48000, vector_add.BLEP_SAW)
+    for v = 1, numVoices do
+        vector_add.blep_bank_set_frequency(saws, v, 220 * (1 + 0.01 * (v - numVoices / 2)))
+        vector_add.blep_bank_set_phase(saws, v, v / numVoices)
+        vector_add.blep_bank_set_gain(saws, v, 1 / numVoices)
+    end
+    local lead = vector_add.blep_bank_create(1, 48000, vector_add.BLEP_SQUARE)
+    vector_add.blep_bank_set_sync(lead, 1, 220)
+
+    for block = 0, 3 do
+        vector_add.blep_bank_process_mix_into(saws, mix, n)
+        -- Sweep the synced slave and modulate its pulse width once per block
+        vector_add.blep_bank_set_frequency(lead, 1, 440 + 300 * block)
+        vector_add.blep_bank_set_pulse_width(lead, 1, 0.5 + 0.1 * block)
+        vector_add.blep_bank_process_into(lead, rows, n, n)
+        local _mix, _rows = mix(), rows()
+        print(string.format("block %d: supersaw %f, synced pulse %f", block, _mix[n - 1], _rows[n - 1]))
+    end
+end
+
+example_blep_bank()
+
+local function example_voice_engine()
+    local n = 256
+    local mix = vector_add.allocate_aligned_memory(n)
+    local engine = vector_add.voice_engine_create(8, 48000)
+    vector_add.voice_engine_set_envelope(engine, 2, 100, 0.6, 10)
+
+    -- A C minor chord, then one note too many steals the oldest voice
+    local notes = { 48, 51, 55, 60, 63, 67, 72, 75, 79 }
+    for _, note in ipairs(notes) do
+        local stolen = vector_add.voice_engine_note_on(engine, note, 440 * 2 ^ ((note - 69) / 12), 0.1, 3000)
+        if stolen then
+            print(string.format("note %d stole note %d", note, stolen))
+        end
+    end
+
+    -- Vibrato across the voice dimension: scale every increment with one vector kernel call
+    local bend = vector_add.allocate_aligned_memory(8)
+    for block = 0, 3 do
+        local increments, lanes = vector_add.voice_engine_get_field(engine, vector_add.VOICE_FIELD_INCREMENT)
+        vector_add.fill_vector_into(1 + 0.003 * math.sin(block), bend, lanes)
+        vector_add.mul_vectors_into(increments, bend, increments, lanes)
+        vector_add.voice_engine_process_into(engine, mix, n)
+        if block == 1 then
+            for _, note in ipairs(notes) do
+                vector_add.voice_engine_note_off(engine, note)
+            end
+        end
+        local active = vector_add.voice_engine_get_voices(engine)
+        print(string.format("block %d: %d voices, last sample %f", block, active, mix()[n - 1]))
+    end
+end
+
+example_voice_engine()
+
+local function example_envelope_bank()
+    local n = 128
+    local numVoices = 64
+    local osc = vector_add.allocate_aligned_memory(numVoices * n)
+    local env = vector_add.allocate_aligned_memory(numVoices * n)
+
+    -- 64 voices: oscillators and envelopes render into rows with the same stride
+    local voices = vector_add.blep_bank_create(numVoices, 48000, vector_add.BLEP_SAW)
+    local envelopes = vector_add.envelope_bank_create(numVoices, 48000)
+    for v = 1, numVoices do
+        vector_add.blep_bank_set_frequency(voices, v, 55 * v)
+        if v % 2 == 0 then
+            vector_add.envelope_bank_set_adsr(envelopes, v, 1, 2, 0.5, 1)
+        else
+            -- slow swell, fast pluck, then a hold at 0.3 until the gate closes and a curved fade
+            vector_add.envelope_bank_set_segments(envelopes, v, {
+                { 1.0, 1, -4 }, { 0.3, 0.5, 4 }, { 0.3, 0 }, { 0.0, 2, 5 }
+            }, 3)
+        end
+        vector_add.envelope_bank_gate(envelopes, v, true)
+    end
+
+    for block = 0, 19 do
+        if block == 10 then
+            for v = 1, numVoices do
+                vector_add.envelope_bank_gate(envelopes, v, false)
+            end
+        end
+        vector_add.blep_bank_process_into(voices, osc, n, n)
+        vector_add.envelope_bank_process_into(envelopes, env, n, n)
+        -- one call applies all 64 envelopes to all 64 voices
+        vector_add.mul_vectors_into(osc, env, osc, numVoices * n)
+        if block % 5 == 4 then
+            print(string.format("block %d: envelope 1 at %f (segment %s), envelope 2 at %f (segment %s)", block,
+                vector_add.envelope_bank_get_level(envelopes, 1), tostring(vector_add.envelope_bank_get_stage(envelopes, 1)),
+                vector_add.envelope_bank_get_level(envelopes, 2), tostring(vector_add.envelope_bank_get_stage(envelopes, 2))))
+        end
+    end
+end
+
+example_envelope_bank()
+
+local function example_svf_bank()
+    local n = 256
+    local numVoices = 4
+    local osc = vector_add.allocate_aligned_memory(numVoices * n)
+    local env = vector_add.allocate_aligned_memory(numVoices * n)
+    local voices = vector_add.blep_bank_create(numVoices, 48000, vector_add.BLEP_SAW)
+    local envelopes = vector_add.envelope_bank_create(numVoices, 48000)
+    local filters = vector_add.svf_bank_create(numVoices, 48000)
+
+    -- Per voice views into the row buffers, and a cutoff buffer per voice
+    local inputs, cutoffs, lowpass = {}, {}, {}
+    for v = 1, numVoices do
+        local row = ffi.cast("double*", osc()) + (v - 1) * n
+        inputs[v] = function() return row end
+        local envRow = ffi.cast("double*", env()) + (v - 1) * n
+        cutoffs[v] = function() return envRow end
+        lowpass[v] = vector_add.allocate_aligned_memory(n)
+        vector_add.blep_bank_set_frequency(voices, v, 110 * v)
+        vector_add.envelope_bank_set_adsr(envelopes, v, 2, 60, 0.2, 100)
+        vector_add.envelope_bank_gate(envelopes, v, true)
+        vector_add.svf_bank_set_resonance(filters, v, 1 + 2 * v)
+    end
+
+    for block = 0, 3 do
+        vector_add.blep_bank_process_into(voices, osc, n, n)
+        vector_add.envelope_bank_process_into(envelopes, env, n, n)
+        -- the envelope sweeps the cutoff from 300 Hz to 8.3 kHz, coefficients follow every sample
+        vector_add.compute_a_plus_bx_into(300, 8000, env, env, numVoices * n)
+        vector_add.svf_bank_process(filters, inputs, n, { lowpass = lowpass }, cutoffs)
+        local _lp = lowpass[numVoices]()
+        print(string.format("block %d: voice %d lowpass %f, cutoff %.0f Hz", block, numVoices, _lp[n - 1], env()[numVoices * n - 1]))
+    end
+end
+
+example_svf_bank()
+
+local function example_biquad_bank()
+    local n = 512
+    local numBands = 32
+    local left = vector_add.allocate_aligned_memory(n)
+    local right = vector_add.allocate_aligned_memory(n)
+
+    -- One-off batch design, e.g. to draw an EQ curve
+    local coeffs = vector_add.biquad_design({
+        { vector_add.BIQUAD_LOWSHELF, 100, 0.707, 3 },
+        { vector_add.BIQUAD_PEAK, 2500, 1.4, -4 },
+        { vector_add.BIQUAD_HIGHPASS, 30, 0.707 }
+    }, 48000)
+    print(string.format("peak band: b0 %f a1 %f a2 %f", coeffs.b0()[1], coeffs.a1()[1], coeffs.a2()[1]))
+
+    -- A 32 band stereo graphic EQ whose gains are automated every block; the bank redesigns
+    -- all 64 biquads in one batch and ramps the coefficients over the block
+    local eq = vector_add.biquad_bank_create(2, numBands, 48000)
+    for block = 0, 7 do
+        for band = 1, numBands do
+            local frequency = 20 * 2 ^ ((band - 1) / 3.2)
+            local gain = 6 * math.sin(0.4 * band + 0.5 * block)
+            vector_add.biquad_bank_set(eq, 1, band, vector_add.BIQUAD_PEAK, frequency, 4.3, gain)
+            vector_add.biquad_bank_set(eq, 2, band, vector_add.BIQUAD_PEAK, frequency, 4.3, -gain)
+        end
+        local _l, _r = left(), right()
+        for i = 0, n - 1 do
+            _l[i] = (i == 0 and block == 0) and 1 or 0
+            _r[i] = _l[i]
+        end
+        vector_add.biquad_bank_process_inplace(eq, { left, right }, n)
+        if block % 4 == 0 then
+            print(string.format("block %d: impulse response left %f, right %f", block, _l[10], _r[10]))
+        end
+    end
+end
+
+example_biquad_bank()
+
+local function example_crossover()
+    local n = 256
+    local left = vector_add.allocate_aligned_memory(n)
+    local right = vector_add.allocate_aligned_memory(n)
+    local xo = vector_add.crossover_create(2, 4, 48000, n)
+    vector_add.crossover_set_frequency(xo, 1, 120)
+    vector_add.crossover_set_frequency(xo, 2, 1000)
+    vector_add.crossover_set_frequency(xo, 3, 6000)
+
+    -- Multiband saturation: split, drive each band differently, recombine with band gains
+    local drives = { 1.5, 1, 3, 0.5 }
+    for block = 0, 3 do
+        local _l, _r = left(), right()
+        for i = 0, n - 1 do
+            local t = block * n + i
+            _l[i] = 0.8 * math.sin(0.01 * t) + 0.2 * math.sin(0.9 * t)
+            _r[i] = 0.8 * math.sin(0.013 * t) + 0.2 * math.sin(0.7 * t)
+        end
+        local bands = vector_add.crossover_process(xo, { left, right }, n)
+        for c = 1, 2 do
+            for b = 1, 4 do
+                vector_add.saturate_vector_into(bands[c][b], bands[c][b], n, vector_add.SAT_TANH, drives[b])
+            end
+        end
+        vector_add.crossover_recombine_into(xo, { left, right }, n, { 1, 1, 0.7, 1 })
+        print(string.format("block %d: left %f, right %f", block, _l[n - 1], _r[n - 1]))
+    end
+end
+
+example_crossover()
+
+local function example_complex_kernels()
+    local n = 8
+    local re = vector_add.allocate_aligned_memory(n)
+    local im = vector_add.allocate_aligned_memory(n)
+    local mag = vector_add.allocate_aligned_memory(n)
+    local phase = vector_add.allocate_aligned_memory(n)
+    local z = vector_add.allocate_aligned_memory(2 * n)
+    local _re, _im, _z = re(), im(), z()
+    for i = 0, n - 1 do
+        _re[i] = math.cos(0.7 * i)
+        _im[i] = math.sin(0.7 * i)
+        _z[2 * i] = 0.5
+        _z[2 * i + 1] = 0.5
+    end
+
+    -- Split layout: polar round trip with the phases advanced by a quarter turn
+    vector_add.complex_to_polar_split_into(re, im, mag, phase, n)
+    local _phase = phase()
+    for i = 0, n - 1 do
+        _phase[i] = _phase[i] + math.pi / 2
+    end
+    vector_add.complex_from_polar_split_into(mag, phase, re, im, n)
+    print(string.format("rotated: (%f, %f)", _re[1], _im[1]))
+
+    -- Interleaved layout: z * conj(z) is the power spectrum on the real parts
+    vector_add.complex_conj_mul_interleaved_into(z, z, z, n)
+    vector_add.complex_magnitude_interleaved_into(z, mag, n)
+    print(string.format("power: %f, magnitude: %f", _z[0], mag()[0]))
+end
+
+example_complex_kernels()
+
+local function example_stft()
+    local n = 300 -- host blocks need not line up with the hop
+    local fftSize, hop = 1024, 256
+    local st = vector_add.stft_create(1, fftSize, hop, vector_add.STFT_WINDOW_HANN)
+    local buffer = vector_add.allocate_aligned_memory(n)
+    local magnitude = vector_add.allocate_aligned_memory(st.binVectorSize)
+
+    -- Spectral gate: bins below the threshold are cleared, the tone at bin 32 passes, the noise floor goes
+    local threshold = 20
+    local function gate(re, im, numBins)
+        vector_add.complex_magnitude_split_into(re, im, magnitude, st.binVectorSize)
+        local _re, _im, _m = re(), im(), magnitude()
+        for k = 0, numBins - 1 do
+            if _m[k] < threshold then
+                _re[k] = 0
+                _im[k] = 0
+            end
+        end
+    end
+
+    local seed = 1
+    for block = 0, 15 do
+        local _b = buffer()
+        for i = 0, n - 1 do
+            seed = (seed * 1103515245 + 12345) % 2147483648
+            _b[i] = 0.5 * math.sin(2 * math.pi * 32 * (block * n + i) / fftSize) + 0.05 * (seed / 2147483648 - 0.5)
+        end
+        vector_add.stft_process(st, { buffer }, { buffer }, n, gate)
+        if block % 4 == 3 then
+            print(string.format("block %d: %f (latency %d)", block, _b[n - 1], vector_add.stft_get_latency(st)))
+        end
+    end
+end
+
+example_stft()
@@ -1,7 +1,10 @@
 #include <immintrin.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <time.h>
+#include <math.h>
 
 extern void add_vectors(const double* a, const double* b, double* result, size_t n);
 extern void square_vector(const double* a, double* result, size_t n);
@@ -11,6 +14,148 @@ extern double* compute_rms_windowed(const double* input, size_t n, size_t window
 extern void compute_abs_ratio(const double* a, const double* b, double* result, size_t n);
 extern void squared_difference(const double* a, const double* b, double* result, size_t n);
 extern void compute_a_plus_bx(double a, double b, const double* x, double* result, size_t n);
+extern void compute_a_plus_bx_ex(double a, double b, const double* x, double* result, size_t n, int store_mode);
+extern size_t get_streaming_store_threshold(void);
+extern void zero_vector(double* result, size_t n);
+extern void accumulate_vector(const double* x, double gain, double* y, size_t n);
+extern void apply_gain_ramp(const double* x, double* result, double g0, double g1, size_t n);
+typedef struct smoother_bank smoother_bank;
+extern smoother_bank* smoother_bank_create(size_t num_params, double sample_rate, double time_ms);
+extern void smoother_bank_destroy(smoother_bank* bank);
+extern void smoother_bank_set_target(smoother_bank* bank, size_t index, double target);
+extern void smoother_bank_process(smoother_bank* bank, double* result, size_t stride, size_t n);
+extern unsigned int simd_set_ftz_daz(int on);
+extern void simd_restore_fp_mode(unsigned int mode);
+extern void count_fp_classes(const double* input, size_t n, size_t counts[3]);
+extern size_t flush_denormals(double* x, size_t n);
+extern uint16_t* allocate_half_memory(size_t n);
+extern void free_half_memory(uint16_t* ptr);
+extern void convert_double_to_f16(const double* input, uint16_t* result, size_t n);
+extern void convert_double_to_bf16(const double* input, uint16_t* result, size_t n);
+extern void add_vectors_f16src(const uint16_t* a, const double* b, double* result, size_t n);
+extern void add_vectors_bf16src(const uint16_t* a, const double* b, double* result, size_t n);
+extern void mix_n_vectors(const double* const* inputs, const double* gains, size_t num_inputs, double* result, size_t n);
+typedef struct simd_rng simd_rng;
+extern simd_rng* simd_rng_create(uint64_t seed);
+extern void simd_rng_destroy(simd_rng* rng);
+extern void simd_rng_fill_uniform(simd_rng* rng, double* result, size_t n, double lo, double hi);
+extern void simd_rng_fill_gaussian(simd_rng* rng, double* result, size_t n, double mean, double sigma);
+extern void simd_rng_fill_pink(simd_rng* rng, double* result, size_t n, double amplitude);
+typedef struct delay_line delay_line;
+extern delay_line* delay_line_create(size_t max_delay, size_t max_block);
+extern void delay_line_destroy(delay_line* dl);
+extern void delay_line_write(delay_line* dl, const double* input, size_t n);
+extern void delay_line_read(const delay_line* dl, const double* delays, double* result, size_t n, int interpolation);
+typedef struct fdn_reverb fdn_reverb;
+extern fdn_reverb* fdn_reverb_create(size_t num_lines, double sample_rate, double max_delay_ms);
+extern void fdn_reverb_destroy(fdn_reverb* fdn);
+extern void fdn_reverb_set_decay(fdn_reverb* fdn, double rt60, double damping_hz);
+extern void fdn_reverb_process(fdn_reverb* fdn, const double* in_left, const double* in_right, double* out_left, double* out_right, size_t n);
+typedef struct limiter limiter;
+extern limiter* limiter_create(size_t num_channels, double sample_rate, double lookahead_ms, size_t max_block);
+extern void limiter_destroy(limiter* lim);
+extern void limiter_set_ceiling(limiter* lim, double ceiling);
+extern size_t limiter_get_latency(const limiter* lim);
+extern void limiter_process(limiter* lim, double* const* channels, size_t n);
+extern size_t sliding_max(const double* input, size_t n, size_t window, size_t hop, double* result);
+extern size_t sliding_min(const double* input, size_t n, size_t window, size_t hop, double* result);
+extern size_t sliding_sum(const double* input, size_t n, size_t window, size_t hop, double* result);
+typedef struct dynamics dynamics;
+extern dynamics* dynamics_create(size_t num_channels, double sample_rate, size_t max_block);
+extern void dynamics_destroy(dynamics* dyn);
+extern void dynamics_set_curve(dynamics* dyn, double threshold_db, double ratio, double knee_db, double range_db);
+extern void dynamics_set_times(dynamics* dyn, double attack_ms, double release_ms);
+extern void dynamics_set_link(dynamics* dyn, int link);
+extern double dynamics_get_gain_db(const dynamics* dyn, size_t channel);
+extern void dynamics_process(dynamics* dyn, double* const* channels, const double* const* sidechain, size_t n);
+extern void saturate_vector(const double* input, double* result, size_t n, int curve, double drive, double bias);
+typedef struct saturator saturator;
+extern saturator* saturator_create(int curve, double drive, double bias);
+extern void saturator_destroy(saturator* sat);
+extern void saturator_process(saturator* sat, const double* input, double* result, size_t n);
+typedef struct oversampler oversampler;
+typedef void (*oversampler_kernel)(double* x, size_t n, void* user);
+extern oversampler* oversampler_create(size_t num_channels, size_t factor, size_t max_block);
+extern void oversampler_destroy(oversampler* os);
+extern double oversampler_get_latency(const oversampler* os);
+extern void oversampler_process(oversampler* os, double* const* channels, size_t n, oversampler_kernel kernel, void* user);
+typedef struct wavetable wavetable;
+typedef struct wavetable_bank wavetable_bank;
+extern wavetable* wavetable_acquire_shape(int shape, size_t table_size);
+extern void wavetable_release(wavetable* wt);
+extern wavetable_bank* wavetable_bank_create(wavetable* table, size_t num_voices, double sample_rate);
+extern void wavetable_bank_destroy(wavetable_bank* bank);
+extern void wavetable_bank_set_frequency(wavetable_bank* bank, size_t voice, double frequency);
+extern void wavetable_bank_process(wavetable_bank* bank, double* result, size_t stride, size_t n);
+typedef struct additive_bank additive_bank;
+extern additive_bank* additive_bank_create(size_t num_partials, double sample_rate);
+extern void additive_bank_destroy(additive_bank* bank);
+extern void additive_bank_reset(additive_bank* bank);
+extern void additive_bank_set_partial(additive_bank* bank, size_t partial, double frequency, double amplitude);
+extern void additive_bank_process(additive_bank* bank, double* result, size_t n);
+typedef struct blep_bank blep_bank;
+extern blep_bank* blep_bank_create(size_t num_voices, double sample_rate);
+extern void blep_bank_destroy(blep_bank* bank);
+extern void blep_bank_set_shape(blep_bank* bank, int shape);
+extern void blep_bank_set_frequency(blep_bank* bank, size_t voice, double frequency);
+extern void blep_bank_set_pulse_width(blep_bank* bank, size_t voice, double pulse_width);
+extern void blep_bank_set_sync(blep_bank* bank, size_t voice, double master_frequency);
+extern void blep_bank_process(blep_bank* bank, double* result, size_t stride, size_t n);
+typedef struct voice_engine voice_engine;
+extern voice_engine* voice_engine_create(size_t max_voices, double sample_rate);
+extern void voice_engine_destroy(voice_engine* engine);
+extern void voice_engine_set_envelope(voice_engine* engine, double attack_ms, double decay_ms, double sustain, double release_ms);
+extern int voice_engine_note_on(voice_engine* engine, int id, double frequency, double velocity, double cutoff);
+extern void voice_engine_note_off(voice_engine* engine, int id);
+extern size_t voice_engine_get_active(const voice_engine* engine);
+extern int voice_engine_get_id(const voice_engine* engine, size_t slot);
+extern void voice_engine_process(voice_engine* engine, double* result, size_t n);
+typedef struct envelope_bank envelope_bank;
+extern envelope_bank* envelope_bank_create(size_t num_envelopes, double sample_rate);
+extern void envelope_bank_destroy(envelope_bank* bank);
+extern void envelope_bank_set_segment(envelope_bank* bank, size_t envelope, int segment, double target, double time_ms, double curve);
+extern void envelope_bank_set_layout(envelope_bank* bank, size_t envelope, int num_segments, int sustain);
+extern void envelope_bank_set_adsr(envelope_bank* bank, size_t envelope, double attack_ms, double decay_ms, double sustain, double release_ms);
+extern void envelope_bank_gate(envelope_bank* bank, size_t envelope, int on);
+extern void envelope_bank_process(envelope_bank* bank, double* result, size_t stride, size_t n);
+typedef struct svf_bank svf_bank;
+extern svf_bank* svf_bank_create(size_t num_voices, double sample_rate);
+extern void svf_bank_destroy(svf_bank* bank);
+extern void svf_bank_set_resonance(svf_bank* bank, size_t voice, double q);
+extern void svf_bank_process(svf_bank* bank, const double* const* inputs, const double* const* cutoff, const double* const* resonance,
+                             double* const* lowpass, double* const* bandpass, double* const* highpass, double* const* notch, size_t n);
+extern void biquad_design(const int* types, const double* frequencies, const double* qs, const double* gains_db, size_t count, double sample_rate,
+                          double* b0, double* b1, double* b2, double* a1, double* a2);
+typedef struct crossover crossover;
+extern crossover* crossover_create(size_t num_channels, size_t num_bands, double sample_rate);
+extern void crossover_destroy(crossover* xo);
+extern void crossover_process(crossover* xo, const double* const* inputs, double* const* bands, size_t n);
+extern void crossover_recombine(const crossover* xo, const double* const* bands, const double* gains, double* const* outputs, size_t n);
+extern void complex_mul_split(const double* a_re, const double* a_im, const double* b_re, const double* b_im, double* r_re, double* r_im, size_t n);
+extern void complex_to_polar_split(const double* re, const double* im, double* magnitude, double* phase, size_t n);
+extern void complex_from_polar_interleaved(const double* magnitude, const double* phase, double* z, size_t n);
+extern void complex_conj_mul_interleaved(const double* a, const double* b, double* result, size_t n);
+enum {
+    STFT_WINDOW_HANN            = 0,
+    STFT_WINDOW_BLACKMAN_HARRIS = 1,
+    STFT_WINDOW_KAISER          = 2
+};
+typedef struct stft stft;
+typedef void (*stft_kernel)(double* re, double* im, size_t num_bins, size_t channel, void* user);
+extern stft* stft_create(size_t num_channels, size_t fft_size, size_t hop, int window, double beta);
+extern void stft_destroy(stft* st);
+extern size_t stft_get_latency(const stft* st);
+extern void stft_process(stft* st, const double* const* inputs, double* const* outputs, size_t n, stft_kernel kernel, void* user);
+extern void convert_int16_to_double(const int16_t* input, double* result, size_t n);
+extern void convert_double_to_int16(const double* input, int16_t* result, size_t n, double gain, simd_rng* dither);
+
+enum { STORE_AUTO = 0, STORE_CACHED = 1, STORE_STREAM = 2 };
+enum { DELAY_INTERP_LINEAR = 0, DELAY_INTERP_HERMITE = 1, DELAY_INTERP_LAGRANGE = 2 };
+enum { DYN_LINK_NONE = 0, DYN_LINK_PAIRS = 1, DYN_LINK_ALL = 2 };
+enum { SAT_HARD = 0, SAT_CUBIC = 1, SAT_TANH = 2, SAT_ATAN = 3 };
+enum { WT_SINE = 0, WT_SAW = 1, WT_SQUARE = 2, WT_TRIANGLE = 3 };
+enum { BLEP_SAW = 0, BLEP_SQUARE = 1, BLEP_TRIANGLE = 2 };
+enum { BIQUAD_LOWPASS = 0, BIQUAD_HIGHPASS = 1, BIQUAD_BANDPASS = 2, BIQUAD_NOTCH = 3, BIQUAD_PEAK = 4, BIQUAD_LOWSHELF = 5, BIQUAD_HIGHSHELF = 6, BIQUAD_ALLPASS = 7 };
 
 void demo_add_vectors(size_t n) {
     double* a = allocate_aligned_memory(n);
@@ -183,6 +328,866 @@ void demo_compute_a_plus_bx(double a, double b, size_t n) {
     free_aligned_memory(result);
 }
 
+void demo_streaming_stores(size_t n) {
+    double* x = allocate_aligned_memory(n);
+    double* cached = allocate_aligned_memory(n);
+    double* streamed = allocate_aligned_memory(n);
+
+    if (!x || !cached || !streamed) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Initialize x with some values
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = (double)i;
+        cached[i] = streamed[i] = 0.0;
+    }
+
+    printf("\nSTREAMING STORES (threshold %zu bytes, output %zu bytes)\n", get_streaming_store_threshold(), n * sizeof(double));
+    // Call compute_a_plus_bx once per store mode and time it
+    clock_t start = clock();
+    compute_a_plus_bx_ex(1.0, 0.5, x, cached, n, STORE_CACHED);
+    const double cached_ms = 1000.0 * (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    compute_a_plus_bx_ex(1.0, 0.5, x, streamed, n, STORE_STREAM);
+    const double streamed_ms = 1000.0 * (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; ++i) {
+        mismatches += cached[i] != streamed[i];
+    }
+    printf("cached: %.2f ms, streamed: %.2f ms, mismatches: %zu\n", cached_ms, streamed_ms, mismatches);
+
+    free_aligned_memory(x);
+    free_aligned_memory(cached);
+    free_aligned_memory(streamed);
+}
+
+void demo_mix_n_vectors(size_t n) {
+    double* a = allocate_aligned_memory(n);
+    double* b = allocate_aligned_memory(n);
+    double* c = allocate_aligned_memory(n);
+    double* mixed = allocate_aligned_memory(n);
+    double* accumulated = allocate_aligned_memory(n);
+
+    if (!a || !b || !c || !mixed || !accumulated) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Initialize the inputs with some values
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = (double)i;
+        b[i] = (double)(n - i);
+        c[i] = 1.0;
+    }
+
+    printf("\nMIX N VECTORS\n");
+    // Sum all inputs in one pass, and again by accumulating them one at a time
+    const double* inputs[3] = { a, b, c };
+    const double gains[3] = { 0.5, 0.25, 2.0 };
+    mix_n_vectors(inputs, gains, 3, mixed, n);
+
+    zero_vector(accumulated, n);
+    for (size_t k = 0; k < 3; ++k) {
+        accumulate_vector(inputs[k], gains[k], accumulated, n);
+    }
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("mixed[%zu] = %f, accumulated[%zu] = %f\n", i, mixed[i], i, accumulated[i]);
+    }
+
+    free_aligned_memory(a);
+    free_aligned_memory(b);
+    free_aligned_memory(c);
+    free_aligned_memory(mixed);
+    free_aligned_memory(accumulated);
+}
+
+void demo_gain_smoothing(size_t n) {
+    double* x = allocate_aligned_memory(n);
+    double* ramped = allocate_aligned_memory(n);
+    double* smoothed = allocate_aligned_memory(2 * n);
+    smoother_bank* bank = smoother_bank_create(2, 48000.0, 0.05);
+
+    if (!x || !ramped || !smoothed || !bank) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Initialize x with a constant signal
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = 1.0;
+    }
+
+    printf("\nGAIN RAMP AND SMOOTHING\n");
+    // Ramp the gain from 0 to 1 and glide two parameters to their targets
+    apply_gain_ramp(x, ramped, 0.0, 1.0, n);
+    smoother_bank_set_target(bank, 0, 1.0);
+    smoother_bank_set_target(bank, 1, -2.0);
+    smoother_bank_process(bank, smoothed, n, n);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("ramp[%zu] = %f, smoothed[0][%zu] = %f, smoothed[1][%zu] = %f\n", i, ramped[i], i, smoothed[i], i, smoothed[n + i]);
+    }
+
+    smoother_bank_destroy(bank);
+    free_aligned_memory(x);
+    free_aligned_memory(ramped);
+    free_aligned_memory(smoothed);
+}
+
+void demo_denormals(size_t n) {
+    double* a = allocate_aligned_memory(n);
+
+    if (!a) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Initialize a with a decaying feedback tail plus a NaN and an infinity
+    double tail = 1.0;
+    for (size_t i = 0; i < n; ++i, tail *= 1e-40) {
+        a[i] = tail;
+    }
+    a[n - 2] = NAN;
+    a[n - 1] = INFINITY;
+
+    printf("\nDENORMALS\n");
+    // Count the special values, flush the subnormals and count again
+    size_t counts[3];
+    count_fp_classes(a, n, counts);
+    printf("subnormals: %zu, nans: %zu, infs: %zu\n", counts[0], counts[1], counts[2]);
+    printf("flushed: %zu\n", flush_denormals(a, n));
+    count_fp_classes(a, n, counts);
+    printf("subnormals: %zu, nans: %zu, infs: %zu\n", counts[0], counts[1], counts[2]);
+
+    // With FTZ/DAZ enabled a subnormal result is written as 0
+    const unsigned int saved = simd_set_ftz_daz(1);
+    volatile double tiny = 1e-300;
+    printf("1e-300 * 1e-10 with FTZ = %g\n", tiny * 1e-10);
+    simd_restore_fp_mode(saved);
+    printf("1e-300 * 1e-10 without FTZ = %g\n", tiny * 1e-10);
+
+    free_aligned_memory(a);
+}
+
+void demo_half_storage(size_t n) {
+    double* a = allocate_aligned_memory(n);
+    double* zero = allocate_aligned_memory(n);
+    double* f16_result = allocate_aligned_memory(n);
+    double* bf16_result = allocate_aligned_memory(n);
+    uint16_t* a_f16 = allocate_half_memory(n);
+    uint16_t* a_bf16 = allocate_half_memory(n);
+
+    if (!a || !zero || !f16_result || !bf16_result || !a_f16 || !a_bf16) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Initialize a with some values
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = sin(0.1 * (double)i);
+        zero[i] = 0.0;
+    }
+
+    printf("\nHALF / BFLOAT16 STORAGE (%zu bytes instead of %zu)\n", n * sizeof(uint16_t), n * sizeof(double));
+    // Compress a, then read it back through the converting add kernels
+    convert_double_to_f16(a, a_f16, n);
+    convert_double_to_bf16(a, a_bf16, n);
+    add_vectors_f16src(a_f16, zero, f16_result, n);
+    add_vectors_bf16src(a_bf16, zero, bf16_result, n);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("a[%zu] = %f, f16 = %f, bf16 = %f\n", i, a[i], f16_result[i], bf16_result[i]);
+    }
+
+    free_aligned_memory(a);
+    free_aligned_memory(zero);
+    free_aligned_memory(f16_result);
+    free_aligned_memory(bf16_result);
+    free_half_memory(a_f16);
+    free_half_memory(a_bf16);
+}
+
+void demo_pcm_dither(size_t n) {
+    double* a = allocate_aligned_memory(n);
+    double* result = allocate_aligned_memory(n);
+    int16_t* pcm = (int16_t*)malloc(n * sizeof(int16_t));
+    int16_t* pcm_dithered = (int16_t*)malloc(n * sizeof(int16_t));
+    simd_rng* rng = simd_rng_create(1234);
+
+    if (!a || !result || !pcm || !pcm_dithered || !rng) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Initialize a with a very quiet sine, about 2 LSB of 16 bit
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = 2.0 / 32768.0 * sin(0.4 * (double)i);
+    }
+
+    printf("\nPCM 16 BIT WITH TPDF DITHER\n");
+    convert_double_to_int16(a, pcm, n, 1.0, NULL);
+    convert_double_to_int16(a, pcm_dithered, n, 1.0, rng);
+    convert_int16_to_double(pcm_dithered, result, n);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("a[%zu] = %f LSB, plain = %d, dithered = %d, back = %f\n", i, a[i] * 32768.0, pcm[i], pcm_dithered[i], result[i]);
+    }
+
+    free_aligned_memory(a);
+    free_aligned_memory(result);
+    free(pcm);
+    free(pcm_dithered);
+    simd_rng_destroy(rng);
+}
+
+void demo_noise(size_t n) {
+    double* uniform = allocate_aligned_memory(n);
+    double* gaussian = allocate_aligned_memory(n);
+    double* pink = allocate_aligned_memory(n);
+    simd_rng* rng = simd_rng_create(2024);
+
+    if (!uniform || !gaussian || !pink || !rng) {
+        // Handle allocation failure
+        return;
+    }
+
+    printf("\nNOISE GENERATORS (seed 2024)\n");
+    simd_rng_fill_uniform(rng, uniform, n, -1.0, 1.0);
+    simd_rng_fill_gaussian(rng, gaussian, n, 0.0, 1.0);
+    simd_rng_fill_pink(rng, pink, n, 1.0);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("uniform[%zu] = %f, gaussian = %f, pink = %f\n", i, uniform[i], gaussian[i], pink[i]);
+    }
+
+    free_aligned_memory(uniform);
+    free_aligned_memory(gaussian);
+    free_aligned_memory(pink);
+    simd_rng_destroy(rng);
+}
+
+void demo_delay_line(size_t n) {
+    double* input = allocate_aligned_memory(n);
+    double* delays = allocate_aligned_memory(n);
+    double* result = allocate_aligned_memory(n);
+    delay_line* dl = delay_line_create(32, n);
+
+    if (!input || !delays || !result || !dl) {
+        // Handle allocation failure
+        return;
+    }
+
+    printf("\nFRACTIONAL DELAY LINE (ramp input, Hermite)\n");
+    // Write two blocks of a ramp, then read the second one with a sweeping delay of 2.5 to 6 samples
+    for (size_t block = 0; block < 2; ++block) {
+        for (size_t i = 0; i < n; ++i) {
+            input[i] = (double)(block * n + i);
+            delays[i] = 2.5 + 3.5 * (double)i / (double)n;
+        }
+        delay_line_write(dl, input, n);
+    }
+    delay_line_read(dl, delays, result, n, DELAY_INTERP_HERMITE);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("input = %f, delay = %f, result = %f\n", input[i], delays[i], result[i]);
+    }
+
+    free_aligned_memory(input);
+    free_aligned_memory(delays);
+    free_aligned_memory(result);
+    delay_line_destroy(dl);
+}
+
+void demo_fdn_reverb(size_t n) {
+    double* input = allocate_aligned_memory(n);
+    double* left = allocate_aligned_memory(n);
+    double* right = allocate_aligned_memory(n);
+    fdn_reverb* fdn = fdn_reverb_create(16, 48000.0, 60.0);
+
+    if (!input || !left || !right || !fdn) {
+        // Handle allocation failure
+        return;
+    }
+
+    printf("\nFDN REVERB (16 lines, impulse response energy per block)\n");
+    fdn_reverb_set_decay(fdn, 1.0, 8000.0);
+    for (size_t block = 0; block < 8; ++block) {
+        for (size_t i = 0; i < n; ++i) {
+            input[i] = (block == 0 && i == 0) ? 1.0 : 0.0;
+        }
+        fdn_reverb_process(fdn, input, input, left, right, n);
+        double energy = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            energy += left[i] * left[i] + right[i] * right[i];
+        }
+        // Output the result to the console
+        printf("block %zu: %f dB\n", block, 10.0 * log10(energy + 1e-300));
+    }
+
+    free_aligned_memory(input);
+    free_aligned_memory(left);
+    free_aligned_memory(right);
+    fdn_reverb_destroy(fdn);
+}
+
+void demo_limiter(size_t n) {
+    double* left = allocate_aligned_memory(n);
+    double* right = allocate_aligned_memory(n);
+    limiter* lim = limiter_create(2, 1000.0, 4.0, n);
+
+    if (!left || !right || !lim) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Initialize a quiet signal with one loud burst on the left channel
+    for (size_t i = 0; i < n; ++i) {
+        left[i] = (i >= 8 && i < 12) ? 2.0 : 0.5;
+        right[i] = 0.5;
+    }
+
+    printf("\nLOOKAHEAD LIMITER (ceiling 1.0, latency %zu samples)\n", limiter_get_latency(lim));
+    limiter_set_ceiling(lim, 1.0);
+    double* channels[2] = { left, right };
+    limiter_process(lim, channels, n);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("left[%zu] = %f, right[%zu] = %f\n", i, left[i], i, right[i]);
+    }
+
+    free_aligned_memory(left);
+    free_aligned_memory(right);
+    limiter_destroy(lim);
+}
+
+void demo_sliding_windows(size_t n, size_t window, size_t hop) {
+    double* input = allocate_aligned_memory(n);
+    double* max_result = allocate_aligned_memory(n);
+    double* min_result = allocate_aligned_memory(n);
+    double* sum_result = allocate_aligned_memory(n);
+
+    if (!input || !max_result || !min_result || !sum_result) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Initialize input with some values
+    for (size_t i = 0; i < n; ++i) {
+        input[i] = sin(0.7 * (double)i) * (double)(i % 5);
+    }
+
+    printf("\nSLIDING WINDOWS (window %zu, hop %zu)\n", window, hop);
+    const size_t count = sliding_max(input, n, window, hop, max_result);
+    sliding_min(input, n, window, hop, min_result);
+    sliding_sum(input, n, window, hop, sum_result);
+
+    // Output the result to the console
+    for (size_t k = 0; k < count; ++k) {
+        printf("window %zu: max = %f, min = %f, mean = %f\n", k, max_result[k], min_result[k], sum_result[k] / (double)window);
+    }
+
+    free_aligned_memory(input);
+    free_aligned_memory(max_result);
+    free_aligned_memory(min_result);
+    free_aligned_memory(sum_result);
+}
+
+void demo_dynamics(size_t n) {
+    double* left = allocate_aligned_memory(n);
+    double* right = allocate_aligned_memory(n);
+    dynamics* dyn = dynamics_create(2, 1000.0, n);
+
+    if (!left || !right || !dyn) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Initialize a quiet stereo signal that jumps by 24 dB on the left channel
+    for (size_t i = 0; i < n; ++i) {
+        const double level = i < n / 2 ? 0.05 : 0.8;
+        left[i] = (i & 1) ? -level : level;
+        right[i] = (i & 1) ? -0.05 : 0.05;
+    }
+
+    printf("\nCOMPRESSOR (-18 dB, 4:1, stereo linked)\n");
+    dynamics_set_curve(dyn, -18.0, 4.0, 6.0, 40.0);
+    dynamics_set_times(dyn, 1.0, 50.0);
+    dynamics_set_link(dyn, DYN_LINK_PAIRS);
+    double* channels[2] = { left, right };
+    dynamics_process(dyn, channels, NULL, n);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("left[%zu] = %f, right[%zu] = %f\n", i, left[i], i, right[i]);
+    }
+    printf("gain reduction: %f dB\n", dynamics_get_gain_db(dyn, 0));
+
+    free_aligned_memory(left);
+    free_aligned_memory(right);
+    dynamics_destroy(dyn);
+}
+
+void demo_saturation(size_t n) {
+    double* input = allocate_aligned_memory(n);
+    double* hard = allocate_aligned_memory(n);
+    double* cubic = allocate_aligned_memory(n);
+    double* tanh_result = allocate_aligned_memory(n);
+    double* atan_result = allocate_aligned_memory(n);
+    double* adaa = allocate_aligned_memory(n);
+    saturator* sat = saturator_create(SAT_TANH, 4.0, 0.0);
+
+    if (!input || !hard || !cubic || !tanh_result || !atan_result || !adaa || !sat) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Initialize input with a ramp from -1 to 1
+    for (size_t i = 0; i < n; ++i) {
+        input[i] = -1.0 + 2.0 * (double)i / (double)(n - 1);
+    }
+
+    printf("\nSATURATION (drive 4)\n");
+    saturate_vector(input, hard, n, SAT_HARD, 4.0, 0.0);
+    saturate_vector(input, cubic, n, SAT_CUBIC, 4.0, 0.0);
+    saturate_vector(input, tanh_result, n, SAT_TANH, 4.0, 0.0);
+    saturate_vector(input, atan_result, n, SAT_ATAN, 4.0, 0.0);
+    saturator_process(sat, input, adaa, n);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("x = %f: hard = %f, cubic = %f, tanh = %f, atan = %f, tanh ADAA = %f\n",
+               input[i], hard[i], cubic[i], tanh_result[i], atan_result[i], adaa[i]);
+    }
+
+    free_aligned_memory(input);
+    free_aligned_memory(hard);
+    free_aligned_memory(cubic);
+    free_aligned_memory(tanh_result);
+    free_aligned_memory(atan_result);
+    free_aligned_memory(adaa);
+    saturator_destroy(sat);
+}
+
+// Kernel for demo_oversampling: hard clip with drive, user points to the drive.
+static void clip_kernel(double* x, size_t n, void* user) {
+    saturate_vector(x, x, n, SAT_HARD, *(const double*)user, 0.0);
+}
+
+void demo_oversampling(size_t n) {
+    double* plain = allocate_aligned_memory(n);
+    double* oversampled = allocate_aligned_memory(n);
+    oversampler* os = oversampler_create(1, 4, n);
+
+    if (!plain || !oversampled || !os) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Initialize both buffers with a sine close to Nyquist
+    for (size_t i = 0; i < n; ++i) {
+        plain[i] = oversampled[i] = sin(1.9 * (double)i);
+    }
+
+    printf("\nOVERSAMPLED CLIPPING (4x, latency %f samples)\n", oversampler_get_latency(os));
+    double drive = 3.0;
+    saturate_vector(plain, plain, n, SAT_HARD, drive, 0.0);
+    oversampler_process(os, &oversampled, n, clip_kernel, &drive);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("plain[%zu] = %f, oversampled[%zu] = %f\n", i, plain[i], i, oversampled[i]);
+    }
+
+    free_aligned_memory(plain);
+    free_aligned_memory(oversampled);
+    oversampler_destroy(os);
+}
+
+void demo_wavetable_bank(size_t n) {
+    double* result = allocate_aligned_memory(3 * n);
+    wavetable* saw = wavetable_acquire_shape(WT_SAW, 2048);
+    wavetable_bank* bank = saw ? wavetable_bank_create(saw, 3, 48000.0) : NULL;
+
+    if (!result || !bank) {
+        // Handle allocation failure
+        return;
+    }
+
+    // A low, a middle and a very high voice, the high one plays from a level with few harmonics
+    wavetable_bank_set_frequency(bank, 0, 1500.0);
+    wavetable_bank_set_frequency(bank, 1, 3000.0);
+    wavetable_bank_set_frequency(bank, 2, 9000.0);
+
+    printf("\nWAVETABLE BANK (saw at 1.5, 3 and 9 kHz)\n");
+    wavetable_bank_process(bank, result, n, n);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("voice0[%zu] = %f, voice1[%zu] = %f, voice2[%zu] = %f\n", i, result[i], i, result[n + i], i, result[2 * n + i]);
+    }
+
+    free_aligned_memory(result);
+    wavetable_bank_destroy(bank);
+    wavetable_release(saw);
+}
+
+void demo_additive(size_t n, size_t num_partials) {
+    double* result = allocate_aligned_memory(n);
+    additive_bank* bank = additive_bank_create(num_partials, 48000.0);
+
+    if (!result || !bank) {
+        // Handle allocation failure
+        return;
+    }
+
+    // A band-limited square wave from its odd harmonics, the rest stay silent
+    for (size_t k = 0; k < num_partials; k += 2) {
+        additive_bank_set_partial(bank, k, 1000.0 * (double)(k + 1), 4.0 / (3.14159265358979323846 * (double)(k + 1)));
+    }
+    additive_bank_reset(bank);
+    zero_vector(result, n);
+
+    printf("\nADDITIVE (1 kHz square from %zu partials)\n", num_partials);
+    additive_bank_process(bank, result, n);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("result[%zu] = %f\n", i, result[i]);
+    }
+
+    free_aligned_memory(result);
+    additive_bank_destroy(bank);
+}
+
+void demo_blep_bank(size_t n) {
+    double* result = allocate_aligned_memory(4 * n);
+    blep_bank* bank = blep_bank_create(4, 48000.0);
+
+    if (!result || !bank) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Four pulse voices: plain, narrow, hard synced and high
+    blep_bank_set_shape(bank, BLEP_SQUARE);
+    blep_bank_set_frequency(bank, 0, 3000.0);
+    blep_bank_set_frequency(bank, 1, 3000.0);
+    blep_bank_set_pulse_width(bank, 1, 0.2);
+    blep_bank_set_frequency(bank, 2, 7100.0);
+    blep_bank_set_sync(bank, 2, 3000.0);
+    blep_bank_set_frequency(bank, 3, 11000.0);
+
+    printf("\nPOLYBLEP BANK (pulse 3 kHz, 20%% pulse, 7.1 kHz synced to 3 kHz, 11 kHz)\n");
+    blep_bank_process(bank, result, n, n);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("[%zu] %f %f %f %f\n", i, result[i], result[n + i], result[2 * n + i], result[3 * n + i]);
+    }
+
+    free_aligned_memory(result);
+    blep_bank_destroy(bank);
+}
+
+void demo_voice_engine(size_t n) {
+    double* result = allocate_aligned_memory(n);
+    voice_engine* engine = voice_engine_create(4, 48000.0);
+
+    if (!result || !engine) {
+        // Handle allocation failure
+        return;
+    }
+
+    printf("\nVOICE ENGINE (4 voices, 6 notes, short release)\n");
+    voice_engine_set_envelope(engine, 1.0, 50.0, 0.5, 20.0);
+    for (int note = 0; note < 6; ++note) {
+        if (note == 2) {
+            voice_engine_note_off(engine, 0);
+        }
+        const int stolen = voice_engine_note_on(engine, note, 110.0 * (note + 1), 0.25, 4000.0);
+        voice_engine_process(engine, result, n);
+
+        // Output the result to the console
+        printf("note %d: stolen %2d, last sample %f, slots:", note, stolen, result[n - 1]);
+        for (size_t v = 0; v < voice_engine_get_active(engine); ++v) {
+            printf(" %d", voice_engine_get_id(engine, v));
+        }
+        printf("\n");
+    }
+
+    free_aligned_memory(result);
+    voice_engine_destroy(engine);
+}
+
+void demo_envelope_bank(size_t n) {
+    double* result = allocate_aligned_memory(3 * n);
+    envelope_bank* bank = envelope_bank_create(3, 1000.0);
+
+    if (!result || !bank) {
+        // Handle allocation failure
+        return;
+    }
+
+    // At 1 kHz one sample is one millisecond
+    envelope_bank_set_adsr(bank, 0, 4.0, 8.0, 0.5, 6.0);
+    envelope_bank_set_adsr(bank, 1, 0.0, 12.0, 0.0, 0.0);
+    envelope_bank_set_segment(bank, 2, 0, 1.0, 6.0, -3.0);
+    envelope_bank_set_segment(bank, 2, 1, 0.2, 6.0, 3.0);
+    envelope_bank_set_segment(bank, 2, 2, 0.0, 0.0, 0.0);
+    envelope_bank_set_layout(bank, 2, 3, -1);
+    for (size_t e = 0; e < 3; ++e) {
+        envelope_bank_gate(bank, e, 1);
+    }
+
+    printf("\nENVELOPE BANK (ADSR released at %zu, percussive, one-shot with curved segments)\n", n);
+    envelope_bank_process(bank, result, n, n);
+    envelope_bank_gate(bank, 0, 0);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("[%zu] %f %f %f\n", i, result[i], result[n + i], result[2 * n + i]);
+    }
+    envelope_bank_process(bank, result, n, n);
+    for (size_t i = 0; i < 8; ++i) {
+        printf("[%zu] %f\n", n + i, result[i]);
+    }
+
+    free_aligned_memory(result);
+    envelope_bank_destroy(bank);
+}
+
+void demo_svf_bank(size_t n) {
+    double* input = allocate_aligned_memory(n);
+    double* cutoff = allocate_aligned_memory(n);
+    double* lp = allocate_aligned_memory(n);
+    double* bp = allocate_aligned_memory(n);
+    double* hp = allocate_aligned_memory(n);
+    double* notch = allocate_aligned_memory(n);
+    svf_bank* bank = svf_bank_create(1, 48000.0);
+
+    if (!input || !cutoff || !lp || !bp || !hp || !notch || !bank) {
+        // Handle allocation failure
+        return;
+    }
+
+    // An impulse through a resonant filter whose cutoff sweeps down every sample
+    for (size_t i = 0; i < n; ++i) {
+        input[i] = i == 0 ? 1.0 : 0.0;
+        cutoff[i] = 12000.0 - 10000.0 * (double)i / (double)n;
+    }
+    svf_bank_set_resonance(bank, 0, 4.0);
+    const double* inputs[1] = { input };
+    const double* cutoffs[1] = { cutoff };
+    double* lps[1] = { lp };
+    double* bps[1] = { bp };
+    double* hps[1] = { hp };
+    double* notches[1] = { notch };
+
+    printf("\nSVF BANK (impulse, Q 4, cutoff sweep 12 kHz to 2 kHz: LP BP HP notch)\n");
+    svf_bank_process(bank, inputs, cutoffs, NULL, lps, bps, hps, notches, n);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("[%zu] %f %f %f %f\n", i, lp[i], bp[i], hp[i], notch[i]);
+    }
+
+    free_aligned_memory(input);
+    free_aligned_memory(cutoff);
+    free_aligned_memory(lp);
+    free_aligned_memory(bp);
+    free_aligned_memory(hp);
+    free_aligned_memory(notch);
+    svf_bank_destroy(bank);
+}
+
+void demo_biquad_design(void) {
+    const size_t n = 8;
+    const int types[8] = { BIQUAD_LOWPASS, BIQUAD_HIGHPASS, BIQUAD_BANDPASS, BIQUAD_NOTCH,
+                           BIQUAD_PEAK, BIQUAD_LOWSHELF, BIQUAD_HIGHSHELF, BIQUAD_ALLPASS };
+    double* frequencies = allocate_aligned_memory(n);
+    double* qs = allocate_aligned_memory(n);
+    double* gains = allocate_aligned_memory(n);
+    double* b0 = allocate_aligned_memory(n);
+    double* b1 = allocate_aligned_memory(n);
+    double* b2 = allocate_aligned_memory(n);
+    double* a1 = allocate_aligned_memory(n);
+    double* a2 = allocate_aligned_memory(n);
+
+    if (!frequencies || !qs || !gains || !b0 || !b1 || !b2 || !a1 || !a2) {
+        // Handle allocation failure
+        return;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        frequencies[i] = 1000.0;
+        qs[i] = 0.70710678118654752;
+        gains[i] = 6.0;
+    }
+
+    printf("\nBIQUAD DESIGN (1 kHz at 48 kHz, Q 0.707, +6 dB: LP HP BP notch peak low shelf high shelf allpass)\n");
+    biquad_design(types, frequencies, qs, gains, n, 48000.0, b0, b1, b2, a1, a2);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("[%zu] b %f %f %f a %f %f\n", i, b0[i], b1[i], b2[i], a1[i], a2[i]);
+    }
+
+    free_aligned_memory(frequencies);
+    free_aligned_memory(qs);
+    free_aligned_memory(gains);
+    free_aligned_memory(b0);
+    free_aligned_memory(b1);
+    free_aligned_memory(b2);
+    free_aligned_memory(a1);
+    free_aligned_memory(a2);
+}
+
+void demo_crossover(size_t n) {
+    double* input = allocate_aligned_memory(n);
+    double* output = allocate_aligned_memory(n);
+    double* bands[3] = { allocate_aligned_memory(n), allocate_aligned_memory(n), allocate_aligned_memory(n) };
+    crossover* xo = crossover_create(1, 3, 48000.0);
+
+    if (!input || !output || !bands[0] || !bands[1] || !bands[2] || !xo) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Low and high tones split at 100 Hz and 10 kHz, then recombined
+    for (size_t i = 0; i < n; ++i) {
+        input[i] = sin(0.002 * (double)i) + 0.5 * sin(2.2 * (double)i);
+    }
+    const double* inputs[1] = { input };
+    double* outputs[1] = { output };
+
+    printf("\nCROSSOVER (3 band LR4 at 100 Hz and 10 kHz: input, low, mid, high, sum = allpassed input)\n");
+    crossover_process(xo, inputs, bands, n);
+    crossover_recombine(xo, (const double* const*)bands, NULL, outputs, n);
+
+    // Output the result to the console
+    for (size_t i = n - 8; i < n; ++i) {
+        printf("[%zu] %f %f %f %f %f\n", i, input[i], bands[0][i], bands[1][i], bands[2][i], output[i]);
+    }
+
+    free_aligned_memory(input);
+    free_aligned_memory(output);
+    for (int b = 0; b < 3; ++b) {
+        free_aligned_memory(bands[b]);
+    }
+    crossover_destroy(xo);
+}
+
+void demo_complex_kernels(void) {
+    const size_t n = 8;
+    double* re = allocate_aligned_memory(n);
+    double* im = allocate_aligned_memory(n);
+    double* magnitude = allocate_aligned_memory(n);
+    double* phase = allocate_aligned_memory(n);
+    double* z = allocate_aligned_memory(2 * n);
+
+    if (!re || !im || !magnitude || !phase || !z) {
+        // Handle allocation failure
+        return;
+    }
+
+    // Points on the unit circle 45 degrees apart, squared by a split multiply
+    for (size_t i = 0; i < n; ++i) {
+        re[i] = cos(0.78539816339744831 * i);
+        im[i] = sin(0.78539816339744831 * i);
+    }
+
+    printf("\nCOMPLEX KERNELS (z^2 split -> polar -> interleaved, z * conj(z))\n");
+    complex_mul_split(re, im, re, im, re, im, n);
+    complex_to_polar_split(re, im, magnitude, phase, n);
+    complex_from_polar_interleaved(magnitude, phase, z, n);
+
+    // Output the result to the console
+    for (size_t i = 0; i < n; ++i) {
+        printf("[%zu] |z| %f arg %f -> (%f, %f)\n", i, magnitude[i], phase[i], z[2 * i], z[2 * i + 1]);
+    }
+    complex_conj_mul_interleaved(z, z, z, n);
+    printf("z * conj(z): (%f, %f)\n", z[0], z[1]);
+
+    free_aligned_memory(re);
+    free_aligned_memory(im);
+    free_aligned_memory(magnitude);
+    free_aligned_memory(phase);
+    free_aligned_memory(z);
+}
+
+typedef struct demo_freeze {
+    double* magnitudes;
+    size_t frames;          // frames seen so far
+    size_t capture;         // the frame whose magnitudes are held
+} demo_freeze;
+
+// Spectral freeze: holds the magnitudes of one frame and lets the phases run on.
+static void demo_stft_freeze(double* re, double* im, size_t num_bins, size_t channel, void* user) {
+    demo_freeze* freeze = (demo_freeze*)user;
+    (void)channel;
+    const int capture = ++freeze->frames == freeze->capture;
+    for (size_t k = 0; k < num_bins; ++k) {
+        const double magnitude = sqrt(re[k] * re[k] + im[k] * im[k]);
+        if (capture) {
+            freeze->magnitudes[k] = magnitude;
+        } else if (freeze->frames < freeze->capture) {
+            continue;
+        }
+        const double scale = magnitude > 1e-12 ? freeze->magnitudes[k] / magnitude : 0.0;
+        re[k] *= scale;
+        im[k] *= scale;
+    }
+}
+
+void demo_stft(size_t n) {
+    const size_t fft_size = 512;
+    double* input = allocate_aligned_memory(n);
+    double* output = allocate_aligned_memory(n);
+    double* frozen = allocate_aligned_memory(fft_size / 2 + 1);
+    stft* st = stft_create(1, fft_size, fft_size / 4, STFT_WINDOW_BLACKMAN_HARRIS, 0.0);
+
+    if (!input || !output || !frozen || !st) {
+        // Handle allocation failure
+        return;
+    }
+
+    // A tone fading out; the freeze holds its level from the first full frame on
+    for (size_t i = 0; i < n; ++i) {
+        input[i] = exp(-(double)i / 1000.0) * sin(0.2 * (double)i);
+    }
+    demo_freeze freeze = { frozen, 0, fft_size / (fft_size / 4) };
+
+    printf("\nSTFT (512 point Blackman-Harris, hop 128, spectral freeze in blocks of 100, latency %zu)\n", stft_get_latency(st));
+    for (size_t i = 0; i < n; i += 100) {
+        const size_t count = n - i < 100 ? n - i : 100;
+        const double* in[1] = { input + i };
+        double* out[1] = { output + i };
+        stft_process(st, in, out, count, demo_stft_freeze, &freeze);
+    }
+
+    // Output the result to the console
+    for (size_t i = fft_size + 4; i < n; i += 512) {
+        printf("[%zu] input %f, frozen output %f\n", i, input[i], output[i]);
+    }
+
+    stft_destroy(st);
+    free_aligned_memory(input);
+    free_aligned_memory(output);
+    free_aligned_memory(frozen);
+}
+
 int main() {
     size_t n = 64; // Example size
     size_t window = 12; // Example window size
@@ -193,6 +1198,30 @@ int main() {
     demo_compute_abs_ratio(n);
     demo_squared_difference(n);
     demo_compute_a_plus_bx(10000.0, 2.0, n);
+    demo_streaming_stores((size_t)16 << 20);
+    demo_mix_n_vectors(12);
+    demo_gain_smoothing(8);
+    demo_denormals(16);
+    demo_half_storage(8);
+    demo_pcm_dither(8);
+    demo_noise(8);
+    demo_delay_line(8);
+    demo_fdn_reverb(4800);
+    demo_limiter(20);
+    demo_sliding_windows(n, window, 6);
+    demo_dynamics(16);
+    demo_saturation(12);
+    demo_oversampling(64);
+    demo_wavetable_bank(16);
+    demo_additive(24, 23);
+    demo_blep_bank(16);
+    demo_voice_engine(512);
+    demo_envelope_bank(16);
+    demo_svf_bank(12);
+    demo_biquad_design();
+    demo_crossover(1024);
+    demo_complex_kernels();
+    demo_stft(4096);
 
     return 0;
 }
\ No newline at end of file
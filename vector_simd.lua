@@ -16,6 +16,283 @@ ffi.cdef[[
     void compute_abs_diff_sum(const double* a, const double* b, double* result, size_t n);
     double* compute_rms_windowed(const double* input, size_t n, size_t window);
 
+    enum { STORE_AUTO = 0, STORE_CACHED = 1, STORE_STREAM = 2 };
+    size_t set_streaming_store_threshold(size_t bytes);
+    size_t get_streaming_store_threshold(void);
+    void add_vectors_ex       (const double* a, const double* b, double* result, size_t n, int store_mode);
+    void sub_vectors_ex       (const double* a, const double* b, double* result, size_t n, int store_mode);
+    void mul_vectors_ex       (const double* a, const double* b, double* result, size_t n, int store_mode);
+    void square_vector_ex     (const double* input,              double* result, size_t n, int store_mode);
+    void compute_abs_ratio_ex (const double* a, const double* b, double* result, size_t n, int store_mode);
+    void squared_difference_ex(const double* a, const double* b, double* result, size_t n, int store_mode);
+    void compute_a_plus_bx_ex (double a, double b, const double* x, double* result, size_t n, int store_mode);
+    void compute_abs_diff_sum_ex(const double* a, const double* b, double* result, size_t n, int store_mode);
+
+    void fill_vector_ex      (double value, double* result, size_t n, int store_mode);
+    void zero_vector_ex      (double* result, size_t n, int store_mode);
+    void copy_vector_ex      (const double* input, double* result, size_t n, int store_mode);
+    void scale_vector_inplace(double* x, double gain, size_t n);
+    void accumulate_vector   (const double* x, double gain, double* y, size_t n);
+    void mix_n_vectors_ex    (const double* const* inputs, const double* gains, size_t num_inputs, double* result, size_t n, int store_mode);
+
+    void generate_gain_ramp(double g0, double g1, double* result, size_t n);
+    void apply_gain_ramp   (const double* x, double* result, double g0, double g1, size_t n);
+    typedef struct smoother_bank smoother_bank;
+    smoother_bank* smoother_bank_create(size_t num_params, double sample_rate, double time_ms);
+    void   smoother_bank_destroy   (smoother_bank* bank);
+    void   smoother_bank_set_target(smoother_bank* bank, size_t index, double target);
+    void   smoother_bank_set_time  (smoother_bank* bank, size_t index, double time_ms);
+    void   smoother_bank_reset     (smoother_bank* bank, size_t index, double value);
+    double smoother_bank_get_value (const smoother_bank* bank, size_t index);
+    void   smoother_bank_process   (smoother_bank* bank, double* result, size_t stride, size_t n);
+
+    unsigned int simd_save_fp_mode(void);
+    void         simd_restore_fp_mode(unsigned int mode);
+    unsigned int simd_set_ftz_daz(int on);
+    int          simd_get_ftz_daz(void);
+    void   count_fp_classes(const double* input, size_t n, size_t counts[3]);
+    size_t flush_denormals (double* x, size_t n);
+
+    uint16_t* allocate_half_memory(size_t n);
+    void free_half_memory(uint16_t* ptr);
+    void convert_double_to_f16 (const double* input, uint16_t* result, size_t n);
+    void convert_f16_to_double (const uint16_t* input, double* result, size_t n);
+    void convert_double_to_bf16(const double* input, uint16_t* result, size_t n);
+    void convert_bf16_to_double(const uint16_t* input, double* result, size_t n);
+    void add_vectors_f16src       (const uint16_t* a, const double* b, double* result, size_t n);
+    void mul_vectors_f16src       (const uint16_t* a, const double* b, double* result, size_t n);
+    void accumulate_vector_f16src (const uint16_t* x, double gain, double* y, size_t n);
+    void compute_a_plus_bx_f16dst (double a, double b, const double* x, uint16_t* result, size_t n);
+    void add_vectors_bf16src      (const uint16_t* a, const double* b, double* result, size_t n);
+    void mul_vectors_bf16src      (const uint16_t* a, const double* b, double* result, size_t n);
+    void accumulate_vector_bf16src(const uint16_t* x, double gain, double* y, size_t n);
+    void compute_a_plus_bx_bf16dst(double a, double b, const double* x, uint16_t* result, size_t n);
+
+    typedef struct simd_rng simd_rng;
+    simd_rng* simd_rng_create(uint64_t seed);
+    void      simd_rng_destroy(simd_rng* rng);
+    void      simd_rng_seed(simd_rng* rng, uint64_t seed);
+    void      simd_rng_fill_uniform (simd_rng* rng, double* result, size_t n, double lo, double hi);
+    void      simd_rng_fill_tpdf    (simd_rng* rng, double* result, size_t n, double amplitude);
+    void      simd_rng_fill_gaussian(simd_rng* rng, double* result, size_t n, double mean, double sigma);
+    void      simd_rng_fill_pink    (simd_rng* rng, double* result, size_t n, double amplitude);
+
+    enum { DELAY_INTERP_LINEAR = 0, DELAY_INTERP_HERMITE = 1, DELAY_INTERP_LAGRANGE = 2 };
+    typedef struct delay_line delay_line;
+    delay_line* delay_line_create(size_t max_delay, size_t max_block);
+    void delay_line_destroy  (delay_line* dl);
+    void delay_line_clear    (delay_line* dl);
+    void delay_line_write    (delay_line* dl, const double* input, size_t n);
+    void delay_line_read     (const delay_line* dl, const double* delays, double* result, size_t n, int interpolation);
+    void delay_line_read_taps(const delay_line* dl, const double* delays, size_t num_taps, double* result, size_t stride, size_t n, int interpolation);
+    void delay_line_mix_taps (const delay_line* dl, const double* delays, const double* gains, size_t num_taps, double* result, size_t n, int interpolation);
+
+    typedef struct fdn_reverb fdn_reverb;
+    fdn_reverb* fdn_reverb_create(size_t num_lines, double sample_rate, double max_delay_ms);
+    void fdn_reverb_destroy       (fdn_reverb* fdn);
+    void fdn_reverb_reset         (fdn_reverb* fdn);
+    void fdn_reverb_set_delays    (fdn_reverb* fdn, double min_ms, double max_ms);
+    void fdn_reverb_set_decay     (fdn_reverb* fdn, double rt60, double damping_hz);
+    void fdn_reverb_set_modulation(fdn_reverb* fdn, double depth, double rate_hz);
+    void fdn_reverb_process       (fdn_reverb* fdn, const double* in_left, const double* in_right, double* out_left, double* out_right, size_t n);
+
+    enum { WINDOW_MAX = 0, WINDOW_MIN = 1, WINDOW_SUM = 2 };
+    size_t sliding_max(const double* input, size_t n, size_t window, size_t hop, double* result);
+    size_t sliding_min(const double* input, size_t n, size_t window, size_t hop, double* result);
+    size_t sliding_sum(const double* input, size_t n, size_t window, size_t hop, double* result);
+    typedef struct sliding_window sliding_window;
+    sliding_window* sliding_window_create(int op, size_t window, size_t hop, size_t max_block);
+    void   sliding_window_destroy(sliding_window* sw);
+    void   sliding_window_reset  (sliding_window* sw);
+    size_t sliding_window_process(sliding_window* sw, const double* input, size_t n, double* result);
+
+    typedef struct limiter limiter;
+    limiter* limiter_create(size_t num_channels, double sample_rate, double lookahead_ms, size_t max_block);
+    void   limiter_destroy    (limiter* lim);
+    void   limiter_reset      (limiter* lim);
+    void   limiter_set_ceiling(limiter* lim, double ceiling);
+    void   limiter_set_release(limiter* lim, double release_ms);
+    size_t limiter_get_latency(const limiter* lim);
+    double limiter_get_gain   (const limiter* lim);
+    void   limiter_process    (limiter* lim, double* const* channels, size_t n);
+
+    enum { DYN_COMPRESSOR = 0, DYN_EXPANDER = 1, DYN_GATE = 2 };
+    enum { DYN_DETECT_PEAK = 0, DYN_DETECT_RMS = 1 };
+    enum { DYN_LINK_NONE = 0, DYN_LINK_PAIRS = 1, DYN_LINK_ALL = 2 };
+    typedef struct dynamics dynamics;
+    dynamics* dynamics_create(size_t num_channels, double sample_rate, size_t max_block);
+    void   dynamics_destroy     (dynamics* dyn);
+    void   dynamics_reset       (dynamics* dyn);
+    void   dynamics_set_mode    (dynamics* dyn, int mode);
+    void   dynamics_set_detector(dynamics* dyn, int detector, double rms_ms);
+    void   dynamics_set_curve   (dynamics* dyn, double threshold_db, double ratio, double knee_db, double range_db);
+    void   dynamics_set_times   (dynamics* dyn, double attack_ms, double release_ms);
+    void   dynamics_set_makeup  (dynamics* dyn, double makeup_db);
+    void   dynamics_set_link    (dynamics* dyn, int link);
+    double dynamics_get_gain_db (const dynamics* dyn, size_t channel);
+    void   dynamics_process     (dynamics* dyn, double* const* channels, const double* const* sidechain, size_t n);
+
+    enum { SAT_HARD = 0, SAT_CUBIC = 1, SAT_TANH = 2, SAT_ATAN = 3 };
+    void clamp_vector(const double* input, double* result, size_t n, double lo, double hi);
+    void saturate_vector(const double* input, double* result, size_t n, int curve, double drive, double bias);
+    typedef struct saturator saturator;
+    saturator* saturator_create(int curve, double drive, double bias);
+    void saturator_destroy(saturator* sat);
+    void saturator_reset  (saturator* sat);
+    void saturator_set    (saturator* sat, int curve, double drive, double bias);
+    void saturator_process(saturator* sat, const double* input, double* result, size_t n);
+
+    typedef struct oversampler oversampler;
+    typedef void (*oversampler_kernel)(double* x, size_t n, void* user);
+    oversampler* oversampler_create(size_t num_channels, size_t factor, size_t max_block);
+    void    oversampler_destroy    (oversampler* os);
+    void    oversampler_reset      (oversampler* os);
+    double  oversampler_get_latency(const oversampler* os);
+    size_t  oversampler_get_factor (const oversampler* os);
+    double* oversampler_get_buffer (oversampler* os, size_t channel);
+    size_t  oversampler_upsample   (oversampler* os, const double* const* channels, size_t n);
+    void    oversampler_downsample (oversampler* os, double* const* channels, size_t n);
+    void    oversampler_process    (oversampler* os, double* const* channels, size_t n, oversampler_kernel kernel, void* user);
+    void    oversampler_process_saturate(oversampler* os, double* const* channels, size_t n, int curve, double drive, double bias);
+
+    enum { WT_SINE = 0, WT_SAW = 1, WT_SQUARE = 2, WT_TRIANGLE = 3 };
+    typedef struct wavetable wavetable;
+    wavetable* wavetable_acquire(const char* key, const double* cycle, size_t length, size_t table_size);
+    wavetable* wavetable_acquire_shape(int shape, size_t table_size);
+    void wavetable_release(wavetable* wt);
+    typedef struct wavetable_bank wavetable_bank;
+    wavetable_bank* wavetable_bank_create(wavetable* table, size_t num_voices, double sample_rate);
+    void wavetable_bank_destroy          (wavetable_bank* bank);
+    void wavetable_bank_set_frequency    (wavetable_bank* bank, size_t voice, double frequency);
+    void wavetable_bank_set_phase        (wavetable_bank* bank, size_t voice, double phase);
+    void wavetable_bank_set_gain         (wavetable_bank* bank, size_t voice, double gain);
+    void wavetable_bank_set_interpolation(wavetable_bank* bank, int interpolation);
+    void wavetable_bank_process          (wavetable_bank* bank, double* result, size_t stride, size_t n);
+    void wavetable_bank_process_mix      (wavetable_bank* bank, double* result, size_t n);
+
+    typedef struct additive_bank additive_bank;
+    additive_bank* additive_bank_create(size_t num_partials, double sample_rate);
+    void additive_bank_destroy     (additive_bank* bank);
+    void additive_bank_reset       (additive_bank* bank);
+    void additive_bank_set_partial (additive_bank* bank, size_t partial, double frequency, double amplitude);
+    void additive_bank_set_partials(additive_bank* bank, const double* frequencies, const double* amplitudes, size_t count);
+    void additive_bank_set_phase   (additive_bank* bank, size_t partial, double phase);
+    void additive_bank_process     (additive_bank* bank, double* result, size_t n);
+
+    enum { BLEP_SAW = 0, BLEP_SQUARE = 1, BLEP_TRIANGLE = 2 };
+    typedef struct blep_bank blep_bank;
+    blep_bank* blep_bank_create(size_t num_voices, double sample_rate);
+    void blep_bank_destroy        (blep_bank* bank);
+    void blep_bank_set_shape      (blep_bank* bank, int shape);
+    void blep_bank_set_frequency  (blep_bank* bank, size_t voice, double frequency);
+    void blep_bank_set_phase      (blep_bank* bank, size_t voice, double phase);
+    void blep_bank_set_pulse_width(blep_bank* bank, size_t voice, double pulse_width);
+    void blep_bank_set_sync       (blep_bank* bank, size_t voice, double master_frequency);
+    void blep_bank_set_gain       (blep_bank* bank, size_t voice, double gain);
+    void blep_bank_process        (blep_bank* bank, double* result, size_t stride, size_t n);
+    void blep_bank_process_mix    (blep_bank* bank, double* result, size_t n);
+
+    enum { VOICE_FIELD_PHASE = 0, VOICE_FIELD_INCREMENT = 1, VOICE_FIELD_GAIN = 2, VOICE_FIELD_CUTOFF = 3, VOICE_FIELD_LEVEL = 4, VOICE_FIELD_STAGE = 5 };
+    enum { VOICE_IDLE = 0, VOICE_ATTACK = 1, VOICE_DECAY = 2, VOICE_RELEASE = 3 };
+    typedef struct voice_engine voice_engine;
+    voice_engine* voice_engine_create(size_t max_voices, double sample_rate);
+    void voice_engine_destroy      (voice_engine* engine);
+    void voice_engine_reset        (voice_engine* engine);
+    void voice_engine_set_envelope (voice_engine* engine, double attack_ms, double decay_ms, double sustain, double release_ms);
+    int voice_engine_note_on       (voice_engine* engine, int id, double frequency, double velocity, double cutoff);
+    void voice_engine_note_off     (voice_engine* engine, int id);
+    void voice_engine_set_frequency(voice_engine* engine, int id, double frequency);
+    void voice_engine_set_cutoff   (voice_engine* engine, int id, double cutoff);
+    size_t voice_engine_get_active (const voice_engine* engine);
+    int voice_engine_get_id        (const voice_engine* engine, size_t slot);
+    double* voice_engine_get_field (voice_engine* engine, int field);
+    void voice_engine_process      (voice_engine* engine, double* result, size_t n);
+
+    enum { ENV_MAX_SEGMENTS = 8, ENV_DONE = -1 };
+    typedef struct envelope_bank envelope_bank;
+    envelope_bank* envelope_bank_create(size_t num_envelopes, double sample_rate);
+    void envelope_bank_destroy    (envelope_bank* bank);
+    void envelope_bank_set_segment(envelope_bank* bank, size_t envelope, int segment, double target, double time_ms, double curve);
+    void envelope_bank_set_layout (envelope_bank* bank, size_t envelope, int num_segments, int sustain);
+    void envelope_bank_set_adsr   (envelope_bank* bank, size_t envelope, double attack_ms, double decay_ms, double sustain, double release_ms);
+    void envelope_bank_gate       (envelope_bank* bank, size_t envelope, int on);
+    void envelope_bank_reset      (envelope_bank* bank, size_t envelope, double level);
+    int envelope_bank_get_stage   (const envelope_bank* bank, size_t envelope);
+    double envelope_bank_get_level(const envelope_bank* bank, size_t envelope);
+    void envelope_bank_process    (envelope_bank* bank, double* result, size_t stride, size_t n);
+
+    typedef struct svf_bank svf_bank;
+    svf_bank* svf_bank_create(size_t num_voices, double sample_rate);
+    void svf_bank_destroy      (svf_bank* bank);
+    void svf_bank_reset        (svf_bank* bank);
+    void svf_bank_set_cutoff   (svf_bank* bank, size_t voice, double cutoff);
+    void svf_bank_set_resonance(svf_bank* bank, size_t voice, double q);
+    void svf_bank_process      (svf_bank* bank, const double* const* inputs, const double* const* cutoff, const double* const* resonance,
+                                double* const* lowpass, double* const* bandpass, double* const* highpass, double* const* notch, size_t n);
+
+    enum { BIQUAD_LOWPASS = 0, BIQUAD_HIGHPASS = 1, BIQUAD_BANDPASS = 2, BIQUAD_NOTCH = 3, BIQUAD_PEAK = 4, BIQUAD_LOWSHELF = 5, BIQUAD_HIGHSHELF = 6, BIQUAD_ALLPASS = 7 };
+    void biquad_design(const int* types, const double* frequencies, const double* qs, const double* gains_db, size_t count, double sample_rate,
+                       double* b0, double* b1, double* b2, double* a1, double* a2);
+    typedef struct biquad_bank biquad_bank;
+    biquad_bank* biquad_bank_create(size_t num_channels, size_t num_stages, double sample_rate);
+    void biquad_bank_destroy      (biquad_bank* bank);
+    void biquad_bank_reset        (biquad_bank* bank);
+    void biquad_bank_set          (biquad_bank* bank, size_t channel, size_t stage, int type, double frequency, double q, double gain_db);
+    void biquad_bank_set_smoothing(biquad_bank* bank, int on);
+    void biquad_bank_process      (biquad_bank* bank, double* const* channels, size_t n);
+
+    enum { XO_MAX_BANDS = 8 };
+    typedef struct crossover crossover;
+    crossover* crossover_create(size_t num_channels, size_t num_bands, double sample_rate);
+    void crossover_destroy      (crossover* xo);
+    void crossover_reset        (crossover* xo);
+    void crossover_set_frequency(crossover* xo, size_t index, double frequency);
+    void crossover_process      (crossover* xo, const double* const* inputs, double* const* bands, size_t n);
+    void crossover_recombine    (const crossover* xo, const double* const* bands, const double* gains, double* const* outputs, size_t n);
+
+    void complex_mul_split              (const double* a_re, const double* a_im, const double* b_re, const double* b_im, double* r_re, double* r_im, size_t n);
+    void complex_mul_acc_split          (const double* a_re, const double* a_im, const double* b_re, const double* b_im, double* r_re, double* r_im, size_t n);
+    void complex_conj_mul_split         (const double* a_re, const double* a_im, const double* b_re, const double* b_im, double* r_re, double* r_im, size_t n);
+    void complex_magnitude_split        (const double* re, const double* im, double* result, size_t n);
+    void complex_magnitude_squared_split(const double* re, const double* im, double* result, size_t n);
+    void complex_phase_split            (const double* re, const double* im, double* result, size_t n);
+    void complex_to_polar_split         (const double* re, const double* im, double* magnitude, double* phase, size_t n);
+    void complex_from_polar_split       (const double* magnitude, const double* phase, double* re, double* im, size_t n);
+    void complex_mul_interleaved              (const double* a, const double* b, double* result, size_t n);
+    void complex_mul_acc_interleaved          (const double* a, const double* b, double* result, size_t n);
+    void complex_conj_mul_interleaved         (const double* a, const double* b, double* result, size_t n);
+    void complex_magnitude_interleaved        (const double* z, double* result, size_t n);
+    void complex_magnitude_squared_interleaved(const double* z, double* result, size_t n);
+    void complex_phase_interleaved            (const double* z, double* result, size_t n);
+    void complex_to_polar_interleaved         (const double* z, double* magnitude, double* phase, size_t n);
+    void complex_from_polar_interleaved       (const double* magnitude, const double* phase, double* z, size_t n);
+
+    enum { STFT_WINDOW_HANN = 0, STFT_WINDOW_BLACKMAN_HARRIS = 1, STFT_WINDOW_KAISER = 2 };
+    typedef struct stft stft;
+    typedef void (*stft_kernel)(double* re, double* im, size_t num_bins, size_t channel, void* user);
+    stft*   stft_create       (size_t num_channels, size_t fft_size, size_t hop, int window, double beta);
+    void    stft_destroy      (stft* st);
+    void    stft_reset        (stft* st);
+    size_t  stft_get_latency  (const stft* st);
+    size_t  stft_get_num_bins (const stft* st);
+    double* stft_get_real     (stft* st, size_t channel);
+    double* stft_get_imag     (stft* st, size_t channel);
+    int     stft_frame_pending(const stft* st);
+    size_t  stft_feed         (stft* st, const double* const* inputs, double* const* outputs, size_t offset, size_t n);
+    void    stft_process      (stft* st, const double* const* inputs, double* const* outputs, size_t n, stft_kernel kernel, void* user);
+    void convert_int16_to_double(const int16_t* input, double* result, size_t n);
+    void convert_int24_to_double(const uint8_t* input, double* result, size_t n);
+    void convert_int32_to_double(const int32_t* input, double* result, size_t n);
+    void convert_double_to_int16(const double* input, int16_t* result, size_t n, double gain, simd_rng* dither);
+    void convert_double_to_int24(const double* input, uint8_t* result, size_t n, double gain, simd_rng* dither);
+    void convert_double_to_int32(const double* input, int32_t* result, size_t n, double gain, simd_rng* dither);
+    void convert_int16_to_float(const int16_t* input, float* result, size_t n);
+    void convert_int24_to_float(const uint8_t* input, float* result, size_t n);
+    void convert_int32_to_float(const int32_t* input, float* result, size_t n);
+    void convert_float_to_int16(const float* input, int16_t* result, size_t n, double gain, simd_rng* dither);
+    void convert_float_to_int24(const float* input, uint8_t* result, size_t n, double gain, simd_rng* dither);
+    void convert_float_to_int32(const float* input, int32_t* result, size_t n, double gain, simd_rng* dither);
+
     double* allocate_aligned_memory(size_t n);
     void free_aligned_memory(double* ptr);
 ]]
@@ -28,7 +305,14 @@ local M = {}
 --ffi.metatype("aligned_buffer_t",{})
 M._doubleSize           = ffi.sizeof("double")
 M._maxSimdRegisters     = 4
-M._memoryAlignmentBytes = 8
+M._memoryAlignmentBytes = 64 -- ALIGN of the native library, the kernels load their inputs aligned
+
+--- Store modes for the optional storeMode argument of the *_into functions.
+-- STORE_AUTO streams large outputs past the cache, STORE_CACHED / STORE_STREAM force one way.
+M.STORE_AUTO   = ffi.C.STORE_AUTO
+M.STORE_CACHED = ffi.C.STORE_CACHED
+M.STORE_STREAM = ffi.C.STORE_STREAM
+local STORE_AUTO = M.STORE_AUTO
 
 --- Align the size of the array to fit the number of parallel register slots.
 -- @param n The number of elements in the array.
@@ -70,9 +354,10 @@ end
 -- @param op2 The second input vector.
 -- @param result The output vector.
 -- @param n The number of elements in the vectors.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
 -- @return The result vector and the padded size.
-function M.add_vectors_into(op1, op2, result, n)
-    simdLib.add_vectors(op1(), op2(), result(), n)
+function M.add_vectors_into(op1, op2, result, n, storeMode)
+    simdLib.add_vectors_ex(op1(), op2(), result(), n, storeMode or STORE_AUTO)
     return result, n
 end
 
@@ -81,9 +366,10 @@ end
 -- @param op2 The second input vector.
 -- @param result The output vector.
 -- @param n The number of elements in the vectors.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
 -- @return The result vector and the padded size.
-function M.sub_vectors_into(op1, op2, result, n)
-    simdLib.sub_vectors(op1(), op2(), result(), n)
+function M.sub_vectors_into(op1, op2, result, n, storeMode)
+    simdLib.sub_vectors_ex(op1(), op2(), result(), n, storeMode or STORE_AUTO)
     return result, n
 end
 
@@ -92,9 +378,10 @@ end
 -- @param op2 The second input vector.
 -- @param result The output vector.
 -- @param n The number of elements in the vectors.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
 -- @return The result vector and the padded size.
-function M.mul_vectors_into(op1, op2, result, n)
-    simdLib.mul_vectors(op1(), op2(), result(), n)
+function M.mul_vectors_into(op1, op2, result, n, storeMode)
+    simdLib.mul_vectors_ex(op1(), op2(), result(), n, storeMode or STORE_AUTO)
     return result, n
 end
 
@@ -102,9 +389,10 @@ end
 -- @param input The input vector.
 -- @param result The output vector.
 -- @param n The number of elements in the vectors.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
 -- @return The result vector and the padded size.
-function M.square_vector_into(input, result, n)
-    simdLib.square_vector(input(), result(), n)
+function M.square_vector_into(input, result, n, storeMode)
+    simdLib.square_vector_ex(input(), result(), n, storeMode or STORE_AUTO)
     return result, n
 end
 
@@ -172,9 +460,10 @@ end
 -- @param b The second input vector.
 -- @param result The output vector.
 -- @param n The number of elements in the vectors.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
 -- @return The result vector and the padded size.
-function M.compute_abs_ratio_into(a, b, result, n)
-    simdLib.compute_abs_ratio(a(), b(), result(), n)
+function M.compute_abs_ratio_into(a, b, result, n, storeMode)
+    simdLib.compute_abs_ratio_ex(a(), b(), result(), n, storeMode or STORE_AUTO)
     return result, n
 end
 
@@ -183,9 +472,10 @@ end
 -- @param b The second input vector.
 -- @param result The output vector.
 -- @param n The number of elements in the vectors.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
 -- @return The result vector and the padded size.
-function M.squared_difference_into(a, b, result, n)
-    simdLib.squared_difference(a(), b(), result(), n)
+function M.squared_difference_into(a, b, result, n, storeMode)
+    simdLib.squared_difference_ex(a(), b(), result(), n, storeMode or STORE_AUTO)
     return result, n
 end
 
@@ -195,9 +485,10 @@ end
 -- @param x The input array.
 -- @param result The output array.
 -- @param n The number of elements in the input and output arrays.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
 -- @return The result array and the padded size.
-function M.compute_a_plus_bx_into(a, b, x, result, n)
-    simdLib.compute_a_plus_bx(a, b, x(), result(), n)
+function M.compute_a_plus_bx_into(a, b, x, result, n, storeMode)
+    simdLib.compute_a_plus_bx_ex(a, b, x(), result(), n, storeMode or STORE_AUTO)
     return result, n
 end
 
@@ -206,17 +497,1719 @@ end
 -- @param b The second input vector.
 -- @param result The output vector.
 -- @param n The number of elements in the vectors.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
 -- @return The result vector and the padded size.
-function M.compute_abs_diff_sum_into(a, b, result, n)
-    simdLib.compute_abs_diff_sum(a(), b(), result(), n)
+function M.compute_abs_diff_sum_into(a, b, result, n, storeMode)
+    simdLib.compute_abs_diff_sum_ex(a(), b(), result(), n, storeMode or STORE_AUTO)
     return result, n
 end
 
---- Allocates aligned memory for a vector.
+--- Sets every element of the result vector to value.
+-- @param value The value to write.
+-- @param result The output vector.
+-- @param n The number of elements in the vector.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
+-- @return The result vector and the padded size.
+function M.fill_vector_into(value, result, n, storeMode)
+    simdLib.fill_vector_ex(value, result(), n, storeMode or STORE_AUTO)
+    return result, n
+end
+
+--- Sets every element of the result vector to 0.
+-- @param result The output vector.
+-- @param n The number of elements in the vector.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
+-- @return The result vector and the padded size.
+function M.zero_vector_into(result, n, storeMode)
+    simdLib.zero_vector_ex(result(), n, storeMode or STORE_AUTO)
+    return result, n
+end
+
+--- Copies the input vector into the result vector.
+-- @param input The input vector.
+-- @param result The output vector, must not overlap the input.
+-- @param n The number of elements in the vectors.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
+-- @return The result vector and the padded size.
+function M.copy_vector_into(input, result, n, storeMode)
+    simdLib.copy_vector_ex(input(), result(), n, storeMode or STORE_AUTO)
+    return result, n
+end
+
+--- Multiplies each element of x by gain in place.
+-- @param x The vector to scale.
+-- @param gain The gain.
+-- @param n The number of elements in the vector.
+-- @return The scaled vector and the padded size.
+function M.scale_vector_inplace(x, gain, n)
+    simdLib.scale_vector_inplace(x(), gain, n)
+    return x, n
+end
+
+--- Computes y = y + gain * x.
+-- @param x The input vector.
+-- @param gain The gain applied to x.
+-- @param y The vector accumulated into.
+-- @param n The number of elements in the vectors.
+-- @return The vector y and the padded size.
+function M.accumulate_vector_into(x, gain, y, n)
+    simdLib.accumulate_vector(x(), gain, y(), n)
+    return y, n
+end
+
+--- Sums gains[k] * inputs[k] into the result vector in a single pass.
+-- @param inputs A Lua array of input vectors.
+-- @param gains A Lua array with one gain per input vector.
+-- @param result The output vector, must not be one of the inputs.
+-- @param n The number of elements in the vectors.
+-- @param storeMode Optional M.STORE_AUTO (default), M.STORE_CACHED or M.STORE_STREAM.
+-- @return The result vector and the padded size.
+function M.mix_n_vectors_into(inputs, gains, result, n, storeMode)
+    local numInputs = #inputs
+    local inputPtrs = ffi.new("const double*[?]", numInputs)
+    local gainArray = ffi.new("double[?]", numInputs)
+    for k = 1, numInputs do
+        inputPtrs[k - 1] = inputs[k]()
+        gainArray[k - 1] = gains[k]
+    end
+    simdLib.mix_n_vectors_ex(inputPtrs, gainArray, numInputs, result(), n, storeMode or STORE_AUTO)
+    return result, n
+end
+
+--- Writes a linear ramp from g0 towards g1, reaching g1 at sample n.
+-- @param g0 The value of the first element.
+-- @param g1 The value the ramp is heading to.
+-- @param result The output vector.
+-- @param n The length of the ramp.
+-- @return The result vector and the padded size.
+function M.generate_gain_ramp_into(g0, g1, result, n)
+    simdLib.generate_gain_ramp(g0, g1, result(), n)
+    return result, n
+end
+
+--- Multiplies x with a gain ramping linearly from g0 towards g1.
+-- @param x The input vector.
+-- @param result The output vector, may be x.
+-- @param g0 The gain of the first element.
+-- @param g1 The gain the ramp is heading to.
+-- @param n The number of elements in the vectors.
+-- @return The result vector and the padded size.
+function M.apply_gain_ramp_into(x, result, g0, g1, n)
+    simdLib.apply_gain_ramp(x(), result(), g0, g1, n)
+    return result, n
+end
+
+--- Creates a bank of one-pole parameter smoothers, freed by the garbage collector.
+-- Parameter indices are 0 based like the buffers.
+-- @param numParams The number of smoothed parameters.
+-- @param sampleRate The sample rate in Hz.
+-- @param timeMs The time constant in milliseconds.
+-- @return The smoother bank.
+function M.smoother_bank_create(numParams, sampleRate, timeMs)
+    local bank = simdLib.smoother_bank_create(numParams, sampleRate, timeMs)
+    if bank == nil then
+        error("Failed to allocate smoother bank")
+    end
+    return ffi.gc(bank, simdLib.smoother_bank_destroy)
+end
+
+--- Sets the value a parameter glides to.
+function M.smoother_bank_set_target(bank, index, target)
+    simdLib.smoother_bank_set_target(bank, index, target)
+end
+
+--- Sets the time constant of a parameter in milliseconds, 0 disables smoothing.
+function M.smoother_bank_set_time(bank, index, timeMs)
+    simdLib.smoother_bank_set_time(bank, index, timeMs)
+end
+
+--- Jumps a parameter to value without smoothing.
+function M.smoother_bank_reset(bank, index, value)
+    simdLib.smoother_bank_reset(bank, index, value)
+end
+
+--- Returns the value a parameter reached at the end of the last block.
+function M.smoother_bank_get_value(bank, index)
+    return simdLib.smoother_bank_get_value(bank, index)
+end
+
+--- Renders n smoothed samples per parameter, parameter p goes to result()[p * stride ...].
+-- @param bank The smoother bank.
+-- @param result The output buffer holding one row per parameter.
+-- @param stride The distance between two rows, a multiple of 4 and at least n.
+-- @param n The number of samples per parameter.
+-- @return The result buffer.
+function M.smoother_bank_process_into(bank, result, stride, n)
+    simdLib.smoother_bank_process(bank, result(), stride, n)
+    return result
+end
+
+--- Switches flush-to-zero / denormals-are-zero on or off for the calling thread.
+-- @param on true to enable.
+-- @return The previous floating point mode, for M.restore_fp_mode.
+function M.set_ftz_daz(on)
+    return simdLib.simd_set_ftz_daz(on and 1 or 0)
+end
+
+--- Returns true if flush-to-zero and denormals-are-zero are enabled on the calling thread.
+function M.get_ftz_daz()
+    return simdLib.simd_get_ftz_daz() ~= 0
+end
+
+--- Restores a floating point mode returned by M.set_ftz_daz.
+function M.restore_fp_mode(mode)
+    simdLib.simd_restore_fp_mode(mode)
+end
+
+--- Calls fn(...) with flush-to-zero / denormals-are-zero enabled and restores the previous mode
+-- afterwards, also when fn raises an error.
+-- @param fn The function to run, e.g. the block processing of a feedback effect.
+-- @return The return values of fn.
+function M.with_ftz_daz(fn, ...)
+    local saved = simdLib.simd_set_ftz_daz(1)
+    local results = { pcall(fn, ...) }
+    simdLib.simd_restore_fp_mode(saved)
+    if not results[1] then
+        error(results[2], 0)
+    end
+    return unpack(results, 2, table.maxn(results))
+end
+
+local fpClassCounts = ffi.new("size_t[3]")
+
+--- Counts subnormal, NaN and infinite values in a vector.
+-- @param input The input vector.
+-- @param n The number of elements in the vector.
+-- @return The number of subnormals, NaNs and infinities.
+function M.count_fp_classes(input, n)
+    simdLib.count_fp_classes(input(), n, fpClassCounts)
+    return tonumber(fpClassCounts[0]), tonumber(fpClassCounts[1]), tonumber(fpClassCounts[2])
+end
+
+--- Replaces subnormal values with 0 in place.
+-- @param x The vector to flush.
+-- @param n The number of elements in the vector.
+-- @return The number of flushed values.
+function M.flush_denormals_inplace(x, n)
+    return tonumber(simdLib.flush_denormals(x(), n))
+end
+
+--- Allocates a compressed 16 bit vector for IEEE half or bfloat16 samples.
+-- Use it with the *_f16* or *_bf16* functions, the format is decided by the functions used.
 -- @param n The number of elements in the vector.
 -- @return A table containing the aligned memory pointer and the padded size.
-function M.allocate_aligned_memory(n)
-    return create_aligned_memory(n)
+function M.allocate_half_memory(n)
+    local simdPegisterPaddedN = M.simdRegisterPaddingSize(n)
+    local memPtr = simdLib.allocate_half_memory(simdPegisterPaddedN)
+    if memPtr == nil then
+        error("Failed to allocate memory")
+    end
+    local resTableWithGC = { ptr=memPtr }
+    function resTableWithGC:getPtr() return self.ptr end
+    setmetatable(resTableWithGC, {
+        __call = function(obj) return obj.ptr end,
+        __gc = function(obj) simdLib.free_half_memory(obj.ptr) end
+    })
+    return resTableWithGC, simdPegisterPaddedN
+end
+
+--- Converts a double vector into a compressed half (format "f16") or bfloat16 (format "bf16") vector.
+-- @param input The double input vector.
+-- @param result The compressed output vector from M.allocate_half_memory.
+-- @param n The number of elements in the vectors.
+-- @param format "f16" (default) or "bf16".
+-- @return The result vector and the padded size.
+function M.compress_vector_into(input, result, n, format)
+    if format == "bf16" then
+        simdLib.convert_double_to_bf16(input(), result(), n)
+    else
+        simdLib.convert_double_to_f16(input(), result(), n)
+    end
+    return result, n
+end
+
+--- Converts a compressed half or bfloat16 vector back into doubles.
+-- @param input The compressed input vector.
+-- @param result The double output vector.
+-- @param n The number of elements in the vectors.
+-- @param format "f16" (default) or "bf16".
+-- @return The result vector and the padded size.
+function M.decompress_vector_into(input, result, n, format)
+    if format == "bf16" then
+        simdLib.convert_bf16_to_double(input(), result(), n)
+    else
+        simdLib.convert_f16_to_double(input(), result(), n)
+    end
+    return result, n
+end
+
+--- Adds a compressed vector to a double vector, converting while loading.
+-- @param a The compressed first input vector.
+-- @param b The double second input vector.
+-- @param result The output vector.
+-- @param n The number of elements in the vectors.
+-- @param format "f16" (default) or "bf16".
+-- @return The result vector and the padded size.
+function M.add_vectors_compressed_into(a, b, result, n, format)
+    if format == "bf16" then
+        simdLib.add_vectors_bf16src(a(), b(), result(), n)
+    else
+        simdLib.add_vectors_f16src(a(), b(), result(), n)
+    end
+    return result, n
+end
+
+--- Multiplies a compressed vector with a double vector, converting while loading.
+-- @param a The compressed first input vector.
+-- @param b The double second input vector.
+-- @param result The output vector.
+-- @param n The number of elements in the vectors.
+-- @param format "f16" (default) or "bf16".
+-- @return The result vector and the padded size.
+function M.mul_vectors_compressed_into(a, b, result, n, format)
+    if format == "bf16" then
+        simdLib.mul_vectors_bf16src(a(), b(), result(), n)
+    else
+        simdLib.mul_vectors_f16src(a(), b(), result(), n)
+    end
+    return result, n
+end
+
+--- Computes y = y + gain * x for a compressed x.
+-- @param x The compressed input vector.
+-- @param gain The gain applied to x.
+-- @param y The double vector accumulated into.
+-- @param n The number of elements in the vectors.
+-- @param format "f16" (default) or "bf16".
+-- @return The vector y and the padded size.
+function M.accumulate_vector_compressed_into(x, gain, y, n, format)
+    if format == "bf16" then
+        simdLib.accumulate_vector_bf16src(x(), gain, y(), n)
+    else
+        simdLib.accumulate_vector_f16src(x(), gain, y(), n)
+    end
+    return y, n
+end
+
+--- Computes a + b * x into a compressed vector, converting while storing.
+-- @param a The scalar value to be added.
+-- @param b The scalar value to be multiplied with each element of x.
+-- @param x The double input vector.
+-- @param result The compressed output vector.
+-- @param n The number of elements in the vectors.
+-- @param format "f16" (default) or "bf16".
+-- @return The result vector and the padded size.
+function M.compute_a_plus_bx_compressed_into(a, b, x, result, n, format)
+    if format == "bf16" then
+        simdLib.compute_a_plus_bx_bf16dst(a, b, x(), result(), n)
+    else
+        simdLib.compute_a_plus_bx_f16dst(a, b, x(), result(), n)
+    end
+    return result, n
+end
+
+--- Creates a seeded random number generator, e.g. for dithering.
+-- @param seed The seed, the same seed always produces the same sequence.
+-- @return The generator.
+function M.rng_create(seed)
+    local rng = simdLib.simd_rng_create(seed or 0)
+    if rng == nil then
+        error("Failed to allocate random number generator")
+    end
+    return ffi.gc(rng, simdLib.simd_rng_destroy)
+end
+
+--- Restarts a generator with a new seed.
+function M.rng_seed(rng, seed)
+    simdLib.simd_rng_seed(rng, seed)
+end
+
+--- Fills a vector with uniform white noise in [lo, hi).
+-- @param rng The generator from M.rng_create.
+-- @param result The output vector.
+-- @param n The number of elements in the vector.
+-- @param lo Optional lower bound, defaults to -1.
+-- @param hi Optional upper bound, defaults to 1.
+-- @return The result vector and the size.
+function M.noise_uniform_into(rng, result, n, lo, hi)
+    simdLib.simd_rng_fill_uniform(rng, result(), n, lo or -1.0, hi or 1.0)
+    return result, n
+end
+
+--- Fills a vector with triangular (TPDF) white noise in (-amplitude, amplitude).
+-- @param amplitude Optional peak value, defaults to 1.
+function M.noise_tpdf_into(rng, result, n, amplitude)
+    simdLib.simd_rng_fill_tpdf(rng, result(), n, amplitude or 1.0)
+    return result, n
+end
+
+--- Fills a vector with Gaussian white noise.
+-- @param mean Optional mean, defaults to 0.
+-- @param sigma Optional standard deviation, defaults to 1.
+function M.noise_gaussian_into(rng, result, n, mean, sigma)
+    simdLib.simd_rng_fill_gaussian(rng, result(), n, mean or 0.0, sigma or 1.0)
+    return result, n
+end
+
+--- Fills a vector with pink (1/f) noise in [-amplitude, amplitude), consecutive calls continue the stream.
+-- @param amplitude Optional peak value, defaults to 1.
+function M.noise_pink_into(rng, result, n, amplitude)
+    simdLib.simd_rng_fill_pink(rng, result(), n, amplitude or 1.0)
+    return result, n
+end
+
+M.DELAY_LINEAR = simdLib.DELAY_INTERP_LINEAR
+M.DELAY_HERMITE = simdLib.DELAY_INTERP_HERMITE
+M.DELAY_LAGRANGE = simdLib.DELAY_INTERP_LAGRANGE
+
+--- Creates a fractional delay line, filled with silence.
+-- @param maxDelay The longest delay in samples that will be read.
+-- @param maxBlock The largest block size passed to write and read.
+-- @return The delay line.
+function M.delay_line_create(maxDelay, maxBlock)
+    local dl = simdLib.delay_line_create(maxDelay, maxBlock)
+    if dl == nil then
+        error("Failed to allocate delay line")
+    end
+    return ffi.gc(dl, simdLib.delay_line_destroy)
+end
+
+--- Fills the delay line with silence.
+function M.delay_line_clear(dl)
+    simdLib.delay_line_clear(dl)
+end
+
+--- Appends a block of n samples from input to the delay line.
+function M.delay_line_write(dl, input, n)
+    simdLib.delay_line_write(dl, input(), n)
+end
+
+--- Reads the last written block with a fractional delay per sample.
+-- @param dl The delay line.
+-- @param delays The vector of delays in samples.
+-- @param result The output vector.
+-- @param n The number of samples.
+-- @param interpolation Optional M.DELAY_LINEAR (default), M.DELAY_HERMITE or M.DELAY_LAGRANGE.
+-- @return The result vector and the size.
+function M.delay_line_read_into(dl, delays, result, n, interpolation)
+    simdLib.delay_line_read(dl, delays(), result(), n, interpolation or M.DELAY_LINEAR)
+    return result, n
+end
+
+--- Reads many taps with fixed delays, tap t goes to result()[(t - 1) * stride ...].
+-- @param delays A Lua table of delays in samples.
+-- @param stride The distance between two rows, a multiple of 4 and at least n.
+-- @return The result buffer.
+function M.delay_line_read_taps_into(dl, delays, result, stride, n, interpolation)
+    local numTaps = #delays
+    local cDelays = ffi.new("double[?]", numTaps, delays)
+    simdLib.delay_line_read_taps(dl, cDelays, numTaps, result(), stride, n, interpolation or M.DELAY_LINEAR)
+    return result
+end
+
+--- Reads many taps with fixed delays and sums them with a gain per tap.
+-- @param delays A Lua table of delays in samples.
+-- @param gains A Lua table of gains, one per delay.
+-- @return The result vector and the size.
+function M.delay_line_mix_taps_into(dl, delays, gains, result, n, interpolation)
+    local numTaps = #delays
+    local cDelays = ffi.new("double[?]", numTaps, delays)
+    local cGains = ffi.new("double[?]", numTaps, gains)
+    simdLib.delay_line_mix_taps(dl, cDelays, cGains, numTaps, result(), n, interpolation or M.DELAY_LINEAR)
+    return result, n
+end
+
+--- Creates a feedback delay network reverb.
+-- @param numLines The number of delay lines: 8, 16 or 32.
+-- @param sampleRate The sample rate in Hz.
+-- @param maxDelayMs The longest delay in milliseconds.
+-- @return The reverb.
+function M.fdn_reverb_create(numLines, sampleRate, maxDelayMs)
+    local fdn = simdLib.fdn_reverb_create(numLines, sampleRate, maxDelayMs)
+    if fdn == nil then
+        error("Failed to create reverb with " .. tostring(numLines) .. " lines")
+    end
+    return ffi.gc(fdn, simdLib.fdn_reverb_destroy)
+end
+
+--- Clears the reverb tail.
+function M.fdn_reverb_reset(fdn)
+    simdLib.fdn_reverb_reset(fdn)
+end
+
+--- Spreads the delay lengths between minMs and maxMs.
+function M.fdn_reverb_set_delays(fdn, minMs, maxMs)
+    simdLib.fdn_reverb_set_delays(fdn, minMs, maxMs)
+end
+
+--- Sets the reverb time in seconds and the damping cutoff in Hz.
+function M.fdn_reverb_set_decay(fdn, rt60, dampingHz)
+    simdLib.fdn_reverb_set_decay(fdn, rt60, dampingHz)
+end
+
+--- Sets the delay modulation depth in samples and the rate in Hz.
+function M.fdn_reverb_set_modulation(fdn, depth, rateHz)
+    simdLib.fdn_reverb_set_modulation(fdn, depth, rateHz)
+end
+
+--- Renders the wet signal of n samples, inRight defaults to inLeft for mono sources.
+-- @return The left and right output vectors.
+function M.fdn_reverb_process_into(fdn, inLeft, inRight, outLeft, outRight, n)
+    inRight = inRight or inLeft
+    simdLib.fdn_reverb_process(fdn, inLeft(), inRight(), outLeft(), outRight(), n)
+    return outLeft, outRight
+end
+
+M.WINDOW_MAX = simdLib.WINDOW_MAX
+M.WINDOW_MIN = simdLib.WINDOW_MIN
+M.WINDOW_SUM = simdLib.WINDOW_SUM
+
+--- Computes the maximum of every window of the given length, moving by hop samples.
+-- @param input The input vector.
+-- @param n The number of elements in the input.
+-- @param window The window length.
+-- @param hop Optional distance between two windows, defaults to 1.
+-- @param result The output vector, room for (n - window) / hop + 1 elements.
+-- @return The result vector and the number of windows.
+function M.sliding_max_into(input, n, window, hop, result)
+    return result, tonumber(simdLib.sliding_max(input(), n, window, hop or 1, result()))
+end
+
+--- Computes the minimum of every window, see M.sliding_max_into.
+function M.sliding_min_into(input, n, window, hop, result)
+    return result, tonumber(simdLib.sliding_min(input(), n, window, hop or 1, result()))
+end
+
+--- Computes the sum of every window, see M.sliding_max_into.
+function M.sliding_sum_into(input, n, window, hop, result)
+    return result, tonumber(simdLib.sliding_sum(input(), n, window, hop or 1, result()))
+end
+
+--- Computes the average of every window, see M.sliding_max_into.
+function M.sliding_mean_into(input, n, window, hop, result)
+    local count = tonumber(simdLib.sliding_sum(input(), n, window, hop or 1, result()))
+    simdLib.scale_vector_inplace(result(), 1.0 / window, count)
+    return result, count
+end
+
+--- Creates the streaming state for sliding windows over a signal that arrives in blocks.
+-- @param op M.WINDOW_MAX, M.WINDOW_MIN or M.WINDOW_SUM.
+-- @param window The window length.
+-- @param hop The distance between the starts of two windows.
+-- @param maxBlock The largest block size passed to M.sliding_window_process_into.
+-- @return The sliding window state.
+function M.sliding_window_create(op, window, hop, maxBlock)
+    local sw = simdLib.sliding_window_create(op, window, hop, maxBlock)
+    if sw == nil then
+        error("Failed to create sliding window")
+    end
+    return ffi.gc(sw, simdLib.sliding_window_destroy)
+end
+
+--- Drops the window in progress.
+function M.sliding_window_reset(sw)
+    simdLib.sliding_window_reset(sw)
+end
+
+--- Feeds n samples and writes the result of every completed window.
+-- @param result The output vector, room for maxBlock / hop + 1 elements.
+-- @return The result vector and the number of windows written.
+function M.sliding_window_process_into(sw, input, n, result)
+    return result, tonumber(simdLib.sliding_window_process(sw, input(), n, result()))
+end
+
+--- Creates a lookahead brickwall limiter linked over numChannels channels.
+-- @param numChannels The number of channels.
+-- @param sampleRate The sample rate in Hz.
+-- @param lookaheadMs The lookahead (and latency) in milliseconds.
+-- @param maxBlock The largest block size passed to M.limiter_process.
+-- @return The limiter.
+function M.limiter_create(numChannels, sampleRate, lookaheadMs, maxBlock)
+    local lim = simdLib.limiter_create(numChannels, sampleRate, lookaheadMs, maxBlock)
+    if lim == nil then
+        error("Failed to allocate limiter")
+    end
+    return { ptr = ffi.gc(lim, simdLib.limiter_destroy), channels = ffi.new("double*[?]", numChannels), numChannels = numChannels }
+end
+
+--- Sets the highest absolute output value.
+function M.limiter_set_ceiling(lim, ceiling)
+    simdLib.limiter_set_ceiling(lim.ptr, ceiling)
+end
+
+--- Sets the release time in milliseconds.
+function M.limiter_set_release(lim, releaseMs)
+    simdLib.limiter_set_release(lim.ptr, releaseMs)
+end
+
+--- Clears the lookahead delay and the gain state.
+function M.limiter_reset(lim)
+    simdLib.limiter_reset(lim.ptr)
+end
+
+--- Returns the latency in samples.
+function M.limiter_get_latency(lim)
+    return tonumber(simdLib.limiter_get_latency(lim.ptr))
+end
+
+--- Returns the gain applied to the last sample, for gain reduction meters.
+function M.limiter_get_gain(lim)
+    return simdLib.limiter_get_gain(lim.ptr)
+end
+
+--- Limits the channel vectors in place.
+-- @param lim The limiter.
+-- @param channels A Lua table of channel vectors.
+-- @param n The number of samples per channel.
+-- @return The channel table.
+function M.limiter_process_inplace(lim, channels, n)
+    for c = 1, lim.numChannels do
+        lim.channels[c - 1] = channels[c]()
+    end
+    simdLib.limiter_process(lim.ptr, lim.channels, n)
+    return channels
+end
+
+M.DYN_COMPRESSOR  = simdLib.DYN_COMPRESSOR
+M.DYN_EXPANDER    = simdLib.DYN_EXPANDER
+M.DYN_GATE        = simdLib.DYN_GATE
+M.DYN_DETECT_PEAK = simdLib.DYN_DETECT_PEAK
+M.DYN_DETECT_RMS  = simdLib.DYN_DETECT_RMS
+M.DYN_LINK_NONE   = simdLib.DYN_LINK_NONE
+M.DYN_LINK_PAIRS  = simdLib.DYN_LINK_PAIRS
+M.DYN_LINK_ALL    = simdLib.DYN_LINK_ALL
+
+--- Creates a compressor / expander / gate for numChannels channels (at most 64).
+-- Defaults: peak compressor, -18 dB threshold, 4:1, 6 dB knee, 40 dB range, 5/100 ms attack/release.
+-- @param numChannels The number of channels.
+-- @param sampleRate The sample rate in Hz.
+-- @param maxBlock The largest block size passed to M.dynamics_process_inplace.
+-- @return The dynamics processor.
+function M.dynamics_create(numChannels, sampleRate, maxBlock)
+    local dyn = simdLib.dynamics_create(numChannels, sampleRate, maxBlock)
+    if dyn == nil then
+        error("Failed to allocate dynamics processor")
+    end
+    return {
+        ptr = ffi.gc(dyn, simdLib.dynamics_destroy),
+        channels = ffi.new("double*[?]", numChannels),
+        sidechain = ffi.new("const double*[?]", numChannels),
+        numChannels = numChannels
+    }
+end
+
+--- Sets M.DYN_COMPRESSOR, M.DYN_EXPANDER or M.DYN_GATE.
+function M.dynamics_set_mode(dyn, mode)
+    simdLib.dynamics_set_mode(dyn.ptr, mode)
+end
+
+--- Sets M.DYN_DETECT_PEAK or M.DYN_DETECT_RMS, the RMS averaging time defaults to 10 ms.
+function M.dynamics_set_detector(dyn, detector, rmsMs)
+    simdLib.dynamics_set_detector(dyn.ptr, detector, rmsMs or 10.0)
+end
+
+--- Sets the static curve: threshold in dBFS, ratio, knee width in dB (default 6) and range in dB (default 40).
+function M.dynamics_set_curve(dyn, thresholdDb, ratio, kneeDb, rangeDb)
+    simdLib.dynamics_set_curve(dyn.ptr, thresholdDb, ratio, kneeDb or 6.0, rangeDb or 40.0)
+end
+
+--- Sets the attack and release times in milliseconds.
+function M.dynamics_set_times(dyn, attackMs, releaseMs)
+    simdLib.dynamics_set_times(dyn.ptr, attackMs, releaseMs)
+end
+
+--- Sets the makeup gain in dB.
+function M.dynamics_set_makeup(dyn, makeupDb)
+    simdLib.dynamics_set_makeup(dyn.ptr, makeupDb)
+end
+
+--- Sets M.DYN_LINK_NONE, M.DYN_LINK_PAIRS (stereo pairs) or M.DYN_LINK_ALL.
+function M.dynamics_set_link(dyn, link)
+    simdLib.dynamics_set_link(dyn.ptr, link)
+end
+
+--- Clears the detector and gain states.
+function M.dynamics_reset(dyn)
+    simdLib.dynamics_reset(dyn.ptr)
+end
+
+--- Returns the current gain of a channel (1-based) in dB, for gain reduction meters.
+function M.dynamics_get_gain_db(dyn, channel)
+    return simdLib.dynamics_get_gain_db(dyn.ptr, channel - 1)
+end
+
+--- Processes the channel vectors in place.
+-- @param dyn The dynamics processor.
+-- @param channels A Lua table of channel vectors.
+-- @param n The number of samples per channel.
+-- @param sidechain Optional Lua table of sidechain vectors driving the detector.
+-- @return The channel table.
+function M.dynamics_process_inplace(dyn, channels, n, sidechain)
+    for c = 1, dyn.numChannels do
+        dyn.channels[c - 1] = channels[c]()
+        if sidechain then
+            dyn.sidechain[c - 1] = sidechain[c]()
+        end
+    end
+    simdLib.dynamics_process(dyn.ptr, dyn.channels, sidechain and dyn.sidechain or nil, n)
+    return channels
+end
+
+M.SAT_HARD  = simdLib.SAT_HARD
+M.SAT_CUBIC = simdLib.SAT_CUBIC
+M.SAT_TANH  = simdLib.SAT_TANH
+M.SAT_ATAN  = simdLib.SAT_ATAN
+
+--- Clamps each element to [lo, hi].
+-- @param input The input vector.
+-- @param result The output vector, may be the input vector.
+-- @param n The number of elements in the vectors.
+-- @param lo Optional lower bound, defaults to -1.
+-- @param hi Optional upper bound, defaults to 1.
+-- @return The result vector and the padded size.
+function M.clamp_vector_into(input, result, n, lo, hi)
+    simdLib.clamp_vector(input(), result(), n, lo or -1.0, hi or 1.0)
+    return result, n
+end
+
+--- Waveshapes each element: result = f(drive * x + bias) - f(bias).
+-- @param input The input vector.
+-- @param result The output vector, may be the input vector.
+-- @param n The number of elements in the vectors.
+-- @param curve M.SAT_HARD, M.SAT_CUBIC, M.SAT_TANH or M.SAT_ATAN.
+-- @param drive Optional gain in front of the curve, defaults to 1.
+-- @param bias Optional offset in front of the curve for asymmetric shaping, defaults to 0.
+-- @return The result vector and the padded size.
+function M.saturate_vector_into(input, result, n, curve, drive, bias)
+    simdLib.saturate_vector(input(), result(), n, curve, drive or 1.0, bias or 0.0)
+    return result, n
+end
+
+--- Creates a saturator with antiderivative anti-aliasing that keeps its state across blocks.
+-- @param curve M.SAT_HARD, M.SAT_CUBIC, M.SAT_TANH or M.SAT_ATAN.
+-- @param drive Optional gain in front of the curve, defaults to 1.
+-- @param bias Optional offset in front of the curve, defaults to 0.
+-- @return The saturator.
+function M.saturator_create(curve, drive, bias)
+    local sat = simdLib.saturator_create(curve, drive or 1.0, bias or 0.0)
+    if sat == nil then
+        error("Failed to allocate saturator")
+    end
+    return ffi.gc(sat, simdLib.saturator_destroy)
+end
+
+--- Sets the curve, drive and bias of a saturator.
+function M.saturator_set(sat, curve, drive, bias)
+    simdLib.saturator_set(sat, curve, drive or 1.0, bias or 0.0)
+end
+
+--- Clears the anti-aliasing state.
+function M.saturator_reset(sat)
+    simdLib.saturator_reset(sat)
+end
+
+--- Waveshapes a block with antiderivative anti-aliasing (half a sample of delay).
+-- @param sat The saturator.
+-- @param input The input vector.
+-- @param result The output vector, may be the input vector.
+-- @param n The number of elements in the vectors.
+-- @return The result vector and the padded size.
+function M.saturator_process_into(sat, input, result, n)
+    simdLib.saturator_process(sat, input(), result(), n)
+    return result, n
+end
+
+--- Creates a 2x, 4x or 8x oversampler with preallocated buffers.
+-- @param numChannels The number of channels.
+-- @param factor 2, 4 or 8.
+-- @param maxBlock The largest block size at the base rate.
+-- @return The oversampler. Its upsampled channel buffers are in the field buffers.
+function M.oversampler_create(numChannels, factor, maxBlock)
+    local os = simdLib.oversampler_create(numChannels, factor, maxBlock)
+    if os == nil then
+        error("Failed to allocate oversampler")
+    end
+    -- The upsampled buffers are owned by the oversampler, wrap them as callable vectors without a finalizer
+    local buffers = {}
+    for c = 1, numChannels do
+        buffers[c] = setmetatable({ ptr = simdLib.oversampler_get_buffer(os, c - 1) }, {
+            __call = function(obj) return obj.ptr end
+        })
+    end
+    return {
+        ptr = ffi.gc(os, simdLib.oversampler_destroy),
+        channels = ffi.new("double*[?]", numChannels),
+        buffers = buffers,
+        numChannels = numChannels,
+        factor = factor
+    }
+end
+
+--- Clears the filter histories.
+function M.oversampler_reset(os)
+    simdLib.oversampler_reset(os.ptr)
+end
+
+--- Returns the round trip latency in samples at the base rate, a whole number at every factor.
+function M.oversampler_get_latency(os)
+    return simdLib.oversampler_get_latency(os.ptr)
+end
+
+local function oversampler_bind(os, channels)
+    for c = 1, os.numChannels do
+        os.channels[c - 1] = channels[c]()
+    end
+end
+
+--- Upsamples the channel vectors into the oversampler's buffers.
+-- @param os The oversampler.
+-- @param channels A Lua table of channel vectors.
+-- @param n The number of samples per channel at the base rate.
+-- @return The table of upsampled buffers and their length n * factor.
+function M.oversampler_upsample(os, channels, n)
+    oversampler_bind(os, channels)
+    return os.buffers, tonumber(simdLib.oversampler_upsample(os.ptr, ffi.cast("const double* const*", os.channels), n))
+end
+
+--- Downsamples the oversampler's buffers into the channel vectors.
+-- @param os The oversampler.
+-- @param channels A Lua table of channel vectors.
+-- @param n The number of samples per channel at the base rate.
+-- @return The channel table.
+function M.oversampler_downsample_into(os, channels, n)
+    oversampler_bind(os, channels)
+    simdLib.oversampler_downsample(os.ptr, os.channels, n)
+    return channels
+end
+
+--- Runs fn(buffer, nUp) on every upsampled channel between upsampling and downsampling,
+-- e.g. function(b, m) vector_simd.saturate_vector_into(b, b, m, vector_simd.SAT_TANH, 4) end.
+-- @param os The oversampler.
+-- @param channels A Lua table of channel vectors, processed in place.
+-- @param n The number of samples per channel at the base rate.
+-- @param fn The elementwise stage.
+-- @return The channel table.
+function M.oversampler_process_inplace(os, channels, n, fn)
+    local buffers, nUp = M.oversampler_upsample(os, channels, n)
+    for c = 1, os.numChannels do
+        fn(buffers[c], nUp)
+    end
+    simdLib.oversampler_downsample(os.ptr, os.channels, n)
+    return channels
+end
+
+--- Oversampled saturation of the channel vectors in place, see M.saturate_vector_into.
+function M.oversampler_saturate_inplace(os, channels, n, curve, drive, bias)
+    oversampler_bind(os, channels)
+    simdLib.oversampler_process_saturate(os.ptr, os.channels, n, curve, drive or 1.0, bias or 0.0)
+    return channels
+end
+
+M.WT_SINE     = simdLib.WT_SINE
+M.WT_SAW      = simdLib.WT_SAW
+M.WT_SQUARE   = simdLib.WT_SQUARE
+M.WT_TRIANGLE = simdLib.WT_TRIANGLE
+
+--- Returns the process wide shared mip-mapped wavetable of a built-in shape.
+-- @param shape M.WT_SINE, M.WT_SAW, M.WT_SQUARE or M.WT_TRIANGLE.
+-- @param tableSize Optional samples per table row, defaults to 2048.
+-- @return The wavetable, released when garbage collected.
+function M.wavetable_acquire_shape(shape, tableSize)
+    local wt = simdLib.wavetable_acquire_shape(shape, tableSize or 2048)
+    if wt == nil then
+        error("Failed to allocate wavetable")
+    end
+    return ffi.gc(wt, simdLib.wavetable_release)
+end
+
+--- Returns a mip-mapped wavetable of one cycle. With a key the table is built once and shared by
+-- every caller (and plugin instance) asking for the same key.
+-- @param key The cache key, or nil for a private table.
+-- @param cycle A vector holding one cycle, may be nil if the key is already cached.
+-- @param length The number of samples in the cycle.
+-- @param tableSize Optional samples per table row, defaults to 2048.
+-- @return The wavetable, released when garbage collected.
+function M.wavetable_acquire(key, cycle, length, tableSize)
+    local wt = simdLib.wavetable_acquire(key, cycle and cycle() or nil, length or 0, tableSize or 2048)
+    if wt == nil then
+        error("Failed to allocate wavetable")
+    end
+    return ffi.gc(wt, simdLib.wavetable_release)
+end
+
+--- Creates a bank of numVoices wavetable oscillators, all silent until a frequency is set.
+-- @param wt The wavetable, the bank keeps its own reference.
+-- @param numVoices The number of voices.
+-- @param sampleRate The sample rate in Hz.
+-- @return The oscillator bank.
+function M.wavetable_bank_create(wt, numVoices, sampleRate)
+    local bank = simdLib.wavetable_bank_create(wt, numVoices, sampleRate)
+    if bank == nil then
+        error("Failed to allocate wavetable bank")
+    end
+    return ffi.gc(bank, simdLib.wavetable_bank_destroy)
+end
+
+--- Sets the frequency in Hz of a voice (1-based).
+function M.wavetable_bank_set_frequency(bank, voice, frequency)
+    simdLib.wavetable_bank_set_frequency(bank, voice - 1, frequency)
+end
+
+--- Sets the phase in cycles of a voice (1-based).
+function M.wavetable_bank_set_phase(bank, voice, phase)
+    simdLib.wavetable_bank_set_phase(bank, voice - 1, phase)
+end
+
+--- Sets the gain of a voice (1-based).
+function M.wavetable_bank_set_gain(bank, voice, gain)
+    simdLib.wavetable_bank_set_gain(bank, voice - 1, gain)
+end
+
+--- Sets M.DELAY_LINEAR, M.DELAY_HERMITE (default) or M.DELAY_LAGRANGE table interpolation.
+function M.wavetable_bank_set_interpolation(bank, interpolation)
+    simdLib.wavetable_bank_set_interpolation(bank, interpolation)
+end
+
+--- Renders every voice into its own row of the result.
+-- @param bank The oscillator bank.
+-- @param result The output vector, voice v (1-based) starts at element (v - 1) * stride.
+-- @param stride The distance between voice rows, a multiple of 4.
+-- @param n The number of samples per voice.
+-- @return The result vector and n.
+function M.wavetable_bank_process_into(bank, result, stride, n)
+    simdLib.wavetable_bank_process(bank, result(), stride, n)
+    return result, n
+end
+
+--- Renders the sum of all voices.
+-- @return The result vector and n.
+function M.wavetable_bank_process_mix_into(bank, result, n)
+    simdLib.wavetable_bank_process_mix(bank, result(), n)
+    return result, n
+end
+
+--- Creates an additive oscillator bank with numPartials silent sine partials.
+-- @param numPartials The number of partials.
+-- @param sampleRate The sample rate in Hz.
+-- @return The additive bank.
+function M.additive_bank_create(numPartials, sampleRate)
+    local bank = simdLib.additive_bank_create(numPartials, sampleRate)
+    if bank == nil then
+        error("Failed to allocate additive bank")
+    end
+    return ffi.gc(bank, simdLib.additive_bank_destroy)
+end
+
+--- Restarts all partials at phase 0, jumping to their targets.
+function M.additive_bank_reset(bank)
+    simdLib.additive_bank_reset(bank)
+end
+
+--- Sets the target frequency in Hz and amplitude of a partial (1-based), reached over the next block.
+function M.additive_bank_set_partial(bank, partial, frequency, amplitude)
+    simdLib.additive_bank_set_partial(bank, partial - 1, frequency, amplitude)
+end
+
+--- Sets the targets of the first count partials from two vectors.
+function M.additive_bank_set_partials(bank, frequencies, amplitudes, count)
+    simdLib.additive_bank_set_partials(bank, frequencies(), amplitudes(), count)
+end
+
+--- Sets the phase in cycles of a partial (1-based) immediately.
+function M.additive_bank_set_phase(bank, partial, phase)
+    simdLib.additive_bank_set_phase(bank, partial - 1, phase)
+end
+
+--- Adds the sum of all partials to the result, ramping them to their targets over the block.
+-- @param bank The additive bank.
+-- @param result The vector accumulated into.
+-- @param n The number of samples.
+-- @return The result vector and n.
+function M.additive_bank_process_into(bank, result, n)
+    simdLib.additive_bank_process(bank, result(), n)
+    return result, n
+end
+
+M.BLEP_SAW      = simdLib.BLEP_SAW
+M.BLEP_SQUARE   = simdLib.BLEP_SQUARE
+M.BLEP_TRIANGLE = simdLib.BLEP_TRIANGLE
+
+--- Creates a bank of numVoices polyBLEP oscillators (saw, pulse, triangle) with hard sync.
+-- @param numVoices The number of voices.
+-- @param sampleRate The sample rate in Hz.
+-- @param shape Optional M.BLEP_SAW (default), M.BLEP_SQUARE or M.BLEP_TRIANGLE.
+-- @return The oscillator bank.
+function M.blep_bank_create(numVoices, sampleRate, shape)
+    local bank = simdLib.blep_bank_create(numVoices, sampleRate)
+    if bank == nil then
+        error("Failed to allocate polyBLEP bank")
+    end
+    simdLib.blep_bank_set_shape(bank, shape or simdLib.BLEP_SAW)
+    return ffi.gc(bank, simdLib.blep_bank_destroy)
+end
+
+--- Sets the waveform of all voices.
+function M.blep_bank_set_shape(bank, shape)
+    simdLib.blep_bank_set_shape(bank, shape)
+end
+
+--- Sets the frequency in Hz of a voice (1-based).
+function M.blep_bank_set_frequency(bank, voice, frequency)
+    simdLib.blep_bank_set_frequency(bank, voice - 1, frequency)
+end
+
+--- Restarts a voice (1-based) at a phase in cycles.
+function M.blep_bank_set_phase(bank, voice, phase)
+    simdLib.blep_bank_set_phase(bank, voice - 1, phase or 0.0)
+end
+
+--- Sets the pulse width (0.01 to 0.99) of a voice (1-based) for M.BLEP_SQUARE.
+function M.blep_bank_set_pulse_width(bank, voice, pulseWidth)
+    simdLib.blep_bank_set_pulse_width(bank, voice - 1, pulseWidth)
+end
+
+--- Hard syncs a voice (1-based) to a master frequency in Hz, 0 or nil disables sync.
+function M.blep_bank_set_sync(bank, voice, masterFrequency)
+    simdLib.blep_bank_set_sync(bank, voice - 1, masterFrequency or 0.0)
+end
+
+--- Sets the gain of a voice (1-based).
+function M.blep_bank_set_gain(bank, voice, gain)
+    simdLib.blep_bank_set_gain(bank, voice - 1, gain)
+end
+
+--- Renders every voice into its own row of the result.
+-- @param bank The oscillator bank.
+-- @param result The output vector, voice v (1-based) starts at element (v - 1) * stride.
+-- @param stride The distance between voice rows, a multiple of 4.
+-- @param n The number of samples per voice.
+-- @return The result vector and n.
+function M.blep_bank_process_into(bank, result, stride, n)
+    simdLib.blep_bank_process(bank, result(), stride, n)
+    return result, n
+end
+
+--- Renders the sum of all voices.
+-- @return The result vector and n.
+function M.blep_bank_process_mix_into(bank, result, n)
+    simdLib.blep_bank_process_mix(bank, result(), n)
+    return result, n
+end
+
+M.VOICE_FIELD_PHASE     = simdLib.VOICE_FIELD_PHASE
+M.VOICE_FIELD_INCREMENT = simdLib.VOICE_FIELD_INCREMENT
+M.VOICE_FIELD_GAIN      = simdLib.VOICE_FIELD_GAIN
+M.VOICE_FIELD_CUTOFF    = simdLib.VOICE_FIELD_CUTOFF
+M.VOICE_FIELD_LEVEL     = simdLib.VOICE_FIELD_LEVEL
+M.VOICE_FIELD_STAGE     = simdLib.VOICE_FIELD_STAGE
+M.VOICE_IDLE    = simdLib.VOICE_IDLE
+M.VOICE_ATTACK  = simdLib.VOICE_ATTACK
+M.VOICE_DECAY   = simdLib.VOICE_DECAY
+M.VOICE_RELEASE = simdLib.VOICE_RELEASE
+
+--- Creates a polyphonic voice engine (polyBLEP saw, 2 pole lowpass, ADSR) with SoA voice state.
+-- @param maxVoices The polyphony, further note ons steal a voice.
+-- @param sampleRate The sample rate in Hz.
+-- @return The voice engine.
+function M.voice_engine_create(maxVoices, sampleRate)
+    local engine = simdLib.voice_engine_create(maxVoices, sampleRate)
+    if engine == nil then
+        error("Failed to allocate voice engine")
+    end
+    return ffi.gc(engine, simdLib.voice_engine_destroy)
+end
+
+--- Silences all voices at once.
+function M.voice_engine_reset(engine)
+    simdLib.voice_engine_reset(engine)
+end
+
+--- Sets the envelope of all voices.
+-- @param attackMs Time to full level in milliseconds.
+-- @param decayMs Time to fall by 80 dB towards the sustain level in milliseconds.
+-- @param sustain The sustain level, 0 to 1.
+-- @param releaseMs Time to fall by 80 dB after the note off in milliseconds.
+function M.voice_engine_set_envelope(engine, attackMs, decayMs, sustain, releaseMs)
+    simdLib.voice_engine_set_envelope(engine, attackMs, decayMs, sustain, releaseMs)
+end
+
+--- Starts or retriggers the voice with the given id, e.g. a note number.
+-- @param engine The voice engine.
+-- @param id The voice id, any integer but -1.
+-- @param frequency The oscillator frequency in Hz.
+-- @param velocity The voice gain.
+-- @param cutoff The lowpass cutoff in Hz.
+-- @return The id of the stolen voice, or nil if no voice was stolen.
+function M.voice_engine_note_on(engine, id, frequency, velocity, cutoff)
+    local stolen = simdLib.voice_engine_note_on(engine, id, frequency, velocity, cutoff)
+    if stolen == -1 then
+        return nil
+    end
+    return stolen
+end
+
+--- Releases the voice with the given id.
+function M.voice_engine_note_off(engine, id)
+    simdLib.voice_engine_note_off(engine, id)
+end
+
+--- Changes the frequency in Hz of the voice with the given id.
+function M.voice_engine_set_frequency(engine, id, frequency)
+    simdLib.voice_engine_set_frequency(engine, id, frequency)
+end
+
+--- Changes the lowpass cutoff in Hz of the voice with the given id.
+function M.voice_engine_set_cutoff(engine, id, cutoff)
+    simdLib.voice_engine_set_cutoff(engine, id, cutoff)
+end
+
+--- Returns the number of live voices and their ids in slot order.
+function M.voice_engine_get_voices(engine)
+    local active = tonumber(simdLib.voice_engine_get_active(engine))
+    local ids = {}
+    for slot = 1, active do
+        ids[slot] = simdLib.voice_engine_get_id(engine, slot - 1)
+    end
+    return active, ids
+end
+
+--- Returns a lane array of the voice state and the number of lanes a SIMD pass covers.
+-- Vector kernels can run on it across the voice dimension, e.g. mul_vectors on M.VOICE_FIELD_INCREMENT.
+-- The contents follow the live voices only until the next engine call.
+-- @param engine The voice engine.
+-- @param field One of the M.VOICE_FIELD_* constants.
+-- @return The lane array as a callable vector owned by the engine, and the padded lane count (a multiple of 4).
+function M.voice_engine_get_field(engine, field)
+    local lanes = simdLib.voice_engine_get_field(engine, field)
+    if lanes == nil then
+        error("Invalid voice field")
+    end
+    local active = tonumber(simdLib.voice_engine_get_active(engine))
+    local view = setmetatable({ ptr = lanes }, {
+        __call = function(obj) return obj.ptr end
+    })
+    return view, 4 * math.ceil(active / 4)
+end
+
+--- Renders the sum of all live voices and frees finished ones.
+-- @return The result vector and n.
+function M.voice_engine_process_into(engine, result, n)
+    simdLib.voice_engine_process(engine, result(), n)
+    return result, n
+end
+
+M.ENV_MAX_SEGMENTS = simdLib.ENV_MAX_SEGMENTS
+M.ENV_DONE = simdLib.ENV_DONE
+
+--- Creates a bank of numEnvelopes multi-segment envelopes.
+-- @param numEnvelopes The number of envelopes.
+-- @param sampleRate The sample rate in Hz.
+-- @return The envelope bank.
+function M.envelope_bank_create(numEnvelopes, sampleRate)
+    local bank = simdLib.envelope_bank_create(numEnvelopes, sampleRate)
+    if bank == nil then
+        error("Failed to allocate envelope bank")
+    end
+    return ffi.gc(bank, simdLib.envelope_bank_destroy)
+end
+
+--- Defines the segments of an envelope (1-based).
+-- @param bank The envelope bank.
+-- @param envelope The envelope index (1-based).
+-- @param segments A list of { target, timeMs, curve } tables, curve 0 (default) is linear,
+-- > 0 exponential starting fast, < 0 exponential starting slow. At most M.ENV_MAX_SEGMENTS.
+-- @param sustain Optional 1-based index of the segment held while the gate is open, nil for a one-shot.
+function M.envelope_bank_set_segments(bank, envelope, segments, sustain)
+    for s, seg in ipairs(segments) do
+        simdLib.envelope_bank_set_segment(bank, envelope - 1, s - 1, seg[1], seg[2], seg[3] or 0.0)
+    end
+    simdLib.envelope_bank_set_layout(bank, envelope - 1, #segments, sustain and sustain - 1 or -1)
+end
+
+--- Shapes an envelope (1-based) as a classic ADSR.
+function M.envelope_bank_set_adsr(bank, envelope, attackMs, decayMs, sustain, releaseMs)
+    simdLib.envelope_bank_set_adsr(bank, envelope - 1, attackMs, decayMs, sustain, releaseMs)
+end
+
+--- Opens (true) or closes (false) the gate of an envelope (1-based).
+function M.envelope_bank_gate(bank, envelope, on)
+    simdLib.envelope_bank_gate(bank, envelope - 1, on and 1 or 0)
+end
+
+--- Jumps an envelope (1-based) to a level and stops it.
+function M.envelope_bank_reset(bank, envelope, level)
+    simdLib.envelope_bank_reset(bank, envelope - 1, level or 0.0)
+end
+
+--- Returns the 1-based segment an envelope (1-based) is in, or nil once it is done.
+function M.envelope_bank_get_stage(bank, envelope)
+    local stage = simdLib.envelope_bank_get_stage(bank, envelope - 1)
+    if stage == simdLib.ENV_DONE then
+        return nil
+    end
+    return stage + 1
+end
+
+--- Returns the current level of an envelope (1-based).
+function M.envelope_bank_get_level(bank, envelope)
+    return simdLib.envelope_bank_get_level(bank, envelope - 1)
+end
+
+--- Renders every envelope into its own row of the result.
+-- @param bank The envelope bank.
+-- @param result The output vector, envelope e (1-based) starts at element (e - 1) * stride.
+-- @param stride The distance between envelope rows, a multiple of 4.
+-- @param n The number of samples per envelope.
+-- @return The result vector and n.
+function M.envelope_bank_process_into(bank, result, stride, n)
+    simdLib.envelope_bank_process(bank, result(), stride, n)
+    return result, n
+end
+
+--- Creates a bank of numVoices zero-delay-feedback state variable filters.
+-- @param numVoices The number of filters (voices or channels).
+-- @param sampleRate The sample rate in Hz.
+-- @return The filter bank.
+function M.svf_bank_create(numVoices, sampleRate)
+    local bank = simdLib.svf_bank_create(numVoices, sampleRate)
+    if bank == nil then
+        error("Failed to allocate SVF bank")
+    end
+    return {
+        ptr = ffi.gc(bank, simdLib.svf_bank_destroy),
+        inputs = ffi.new("const double*[?]", numVoices),
+        cutoff = ffi.new("const double*[?]", numVoices),
+        resonance = ffi.new("const double*[?]", numVoices),
+        lowpass = ffi.new("double*[?]", numVoices),
+        bandpass = ffi.new("double*[?]", numVoices),
+        highpass = ffi.new("double*[?]", numVoices),
+        notch = ffi.new("double*[?]", numVoices),
+        numVoices = numVoices
+    }
+end
+
+--- Clears the filter states.
+function M.svf_bank_reset(bank)
+    simdLib.svf_bank_reset(bank.ptr)
+end
+
+--- Sets the static cutoff in Hz of a filter (1-based), used without cutoff vectors.
+function M.svf_bank_set_cutoff(bank, voice, cutoff)
+    simdLib.svf_bank_set_cutoff(bank.ptr, voice - 1, cutoff)
+end
+
+--- Sets the static Q of a filter (1-based), used without resonance vectors.
+function M.svf_bank_set_resonance(bank, voice, q)
+    simdLib.svf_bank_set_resonance(bank.ptr, voice - 1, q)
+end
+
+-- Fills a pointer array from a Lua table of vectors, returns nil for a missing table.
+local function _svf_rows(array, vectors, count)
+    if not vectors then
+        return nil
+    end
+    for v = 1, count do
+        array[v - 1] = vectors[v]()
+    end
+    return array
+end
+
+--- Filters a block of all voices, computing the requested responses in one pass.
+-- @param bank The filter bank.
+-- @param inputs A Lua table of input vectors.
+-- @param n The number of samples per voice.
+-- @param outputs A table with any of the fields lowpass, bandpass, highpass and notch, each a
+-- Lua table of output vectors. An output vector may be the input vector.
+-- @param cutoff Optional Lua table of per sample cutoff vectors in Hz.
+-- @param resonance Optional Lua table of per sample Q vectors.
+-- @return The outputs table.
+function M.svf_bank_process(bank, inputs, n, outputs, cutoff, resonance)
+    local count = bank.numVoices
+    simdLib.svf_bank_process(bank.ptr, _svf_rows(bank.inputs, inputs, count),
+        _svf_rows(bank.cutoff, cutoff, count), _svf_rows(bank.resonance, resonance, count),
+        _svf_rows(bank.lowpass, outputs.lowpass, count), _svf_rows(bank.bandpass, outputs.bandpass, count),
+        _svf_rows(bank.highpass, outputs.highpass, count), _svf_rows(bank.notch, outputs.notch, count), n)
+    return outputs
+end
+
+M.BIQUAD_LOWPASS   = simdLib.BIQUAD_LOWPASS
+M.BIQUAD_HIGHPASS  = simdLib.BIQUAD_HIGHPASS
+M.BIQUAD_BANDPASS  = simdLib.BIQUAD_BANDPASS
+M.BIQUAD_NOTCH     = simdLib.BIQUAD_NOTCH
+M.BIQUAD_PEAK      = simdLib.BIQUAD_PEAK
+M.BIQUAD_LOWSHELF  = simdLib.BIQUAD_LOWSHELF
+M.BIQUAD_HIGHSHELF = simdLib.BIQUAD_HIGHSHELF
+M.BIQUAD_ALLPASS   = simdLib.BIQUAD_ALLPASS
+
+--- Designs a batch of RBJ cookbook biquads in one vectorized call.
+-- @param bands A list of { type, frequency, q, gainDb } tables, gainDb defaults to 0.
+-- @param sampleRate The sample rate in Hz.
+-- @return A table with the coefficient vectors b0, b1, b2, a1 and a2 (a0 = 1), and the band count.
+function M.biquad_design(bands, sampleRate)
+    local count = #bands
+    local types = ffi.new("int[?]", count)
+    local frequencies = M.allocate_aligned_memory(count)
+    local qs = M.allocate_aligned_memory(count)
+    local gains = M.allocate_aligned_memory(count)
+    local _f, _q, _g = frequencies(), qs(), gains()
+    for i, band in ipairs(bands) do
+        types[i - 1] = band[1]
+        _f[i - 1] = band[2]
+        _q[i - 1] = band[3]
+        _g[i - 1] = band[4] or 0.0
+    end
+    local coeffs = {
+        b0 = M.allocate_aligned_memory(count),
+        b1 = M.allocate_aligned_memory(count),
+        b2 = M.allocate_aligned_memory(count),
+        a1 = M.allocate_aligned_memory(count),
+        a2 = M.allocate_aligned_memory(count)
+    }
+    simdLib.biquad_design(types, _f, _q, _g, count, sampleRate,
+        coeffs.b0(), coeffs.b1(), coeffs.b2(), coeffs.a1(), coeffs.a2())
+    return coeffs, count
+end
+
+--- Creates numChannels cascades of numStages biquads, all passing through until set.
+-- @param numChannels The number of channels, each with its own cascade.
+-- @param numStages The number of biquads per cascade.
+-- @param sampleRate The sample rate in Hz.
+-- @return The biquad bank.
+function M.biquad_bank_create(numChannels, numStages, sampleRate)
+    local bank = simdLib.biquad_bank_create(numChannels, numStages, sampleRate)
+    if bank == nil then
+        error("Failed to allocate biquad bank")
+    end
+    return {
+        ptr = ffi.gc(bank, simdLib.biquad_bank_destroy),
+        channels = ffi.new("double*[?]", numChannels),
+        numChannels = numChannels
+    }
+end
+
+--- Clears the filter states and jumps to the current parameters.
+function M.biquad_bank_reset(bank)
+    simdLib.biquad_bank_reset(bank.ptr)
+end
+
+--- Sets one biquad (1-based channel and stage), designed with all others at the next block.
+-- @param gainDb Optional gain in dB for M.BIQUAD_PEAK and the shelves.
+function M.biquad_bank_set(bank, channel, stage, type, frequency, q, gainDb)
+    simdLib.biquad_bank_set(bank.ptr, channel - 1, stage - 1, type, frequency, q, gainDb or 0.0)
+end
+
+--- Enables (default) or disables ramping the coefficients over a block after a change.
+function M.biquad_bank_set_smoothing(bank, on)
+    simdLib.biquad_bank_set_smoothing(bank.ptr, on and 1 or 0)
+end
+
+--- Filters the channel vectors in place.
+-- @param bank The biquad bank.
+-- @param channels A Lua table of channel vectors.
+-- @param n The number of samples per channel.
+-- @return The channel table.
+function M.biquad_bank_process_inplace(bank, channels, n)
+    for c = 1, bank.numChannels do
+        bank.channels[c - 1] = channels[c]()
+    end
+    simdLib.biquad_bank_process(bank.ptr, bank.channels, n)
+    return channels
+end
+
+M.XO_MAX_BANDS = simdLib.XO_MAX_BANDS
+
+--- Creates a Linkwitz-Riley (LR4) crossover with phase aligned bands.
+-- @param numChannels The number of channels.
+-- @param numBands The number of bands, 2 to M.XO_MAX_BANDS.
+-- @param sampleRate The sample rate in Hz.
+-- @param maxBlock The largest block size, the band buffers are allocated for it.
+-- @return The crossover. Its band vectors are in bands[channel][band].
+function M.crossover_create(numChannels, numBands, sampleRate, maxBlock)
+    local xo = simdLib.crossover_create(numChannels, numBands, sampleRate)
+    if xo == nil then
+        error("Failed to allocate crossover")
+    end
+    local bands = {}
+    local bandPtrs = ffi.new("double*[?]", numChannels * numBands)
+    for c = 1, numChannels do
+        bands[c] = {}
+        for b = 1, numBands do
+            bands[c][b] = M.allocate_aligned_memory(maxBlock)
+            bandPtrs[(c - 1) * numBands + b - 1] = bands[c][b]()
+        end
+    end
+    return {
+        ptr = ffi.gc(xo, simdLib.crossover_destroy),
+        bands = bands,
+        bandPtrs = bandPtrs,
+        channels = ffi.new("const double*[?]", numChannels),
+        outputs = ffi.new("double*[?]", numChannels),
+        gains = ffi.new("double[?]", numBands),
+        numChannels = numChannels,
+        numBands = numBands
+    }
+end
+
+--- Clears the filter states.
+function M.crossover_reset(xo)
+    simdLib.crossover_reset(xo.ptr)
+end
+
+--- Moves a split frequency (1-based, 1 to numBands - 1), keep them ascending.
+function M.crossover_set_frequency(xo, index, frequency)
+    simdLib.crossover_set_frequency(xo.ptr, index - 1, frequency)
+end
+
+--- Splits the channel vectors into the band vectors xo.bands[channel][band].
+-- @param xo The crossover.
+-- @param channels A Lua table of input vectors.
+-- @param n The number of samples per channel, at most maxBlock.
+-- @return The band table.
+function M.crossover_process(xo, channels, n)
+    for c = 1, xo.numChannels do
+        xo.channels[c - 1] = channels[c]()
+    end
+    simdLib.crossover_process(xo.ptr, xo.channels, xo.bandPtrs, n)
+    return xo.bands
+end
+
+--- Sums the band vectors of every channel into the output vectors.
+-- @param xo The crossover.
+-- @param outputs A Lua table of output vectors, one per channel.
+-- @param n The number of samples per channel.
+-- @param gains Optional Lua table of linear band gains.
+-- @return The output table.
+function M.crossover_recombine_into(xo, outputs, n, gains)
+    for c = 1, xo.numChannels do
+        xo.outputs[c - 1] = outputs[c]()
+    end
+    if gains then
+        for b = 1, xo.numBands do
+            xo.gains[b - 1] = gains[b]
+        end
+    end
+    simdLib.crossover_recombine(xo.ptr, ffi.cast("const double* const*", xo.bandPtrs), gains and xo.gains or nil, xo.outputs, n)
+    return outputs
+end
+
+--- Multiplies complex vectors in split layout (separate real and imaginary vectors): r = a * b.
+-- @param aRe The real parts of a.
+-- @param aIm The imaginary parts of a.
+-- @param bRe The real parts of b.
+-- @param bIm The imaginary parts of b.
+-- @param rRe The real parts of the result, may be an input.
+-- @param rIm The imaginary parts of the result, may be an input.
+-- @param n The number of complex values.
+-- @return The result vectors and the padded size.
+function M.complex_mul_split_into(aRe, aIm, bRe, bIm, rRe, rIm, n)
+    simdLib.complex_mul_split(aRe(), aIm(), bRe(), bIm(), rRe(), rIm(), n)
+    return rRe, rIm, n
+end
+
+--- Multiplies and accumulates complex vectors in split layout: r += a * b.
+-- @param n The number of complex values. The other parameters as in complex_mul_split_into.
+-- @return The result vectors and the padded size.
+function M.complex_mul_acc_split_into(aRe, aIm, bRe, bIm, rRe, rIm, n)
+    simdLib.complex_mul_acc_split(aRe(), aIm(), bRe(), bIm(), rRe(), rIm(), n)
+    return rRe, rIm, n
+end
+
+--- Multiplies by the conjugate in split layout: r = a * conj(b).
+-- @param n The number of complex values. The other parameters as in complex_mul_split_into.
+-- @return The result vectors and the padded size.
+function M.complex_conj_mul_split_into(aRe, aIm, bRe, bIm, rRe, rIm, n)
+    simdLib.complex_conj_mul_split(aRe(), aIm(), bRe(), bIm(), rRe(), rIm(), n)
+    return rRe, rIm, n
+end
+
+--- Computes the magnitudes |z| of complex values in split layout.
+-- @param re The real parts.
+-- @param im The imaginary parts.
+-- @param result The output vector.
+-- @param n The number of complex values.
+-- @return The result vector and the padded size.
+function M.complex_magnitude_split_into(re, im, result, n)
+    simdLib.complex_magnitude_split(re(), im(), result(), n)
+    return result, n
+end
+
+--- Computes the squared magnitudes |z|^2 of complex values in split layout.
+-- @param n The number of complex values. The other parameters as in complex_magnitude_split_into.
+-- @return The result vector and the padded size.
+function M.complex_magnitude_squared_split_into(re, im, result, n)
+    simdLib.complex_magnitude_squared_split(re(), im(), result(), n)
+    return result, n
+end
+
+--- Computes the phases arg(z) in (-pi, pi] of complex values in split layout.
+-- @param n The number of complex values. The other parameters as in complex_magnitude_split_into.
+-- @return The result vector and the padded size.
+function M.complex_phase_split_into(re, im, result, n)
+    simdLib.complex_phase_split(re(), im(), result(), n)
+    return result, n
+end
+
+--- Converts complex values in split layout to magnitude and phase.
+-- @param re The real parts.
+-- @param im The imaginary parts.
+-- @param magnitude The output magnitudes, may be re.
+-- @param phase The output phases in (-pi, pi], may be im.
+-- @param n The number of complex values.
+-- @return The magnitude and phase vectors and the padded size.
+function M.complex_to_polar_split_into(re, im, magnitude, phase, n)
+    simdLib.complex_to_polar_split(re(), im(), magnitude(), phase(), n)
+    return magnitude, phase, n
+end
+
+--- Converts magnitude and phase to complex values in split layout.
+-- @param magnitude The magnitudes.
+-- @param phase The phases in radians.
+-- @param re The output real parts, may be magnitude.
+-- @param im The output imaginary parts, may be phase.
+-- @param n The number of complex values.
+-- @return The real and imaginary vectors and the padded size.
+function M.complex_from_polar_split_into(magnitude, phase, re, im, n)
+    simdLib.complex_from_polar_split(magnitude(), phase(), re(), im(), n)
+    return re, im, n
+end
+
+--- Multiplies complex vectors in interleaved layout (re, im, re, im, ..): r = a * b.
+-- @param a The first input, a vector of 2 n doubles.
+-- @param b The second input, a vector of 2 n doubles.
+-- @param result The output, a vector of 2 n doubles, may be an input.
+-- @param n The number of complex values.
+-- @return The result vector and the padded size.
+function M.complex_mul_interleaved_into(a, b, result, n)
+    simdLib.complex_mul_interleaved(a(), b(), result(), n)
+    return result, n
+end
+
+--- Multiplies and accumulates complex vectors in interleaved layout: r += a * b.
+-- @param n The number of complex values. The other parameters as in complex_mul_interleaved_into.
+-- @return The result vector and the padded size.
+function M.complex_mul_acc_interleaved_into(a, b, result, n)
+    simdLib.complex_mul_acc_interleaved(a(), b(), result(), n)
+    return result, n
+end
+
+--- Multiplies by the conjugate in interleaved layout: r = a * conj(b).
+-- @param n The number of complex values. The other parameters as in complex_mul_interleaved_into.
+-- @return The result vector and the padded size.
+function M.complex_conj_mul_interleaved_into(a, b, result, n)
+    simdLib.complex_conj_mul_interleaved(a(), b(), result(), n)
+    return result, n
+end
+
+--- Computes the magnitudes |z| of complex values in interleaved layout.
+-- @param z The complex input, a vector of 2 n doubles.
+-- @param result The output vector of n doubles.
+-- @param n The number of complex values.
+-- @return The result vector and the padded size.
+function M.complex_magnitude_interleaved_into(z, result, n)
+    simdLib.complex_magnitude_interleaved(z(), result(), n)
+    return result, n
+end
+
+--- Computes the squared magnitudes |z|^2 of complex values in interleaved layout.
+-- @param n The number of complex values. The other parameters as in complex_magnitude_interleaved_into.
+-- @return The result vector and the padded size.
+function M.complex_magnitude_squared_interleaved_into(z, result, n)
+    simdLib.complex_magnitude_squared_interleaved(z(), result(), n)
+    return result, n
+end
+
+--- Computes the phases arg(z) in (-pi, pi] of complex values in interleaved layout.
+-- @param n The number of complex values. The other parameters as in complex_magnitude_interleaved_into.
+-- @return The result vector and the padded size.
+function M.complex_phase_interleaved_into(z, result, n)
+    simdLib.complex_phase_interleaved(z(), result(), n)
+    return result, n
+end
+
+--- Converts complex values in interleaved layout to magnitude and phase.
+-- @param z The complex input, a vector of 2 n doubles.
+-- @param magnitude The output magnitudes, n doubles.
+-- @param phase The output phases in (-pi, pi], n doubles.
+-- @param n The number of complex values.
+-- @return The magnitude and phase vectors and the padded size.
+function M.complex_to_polar_interleaved_into(z, magnitude, phase, n)
+    simdLib.complex_to_polar_interleaved(z(), magnitude(), phase(), n)
+    return magnitude, phase, n
+end
+
+--- Converts magnitude and phase to complex values in interleaved layout.
+-- @param magnitude The magnitudes, n doubles.
+-- @param phase The phases in radians, n doubles.
+-- @param z The complex output, a vector of 2 n doubles.
+-- @param n The number of complex values.
+-- @return The complex vector and the padded size.
+function M.complex_from_polar_interleaved_into(magnitude, phase, z, n)
+    simdLib.complex_from_polar_interleaved(magnitude(), phase(), z(), n)
+    return z, n
+end
+
+M.STFT_WINDOW_HANN            = simdLib.STFT_WINDOW_HANN
+M.STFT_WINDOW_BLACKMAN_HARRIS = simdLib.STFT_WINDOW_BLACKMAN_HARRIS
+M.STFT_WINDOW_KAISER          = simdLib.STFT_WINDOW_KAISER
+
+--- Creates an STFT analysis/resynthesis object with overlap-add.
+-- @param numChannels The number of channels.
+-- @param fftSize The frame and FFT size, a power of two from 16 to 65536.
+-- @param hop The frame advance, a multiple of 4 that divides fftSize, at most fftSize / 2.
+-- @param window Optional M.STFT_WINDOW_HANN (default), M.STFT_WINDOW_BLACKMAN_HARRIS or M.STFT_WINDOW_KAISER.
+-- @param beta Optional Kaiser shape, default 8.6.
+-- @return The STFT. Its spectra are in the fields real and imag, numBins bins per channel from DC to Nyquist,
+--         zero padded to binVectorSize for the vector kernels.
+function M.stft_create(numChannels, fftSize, hop, window, beta)
+    local st = simdLib.stft_create(numChannels, fftSize, hop, window or simdLib.STFT_WINDOW_HANN, beta or 8.6)
+    if st == nil then
+        error("Failed to allocate STFT")
+    end
+    -- The bins are owned by the STFT, wrap them as callable vectors without a finalizer
+    local real, imag = {}, {}
+    for c = 1, numChannels do
+        real[c] = setmetatable({ ptr = simdLib.stft_get_real(st, c - 1) }, { __call = function(obj) return obj.ptr end })
+        imag[c] = setmetatable({ ptr = simdLib.stft_get_imag(st, c - 1) }, { __call = function(obj) return obj.ptr end })
+    end
+    local numBins = tonumber(simdLib.stft_get_num_bins(st))
+    return {
+        ptr = ffi.gc(st, simdLib.stft_destroy),
+        inputs = ffi.new("double*[?]", numChannels),
+        outputs = ffi.new("double*[?]", numChannels),
+        real = real,
+        imag = imag,
+        numChannels = numChannels,
+        numBins = numBins,
+        binVectorSize = M.simdRegisterPaddingSize(numBins),
+        fftSize = fftSize,
+        hop = hop
+    }
+end
+
+--- Clears the frames, the overlap-add state and the spectra.
+function M.stft_reset(st)
+    simdLib.stft_reset(st.ptr)
+end
+
+--- Returns the delay from input to output in samples, the FFT size.
+function M.stft_get_latency(st)
+    return tonumber(simdLib.stft_get_latency(st.ptr))
+end
+
+--- Runs a block of any length through the STFT and calls fn(real, imag, numBins, channel) on the spectrum
+-- of every channel of every frame that completes within the block, e.g. a spectral gate
+-- function(re, im, nb, c) ... end working on re() and im() in place.
+-- @param st The STFT.
+-- @param inputs A Lua table of input channel vectors.
+-- @param outputs A Lua table of output channel vectors, may be the inputs.
+-- @param n The number of samples per channel.
+-- @param fn Optional spectral processing, the spectra pass unchanged without it.
+-- @return The output table.
+function M.stft_process(st, inputs, outputs, n, fn)
+    for c = 1, st.numChannels do
+        st.inputs[c - 1] = inputs[c]()
+        st.outputs[c - 1] = outputs[c]()
+    end
+    local inputPtrs = ffi.cast("const double* const*", st.inputs)
+    local offset = 0
+    while offset < n do
+        offset = tonumber(simdLib.stft_feed(st.ptr, inputPtrs, st.outputs, offset, n))
+        if fn and simdLib.stft_frame_pending(st.ptr) ~= 0 then
+            for c = 1, st.numChannels do
+                fn(st.real[c], st.imag[c], st.numBins, c)
+            end
+        end
+    end
+    return outputs
+end
+
+--- Allocates a PCM buffer for n samples of 16, 24 (packed, 3 bytes) or 32 bit integers.
+-- @param n The number of samples.
+-- @param bits 16, 24 or 32.
+-- @return The zero initialized buffer (garbage collected cdata) and the padded size.
+function M.allocate_pcm_memory(n, bits)
+    local simdPegisterPaddedN = M.simdRegisterPaddingSize(n)
+    if bits == 16 then
+        return ffi.new("int16_t[?]", simdPegisterPaddedN), simdPegisterPaddedN
+    elseif bits == 24 then
+        return ffi.new("uint8_t[?]", simdPegisterPaddedN * 3), simdPegisterPaddedN
+    elseif bits == 32 then
+        return ffi.new("int32_t[?]", simdPegisterPaddedN), simdPegisterPaddedN
+    end
+    error("Unsupported PCM bit depth " .. tostring(bits))
+end
+
+--- Converts PCM samples into doubles in [-1, 1).
+-- @param pcm The PCM input, e.g. from M.allocate_pcm_memory.
+-- @param result The output vector.
+-- @param n The number of samples.
+-- @param bits 16, 24 or 32.
+-- @return The result vector and the size.
+function M.pcm_to_vector_into(pcm, result, n, bits)
+    if bits == 16 then
+        simdLib.convert_int16_to_double(pcm, result(), n)
+    elseif bits == 24 then
+        simdLib.convert_int24_to_double(pcm, result(), n)
+    elseif bits == 32 then
+        simdLib.convert_int32_to_double(pcm, result(), n)
+    else
+        error("Unsupported PCM bit depth " .. tostring(bits))
+    end
+    return result, n
+end
+
+--- Converts doubles into PCM samples with gain, optional TPDF dither, rounding and saturation.
+-- @param input The input vector.
+-- @param pcm The PCM output, e.g. from M.allocate_pcm_memory.
+-- @param n The number of samples.
+-- @param bits 16, 24 or 32.
+-- @param gain Optional gain applied before quantization, defaults to 1.0.
+-- @param rng Optional generator from M.rng_create, enables dithering.
+-- @return The PCM buffer and the size.
+function M.vector_to_pcm_into(input, pcm, n, bits, gain, rng)
+    gain = gain or 1.0
+    if bits == 16 then
+        simdLib.convert_double_to_int16(input(), pcm, n, gain, rng)
+    elseif bits == 24 then
+        simdLib.convert_double_to_int24(input(), pcm, n, gain, rng)
+    elseif bits == 32 then
+        simdLib.convert_double_to_int32(input(), pcm, n, gain, rng)
+    else
+        error("Unsupported PCM bit depth " .. tostring(bits))
+    end
+    return pcm, n
+end
+
+--- Sets the output size in bytes from which STORE_AUTO switches to streaming stores.
+-- @param bytes The new threshold, about half of the last level cache is a good value.
+-- @return The previous threshold.
+function M.set_streaming_store_threshold(bytes)
+    return tonumber(simdLib.set_streaming_store_threshold(bytes))
+end
+
+--- Returns the output size in bytes from which STORE_AUTO switches to streaming stores.
+function M.get_streaming_store_threshold()
+    return tonumber(simdLib.get_streaming_store_threshold())
+end
+
+--- Allocates aligned memory for a vector.
+-- @param n The number of elements in the vector.
+-- @return A table containing the aligned memory pointer and the padded size.
+function M.allocate_aligned_memory(n)
+    return create_aligned_memory(n)
+end
+
+--- Wraps memory owned by someone else (e.g. the buffers handed out by batch_exe) so it can be
+-- passed to the *_into functions. The memory is not freed by the wrapper.
+-- @param ptr A double* cdata or a light userdata pointing to aligned memory.
+-- @return A callable table returning the pointer.
+function M.wrap_pointer(ptr)
+    local wrapped = { ptr=ffi.cast("double*", ptr) }
+    function wrapped:getPtr() return self.ptr end
+    setmetatable(wrapped, {
+        __call = function(obj) return obj.ptr end
+    })
+    return wrapped
 end
 
 return M
\ No newline at end of file
@@ -1,4 +1,8 @@
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 //https://learn.arm.com/learning-paths/cross-platform/intrinsics/simde/
@@ -36,7 +40,20 @@ PRAGMA_OPTIMIZE_OFF
 
 #include "simde/check.h"
 #include "simde/x86/avx.h"
+#include "simde/x86/avx2.h"
+#include "simde/x86/fma.h"
+#include "simde/x86/f16c.h"
+#include "simde/x86/avx512/fpclass.h"
+#include "simde/x86/avx512/load.h"
 #include "simde/simde-features.h"
+#include "simde/simde-complex.h"
+// The GNU branch of simde-complex.h guards creal/cimag with the names of the float variants, so they stay undefined there.
+#if !defined(simde_math_creal)
+  #define simde_math_creal(z) __builtin_creal(z)
+#endif
+#if !defined(simde_math_cimag)
+  #define simde_math_cimag(z) __builtin_cimag(z)
+#endif
 
 #if defined(SIMDE_X86_AVX2_NATIVE) 
   PRAGMA_MESSAGE("AVX2 supported.")
@@ -46,6 +63,66 @@ PRAGMA_OPTIMIZE_OFF
 
 const int ALIGN = 64;
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/**
+ * How a kernel writes its output array.
+ * STORE_AUTO   uses non-temporal streaming stores once the output is larger than the streaming threshold.
+ * STORE_CACHED always writes through the cache.
+ * STORE_STREAM always uses streaming stores, e.g. for outputs that are not read again soon.
+ */
+enum store_mode { STORE_AUTO = 0, STORE_CACHED = 1, STORE_STREAM = 2 };
+
+// About half of a typical 8 MB last level cache, see set_streaming_store_threshold
+static size_t streaming_store_threshold = (size_t)4 << 20;
+
+/**
+ * Sets the output size in bytes from which STORE_AUTO kernels switch to streaming stores.
+ * Streaming stores bypass the cache, so the inputs stay cached and no read-for-ownership traffic is paid,
+ * but the output has to come from memory again when it is read. About half of the last level cache is a
+ * good value. Should be set once at start up, it is not synchronized with running kernels.
+ *
+ * @param bytes The new threshold, SIZE_MAX disables streaming stores in STORE_AUTO mode.
+ * @return The previous threshold.
+ */
+__declspec(dllexport) size_t set_streaming_store_threshold(size_t bytes) {
+    const size_t previous = streaming_store_threshold;
+    streaming_store_threshold = bytes;
+    return previous;
+}
+
+/**
+ * Returns the output size in bytes from which STORE_AUTO kernels use streaming stores.
+ */
+__declspec(dllexport) size_t get_streaming_store_threshold(void) {
+    return streaming_store_threshold;
+}
+
+// Streaming stores need 32 byte aligned addresses, anything else falls back to cached stores.
+static inline int use_streaming_store(const double* result, size_t n, int store_mode) {
+    if (((uintptr_t)result & 31) != 0 || store_mode == STORE_CACHED) {
+        return 0;
+    }
+    return store_mode == STORE_STREAM || n * sizeof(double) >= streaming_store_threshold;
+}
+
+static inline void store_result(double* result, simde__m256d v, int stream) {
+    if (stream) {
+        simde_mm256_stream_pd(result, v);
+    } else {
+        simde_mm256_storeu_pd(result, v);
+    }
+}
+
+// Streaming stores are weakly ordered, fence them before anyone reads the output.
+static inline void finish_stores(int stream) {
+    if (stream) {
+        simde_mm_sfence();
+    }
+}
+
 /**
  * Computes a + b for each element in the arrays a and b.
  * The result is stored in the output array.
@@ -54,18 +131,28 @@ const int ALIGN = 64;
  * @param b The second input vector, aligned to ALIGN.
  * @param result The output vector, aligned to ALIGN.
  * @param n The number of elements in the input and output vectors.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
  */
-__declspec(dllexport) void add_vectors(const double* a, const double* b, double* result, size_t n) {
+__declspec(dllexport) void add_vectors_ex(const double* a, const double* b, double* result, size_t n, int store_mode) {
     const double* _a      = __builtin_assume_aligned(a, ALIGN);
     const double* _b      = __builtin_assume_aligned(b, ALIGN);
           double* _result = __builtin_assume_aligned(result, ALIGN);
 
+    const int stream = use_streaming_store(result, n, store_mode);
     for (size_t i = 0; i < n; i += 4, _a+=4, _b+=4, _result+=4) {
         const simde__m256d va = simde_mm256_load_pd(__builtin_assume_aligned(_a, ALIGN));
         const simde__m256d vb = simde_mm256_load_pd(__builtin_assume_aligned(_b, ALIGN));
         const simde__m256d vresult = simde_mm256_add_pd(va, vb);
-        simde_mm256_storeu_pd(_result, vresult);
+        store_result(_result, vresult, stream);
     }
+    finish_stores(stream);
+}
+
+/**
+ * Same as add_vectors_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void add_vectors(const double* a, const double* b, double* result, size_t n) {
+    add_vectors_ex(a, b, result, n, STORE_AUTO);
 }
 
 /**
@@ -76,18 +163,28 @@ __declspec(dllexport) void add_vectors(const double* a, const double* b, double*
  * @param b The second input vector, aligned to ALIGN.
  * @param result The output vector, aligned to ALIGN.
  * @param n The number of elements in the input and output vectors.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
  */
-__declspec(dllexport) void sub_vectors(const double* a, const double* b, double* result, size_t n) {
+__declspec(dllexport) void sub_vectors_ex(const double* a, const double* b, double* result, size_t n, int store_mode) {
     const double* _a      = __builtin_assume_aligned(a, ALIGN);
     const double* _b      = __builtin_assume_aligned(b, ALIGN);
           double* _result = __builtin_assume_aligned(result, ALIGN);
 
+    const int stream = use_streaming_store(result, n, store_mode);
     for (size_t i = 0; i < n; i += 4, _a += 4, _b += 4, _result += 4) {
         const simde__m256d va = simde_mm256_load_pd(_a);
         const simde__m256d vb = simde_mm256_load_pd(_b);
         const simde__m256d vresult = simde_mm256_sub_pd(va, vb);
-        simde_mm256_storeu_pd(_result, vresult);
+        store_result(_result, vresult, stream);
     }
+    finish_stores(stream);
+}
+
+/**
+ * Same as sub_vectors_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void sub_vectors(const double* a, const double* b, double* result, size_t n) {
+    sub_vectors_ex(a, b, result, n, STORE_AUTO);
 }
 
 /**
@@ -98,18 +195,28 @@ __declspec(dllexport) void sub_vectors(const double* a, const double* b, double*
  * @param b The second input vector, aligned to ALIGN.
  * @param result The output vector, aligned to ALIGN.
  * @param n The number of elements in the input and output vectors.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
  */
-__declspec(dllexport) void mul_vectors(const double* a, const double* b, double* result, size_t n) {
+__declspec(dllexport) void mul_vectors_ex(const double* a, const double* b, double* result, size_t n, int store_mode) {
     const double* _a      = __builtin_assume_aligned(a, ALIGN);
     const double* _b      = __builtin_assume_aligned(b, ALIGN);
           double* _result = __builtin_assume_aligned(result, ALIGN);
 
+    const int stream = use_streaming_store(result, n, store_mode);
     for (size_t i = 0; i < n; i += 4, _a += 4, _b += 4, _result += 4) {
         const simde__m256d va = simde_mm256_load_pd(_a);
         const simde__m256d vb = simde_mm256_load_pd(_b);
         const simde__m256d vresult = simde_mm256_mul_pd(va, vb);
-        simde_mm256_storeu_pd(_result, vresult);
+        store_result(_result, vresult, stream);
     }
+    finish_stores(stream);
+}
+
+/**
+ * Same as mul_vectors_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void mul_vectors(const double* a, const double* b, double* result, size_t n) {
+    mul_vectors_ex(a, b, result, n, STORE_AUTO);
 }
 
 /**
@@ -120,12 +227,14 @@ __declspec(dllexport) void mul_vectors(const double* a, const double* b, double*
  * @param b The second input vector, aligned to ALIGN.
  * @param result The output vector, aligned to ALIGN.
  * @param n The number of elements in the input and output vectors.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
  */
-__declspec(dllexport) void compute_abs_diff_sum(const double* a, const double* b, double* result, size_t n) {
+__declspec(dllexport) void compute_abs_diff_sum_ex(const double* a, const double* b, double* result, size_t n, int store_mode) {
     const double* _a      = __builtin_assume_aligned(a, ALIGN);
     const double* _b      = __builtin_assume_aligned(b, ALIGN);
           double* _result = __builtin_assume_aligned(result, ALIGN);
 
+    const int stream = use_streaming_store(result, n, store_mode);
     for (size_t i = 0; i < n; i += 4, _a += 4, _b += 4, _result += 4) {
         const simde__m256d va = simde_mm256_load_pd(_a);
         const simde__m256d vb = simde_mm256_load_pd(_b);
@@ -138,8 +247,16 @@ __declspec(dllexport) void compute_abs_diff_sum(const double* a, const double* b
         const simde__m256d vdiff = simde_mm256_sub_pd(simde_mm256_sub_pd(vabs_sum, vabs_a), vabs_b); // abs(a + b) - abs(a) - abs(b)
         const simde__m256d vabs_diff = simde_mm256_andnot_pd(simde_mm256_set1_pd(-0.0), vdiff); // abs(abs(a + b) - abs(a) - abs(b))
 
-        simde_mm256_storeu_pd(_result, vabs_diff);
+        store_result(_result, vabs_diff, stream);
     }
+    finish_stores(stream);
+}
+
+/**
+ * Same as compute_abs_diff_sum_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void compute_abs_diff_sum(const double* a, const double* b, double* result, size_t n) {
+    compute_abs_diff_sum_ex(a, b, result, n, STORE_AUTO);
 }
 
 /**
@@ -149,16 +266,26 @@ __declspec(dllexport) void compute_abs_diff_sum(const double* a, const double* b
  * @param input The input vector, aligned to ALIGN.
  * @param result The output vector, aligned to ALIGN.
  * @param n The number of elements in the input and output vectors.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
  */
-__declspec(dllexport) void square_vector(const double* input, double* result, size_t n) {
+__declspec(dllexport) void square_vector_ex(const double* input, double* result, size_t n, int store_mode) {
     __builtin_assume_aligned(input, ALIGN);
     __builtin_assume_aligned(result, ALIGN);
+    const int stream = use_streaming_store(result, n, store_mode);
     size_t i;
     for (i = 0; i < n; i += 4, input+=4) {
         const simde__m256d vinput  = simde_mm256_load_pd( __builtin_assume_aligned(input, ALIGN));
         const simde__m256d vresult = simde_mm256_mul_pd(vinput, vinput);
-        _mm256_storeu_pd(&result[i], vresult);
+        store_result(&result[i], vresult, stream);
     }
+    finish_stores(stream);
+}
+
+/**
+ * Same as square_vector_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void square_vector(const double* input, double* result, size_t n) {
+    square_vector_ex(input, result, n, STORE_AUTO);
 }
 
 /**
@@ -229,12 +356,14 @@ __declspec(dllexport) double* compute_rms_windowed(const double* input, size_t n
  * @param b The second input vector, aligned to ALIGN.
  * @param result The output vector, aligned to ALIGN.
  * @param n The number of elements in the input and output vectors.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
  */
-__declspec(dllexport) void compute_abs_ratio(const double* a, const double* b, double* result, size_t n) {
+__declspec(dllexport) void compute_abs_ratio_ex(const double* a, const double* b, double* result, size_t n, int store_mode) {
     const double* _a      = __builtin_assume_aligned(a, ALIGN);
     const double* _b      = __builtin_assume_aligned(b, ALIGN);
           double* _result = __builtin_assume_aligned(result, ALIGN);
 
+    const int stream = use_streaming_store(result, n, store_mode);
     for (size_t i = 0; i < n; i += 4, _a += 4, _b += 4, _result += 4) {
         const simde__m256d va = simde_mm256_load_pd(_a);
         const simde__m256d vb = simde_mm256_load_pd(_b);
@@ -247,8 +376,16 @@ __declspec(dllexport) void compute_abs_ratio(const double* a, const double* b, d
         const simde__m256d vabs_sum_ab = simde_mm256_andnot_pd(simde_mm256_set1_pd(-0.0), vsum); // abs(a + b)
 
         const simde__m256d vresult = simde_mm256_div_pd(vabs_sum_ab, vabs_sum); // abs(a + b) / (abs(a) + abs(b))
-        simde_mm256_storeu_pd(_result, vresult);
+        store_result(_result, vresult, stream);
     }
+    finish_stores(stream);
+}
+
+/**
+ * Same as compute_abs_ratio_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void compute_abs_ratio(const double* a, const double* b, double* result, size_t n) {
+    compute_abs_ratio_ex(a, b, result, n, STORE_AUTO);
 }
 
 /**
@@ -259,19 +396,29 @@ __declspec(dllexport) void compute_abs_ratio(const double* a, const double* b, d
  * @param b The second input vector, aligned to ALIGN.
  * @param result The output vector, aligned to ALIGN.
  * @param n The number of elements in the input and output vectors.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
  */
-__declspec(dllexport) void squared_difference(const double* a, const double* b, double* result, size_t n) {
+__declspec(dllexport) void squared_difference_ex(const double* a, const double* b, double* result, size_t n, int store_mode) {
     const double* _a      = __builtin_assume_aligned(a, ALIGN);
     const double* _b      = __builtin_assume_aligned(b, ALIGN);
           double* _result = __builtin_assume_aligned(result, ALIGN);
 
+    const int stream = use_streaming_store(result, n, store_mode);
     for (size_t i = 0; i < n; i += 4, _a += 4, _b += 4, _result += 4) {
         const simde__m256d va = simde_mm256_load_pd(_a);
         const simde__m256d vb = simde_mm256_load_pd(_b);
         const simde__m256d vdiff = simde_mm256_sub_pd(va, vb);
         const simde__m256d vsquared_diff = simde_mm256_mul_pd(vdiff, vdiff);
-        simde_mm256_storeu_pd(_result, vsquared_diff);
+        store_result(_result, vsquared_diff, stream);
     }
+    finish_stores(stream);
+}
+
+/**
+ * Same as squared_difference_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void squared_difference(const double* a, const double* b, double* result, size_t n) {
+    squared_difference_ex(a, b, result, n, STORE_AUTO);
 }
 
 /**
@@ -283,11 +430,13 @@ __declspec(dllexport) void squared_difference(const double* a, const double* b,
  * @param x The input array, aligned to ALIGN.
  * @param result The output array, aligned to ALIGN.
  * @param n The number of elements in the input and output arrays.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
  */
-__declspec(dllexport) void compute_a_plus_bx(double a, double b, const double* x, double* result, size_t n) {
+__declspec(dllexport) void compute_a_plus_bx_ex(double a, double b, const double* x, double* result, size_t n, int store_mode) {
     const double* _x      = __builtin_assume_aligned(x, ALIGN);
           double* _result = __builtin_assume_aligned(result, ALIGN);
 
+    const int stream = use_streaming_store(result, n, store_mode);
     const simde__m256d va = simde_mm256_set1_pd(a);
     const simde__m256d vb = simde_mm256_set1_pd(b);
 
@@ -295,7 +444,6987 @@ __declspec(dllexport) void compute_a_plus_bx(double a, double b, const double* x
         const simde__m256d vx = simde_mm256_load_pd(_x);
         const simde__m256d vbx = simde_mm256_mul_pd(vb, vx);
         const simde__m256d vresult = simde_mm256_add_pd(va, vbx);
-        simde_mm256_storeu_pd(_result, vresult);
+        store_result(_result, vresult, stream);
+    }
+    finish_stores(stream);
+}
+
+/**
+ * Same as compute_a_plus_bx_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void compute_a_plus_bx(double a, double b, const double* x, double* result, size_t n) {
+    compute_a_plus_bx_ex(a, b, x, result, n, STORE_AUTO);
+}
+
+/**
+ * Sets every element of the output array to value.
+ *
+ * @param value The value to write.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the output vector.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
+ */
+__declspec(dllexport) void fill_vector_ex(double value, double* result, size_t n, int store_mode) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+
+    const int stream = use_streaming_store(result, n, store_mode);
+    const simde__m256d vvalue = simde_mm256_set1_pd(value);
+    for (size_t i = 0; i < n; i += 4, _result += 4) {
+        store_result(_result, vvalue, stream);
+    }
+    finish_stores(stream);
+}
+
+/**
+ * Same as fill_vector_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void fill_vector(double value, double* result, size_t n) {
+    fill_vector_ex(value, result, n, STORE_AUTO);
+}
+
+/**
+ * Sets every element of the output array to 0.
+ *
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the output vector.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
+ */
+__declspec(dllexport) void zero_vector_ex(double* result, size_t n, int store_mode) {
+    fill_vector_ex(0.0, result, n, store_mode);
+}
+
+/**
+ * Same as zero_vector_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void zero_vector(double* result, size_t n) {
+    fill_vector_ex(0.0, result, n, STORE_AUTO);
+}
+
+/**
+ * Copies the input array into the output array. The arrays must not overlap.
+ *
+ * @param input The input vector, aligned to ALIGN.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the input and output vectors.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
+ */
+__declspec(dllexport) void copy_vector_ex(const double* input, double* result, size_t n, int store_mode) {
+    const double* _input  = __builtin_assume_aligned(input, ALIGN);
+          double* _result = __builtin_assume_aligned(result, ALIGN);
+
+    const int stream = use_streaming_store(result, n, store_mode);
+    for (size_t i = 0; i < n; i += 4, _input += 4, _result += 4) {
+        store_result(_result, simde_mm256_load_pd(_input), stream);
+    }
+    finish_stores(stream);
+}
+
+/**
+ * Same as copy_vector_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void copy_vector(const double* input, double* result, size_t n) {
+    copy_vector_ex(input, result, n, STORE_AUTO);
+}
+
+/**
+ * Computes x = gain * x in place.
+ * The array is read right before it is written, so this always uses cached stores.
+ *
+ * @param x The vector to scale, aligned to ALIGN.
+ * @param gain The gain applied to each element.
+ * @param n The number of elements in the vector.
+ */
+__declspec(dllexport) void scale_vector_inplace(double* x, double gain, size_t n) {
+    double* _x = __builtin_assume_aligned(x, ALIGN);
+
+    const simde__m256d vgain = simde_mm256_set1_pd(gain);
+    for (size_t i = 0; i < n; i += 4, _x += 4) {
+        simde_mm256_storeu_pd(_x, simde_mm256_mul_pd(vgain, simde_mm256_load_pd(_x)));
+    }
+}
+
+/**
+ * Computes y = y + gain * x for each element, e.g. to add a send into a bus.
+ * The output is also an input, so this always uses cached stores.
+ *
+ * @param x The input vector, aligned to ALIGN.
+ * @param gain The gain applied to x.
+ * @param y The vector accumulated into, aligned to ALIGN.
+ * @param n The number of elements in the vectors.
+ */
+__declspec(dllexport) void accumulate_vector(const double* x, double gain, double* y, size_t n) {
+    const double* _x = __builtin_assume_aligned(x, ALIGN);
+          double* _y = __builtin_assume_aligned(y, ALIGN);
+
+    const simde__m256d vgain = simde_mm256_set1_pd(gain);
+    for (size_t i = 0; i < n; i += 4, _x += 4, _y += 4) {
+        const simde__m256d vx = simde_mm256_load_pd(_x);
+        const simde__m256d vy = simde_mm256_load_pd(_y);
+        simde_mm256_storeu_pd(_y, simde_mm256_fmadd_pd(vgain, vx, vy)); // y + gain * x
+    }
+}
+
+/**
+ * Computes result = sum(gains[k] * inputs[k]) over num_inputs inputs in a single pass,
+ * so every output element is written once no matter how many inputs are summed.
+ * With no inputs the output is zeroed.
+ *
+ * @param inputs The input vectors, each aligned to ALIGN.
+ * @param gains The gain for each input vector.
+ * @param num_inputs The number of input vectors.
+ * @param result The output vector, aligned to ALIGN. Must not be one of the inputs.
+ * @param n The number of elements in the input and output vectors.
+ * @param store_mode One of STORE_AUTO, STORE_CACHED, STORE_STREAM.
+ */
+__declspec(dllexport) void mix_n_vectors_ex(const double* const* inputs, const double* gains, size_t num_inputs, double* result, size_t n, int store_mode) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+
+    const int stream = use_streaming_store(result, n, store_mode);
+    size_t i = 0;
+    // two independent accumulators per input hide the FMA latency
+    for (; i + 8 <= n; i += 8, _result += 8) {
+        simde__m256d vsum0 = simde_mm256_setzero_pd();
+        simde__m256d vsum1 = simde_mm256_setzero_pd();
+        for (size_t k = 0; k < num_inputs; ++k) {
+            const double* _in = __builtin_assume_aligned(inputs[k], ALIGN);
+            const simde__m256d vgain = simde_mm256_set1_pd(gains[k]);
+            vsum0 = simde_mm256_fmadd_pd(vgain, simde_mm256_load_pd(_in + i), vsum0);
+            vsum1 = simde_mm256_fmadd_pd(vgain, simde_mm256_load_pd(_in + i + 4), vsum1);
+        }
+        store_result(_result, vsum0, stream);
+        store_result(_result + 4, vsum1, stream);
+    }
+    for (; i < n; i += 4, _result += 4) {
+        simde__m256d vsum = simde_mm256_setzero_pd();
+        for (size_t k = 0; k < num_inputs; ++k) {
+            const double* _in = __builtin_assume_aligned(inputs[k], ALIGN);
+            vsum = simde_mm256_fmadd_pd(simde_mm256_set1_pd(gains[k]), simde_mm256_load_pd(_in + i), vsum);
+        }
+        store_result(_result, vsum, stream);
+    }
+    finish_stores(stream);
+}
+
+/**
+ * Same as mix_n_vectors_ex with STORE_AUTO.
+ */
+__declspec(dllexport) void mix_n_vectors(const double* const* inputs, const double* gains, size_t num_inputs, double* result, size_t n) {
+    mix_n_vectors_ex(inputs, gains, num_inputs, result, n, STORE_AUTO);
+}
+
+/**
+ * Writes a linear ramp from g0 towards g1: result[i] = g0 + (g1 - g0) * i / n.
+ * The ramp reaches g1 at sample n, i.e. exactly where the next block starting at g1 picks up.
+ *
+ * @param g0 The value of the first element.
+ * @param g1 The value the ramp is heading to.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The length of the ramp.
+ */
+__declspec(dllexport) void generate_gain_ramp(double g0, double g1, double* result, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    if (n == 0) {
+        return;
+    }
+
+    // the gain is computed from the sample index instead of summing up steps, so it does not drift
+    const simde__m256d vg0   = simde_mm256_set1_pd(g0);
+    const simde__m256d vstep = simde_mm256_set1_pd((g1 - g0) / (double)n);
+    const simde__m256d vfour = simde_mm256_set1_pd(4.0);
+    simde__m256d vidx = simde_mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    for (size_t i = 0; i < n; i += 4, _result += 4) {
+        simde_mm256_storeu_pd(_result, simde_mm256_fmadd_pd(vstep, vidx, vg0));
+        vidx = simde_mm256_add_pd(vidx, vfour);
+    }
+}
+
+/**
+ * Computes result = x * gain, where the gain ramps linearly from g0 towards g1 like generate_gain_ramp.
+ * Use it instead of compute_a_plus_bx(0, g, ...) when a gain changes, to avoid zipper noise.
+ *
+ * @param x The input vector, aligned to ALIGN.
+ * @param result The output vector, aligned to ALIGN. May be x.
+ * @param g0 The gain of the first element.
+ * @param g1 The gain the ramp is heading to.
+ * @param n The number of elements in the input and output vectors.
+ */
+__declspec(dllexport) void apply_gain_ramp(const double* x, double* result, double g0, double g1, size_t n) {
+    const double* _x      = __builtin_assume_aligned(x, ALIGN);
+          double* _result = __builtin_assume_aligned(result, ALIGN);
+    if (n == 0) {
+        return;
+    }
+
+    const simde__m256d vg0   = simde_mm256_set1_pd(g0);
+    const simde__m256d vstep = simde_mm256_set1_pd((g1 - g0) / (double)n);
+    const simde__m256d vfour = simde_mm256_set1_pd(4.0);
+    simde__m256d vidx = simde_mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    for (size_t i = 0; i < n; i += 4, _x += 4, _result += 4) {
+        const simde__m256d vgain = simde_mm256_fmadd_pd(vstep, vidx, vg0);
+        simde_mm256_storeu_pd(_result, simde_mm256_mul_pd(vgain, simde_mm256_load_pd(_x)));
+        vidx = simde_mm256_add_pd(vidx, vfour);
+    }
+}
+
+/**
+ * A bank of one-pole exponential parameter smoothers, y[k] = target + a * (y[k-1] - target).
+ * The state of all parameters is kept in struct-of-arrays layout.
+ */
+typedef struct smoother_bank {
+    size_t num_params;
+    double sample_rate;
+    double* current;   // value reached at the end of the last processed block
+    double* target;
+    double* coeff;     // pole a, 0 jumps to the target immediately
+} smoother_bank;
+
+static double smoother_coeff(double sample_rate, double time_ms) {
+    return time_ms > 0.0 ? exp(-1000.0 / (time_ms * sample_rate)) : 0.0;
+}
+
+/**
+ * Creates a bank of one-pole smoothers, all starting at 0 with the same time constant.
+ *
+ * @param num_params The number of smoothed parameters.
+ * @param sample_rate The sample rate in Hz.
+ * @param time_ms The time constant in milliseconds (time to cover 63% of a step).
+ * @return The smoother bank, or NULL if the allocation fails.
+ */
+__declspec(dllexport) smoother_bank* smoother_bank_create(size_t num_params, double sample_rate, double time_ms) {
+    smoother_bank* bank = (smoother_bank*)calloc(1, sizeof(smoother_bank));
+    if (!bank) {
+        return NULL;
+    }
+    const size_t padded_n = (num_params + 3) & ~(size_t)3;
+    bank->num_params  = num_params;
+    bank->sample_rate = sample_rate;
+    bank->current = (double*)_mm_malloc((padded_n > 0 ? padded_n : 4) * sizeof(double), ALIGN);
+    bank->target  = (double*)_mm_malloc((padded_n > 0 ? padded_n : 4) * sizeof(double), ALIGN);
+    bank->coeff   = (double*)_mm_malloc((padded_n > 0 ? padded_n : 4) * sizeof(double), ALIGN);
+    if (!bank->current || !bank->target || !bank->coeff) {
+        _mm_free(bank->current);
+        _mm_free(bank->target);
+        _mm_free(bank->coeff);
+        free(bank);
+        return NULL;
+    }
+    const double coeff = smoother_coeff(sample_rate, time_ms);
+    for (size_t i = 0; i < padded_n; ++i) {
+        bank->current[i] = 0.0;
+        bank->target[i]  = 0.0;
+        bank->coeff[i]   = coeff;
+    }
+    return bank;
+}
+
+/**
+ * Frees a smoother bank created by smoother_bank_create.
+ *
+ * @param bank The smoother bank, may be NULL.
+ */
+__declspec(dllexport) void smoother_bank_destroy(smoother_bank* bank) {
+    if (!bank) {
+        return;
+    }
+    _mm_free(bank->current);
+    _mm_free(bank->target);
+    _mm_free(bank->coeff);
+    free(bank);
+}
+
+/**
+ * Sets the value a parameter glides to.
+ *
+ * @param bank The smoother bank.
+ * @param index The parameter index.
+ * @param target The new target value.
+ */
+__declspec(dllexport) void smoother_bank_set_target(smoother_bank* bank, size_t index, double target) {
+    if (index < bank->num_params) {
+        bank->target[index] = target;
+    }
+}
+
+/**
+ * Sets the time constant of a parameter.
+ *
+ * @param bank The smoother bank.
+ * @param index The parameter index.
+ * @param time_ms The time constant in milliseconds, 0 disables smoothing.
+ */
+__declspec(dllexport) void smoother_bank_set_time(smoother_bank* bank, size_t index, double time_ms) {
+    if (index < bank->num_params) {
+        bank->coeff[index] = smoother_coeff(bank->sample_rate, time_ms);
+    }
+}
+
+/**
+ * Jumps a parameter to value without smoothing, e.g. when a voice starts.
+ *
+ * @param bank The smoother bank.
+ * @param index The parameter index.
+ * @param value The new current and target value.
+ */
+__declspec(dllexport) void smoother_bank_reset(smoother_bank* bank, size_t index, double value) {
+    if (index < bank->num_params) {
+        bank->current[index] = value;
+        bank->target[index]  = value;
+    }
+}
+
+/**
+ * Returns the current value of a parameter, i.e. the last value written by smoother_bank_process.
+ *
+ * @param bank The smoother bank.
+ * @param index The parameter index.
+ * @return The current value, 0 for an invalid index.
+ */
+__declspec(dllexport) double smoother_bank_get_value(const smoother_bank* bank, size_t index) {
+    return index < bank->num_params ? bank->current[index] : 0.0;
+}
+
+/**
+ * Renders n smoothed samples for every parameter.
+ * The recursion is evaluated in closed form, y[k] = target + (y[-1] - target) * a^(k+1), with one
+ * power of a per lane, so there is no sample to sample dependency and 4 samples are computed at once.
+ *
+ * @param bank The smoother bank.
+ * @param result The output, parameter p is written to result + p * stride, aligned to ALIGN.
+ * @param stride The distance between two parameter rows in doubles, a multiple of 4 and at least n.
+ * @param n The number of samples per parameter.
+ */
+__declspec(dllexport) void smoother_bank_process(smoother_bank* bank, double* result, size_t stride, size_t n) {
+    for (size_t p = 0; p < bank->num_params; ++p) {
+        double* _result = __builtin_assume_aligned(result + p * stride, ALIGN);
+        const double a = bank->coeff[p];
+        const double target = bank->target[p];
+        const double delta = bank->current[p] - target;
+
+        if (delta == 0.0) {
+            fill_vector_ex(target, _result, n, STORE_CACHED);
+            continue;
+        }
+        const double a2 = a * a;
+        const double a4 = a2 * a2;
+        const simde__m256d vtarget = simde_mm256_set1_pd(target);
+        const simde__m256d va4 = simde_mm256_set1_pd(a4);
+        simde__m256d vdelta = simde_mm256_mul_pd(simde_mm256_set1_pd(delta), simde_mm256_set_pd(a4, a2 * a, a2, a));
+        for (size_t i = 0; i < n; i += 4, _result += 4) {
+            simde_mm256_storeu_pd(_result, simde_mm256_add_pd(vtarget, vdelta));
+            vdelta = simde_mm256_mul_pd(vdelta, va4);
+        }
+
+        // snap to the target once the distance is inaudible, so the state never decays into subnormals
+        const double remaining = delta * pow(a, (double)n);
+        bank->current[p] = fabs(remaining) < 1e-12 * (fabs(target) + 1e-12) ? target : target + remaining;
+    }
+}
+
+// MXCSR bits: flush-to-zero for results, denormals-are-zero for inputs
+#define MXCSR_FTZ 0x8000u
+#define MXCSR_DAZ 0x0040u
+
+/**
+ * Returns the floating point control word (MXCSR) of the calling thread,
+ * to be handed back to simd_restore_fp_mode later.
+ */
+__declspec(dllexport) unsigned int simd_save_fp_mode(void) {
+    return simde_mm_getcsr();
+}
+
+/**
+ * Restores a floating point control word saved by simd_save_fp_mode or returned by simd_set_ftz_daz.
+ *
+ * @param mode The saved control word.
+ */
+__declspec(dllexport) void simd_restore_fp_mode(unsigned int mode) {
+    simde_mm_setcsr(mode);
+}
+
+/**
+ * Switches flush-to-zero and denormals-are-zero on or off for the calling thread.
+ * With both on, subnormal inputs are read as 0 and subnormal results are written as 0, so decaying
+ * feedback paths never hit the slow microcode path. The setting is per thread, set it on the audio thread.
+ *
+ * @param on Non zero to enable FTZ and DAZ, 0 to disable both.
+ * @return The previous control word, to restore it with simd_restore_fp_mode.
+ */
+__declspec(dllexport) unsigned int simd_set_ftz_daz(int on) {
+    const unsigned int previous = simde_mm_getcsr();
+    simde_mm_setcsr(on ? (previous | MXCSR_FTZ | MXCSR_DAZ) : (previous & ~(MXCSR_FTZ | MXCSR_DAZ)));
+    return previous;
+}
+
+/**
+ * Returns non zero if flush-to-zero and denormals-are-zero are both enabled on the calling thread.
+ */
+__declspec(dllexport) int simd_get_ftz_daz(void) {
+    return (simde_mm_getcsr() & (MXCSR_FTZ | MXCSR_DAZ)) == (MXCSR_FTZ | MXCSR_DAZ);
+}
+
+// Scoped FTZ/DAZ for kernels with feedback paths, pair every enter with a leave.
+static inline unsigned int ftz_daz_enter(void) {
+    const unsigned int saved = simde_mm_getcsr();
+    simde_mm_setcsr(saved | MXCSR_FTZ | MXCSR_DAZ);
+    return saved;
+}
+
+static inline void ftz_daz_leave(unsigned int saved) {
+    simde_mm_setcsr(saved);
+}
+
+// All ones in the lanes of a block of 4 that lie below n, the last block of an array may be partial.
+static inline simde__m256i live_lanes_si256(size_t i, size_t n) {
+    return i + 4 <= n ? simde_mm256_set1_epi64x(-1)
+                      : simde_mm256_cmpgt_epi64(simde_mm256_set1_epi64x((int64_t)(n - i)), simde_mm256_setr_epi64x(0, 1, 2, 3));
+}
+
+/**
+ * Counts subnormal, NaN and infinite values in the input array.
+ * Classification looks at the bit pattern, so it also sees subnormals while DAZ is enabled.
+ * Uses vfpclasspd when AVX-512DQ is available.
+ *
+ * @param input The input vector, aligned to ALIGN.
+ * @param n The number of elements in the input vector, the padding behind them is not counted.
+ * @param counts Receives the number of subnormals, NaNs and infinities, in that order.
+ */
+__declspec(dllexport) void count_fp_classes(const double* input, size_t n, size_t counts[3]) {
+    const double* _input = __builtin_assume_aligned(input, ALIGN);
+    size_t subnormals = 0, nans = 0, infs = 0;
+    size_t i = 0;
+
+#if defined(SIMDE_X86_AVX512DQ_NATIVE)
+    for (; i + 8 <= n; i += 8) {
+        const simde__m512d v = simde_mm512_load_pd(_input + i);
+        subnormals += (size_t)__builtin_popcount(simde_mm512_fpclass_pd_mask(v, 0x20));        // denormal
+        nans       += (size_t)__builtin_popcount(simde_mm512_fpclass_pd_mask(v, 0x01 | 0x80)); // QNaN | SNaN
+        infs       += (size_t)__builtin_popcount(simde_mm512_fpclass_pd_mask(v, 0x08 | 0x10)); // +inf | -inf
+    }
+#endif
+
+    // the compare masks are all ones (-1) per matching lane, subtracting them counts per lane
+    const simde__m256i vexp_mask  = simde_mm256_set1_epi64x(INT64_C(0x7FF0000000000000));
+    const simde__m256i vmant_mask = simde_mm256_set1_epi64x(INT64_C(0x000FFFFFFFFFFFFF));
+    const simde__m256i vzero = simde_mm256_setzero_si256();
+    simde__m256i vsub = simde_mm256_setzero_si256();
+    simde__m256i vnan = simde_mm256_setzero_si256();
+    simde__m256i vinf = simde_mm256_setzero_si256();
+    for (; i < n; i += 4) {
+        const simde__m256i bits = simde_mm256_castpd_si256(simde_mm256_load_pd(_input + i));
+        const simde__m256i exp  = simde_mm256_and_si256(bits, vexp_mask);
+        const simde__m256i mant_zero = simde_mm256_cmpeq_epi64(simde_mm256_and_si256(bits, vmant_mask), vzero);
+        const simde__m256i exp_zero  = simde_mm256_cmpeq_epi64(exp, vzero);
+        const simde__m256i exp_max   = simde_mm256_and_si256(simde_mm256_cmpeq_epi64(exp, vexp_mask), live_lanes_si256(i, n));
+        const simde__m256i mant_set  = simde_mm256_andnot_si256(mant_zero, live_lanes_si256(i, n));
+        vsub = simde_mm256_sub_epi64(vsub, simde_mm256_and_si256(mant_set, exp_zero));   // exp == 0 && mant != 0
+        vnan = simde_mm256_sub_epi64(vnan, simde_mm256_and_si256(mant_set, exp_max));    // exp == max && mant != 0
+        vinf = simde_mm256_sub_epi64(vinf, simde_mm256_and_si256(mant_zero, exp_max));   // exp == max && mant == 0
+    }
+    int64_t lanes[4];
+    simde_mm256_storeu_si256((simde__m256i*)lanes, vsub);
+    subnormals += (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    simde_mm256_storeu_si256((simde__m256i*)lanes, vnan);
+    nans += (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    simde_mm256_storeu_si256((simde__m256i*)lanes, vinf);
+    infs += (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+
+    counts[0] = subnormals;
+    counts[1] = nans;
+    counts[2] = infs;
+}
+
+/**
+ * Replaces subnormal values in the array with 0 (keeping the sign), in place.
+ * Works on the bit pattern, independent of the FTZ/DAZ setting.
+ *
+ * @param x The vector to flush, aligned to ALIGN.
+ * @param n The number of elements in the vector, the padding behind them is left alone.
+ * @return The number of flushed values.
+ */
+__declspec(dllexport) size_t flush_denormals(double* x, size_t n) {
+    double* _x = __builtin_assume_aligned(x, ALIGN);
+
+    const simde__m256i vexp_mask  = simde_mm256_set1_epi64x(INT64_C(0x7FF0000000000000));
+    const simde__m256i vmant_mask = simde_mm256_set1_epi64x(INT64_C(0x000FFFFFFFFFFFFF));
+    const simde__m256i vzero = simde_mm256_setzero_si256();
+    const simde__m256d vsign = simde_mm256_set1_pd(-0.0);
+    size_t flushed = 0;
+    for (size_t i = 0; i < n; i += 4, _x += 4) {
+        const simde__m256d v = simde_mm256_load_pd(_x);
+        const simde__m256i bits = simde_mm256_castpd_si256(v);
+        const simde__m256i exp_zero  = simde_mm256_cmpeq_epi64(simde_mm256_and_si256(bits, vexp_mask), vzero);
+        const simde__m256i mant_zero = simde_mm256_cmpeq_epi64(simde_mm256_and_si256(bits, vmant_mask), vzero);
+        const simde__m256d subnormal = simde_mm256_castsi256_pd(simde_mm256_and_si256(simde_mm256_andnot_si256(mant_zero, exp_zero), live_lanes_si256(i, n)));
+        const int mask = simde_mm256_movemask_pd(subnormal);
+        if (mask) {
+            simde_mm256_storeu_pd(_x, simde_mm256_blendv_pd(v, simde_mm256_and_pd(v, vsign), subnormal));
+            flushed += (size_t)__builtin_popcount(mask);
+        }
+    }
+    return flushed;
+}
+
+/*
+ * Compressed 16 bit sample storage.
+ * IEEE half (via F16C) keeps 11 bits of precision over +-65504, bfloat16 keeps 8 bits over the full
+ * float range. Both cost a quarter of a double, which is what long delay lines and sample caches need.
+ * Compressed buffers come from allocate_half_memory and hold uint16_t, 4 samples are converted at a time.
+ */
+
+static inline simde__m256d load_f16_pd(const uint16_t* p) {
+    return simde_mm256_cvtps_pd(simde_mm_cvtph_ps(simde_mm_loadl_epi64((const simde__m128i*)p)));
+}
+
+static inline void store_f16_pd(uint16_t* p, simde__m256d v) {
+    simde_mm_storel_epi64((simde__m128i*)p, simde_mm_cvtps_ph(simde_mm256_cvtpd_ps(v), SIMDE_MM_FROUND_TO_NEAREST_INT));
+}
+
+static inline simde__m256d load_bf16_pd(const uint16_t* p) {
+    const simde__m128i bits = simde_mm_slli_epi32(simde_mm_cvtepu16_epi32(simde_mm_loadl_epi64((const simde__m128i*)p)), 16);
+    return simde_mm256_cvtps_pd(simde_mm_castsi128_ps(bits));
+}
+
+static inline void store_bf16_pd(uint16_t* p, simde__m256d v) {
+    const simde__m128 f = simde_mm256_cvtpd_ps(v);
+    const simde__m128i bits = simde_mm_castps_si128(f);
+    // round to nearest even: add 0x7FFF plus the lowest kept bit, then drop the low half
+    const simde__m128i lsb = simde_mm_and_si128(simde_mm_srli_epi32(bits, 16), simde_mm_set1_epi32(1));
+    const simde__m128i rounded = simde_mm_srli_epi32(simde_mm_add_epi32(bits, simde_mm_add_epi32(lsb, simde_mm_set1_epi32(0x7FFF))), 16);
+    // NaNs are truncated and made quiet, rounding could carry their payload into the exponent
+    const simde__m128i quiet_nan = simde_mm_or_si128(simde_mm_srli_epi32(bits, 16), simde_mm_set1_epi32(0x0040));
+    const simde__m128i is_nan = simde_mm_castps_si128(simde_mm_cmpunord_ps(f, f));
+    const simde__m128i result = simde_mm_or_si128(simde_mm_and_si128(is_nan, quiet_nan), simde_mm_andnot_si128(is_nan, rounded));
+    simde_mm_storel_epi64((simde__m128i*)p, simde_mm_packus_epi32(result, result));
+}
+
+/**
+ * Allocates aligned memory for a compressed (half or bfloat16) vector.
+ *
+ * @param n The number of elements in the vector.
+ * @return A pointer to the allocated memory.
+ */
+__declspec(dllexport) uint16_t* allocate_half_memory(size_t n) {
+    size_t padded_n = (n + 3) & ~3; // Ensure n is a multiple of 4 for AVX
+    return (uint16_t*)_mm_malloc(padded_n * sizeof(uint16_t), ALIGN);
+}
+
+/**
+ * Frees memory allocated by allocate_half_memory.
+ *
+ * @param ptr The pointer to the allocated memory.
+ */
+__declspec(dllexport) void free_half_memory(uint16_t* ptr) {
+    _mm_free(ptr);
+}
+
+/**
+ * Converts doubles to IEEE half precision, rounding to nearest. Values beyond +-65504 become infinite.
+ *
+ * @param input The input vector, aligned to ALIGN.
+ * @param result The compressed output vector.
+ * @param n The number of elements in the input and output vectors.
+ */
+__declspec(dllexport) void convert_double_to_f16(const double* input, uint16_t* result, size_t n) {
+    const double* _input = __builtin_assume_aligned(input, ALIGN);
+    for (size_t i = 0; i < n; i += 4, _input += 4, result += 4) {
+        store_f16_pd(result, simde_mm256_load_pd(_input));
+    }
+}
+
+/**
+ * Converts IEEE half precision values to doubles.
+ *
+ * @param input The compressed input vector.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the input and output vectors.
+ */
+__declspec(dllexport) void convert_f16_to_double(const uint16_t* input, double* result, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t i = 0; i < n; i += 4, input += 4, _result += 4) {
+        simde_mm256_storeu_pd(_result, load_f16_pd(input));
+    }
+}
+
+/**
+ * Converts doubles to bfloat16, rounding to nearest even.
+ *
+ * @param input The input vector, aligned to ALIGN.
+ * @param result The compressed output vector.
+ * @param n The number of elements in the input and output vectors.
+ */
+__declspec(dllexport) void convert_double_to_bf16(const double* input, uint16_t* result, size_t n) {
+    const double* _input = __builtin_assume_aligned(input, ALIGN);
+    for (size_t i = 0; i < n; i += 4, _input += 4, result += 4) {
+        store_bf16_pd(result, simde_mm256_load_pd(_input));
+    }
+}
+
+/**
+ * Converts bfloat16 values to doubles.
+ *
+ * @param input The compressed input vector.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the input and output vectors.
+ */
+__declspec(dllexport) void convert_bf16_to_double(const uint16_t* input, double* result, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t i = 0; i < n; i += 4, input += 4, _result += 4) {
+        simde_mm256_storeu_pd(_result, load_bf16_pd(input));
+    }
+}
+
+/**
+ * Computes a + b where a is stored as IEEE half, e.g. to add a delay line tap to the dry signal.
+ *
+ * @param a The compressed first input vector.
+ * @param b The second input vector, aligned to ALIGN.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the input and output vectors.
+ */
+__declspec(dllexport) void add_vectors_f16src(const uint16_t* a, const double* b, double* result, size_t n) {
+    const double* _b      = __builtin_assume_aligned(b, ALIGN);
+          double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t i = 0; i < n; i += 4, a += 4, _b += 4, _result += 4) {
+        simde_mm256_storeu_pd(_result, simde_mm256_add_pd(load_f16_pd(a), simde_mm256_load_pd(_b)));
+    }
+}
+
+/**
+ * Computes a * b where a is stored as IEEE half.
+ *
+ * @param a The compressed first input vector.
+ * @param b The second input vector, aligned to ALIGN.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the input and output vectors.
+ */
+__declspec(dllexport) void mul_vectors_f16src(const uint16_t* a, const double* b, double* result, size_t n) {
+    const double* _b      = __builtin_assume_aligned(b, ALIGN);
+          double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t i = 0; i < n; i += 4, a += 4, _b += 4, _result += 4) {
+        simde_mm256_storeu_pd(_result, simde_mm256_mul_pd(load_f16_pd(a), simde_mm256_load_pd(_b)));
+    }
+}
+
+/**
+ * Computes y = y + gain * x where x is stored as IEEE half, e.g. to mix a delay tap into a bus.
+ *
+ * @param x The compressed input vector.
+ * @param gain The gain applied to x.
+ * @param y The vector accumulated into, aligned to ALIGN.
+ * @param n The number of elements in the vectors.
+ */
+__declspec(dllexport) void accumulate_vector_f16src(const uint16_t* x, double gain, double* y, size_t n) {
+    double* _y = __builtin_assume_aligned(y, ALIGN);
+    const simde__m256d vgain = simde_mm256_set1_pd(gain);
+    for (size_t i = 0; i < n; i += 4, x += 4, _y += 4) {
+        simde_mm256_storeu_pd(_y, simde_mm256_fmadd_pd(vgain, load_f16_pd(x), simde_mm256_load_pd(_y)));
+    }
+}
+
+/**
+ * Computes a + b * x and stores the result as IEEE half, e.g. to write a gained signal into a delay line.
+ *
+ * @param a The scalar value to be added.
+ * @param b The scalar value to be multiplied with each element of x.
+ * @param x The input array, aligned to ALIGN.
+ * @param result The compressed output array.
+ * @param n The number of elements in the input and output arrays.
+ */
+__declspec(dllexport) void compute_a_plus_bx_f16dst(double a, double b, const double* x, uint16_t* result, size_t n) {
+    const double* _x = __builtin_assume_aligned(x, ALIGN);
+    const simde__m256d va = simde_mm256_set1_pd(a);
+    const simde__m256d vb = simde_mm256_set1_pd(b);
+    for (size_t i = 0; i < n; i += 4, _x += 4, result += 4) {
+        store_f16_pd(result, simde_mm256_fmadd_pd(vb, simde_mm256_load_pd(_x), va));
+    }
+}
+
+/**
+ * Computes a + b where a is stored as bfloat16.
+ *
+ * @param a The compressed first input vector.
+ * @param b The second input vector, aligned to ALIGN.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the input and output vectors.
+ */
+__declspec(dllexport) void add_vectors_bf16src(const uint16_t* a, const double* b, double* result, size_t n) {
+    const double* _b      = __builtin_assume_aligned(b, ALIGN);
+          double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t i = 0; i < n; i += 4, a += 4, _b += 4, _result += 4) {
+        simde_mm256_storeu_pd(_result, simde_mm256_add_pd(load_bf16_pd(a), simde_mm256_load_pd(_b)));
+    }
+}
+
+/**
+ * Computes a * b where a is stored as bfloat16.
+ *
+ * @param a The compressed first input vector.
+ * @param b The second input vector, aligned to ALIGN.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the input and output vectors.
+ */
+__declspec(dllexport) void mul_vectors_bf16src(const uint16_t* a, const double* b, double* result, size_t n) {
+    const double* _b      = __builtin_assume_aligned(b, ALIGN);
+          double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t i = 0; i < n; i += 4, a += 4, _b += 4, _result += 4) {
+        simde_mm256_storeu_pd(_result, simde_mm256_mul_pd(load_bf16_pd(a), simde_mm256_load_pd(_b)));
+    }
+}
+
+/**
+ * Computes y = y + gain * x where x is stored as bfloat16.
+ *
+ * @param x The compressed input vector.
+ * @param gain The gain applied to x.
+ * @param y The vector accumulated into, aligned to ALIGN.
+ * @param n The number of elements in the vectors.
+ */
+__declspec(dllexport) void accumulate_vector_bf16src(const uint16_t* x, double gain, double* y, size_t n) {
+    double* _y = __builtin_assume_aligned(y, ALIGN);
+    const simde__m256d vgain = simde_mm256_set1_pd(gain);
+    for (size_t i = 0; i < n; i += 4, x += 4, _y += 4) {
+        simde_mm256_storeu_pd(_y, simde_mm256_fmadd_pd(vgain, load_bf16_pd(x), simde_mm256_load_pd(_y)));
+    }
+}
+
+/**
+ * Computes a + b * x and stores the result as bfloat16.
+ *
+ * @param a The scalar value to be added.
+ * @param b The scalar value to be multiplied with each element of x.
+ * @param x The input array, aligned to ALIGN.
+ * @param result The compressed output array.
+ * @param n The number of elements in the input and output arrays.
+ */
+__declspec(dllexport) void compute_a_plus_bx_bf16dst(double a, double b, const double* x, uint16_t* result, size_t n) {
+    const double* _x = __builtin_assume_aligned(x, ALIGN);
+    const simde__m256d va = simde_mm256_set1_pd(a);
+    const simde__m256d vb = simde_mm256_set1_pd(b);
+    for (size_t i = 0; i < n; i += 4, _x += 4, result += 4) {
+        store_bf16_pd(result, simde_mm256_fmadd_pd(vb, simde_mm256_load_pd(_x), va));
+    }
+}
+
+#define PINK_ROWS 16
+#define ZIG_LAYERS 1024
+#define ZIG_R 4.038849846109505      // start of the tail, solved so that layer 1023 ends at the top of the curve
+#define ZIG_V 1.2263246463530852e-3  // area of every layer, ZIG_R * f(ZIG_R) plus the tail beyond ZIG_R
+
+/**
+ * Vectorized pseudo random number generator: four independent xoshiro256+ streams, one per lane.
+ * The state is kept as four 256 bit words, s[k] holds word k of all four lanes.
+ */
+typedef struct simd_rng {
+    uint64_t s[4][4];
+    uint32_t pink_rows[PINK_ROWS]; // Voss-McCartney rows as 32 bit uniforms, row k is redrawn every 2^(k+1) samples
+    uint32_t pink_counter;         // samples generated so far, always a multiple of 4
+    double zig_x[ZIG_LAYERS + 1];  // layer widths, x[1] = ZIG_R, x[ZIG_LAYERS] = 0, x[0] = ZIG_V / f(ZIG_R) covers the tail
+    double zig_k[ZIG_LAYERS];      // x[i + 1] / x[i], below it a point of layer i lies under the curve
+    double zig_f[ZIG_LAYERS + 1];  // f(x[i]) = exp(-x[i]^2 / 2)
+} simd_rng;
+
+static uint64_t splitmix64(uint64_t* x) {
+    uint64_t z = (*x += UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+/**
+ * Reseeds a generator. The same seed always produces the same sequence.
+ *
+ * @param rng The generator.
+ * @param seed Any value, it is expanded into the full state with splitmix64.
+ */
+__declspec(dllexport) void simd_rng_seed(simd_rng* rng, uint64_t seed) {
+    for (int k = 0; k < 4; ++k) {
+        for (int lane = 0; lane < 4; ++lane) {
+            rng->s[k][lane] = splitmix64(&seed);
+        }
+    }
+    // start the pink rows at random values instead of 0 to avoid a slow fade in
+    for (int k = 0; k < PINK_ROWS; ++k) {
+        rng->pink_rows[k] = (uint32_t)(splitmix64(&seed) >> 32);
+    }
+    rng->pink_counter = 0;
+}
+
+// Ziggurat tables for Gaussian noise: layer i + 1 starts where layer i, of area ZIG_V, ends.
+static void zig_init(simd_rng* rng) {
+    rng->zig_x[0] = ZIG_V / exp(-0.5 * ZIG_R * ZIG_R);
+    rng->zig_x[1] = ZIG_R;
+    for (int i = 1; i < ZIG_LAYERS - 1; ++i) {
+        const double y = ZIG_V / rng->zig_x[i] + exp(-0.5 * rng->zig_x[i] * rng->zig_x[i]);
+        rng->zig_x[i + 1] = y < 1.0 ? sqrt(-2.0 * log(y)) : 0.0;
+    }
+    rng->zig_x[ZIG_LAYERS] = 0.0;
+    for (int i = 0; i < ZIG_LAYERS; ++i) {
+        rng->zig_k[i] = rng->zig_x[i + 1] / rng->zig_x[i];
+    }
+    for (int i = 0; i <= ZIG_LAYERS; ++i) {
+        rng->zig_f[i] = exp(-0.5 * rng->zig_x[i] * rng->zig_x[i]);
+    }
+}
+
+/**
+ * Creates a seeded generator.
+ *
+ * @param seed The seed, see simd_rng_seed.
+ * @return The generator, or NULL if the allocation fails.
+ */
+__declspec(dllexport) simd_rng* simd_rng_create(uint64_t seed) {
+    simd_rng* rng = (simd_rng*)_mm_malloc(sizeof(simd_rng), ALIGN);
+    if (rng) {
+        simd_rng_seed(rng, seed);
+        zig_init(rng);
+    }
+    return rng;
+}
+
+/**
+ * Frees a generator created by simd_rng_create.
+ *
+ * @param rng The generator, may be NULL.
+ */
+__declspec(dllexport) void simd_rng_destroy(simd_rng* rng) {
+    _mm_free(rng);
+}
+
+// Generator state while a kernel runs, loaded into registers once and written back at the end.
+typedef struct rng_lanes {
+    simde__m256i s0, s1, s2, s3;
+} rng_lanes;
+
+static inline rng_lanes rng_load(const simd_rng* rng) {
+    rng_lanes r;
+    r.s0 = simde_mm256_load_si256((const simde__m256i*)rng->s[0]);
+    r.s1 = simde_mm256_load_si256((const simde__m256i*)rng->s[1]);
+    r.s2 = simde_mm256_load_si256((const simde__m256i*)rng->s[2]);
+    r.s3 = simde_mm256_load_si256((const simde__m256i*)rng->s[3]);
+    return r;
+}
+
+static inline void rng_store(simd_rng* rng, const rng_lanes* r) {
+    simde_mm256_store_si256((simde__m256i*)rng->s[0], r->s0);
+    simde_mm256_store_si256((simde__m256i*)rng->s[1], r->s1);
+    simde_mm256_store_si256((simde__m256i*)rng->s[2], r->s2);
+    simde_mm256_store_si256((simde__m256i*)rng->s[3], r->s3);
+}
+
+// One xoshiro256+ step in every lane, returns 4 random 64 bit values.
+static inline simde__m256i rng_next(rng_lanes* r) {
+    const simde__m256i result = simde_mm256_add_epi64(r->s0, r->s3);
+    const simde__m256i t = simde_mm256_slli_epi64(r->s1, 17);
+    r->s2 = simde_mm256_xor_si256(r->s2, r->s0);
+    r->s3 = simde_mm256_xor_si256(r->s3, r->s1);
+    r->s1 = simde_mm256_xor_si256(r->s1, r->s2);
+    r->s0 = simde_mm256_xor_si256(r->s0, r->s3);
+    r->s2 = simde_mm256_xor_si256(r->s2, t);
+    r->s3 = simde_mm256_or_si256(simde_mm256_slli_epi64(r->s3, 45), simde_mm256_srli_epi64(r->s3, 19)); // rotl 45
+    return result;
+}
+
+// Places the top 52 bits of each lane into the mantissa of 1.0, giving uniform doubles in [1, 2).
+static inline simde__m256d bits_to_unit_pd(simde__m256i bits) {
+    const simde__m256i one = simde_mm256_set1_epi64x(INT64_C(0x3FF0000000000000));
+    return simde_mm256_castsi256_pd(simde_mm256_or_si256(simde_mm256_srli_epi64(bits, 12), one));
+}
+
+// Triangular noise in (-1, 1) from one random draw, the difference of two 32 bit uniforms.
+static inline simde__m256d rng_tpdf(rng_lanes* r) {
+    const simde__m256i bits = rng_next(r);
+    const simde__m256d u1 = bits_to_unit_pd(simde_mm256_and_si256(bits, simde_mm256_set1_epi64x(INT64_C(0xFFFFFFFF00000000)))); // high 32 bits
+    const simde__m256d u2 = bits_to_unit_pd(simde_mm256_slli_epi64(bits, 32)); // low 32 bits
+    return simde_mm256_sub_pd(u1, u2);
+}
+
+/*
+ * PCM conversion. Integers map to [-1, 1) by dividing by 2^(bits-1); the other direction scales by
+ * 2^(bits-1) * gain, optionally adds TPDF dither of +-1 LSB, rounds to nearest and saturates.
+ * 24 bit samples are packed little endian, 3 bytes per sample.
+ * PCM buffers come from files and hosts unpadded, so the loaders and stores below take the number of
+ * samples left and touch at most that many; a partial group of 4 goes through a zeroed temporary.
+ */
+
+static inline simde__m256d load_int16_pd(const int16_t* p, size_t left) {
+    simde__m128i packed = simde_mm_setzero_si128();
+    if (left >= 4) {
+        packed = simde_mm_loadl_epi64((const simde__m128i*)p);
+    } else {
+        memcpy(&packed, p, left * sizeof(int16_t));
+    }
+    return simde_mm256_cvtepi32_pd(simde_mm_cvtepi16_epi32(packed));
+}
+
+static inline simde__m256d load_int24_pd(const uint8_t* p, size_t left) {
+    simde__m128i packed = simde_mm_setzero_si128();
+    memcpy(&packed, p, 3 * (left < 4 ? left : 4));
+    // move the 3 bytes of every sample into the top of a 32 bit lane, the arithmetic shift sign extends
+    const simde__m128i spread = simde_mm_shuffle_epi8(packed, simde_mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11));
+    return simde_mm256_cvtepi32_pd(simde_mm_srai_epi32(spread, 8));
+}
+
+static inline simde__m256d load_int32_pd(const int32_t* p, size_t left) {
+    simde__m128i packed = simde_mm_setzero_si128();
+    if (left >= 4) {
+        packed = simde_mm_loadu_si128((const simde__m128i*)p);
+    } else {
+        memcpy(&packed, p, left * sizeof(int32_t));
+    }
+    return simde_mm256_cvtepi32_pd(packed);
+}
+
+static inline simde__m256d load_float_pd(const float* p, size_t left) {
+    simde__m128 packed = simde_mm_setzero_ps();
+    if (left >= 4) {
+        packed = simde_mm_loadu_ps(p);
+    } else {
+        memcpy(&packed, p, left * sizeof(float));
+    }
+    return simde_mm256_cvtps_pd(packed);
+}
+
+// Scales, dithers, rounds and saturates 4 samples to 32 bit integers.
+static inline simde__m128i quantize_pd(simde__m256d v, simde__m256d vscale, simde__m256d vlo, simde__m256d vhi, rng_lanes* dither) {
+    v = simde_mm256_mul_pd(v, vscale);
+    if (dither) {
+        v = simde_mm256_add_pd(v, rng_tpdf(dither));
+    }
+    v = simde_mm256_min_pd(simde_mm256_max_pd(v, vlo), vhi);
+    return simde_mm256_cvtpd_epi32(simde_mm256_round_pd(v, SIMDE_MM_FROUND_TO_NEAREST_INT | SIMDE_MM_FROUND_NO_EXC));
+}
+
+static inline void store_int16(int16_t* p, simde__m128i v, size_t left) {
+    const simde__m128i packed = simde_mm_packs_epi32(v, v);
+    if (left >= 4) {
+        simde_mm_storel_epi64((simde__m128i*)p, packed);
+    } else {
+        memcpy(p, &packed, left * sizeof(int16_t));
+    }
+}
+
+static inline void store_int24(uint8_t* p, simde__m128i v, size_t left) {
+    const simde__m128i packed = simde_mm_shuffle_epi8(v, simde_mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1));
+    memcpy(p, &packed, 3 * (left < 4 ? left : 4));
+}
+
+static inline void store_int32(int32_t* p, simde__m128i v, size_t left) {
+    if (left >= 4) {
+        simde_mm_storeu_si128((simde__m128i*)p, v);
+    } else {
+        memcpy(p, &v, left * sizeof(int32_t));
+    }
+}
+
+static inline void store_float(float* p, simde__m256d v, size_t left) {
+    const simde__m128 f = simde_mm256_cvtpd_ps(v);
+    if (left >= 4) {
+        simde_mm_storeu_ps(p, f);
+    } else {
+        memcpy(p, &f, left * sizeof(float));
+    }
+}
+
+#define PCM16_SCALE 32768.0
+#define PCM24_SCALE 8388608.0
+#define PCM32_SCALE 2147483648.0
+
+/**
+ * Converts 16 bit PCM to doubles in [-1, 1).
+ *
+ * @param input The PCM input, exactly n samples are read.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of samples.
+ */
+__declspec(dllexport) void convert_int16_to_double(const int16_t* input, double* result, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    const simde__m256d vscale = simde_mm256_set1_pd(1.0 / PCM16_SCALE);
+    for (size_t i = 0; i < n; i += 4, input += 4, _result += 4) {
+        simde_mm256_storeu_pd(_result, simde_mm256_mul_pd(load_int16_pd(input, n - i), vscale));
+    }
+}
+
+/**
+ * Converts packed 24 bit PCM to doubles in [-1, 1).
+ *
+ * @param input The PCM input, 3 bytes per sample, exactly n samples are read.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of samples.
+ */
+__declspec(dllexport) void convert_int24_to_double(const uint8_t* input, double* result, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    const simde__m256d vscale = simde_mm256_set1_pd(1.0 / PCM24_SCALE);
+    for (size_t i = 0; i < n; i += 4, input += 12, _result += 4) {
+        simde_mm256_storeu_pd(_result, simde_mm256_mul_pd(load_int24_pd(input, n - i), vscale));
+    }
+}
+
+/**
+ * Converts 32 bit PCM to doubles in [-1, 1).
+ *
+ * @param input The PCM input, exactly n samples are read.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of samples.
+ */
+__declspec(dllexport) void convert_int32_to_double(const int32_t* input, double* result, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    const simde__m256d vscale = simde_mm256_set1_pd(1.0 / PCM32_SCALE);
+    for (size_t i = 0; i < n; i += 4, input += 4, _result += 4) {
+        simde_mm256_storeu_pd(_result, simde_mm256_mul_pd(load_int32_pd(input, n - i), vscale));
+    }
+}
+
+/**
+ * Converts doubles to 16 bit PCM in one pass: gain, optional TPDF dither, rounding and saturation.
+ *
+ * @param input The input vector, aligned to ALIGN.
+ * @param result The PCM output, exactly n samples are written.
+ * @param n The number of samples.
+ * @param gain Applied before quantization, 1.0 maps [-1, 1) to the full range.
+ * @param dither The generator for TPDF dither, NULL for no dither.
+ */
+__declspec(dllexport) void convert_double_to_int16(const double* input, int16_t* result, size_t n, double gain, simd_rng* dither) {
+    const double* _input = __builtin_assume_aligned(input, ALIGN);
+    const simde__m256d vscale = simde_mm256_set1_pd(gain * PCM16_SCALE);
+    const simde__m256d vlo = simde_mm256_set1_pd(-PCM16_SCALE);
+    const simde__m256d vhi = simde_mm256_set1_pd(PCM16_SCALE - 1.0);
+    rng_lanes r;
+    if (dither) {
+        r = rng_load(dither);
+    }
+    for (size_t i = 0; i < n; i += 4, _input += 4, result += 4) {
+        store_int16(result, quantize_pd(simde_mm256_load_pd(_input), vscale, vlo, vhi, dither ? &r : NULL), n - i);
+    }
+    if (dither) {
+        rng_store(dither, &r);
+    }
+}
+
+/**
+ * Converts doubles to packed 24 bit PCM in one pass: gain, optional TPDF dither, rounding and saturation.
+ *
+ * @param input The input vector, aligned to ALIGN.
+ * @param result The PCM output, 3 bytes per sample, exactly n samples are written.
+ * @param n The number of samples.
+ * @param gain Applied before quantization, 1.0 maps [-1, 1) to the full range.
+ * @param dither The generator for TPDF dither, NULL for no dither.
+ */
+__declspec(dllexport) void convert_double_to_int24(const double* input, uint8_t* result, size_t n, double gain, simd_rng* dither) {
+    const double* _input = __builtin_assume_aligned(input, ALIGN);
+    const simde__m256d vscale = simde_mm256_set1_pd(gain * PCM24_SCALE);
+    const simde__m256d vlo = simde_mm256_set1_pd(-PCM24_SCALE);
+    const simde__m256d vhi = simde_mm256_set1_pd(PCM24_SCALE - 1.0);
+    rng_lanes r;
+    if (dither) {
+        r = rng_load(dither);
+    }
+    for (size_t i = 0; i < n; i += 4, _input += 4, result += 12) {
+        store_int24(result, quantize_pd(simde_mm256_load_pd(_input), vscale, vlo, vhi, dither ? &r : NULL), n - i);
+    }
+    if (dither) {
+        rng_store(dither, &r);
+    }
+}
+
+/**
+ * Converts doubles to 32 bit PCM in one pass: gain, optional TPDF dither, rounding and saturation.
+ *
+ * @param input The input vector, aligned to ALIGN.
+ * @param result The PCM output, exactly n samples are written.
+ * @param n The number of samples.
+ * @param gain Applied before quantization, 1.0 maps [-1, 1) to the full range.
+ * @param dither The generator for TPDF dither, NULL for no dither.
+ */
+__declspec(dllexport) void convert_double_to_int32(const double* input, int32_t* result, size_t n, double gain, simd_rng* dither) {
+    const double* _input = __builtin_assume_aligned(input, ALIGN);
+    const simde__m256d vscale = simde_mm256_set1_pd(gain * PCM32_SCALE);
+    const simde__m256d vlo = simde_mm256_set1_pd(-PCM32_SCALE);
+    const simde__m256d vhi = simde_mm256_set1_pd(PCM32_SCALE - 1.0);
+    rng_lanes r;
+    if (dither) {
+        r = rng_load(dither);
+    }
+    for (size_t i = 0; i < n; i += 4, _input += 4, result += 4) {
+        store_int32(result, quantize_pd(simde_mm256_load_pd(_input), vscale, vlo, vhi, dither ? &r : NULL), n - i);
+    }
+    if (dither) {
+        rng_store(dither, &r);
+    }
+}
+
+/**
+ * Converts 16 bit PCM to floats in [-1, 1).
+ *
+ * @param input The PCM input, exactly n samples are read.
+ * @param result The output vector, exactly n samples are written.
+ * @param n The number of samples.
+ */
+__declspec(dllexport) void convert_int16_to_float(const int16_t* input, float* result, size_t n) {
+    const simde__m256d vscale = simde_mm256_set1_pd(1.0 / PCM16_SCALE);
+    for (size_t i = 0; i < n; i += 4, input += 4, result += 4) {
+        store_float(result, simde_mm256_mul_pd(load_int16_pd(input, n - i), vscale), n - i);
+    }
+}
+
+/**
+ * Converts packed 24 bit PCM to floats in [-1, 1).
+ *
+ * @param input The PCM input, 3 bytes per sample, exactly n samples are read.
+ * @param result The output vector, exactly n samples are written.
+ * @param n The number of samples.
+ */
+__declspec(dllexport) void convert_int24_to_float(const uint8_t* input, float* result, size_t n) {
+    const simde__m256d vscale = simde_mm256_set1_pd(1.0 / PCM24_SCALE);
+    for (size_t i = 0; i < n; i += 4, input += 12, result += 4) {
+        store_float(result, simde_mm256_mul_pd(load_int24_pd(input, n - i), vscale), n - i);
+    }
+}
+
+/**
+ * Converts 32 bit PCM to floats in [-1, 1).
+ *
+ * @param input The PCM input, exactly n samples are read.
+ * @param result The output vector, exactly n samples are written.
+ * @param n The number of samples.
+ */
+__declspec(dllexport) void convert_int32_to_float(const int32_t* input, float* result, size_t n) {
+    const simde__m256d vscale = simde_mm256_set1_pd(1.0 / PCM32_SCALE);
+    for (size_t i = 0; i < n; i += 4, input += 4, result += 4) {
+        store_float(result, simde_mm256_mul_pd(load_int32_pd(input, n - i), vscale), n - i);
+    }
+}
+
+/**
+ * Converts floats to 16 bit PCM, see convert_double_to_int16.
+ *
+ * @param input The input floats, unaligned, exactly n samples are read.
+ * @param result The PCM output, exactly n samples are written.
+ * @param n The number of samples.
+ * @param gain Applied before quantization, 1.0 maps [-1, 1) to the full range.
+ * @param dither The generator for TPDF dither, NULL for no dither.
+ */
+__declspec(dllexport) void convert_float_to_int16(const float* input, int16_t* result, size_t n, double gain, simd_rng* dither) {
+    const simde__m256d vscale = simde_mm256_set1_pd(gain * PCM16_SCALE);
+    const simde__m256d vlo = simde_mm256_set1_pd(-PCM16_SCALE);
+    const simde__m256d vhi = simde_mm256_set1_pd(PCM16_SCALE - 1.0);
+    rng_lanes r;
+    if (dither) {
+        r = rng_load(dither);
+    }
+    for (size_t i = 0; i < n; i += 4, input += 4, result += 4) {
+        store_int16(result, quantize_pd(load_float_pd(input, n - i), vscale, vlo, vhi, dither ? &r : NULL), n - i);
+    }
+    if (dither) {
+        rng_store(dither, &r);
+    }
+}
+
+/**
+ * Converts floats to packed 24 bit PCM, see convert_double_to_int24.
+ *
+ * @param input The input floats, unaligned, exactly n samples are read.
+ * @param result The PCM output, 3 bytes per sample, exactly n samples are written.
+ * @param n The number of samples.
+ * @param gain Applied before quantization, 1.0 maps [-1, 1) to the full range.
+ * @param dither The generator for TPDF dither, NULL for no dither.
+ */
+__declspec(dllexport) void convert_float_to_int24(const float* input, uint8_t* result, size_t n, double gain, simd_rng* dither) {
+    const simde__m256d vscale = simde_mm256_set1_pd(gain * PCM24_SCALE);
+    const simde__m256d vlo = simde_mm256_set1_pd(-PCM24_SCALE);
+    const simde__m256d vhi = simde_mm256_set1_pd(PCM24_SCALE - 1.0);
+    rng_lanes r;
+    if (dither) {
+        r = rng_load(dither);
+    }
+    for (size_t i = 0; i < n; i += 4, input += 4, result += 12) {
+        store_int24(result, quantize_pd(load_float_pd(input, n - i), vscale, vlo, vhi, dither ? &r : NULL), n - i);
+    }
+    if (dither) {
+        rng_store(dither, &r);
+    }
+}
+
+/**
+ * Converts floats to 32 bit PCM, see convert_double_to_int32.
+ *
+ * @param input The input floats, unaligned, exactly n samples are read.
+ * @param result The PCM output, exactly n samples are written.
+ * @param n The number of samples.
+ * @param gain Applied before quantization, 1.0 maps [-1, 1) to the full range.
+ * @param dither The generator for TPDF dither, NULL for no dither.
+ */
+__declspec(dllexport) void convert_float_to_int32(const float* input, int32_t* result, size_t n, double gain, simd_rng* dither) {
+    const simde__m256d vscale = simde_mm256_set1_pd(gain * PCM32_SCALE);
+    const simde__m256d vlo = simde_mm256_set1_pd(-PCM32_SCALE);
+    const simde__m256d vhi = simde_mm256_set1_pd(PCM32_SCALE - 1.0);
+    rng_lanes r;
+    if (dither) {
+        r = rng_load(dither);
+    }
+    for (size_t i = 0; i < n; i += 4, input += 4, result += 4) {
+        store_int32(result, quantize_pd(load_float_pd(input, n - i), vscale, vlo, vhi, dither ? &r : NULL), n - i);
+    }
+    if (dither) {
+        rng_store(dither, &r);
+    }
+}
+
+// Natural logarithm of positive normal numbers, exponent split plus an atanh series, error below 1e-15.
+static inline simde__m256d log_pd(simde__m256d x) {
+    const simde__m256i bits = simde_mm256_castpd_si256(x);
+    const simde__m256i magic = simde_mm256_set1_epi64x(INT64_C(0x4330000000000000)); // 2^52, turns small integers into doubles
+    simde__m256d e = simde_mm256_sub_pd(simde_mm256_castsi256_pd(simde_mm256_or_si256(simde_mm256_srli_epi64(bits, 52), magic)),
+                                        simde_mm256_set1_pd(4503599627370496.0 + 1023.0));
+    simde__m256d m = simde_mm256_castsi256_pd(simde_mm256_or_si256(
+        simde_mm256_and_si256(bits, simde_mm256_set1_epi64x(INT64_C(0x000FFFFFFFFFFFFF))), simde_mm256_set1_epi64x(INT64_C(0x3FF0000000000000))));
+    // move the mantissa into [sqrt(1/2), sqrt(2)) so the series converges fast
+    const simde__m256d big = simde_mm256_cmp_pd(m, simde_mm256_set1_pd(1.4142135623730951), SIMDE_CMP_GT_OQ);
+    m = simde_mm256_blendv_pd(m, simde_mm256_mul_pd(m, simde_mm256_set1_pd(0.5)), big);
+    e = simde_mm256_add_pd(e, simde_mm256_and_pd(big, simde_mm256_set1_pd(1.0)));
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    const simde__m256d f = simde_mm256_div_pd(simde_mm256_sub_pd(m, one), simde_mm256_add_pd(m, one));
+    const simde__m256d f2 = simde_mm256_mul_pd(f, f);
+    simde__m256d p = simde_mm256_set1_pd(1.0 / 21.0);
+    p = simde_mm256_fmadd_pd(p, f2, simde_mm256_set1_pd(1.0 / 19.0));
+    p = simde_mm256_fmadd_pd(p, f2, simde_mm256_set1_pd(1.0 / 17.0));
+    p = simde_mm256_fmadd_pd(p, f2, simde_mm256_set1_pd(1.0 / 15.0));
+    p = simde_mm256_fmadd_pd(p, f2, simde_mm256_set1_pd(1.0 / 13.0));
+    p = simde_mm256_fmadd_pd(p, f2, simde_mm256_set1_pd(1.0 / 11.0));
+    p = simde_mm256_fmadd_pd(p, f2, simde_mm256_set1_pd(1.0 / 9.0));
+    p = simde_mm256_fmadd_pd(p, f2, simde_mm256_set1_pd(1.0 / 7.0));
+    p = simde_mm256_fmadd_pd(p, f2, simde_mm256_set1_pd(1.0 / 5.0));
+    p = simde_mm256_fmadd_pd(p, f2, simde_mm256_set1_pd(1.0 / 3.0));
+    p = simde_mm256_fmadd_pd(p, f2, one);
+    const simde__m256d lnm = simde_mm256_mul_pd(simde_mm256_add_pd(f, f), p);
+    return simde_mm256_fmadd_pd(e, simde_mm256_set1_pd(0.6931471805599453), lnm);
+}
+
+// e^x, split into 2^k * e^r with |r| <= ln(2) / 2 and a Taylor polynomial for e^r, error below 1e-15.
+// The input is clamped to [-708, 709] so 2^k stays a normal number.
+static inline simde__m256d exp_pd(simde__m256d x) {
+    x = simde_mm256_min_pd(simde_mm256_max_pd(x, simde_mm256_set1_pd(-708.0)), simde_mm256_set1_pd(709.0));
+    const simde__m256d k = simde_mm256_round_pd(simde_mm256_mul_pd(x, simde_mm256_set1_pd(1.4426950408889634)),
+                                                SIMDE_MM_FROUND_TO_NEAREST_INT | SIMDE_MM_FROUND_NO_EXC);
+    simde__m256d r = simde_mm256_fnmadd_pd(k, simde_mm256_set1_pd(6.93147180369123816490e-01), x); // ln(2) in two parts
+    r = simde_mm256_fnmadd_pd(k, simde_mm256_set1_pd(1.90821492927058770002e-10), r);
+    simde__m256d p = simde_mm256_set1_pd(1.0 / 479001600.0);
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(1.0 / 39916800.0));
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(1.0 / 3628800.0));
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(1.0 / 362880.0));
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(1.0 / 40320.0));
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(1.0 / 5040.0));
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(1.0 / 720.0));
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(1.0 / 120.0));
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(1.0 / 24.0));
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(1.0 / 6.0));
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(0.5));
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(1.0));
+    p = simde_mm256_fmadd_pd(p, r, simde_mm256_set1_pd(1.0));
+    // 2^k: k + 1023 lands in the low mantissa bits of 2^52 + k + 1023, shift it into the exponent
+    const simde__m256d biased = simde_mm256_add_pd(k, simde_mm256_set1_pd(4503599627370496.0 + 1023.0));
+    const simde__m256d scale = simde_mm256_castsi256_pd(simde_mm256_slli_epi64(simde_mm256_castpd_si256(biased), 52));
+    return simde_mm256_mul_pd(p, scale);
+}
+
+// sin(2 pi t) and cos(2 pi t) for any t, reduced to an octant and evaluated with Taylor polynomials.
+static inline void sincos_2pi_pd(simde__m256d t, simde__m256d* sin_out, simde__m256d* cos_out) {
+    t = simde_mm256_sub_pd(t, simde_mm256_round_pd(t, SIMDE_MM_FROUND_TO_NEAREST_INT | SIMDE_MM_FROUND_NO_EXC));
+    const simde__m256d q = simde_mm256_round_pd(simde_mm256_mul_pd(t, simde_mm256_set1_pd(4.0)), SIMDE_MM_FROUND_TO_NEAREST_INT | SIMDE_MM_FROUND_NO_EXC);
+    const simde__m256d a = simde_mm256_mul_pd(simde_mm256_fnmadd_pd(q, simde_mm256_set1_pd(0.25), t), simde_mm256_set1_pd(6.283185307179586));
+    const simde__m256d a2 = simde_mm256_mul_pd(a, a);
+
+    simde__m256d sp = simde_mm256_set1_pd(-1.0 / 1307674368000.0);
+    sp = simde_mm256_fmadd_pd(sp, a2, simde_mm256_set1_pd(1.0 / 6227020800.0));
+    sp = simde_mm256_fmadd_pd(sp, a2, simde_mm256_set1_pd(-1.0 / 39916800.0));
+    sp = simde_mm256_fmadd_pd(sp, a2, simde_mm256_set1_pd(1.0 / 362880.0));
+    sp = simde_mm256_fmadd_pd(sp, a2, simde_mm256_set1_pd(-1.0 / 5040.0));
+    sp = simde_mm256_fmadd_pd(sp, a2, simde_mm256_set1_pd(1.0 / 120.0));
+    sp = simde_mm256_fmadd_pd(sp, a2, simde_mm256_set1_pd(-1.0 / 6.0));
+    sp = simde_mm256_fmadd_pd(sp, a2, simde_mm256_set1_pd(1.0));
+    const simde__m256d sa = simde_mm256_mul_pd(sp, a);
+
+    simde__m256d cp = simde_mm256_set1_pd(1.0 / 20922789888000.0);
+    cp = simde_mm256_fmadd_pd(cp, a2, simde_mm256_set1_pd(-1.0 / 87178291200.0));
+    cp = simde_mm256_fmadd_pd(cp, a2, simde_mm256_set1_pd(1.0 / 479001600.0));
+    cp = simde_mm256_fmadd_pd(cp, a2, simde_mm256_set1_pd(-1.0 / 3628800.0));
+    cp = simde_mm256_fmadd_pd(cp, a2, simde_mm256_set1_pd(1.0 / 40320.0));
+    cp = simde_mm256_fmadd_pd(cp, a2, simde_mm256_set1_pd(-1.0 / 720.0));
+    cp = simde_mm256_fmadd_pd(cp, a2, simde_mm256_set1_pd(1.0 / 24.0));
+    cp = simde_mm256_fmadd_pd(cp, a2, simde_mm256_set1_pd(-0.5));
+    const simde__m256d ca = simde_mm256_fmadd_pd(cp, a2, simde_mm256_set1_pd(1.0));
+
+    // rotate by q quarter turns: q mod 4 = 0: (s, c), 1: (c, -s), 2: (-s, -c), 3: (-c, s)
+    const simde__m256d qm = simde_mm256_fnmadd_pd(simde_mm256_floor_pd(simde_mm256_mul_pd(q, simde_mm256_set1_pd(0.25))), simde_mm256_set1_pd(4.0), q);
+    const simde__m256d sign = simde_mm256_set1_pd(-0.0);
+    const simde__m256d odd = simde_mm256_or_pd(simde_mm256_cmp_pd(qm, simde_mm256_set1_pd(1.0), SIMDE_CMP_EQ_OQ),
+                                               simde_mm256_cmp_pd(qm, simde_mm256_set1_pd(3.0), SIMDE_CMP_EQ_OQ));
+    const simde__m256d sin_neg = simde_mm256_cmp_pd(qm, simde_mm256_set1_pd(1.5), SIMDE_CMP_GT_OQ);
+    const simde__m256d cos_neg = simde_mm256_or_pd(simde_mm256_cmp_pd(qm, simde_mm256_set1_pd(1.0), SIMDE_CMP_EQ_OQ),
+                                                   simde_mm256_cmp_pd(qm, simde_mm256_set1_pd(2.0), SIMDE_CMP_EQ_OQ));
+    *sin_out = simde_mm256_xor_pd(simde_mm256_blendv_pd(sa, ca, odd), simde_mm256_and_pd(sin_neg, sign));
+    *cos_out = simde_mm256_xor_pd(simde_mm256_blendv_pd(ca, sa, odd), simde_mm256_and_pd(cos_neg, sign));
+}
+
+/**
+ * Fills a vector with uniform white noise.
+ *
+ * @param rng The generator.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the vector.
+ * @param lo The lower bound (inclusive).
+ * @param hi The upper bound (exclusive).
+ */
+__declspec(dllexport) void simd_rng_fill_uniform(simd_rng* rng, double* result, size_t n, double lo, double hi) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    const simde__m256d vscale = simde_mm256_set1_pd(hi - lo);
+    const simde__m256d voffset = simde_mm256_set1_pd(lo - (hi - lo)); // undoes the [1, 2) offset of bits_to_unit_pd
+    rng_lanes r = rng_load(rng);
+    for (size_t i = 0; i < n; i += 4) {
+        simde_mm256_storeu_pd(&_result[i], simde_mm256_fmadd_pd(bits_to_unit_pd(rng_next(&r)), vscale, voffset));
+    }
+    rng_store(rng, &r);
+}
+
+/**
+ * Fills a vector with triangular (TPDF) white noise, e.g. as dither or test signal.
+ *
+ * @param rng The generator.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the vector.
+ * @param amplitude The peak value, the noise lies in (-amplitude, amplitude).
+ */
+__declspec(dllexport) void simd_rng_fill_tpdf(simd_rng* rng, double* result, size_t n, double amplitude) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    const simde__m256d vamp = simde_mm256_set1_pd(amplitude);
+    rng_lanes r = rng_load(rng);
+    for (size_t i = 0; i < n; i += 4) {
+        simde_mm256_storeu_pd(&_result[i], simde_mm256_mul_pd(rng_tpdf(&r), vamp));
+    }
+    rng_store(rng, &r);
+}
+
+// Ziggurat candidates for 4 lanes: a layer index from bits 4..13 (the lowest bits of xoshiro256+ are weak),
+// a sign and magnitude u in [-1, 1) from the top 50 bits and the candidate u * x[layer].
+static inline simde__m256d zig_draw(const simd_rng* rng, rng_lanes* r, simde__m256i* layer, simde__m256d* u) {
+    const simde__m256i bits = rng_next(r);
+    *layer = simde_mm256_and_si256(simde_mm256_srli_epi64(bits, 4), simde_mm256_set1_epi64x(ZIG_LAYERS - 1));
+    const simde__m256i top = simde_mm256_and_si256(bits, simde_mm256_set1_epi64x(~INT64_C(0x3FFF)));
+    *u = simde_mm256_fmsub_pd(bits_to_unit_pd(top), simde_mm256_set1_pd(2.0), simde_mm256_set1_pd(3.0));
+    return simde_mm256_mul_pd(*u, simde_mm256_i64gather_pd(rng->zig_x, *layer, 8));
+}
+
+// Lanes whose candidate lies inside the rectangle of its layer, about 99.6% of all draws.
+static inline simde__m256d zig_inside(const simd_rng* rng, simde__m256i layer, simde__m256d u) {
+    const simde__m256d au = simde_mm256_andnot_pd(simde_mm256_set1_pd(-0.0), u);
+    return simde_mm256_cmp_pd(au, simde_mm256_i64gather_pd(rng->zig_k, layer, 8), SIMDE_CMP_LT_OQ);
+}
+
+// Standard normal samples for a block of candidates in which at least one lane missed its rectangle.
+// Those lanes take the wedge test, or for layer 0 the exact tail beyond ZIG_R, all lanes draw together
+// until every lane is accepted.
+static simde__m256d zig_resolve(const simd_rng* rng, rng_lanes* r, simde__m256i layer, simde__m256d u) {
+    const simde__m256d vone = simde_mm256_set1_pd(1.0);
+    const simde__m256d vtwo = simde_mm256_set1_pd(2.0);
+    simde__m256d z = simde_mm256_mul_pd(u, simde_mm256_i64gather_pd(rng->zig_x, layer, 8));
+    simde__m256d pending = simde_mm256_xor_pd(zig_inside(rng, layer, u), simde_mm256_castsi256_pd(simde_mm256_set1_epi64x(-1)));
+    simde__m256d result = z;
+    while (!simde_mm256_testz_pd(pending, pending)) {
+        const simde__m256d tail = simde_mm256_and_pd(pending, simde_mm256_castsi256_pd(simde_mm256_cmpeq_epi64(layer, simde_mm256_setzero_si256())));
+        simde__m256d tail_ok = simde_mm256_setzero_pd();
+        simde__m256d tail_z = z;
+        if (!simde_mm256_testz_pd(tail, tail)) {
+            // tail: a = -ln(u1) / r, accept r + a if -2 ln(u2) > a^2
+            const simde__m256d a = simde_mm256_div_pd(log_pd(simde_mm256_sub_pd(vtwo, bits_to_unit_pd(rng_next(r)))), simde_mm256_set1_pd(-ZIG_R));
+            const simde__m256d b = log_pd(simde_mm256_sub_pd(vtwo, bits_to_unit_pd(rng_next(r))));
+            tail_ok = simde_mm256_cmp_pd(simde_mm256_mul_pd(simde_mm256_set1_pd(-2.0), b), simde_mm256_mul_pd(a, a), SIMDE_CMP_GT_OQ);
+            tail_z = simde_mm256_or_pd(simde_mm256_add_pd(a, simde_mm256_set1_pd(ZIG_R)), simde_mm256_and_pd(u, simde_mm256_set1_pd(-0.0)));
+        }
+        // wedge: accept z if a uniform height between f(x[i]) and f(x[i + 1]) lies below f(z)
+        const simde__m256d f0 = simde_mm256_i64gather_pd(rng->zig_f, layer, 8);
+        const simde__m256d f1 = simde_mm256_i64gather_pd(rng->zig_f, simde_mm256_add_epi64(layer, simde_mm256_set1_epi64x(1)), 8);
+        const simde__m256d y = simde_mm256_fmadd_pd(simde_mm256_sub_pd(bits_to_unit_pd(rng_next(r)), vone), simde_mm256_sub_pd(f1, f0), f0);
+        const simde__m256d wedge_ok = simde_mm256_cmp_pd(y, exp_pd(simde_mm256_mul_pd(simde_mm256_set1_pd(-0.5), simde_mm256_mul_pd(z, z))), SIMDE_CMP_LT_OQ);
+        const simde__m256d accept = simde_mm256_and_pd(pending, simde_mm256_blendv_pd(wedge_ok, tail_ok, tail));
+        result = simde_mm256_blendv_pd(result, simde_mm256_blendv_pd(z, tail_z, tail), accept);
+        pending = simde_mm256_andnot_pd(accept, pending);
+        // rejected tail lanes retry the tail, rejected wedge lanes start over with a new candidate
+        const simde__m256d redraw = simde_mm256_andnot_pd(tail, pending);
+        simde__m256i new_layer;
+        simde__m256d new_u;
+        const simde__m256d new_z = zig_draw(rng, r, &new_layer, &new_u);
+        layer = simde_mm256_castpd_si256(simde_mm256_blendv_pd(simde_mm256_castsi256_pd(layer), simde_mm256_castsi256_pd(new_layer), redraw));
+        u = simde_mm256_blendv_pd(u, new_u, redraw);
+        z = simde_mm256_blendv_pd(z, new_z, redraw);
+        const simde__m256d inside = simde_mm256_and_pd(redraw, zig_inside(rng, layer, u));
+        result = simde_mm256_blendv_pd(result, z, inside);
+        pending = simde_mm256_andnot_pd(inside, pending);
+    }
+    return result;
+}
+
+#define ZIG_BATCH 128
+
+/**
+ * Fills a vector with Gaussian white noise using the ziggurat method of Marsaglia and Tsang with
+ * 1024 layers. Each block of 4 samples costs one draw, two table gathers and a compare, the first
+ * pass stores every candidate without branching. About 0.4% of the lanes fall outside the rectangle
+ * of their layer, they are collected and a second pass puts them, 4 at a time, through the exact
+ * wedge or tail test, so the distribution is exact including the tails.
+ *
+ * @param rng The generator.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the vector.
+ * @param mean The mean of the distribution.
+ * @param sigma The standard deviation.
+ */
+__declspec(dllexport) void simd_rng_fill_gaussian(simd_rng* rng, double* result, size_t n, double mean, double sigma) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    const simde__m256d vmean = simde_mm256_set1_pd(mean);
+    const simde__m256d vsigma = simde_mm256_set1_pd(sigma);
+    size_t block_pos[ZIG_BATCH];
+    simde__m256i block_layer[ZIG_BATCH];
+    simde__m256d block_u[ZIG_BATCH];
+    int block_missed[ZIG_BATCH];
+    size_t lane_pos[4 * ZIG_BATCH + 4];
+    int64_t lane_layer[4 * ZIG_BATCH + 4];
+    double lane_u[4 * ZIG_BATCH + 4];
+    rng_lanes r = rng_load(rng);
+    for (size_t i = 0; i < n; i += 4 * ZIG_BATCH) {
+        const size_t end = n - i < 4 * ZIG_BATCH ? n : i + 4 * ZIG_BATCH;
+        size_t blocks = 0;
+        // every block is written to the list, only blocks with a missed lane advance it
+        for (size_t j = i; j < end; j += 4) {
+            simde__m256i layer;
+            simde__m256d u;
+            const simde__m256d z = zig_draw(rng, &r, &layer, &u);
+            simde_mm256_storeu_pd(&_result[j], simde_mm256_fmadd_pd(z, vsigma, vmean));
+            const int missed = simde_mm256_movemask_pd(zig_inside(rng, layer, u)) ^ 0xF;
+            block_pos[blocks] = j;
+            block_layer[blocks] = layer;
+            block_u[blocks] = u;
+            block_missed[blocks] = missed;
+            blocks += missed != 0;
+        }
+        // collect the missed lanes, then resolve them 4 at a time
+        size_t count = 0;
+        for (size_t b = 0; b < blocks; ++b) {
+            int64_t layers[4];
+            double us[4];
+            simde_mm256_storeu_si256((simde__m256i*)layers, block_layer[b]);
+            simde_mm256_storeu_pd(us, block_u[b]);
+            for (int missed = block_missed[b]; missed; missed &= missed - 1) {
+                const int l = __builtin_ctz(missed);
+                lane_pos[count] = block_pos[b] + l;
+                lane_layer[count] = layers[l];
+                lane_u[count] = us[l];
+                ++count;
+            }
+        }
+        for (size_t k = count; k < count + 4; ++k) {
+            lane_layer[k] = 1; // u = 0 in layer 1 lies inside its rectangle
+            lane_u[k] = 0.0;
+        }
+        for (size_t k = 0; k < count; k += 4) {
+            double z[4];
+            simde_mm256_storeu_pd(z, simde_mm256_fmadd_pd(zig_resolve(rng, &r, simde_mm256_loadu_si256((const simde__m256i*)&lane_layer[k]),
+                                                                      simde_mm256_loadu_pd(&lane_u[k])), vsigma, vmean));
+            for (size_t l = 0; l < 4 && k + l < count; ++l) {
+                _result[lane_pos[k + l]] = z[l];
+            }
+        }
+    }
+    rng_store(rng, &r);
+}
+
+// Lane picks for rows 2..5 of the pink generator, which live in one register: the permutation that
+// broadcasts lane k and the mask that selects it.
+static const int32_t pink_lane_index[4][8] __attribute__((aligned(32))) = {
+    {0, 1, 0, 1, 0, 1, 0, 1}, {2, 3, 2, 3, 2, 3, 2, 3}, {4, 5, 4, 5, 4, 5, 4, 5}, {6, 7, 6, 7, 6, 7, 6, 7}};
+static const int64_t pink_lane_mask[4][4] __attribute__((aligned(32))) = {
+    {-1, 0, 0, 0}, {0, -1, 0, 0}, {0, 0, -1, 0}, {0, 0, 0, -1}};
+
+/**
+ * Fills a vector with pink (1/f) noise using the Voss-McCartney algorithm with 16 rows,
+ * which is flat to about 1 dB from a few Hz up. The 4 lanes are 4 consecutive samples of one
+ * generator, 4 interleaved generators would fold their images into the spectrum. Sample t redraws
+ * row ctz(t), so a block starting at a multiple of 4 redraws one row of 2 and up in lane 0 and then
+ * rows 0, 1 and 0. Rows 0 and 1 of each lane are picked from this and the previous block's draws,
+ * rows 2 to 5 are kept in a register, only the rows from 6 up, redrawn once every 16 blocks, are
+ * read from memory. Rows and white sample are 32 bit integers whose sum is exact and converted to
+ * double once per block. The state continues across calls, so consecutive blocks form one seamless stream.
+ *
+ * @param rng The generator.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of elements in the vector.
+ * @param amplitude The peak value, the noise lies in [-amplitude, amplitude).
+ */
+__declspec(dllexport) void simd_rng_fill_pink(simd_rng* rng, double* result, size_t n, double amplitude) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    const simde__m256i lomask = simde_mm256_set1_epi64x(INT64_C(0xFFFFFFFF));
+    // a sum s < 2^52 ored into the mantissa of 2^52 gives the double 2^52 + s, uniforms map to [-1, 1)
+    const simde__m256i magic = simde_mm256_set1_epi64x(INT64_C(0x4330000000000000));
+    const simde__m256d offset = simde_mm256_set1_pd(0x1.0p52 + (PINK_ROWS + 1) * 0x1.0p31);
+    const simde__m256d vscale = simde_mm256_set1_pd(amplitude / (PINK_ROWS + 1) * 0x1.0p-31);
+    uint32_t counter = rng->pink_counter;
+    int64_t high_sum = 0;
+    for (int k = 2; k < PINK_ROWS; ++k) {
+        high_sum += rng->pink_rows[k];
+    }
+    simde__m256i high = simde_mm256_set1_epi64x(high_sum);
+    simde__m256i rows = simde_mm256_setr_epi64x(rng->pink_rows[2], rng->pink_rows[3], rng->pink_rows[4], rng->pink_rows[5]);
+    // rows 1 and 0 as left by lanes 2 and 3 of the previous block
+    simde__m256i prev = simde_mm256_setr_epi64x(0, 0, rng->pink_rows[1], rng->pink_rows[0]);
+    rng_lanes r = rng_load(rng);
+    for (size_t i = 0; i < n; i += 4, counter += 4) {
+        // one draw holds 8 uniforms: a new row value and a white sample for each of the 4 samples
+        const simde__m256i bits = rng_next(&r);
+        const simde__m256i v = simde_mm256_srli_epi64(bits, 32);
+        const simde__m256i v0 = simde_mm256_permute4x64_epi64(v, 0x00);
+        simde__m256i old = v0; // counter a multiple of 2^PINK_ROWS: lane 0 redraws no row
+        if (counter & 63) {
+            const int lane = __builtin_ctz(counter) - 2;
+            old = simde_mm256_permutevar8x32_epi32(rows, simde_mm256_load_si256((const simde__m256i*)pink_lane_index[lane]));
+            rows = simde_mm256_blendv_epi8(rows, v0, simde_mm256_load_si256((const simde__m256i*)pink_lane_mask[lane]));
+        } else {
+            const int row = __builtin_ctz(counter | (1u << PINK_ROWS));
+            if (row < PINK_ROWS) {
+                old = simde_mm256_set1_epi64x(rng->pink_rows[row]);
+                rng->pink_rows[row] = (uint32_t)simde_mm_cvtsi128_si64(simde_mm256_castsi256_si128(v));
+            }
+        }
+        high = simde_mm256_add_epi64(simde_mm256_sub_epi64(high, old), v0);
+        // row 0 of lanes 0..3: prev 3, v1, v1, v3 and row 1: prev 2, prev 2, v2, v2
+        const simde__m256i prev23_v01 = simde_mm256_permute2x128_si256(prev, v, 0x21);
+        const simde__m256i prev23_v23 = simde_mm256_permute2x128_si256(prev, v, 0x31);
+        const simde__m256i row0 = simde_mm256_castpd_si256(simde_mm256_shuffle_pd(simde_mm256_castsi256_pd(prev23_v01), simde_mm256_castsi256_pd(v), 0xF));
+        const simde__m256i row1 = simde_mm256_castpd_si256(simde_mm256_movedup_pd(simde_mm256_castsi256_pd(prev23_v23)));
+        const simde__m256i sum = simde_mm256_add_epi64(simde_mm256_add_epi64(high, simde_mm256_and_si256(bits, lomask)), simde_mm256_add_epi64(row0, row1));
+        const simde__m256d value = simde_mm256_sub_pd(simde_mm256_castsi256_pd(simde_mm256_or_si256(sum, magic)), offset);
+        simde_mm256_storeu_pd(&_result[i], simde_mm256_mul_pd(value, vscale));
+        prev = v;
+    }
+    rng_store(rng, &r);
+    int64_t last[4];
+    int64_t high_rows[4];
+    simde_mm256_storeu_si256((simde__m256i*)last, prev);
+    simde_mm256_storeu_si256((simde__m256i*)high_rows, rows);
+    rng->pink_rows[0] = (uint32_t)last[3];
+    rng->pink_rows[1] = (uint32_t)last[2];
+    for (int k = 2; k < 6; ++k) {
+        rng->pink_rows[k] = (uint32_t)high_rows[k - 2];
+    }
+    rng->pink_counter = counter;
+}
+
+/**
+ * Interpolation modes for fractional delay reads.
+ */
+enum {
+    DELAY_INTERP_LINEAR   = 0, // 2 points, delays from 0
+    DELAY_INTERP_HERMITE  = 1, // 4 point cubic Hermite (Catmull-Rom), delays from 1
+    DELAY_INTERP_LAGRANGE = 2  // 4 point third order Lagrange, delays from 1
+};
+
+// Samples copied from the start of the ring behind its end, so 4 point and 4 lane reads never wrap.
+#define DELAY_MIRROR 8
+
+/**
+ * A circular delay line on aligned memory with a mirrored tail. Reads are aligned to the last
+ * block written: with delay d, output j of a read of n samples is the input written at position
+ * j - d of that block.
+ */
+typedef struct delay_line {
+    double* buffer;     // capacity + DELAY_MIRROR samples
+    size_t capacity;    // power of two
+    size_t mask;
+    size_t write_pos;   // next physical write index
+    double max_delay;
+} delay_line;
+
+/**
+ * Creates a delay line, filled with silence.
+ *
+ * @param max_delay The longest delay in samples that will be read.
+ * @param max_block The largest block size passed to write and read.
+ * @return The delay line, or NULL if the allocation fails.
+ */
+__declspec(dllexport) delay_line* delay_line_create(size_t max_delay, size_t max_block) {
+    delay_line* dl = (delay_line*)calloc(1, sizeof(delay_line));
+    if (!dl) {
+        return NULL;
+    }
+    size_t capacity = 16;
+    while (capacity < max_delay + max_block + 4) {
+        capacity <<= 1;
+    }
+    dl->capacity  = capacity;
+    dl->mask      = capacity - 1;
+    dl->max_delay = (double)max_delay;
+    dl->buffer = (double*)_mm_malloc((capacity + DELAY_MIRROR) * sizeof(double), ALIGN);
+    if (!dl->buffer) {
+        free(dl);
+        return NULL;
+    }
+    memset(dl->buffer, 0, (capacity + DELAY_MIRROR) * sizeof(double));
+    return dl;
+}
+
+/**
+ * Frees a delay line created by delay_line_create.
+ *
+ * @param dl The delay line, may be NULL.
+ */
+__declspec(dllexport) void delay_line_destroy(delay_line* dl) {
+    if (!dl) {
+        return;
+    }
+    _mm_free(dl->buffer);
+    free(dl);
+}
+
+/**
+ * Fills the delay line with silence.
+ *
+ * @param dl The delay line.
+ */
+__declspec(dllexport) void delay_line_clear(delay_line* dl) {
+    memset(dl->buffer, 0, (dl->capacity + DELAY_MIRROR) * sizeof(double));
+}
+
+/**
+ * Appends a block of samples.
+ *
+ * @param dl The delay line.
+ * @param input The samples to write.
+ * @param n The number of samples, at most max_block.
+ */
+__declspec(dllexport) void delay_line_write(delay_line* dl, const double* input, size_t n) {
+    size_t pos = dl->write_pos;
+    while (n > 0) {
+        const size_t chunk = n < dl->capacity - pos ? n : dl->capacity - pos;
+        memcpy(dl->buffer + pos, input, chunk * sizeof(double));
+        if (pos < DELAY_MIRROR) {
+            memcpy(dl->buffer + dl->capacity, dl->buffer, DELAY_MIRROR * sizeof(double));
+        }
+        pos = (pos + chunk) & dl->mask;
+        input += chunk;
+        n -= chunk;
+    }
+    dl->write_pos = pos;
+}
+
+// 4x4 transpose, rows r0..r3 become columns.
+static inline void transpose4_pd(simde__m256d* r0, simde__m256d* r1, simde__m256d* r2, simde__m256d* r3) {
+    const simde__m256d t0 = simde_mm256_unpacklo_pd(*r0, *r1);
+    const simde__m256d t1 = simde_mm256_unpackhi_pd(*r0, *r1);
+    const simde__m256d t2 = simde_mm256_unpacklo_pd(*r2, *r3);
+    const simde__m256d t3 = simde_mm256_unpackhi_pd(*r2, *r3);
+    *r0 = simde_mm256_permute2f128_pd(t0, t2, 0x20);
+    *r1 = simde_mm256_permute2f128_pd(t1, t3, 0x20);
+    *r2 = simde_mm256_permute2f128_pd(t0, t2, 0x31);
+    *r3 = simde_mm256_permute2f128_pd(t1, t3, 0x31);
+}
+
+// Weights of the points x[-1], x[0], x[1], x[2] for a read at fraction f between x[0] and x[1].
+static inline void interp_weights_pd(simde__m256d f, int interpolation, simde__m256d h[4]) {
+    const simde__m256d one  = simde_mm256_set1_pd(1.0);
+    const simde__m256d half = simde_mm256_set1_pd(0.5);
+    if (interpolation == DELAY_INTERP_LAGRANGE) {
+        const simde__m256d fp1 = simde_mm256_add_pd(f, one);
+        const simde__m256d fm1 = simde_mm256_sub_pd(f, one);
+        const simde__m256d fm2 = simde_mm256_sub_pd(f, simde_mm256_set1_pd(2.0));
+        const simde__m256d a = simde_mm256_mul_pd(f, fm1);   // f (f - 1)
+        const simde__m256d b = simde_mm256_mul_pd(fp1, fm2); // (f + 1)(f - 2)
+        h[0] = simde_mm256_mul_pd(simde_mm256_mul_pd(a, fm2), simde_mm256_set1_pd(-1.0 / 6.0));
+        h[1] = simde_mm256_mul_pd(simde_mm256_mul_pd(b, fm1), half);
+        h[2] = simde_mm256_mul_pd(simde_mm256_mul_pd(b, f), simde_mm256_set1_pd(-0.5));
+        h[3] = simde_mm256_mul_pd(simde_mm256_mul_pd(a, fp1), simde_mm256_set1_pd(1.0 / 6.0));
+    } else if (interpolation == DELAY_INTERP_HERMITE) {
+        const simde__m256d f2 = simde_mm256_mul_pd(f, f);
+        const simde__m256d f3 = simde_mm256_mul_pd(f2, f);
+        // Catmull-Rom: -0.5 f^3 + f^2 - 0.5 f | 1.5 f^3 - 2.5 f^2 + 1 | -1.5 f^3 + 2 f^2 + 0.5 f | 0.5 f^3 - 0.5 f^2
+        h[0] = simde_mm256_mul_pd(simde_mm256_sub_pd(simde_mm256_fmsub_pd(f2, simde_mm256_set1_pd(2.0), f3), f), half);
+        h[1] = simde_mm256_fmadd_pd(f3, simde_mm256_set1_pd(1.5), simde_mm256_fnmadd_pd(f2, simde_mm256_set1_pd(2.5), one));
+        h[2] = simde_mm256_fmadd_pd(f3, simde_mm256_set1_pd(-1.5), simde_mm256_fmadd_pd(f2, simde_mm256_set1_pd(2.0), simde_mm256_mul_pd(f, half)));
+        h[3] = simde_mm256_mul_pd(simde_mm256_sub_pd(f3, f2), half);
+    } else {
+        h[0] = simde_mm256_setzero_pd();
+        h[1] = simde_mm256_sub_pd(one, f);
+        h[2] = f;
+        h[3] = simde_mm256_setzero_pd();
+    }
+}
+
+/**
+ * Reads n samples with a separate, fractional delay per sample (modulated delays, chorus, flanger).
+ * Linear reads use two AVX2 gathers per 4 outputs, the 4 point modes load 4 neighbours per output
+ * contiguously (the mirrored tail keeps them in one piece) and transpose them into lanes.
+ *
+ * @param dl The delay line.
+ * @param delays The delay in samples per output, aligned to ALIGN, clamped to [0 or 1, max_delay].
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of samples, the size of the last written block.
+ * @param interpolation One of the DELAY_INTERP_* modes.
+ */
+__declspec(dllexport) void delay_line_read(const delay_line* dl, const double* delays, double* result, size_t n, int interpolation) {
+    const double* _delays = __builtin_assume_aligned(delays, ALIGN);
+          double* _result = __builtin_assume_aligned(result, ALIGN);
+    const double* buf = dl->buffer;
+    const simde__m256d vmin  = simde_mm256_set1_pd(interpolation == DELAY_INTERP_LINEAR ? 0.0 : 1.0);
+    const simde__m256d vmax  = simde_mm256_set1_pd(dl->max_delay);
+    const simde__m256d vfour = simde_mm256_set1_pd(4.0);
+    const simde__m128i vmask = simde_mm_set1_epi32((int32_t)dl->mask);
+    // physical position of output 0, kept positive by adding one lap
+    simde__m256d vpos = simde_mm256_add_pd(simde_mm256_set1_pd((double)(dl->write_pos + dl->capacity) - (double)n),
+                                           simde_mm256_set_pd(3.0, 2.0, 1.0, 0.0));
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d d = simde_mm256_min_pd(simde_mm256_max_pd(simde_mm256_load_pd(&_delays[i]), vmin), vmax);
+        const simde__m256d p = simde_mm256_sub_pd(vpos, d);
+        const simde__m256d ip = simde_mm256_floor_pd(p);
+        const simde__m256d f = simde_mm256_sub_pd(p, ip);
+        const simde__m128i idx = simde_mm_and_si128(simde_mm256_cvttpd_epi32(ip), vmask);
+        simde__m256d y;
+        if (interpolation == DELAY_INTERP_LINEAR) {
+            const simde__m256d x0 = simde_mm256_i32gather_pd(buf, idx, 8);
+            const simde__m256d x1 = simde_mm256_i32gather_pd(buf + 1, idx, 8);
+            y = simde_mm256_fmadd_pd(f, simde_mm256_sub_pd(x1, x0), x0);
+        } else {
+            // x[-1] of output k sits at idx[k] - 1, one lap ahead when idx[k] is 0
+            int32_t start[4];
+            simde_mm_storeu_si128((simde__m128i*)start, simde_mm_and_si128(simde_mm_sub_epi32(idx, simde_mm_set1_epi32(1)), vmask));
+            simde__m256d r0 = simde_mm256_loadu_pd(buf + start[0]);
+            simde__m256d r1 = simde_mm256_loadu_pd(buf + start[1]);
+            simde__m256d r2 = simde_mm256_loadu_pd(buf + start[2]);
+            simde__m256d r3 = simde_mm256_loadu_pd(buf + start[3]);
+            transpose4_pd(&r0, &r1, &r2, &r3);
+            simde__m256d h[4];
+            interp_weights_pd(f, interpolation, h);
+            y = simde_mm256_mul_pd(h[0], r0);
+            y = simde_mm256_fmadd_pd(h[1], r1, y);
+            y = simde_mm256_fmadd_pd(h[2], r2, y);
+            y = simde_mm256_fmadd_pd(h[3], r3, y);
+        }
+        simde_mm256_storeu_pd(&_result[i], y);
+        vpos = simde_mm256_add_pd(vpos, vfour);
+    }
+}
+
+// Reads one tap with a fixed delay over a block, the weights are the same for every output so the
+// 4 points are plain unaligned loads of consecutive samples. Adds gain * tap to result if accumulate.
+static void delay_line_tap_block(const delay_line* dl, double delay, int interpolation, double gain, int accumulate, double* result, size_t n) {
+    const double lo = interpolation == DELAY_INTERP_LINEAR ? 0.0 : 1.0;
+    delay = delay < lo ? lo : (delay > dl->max_delay ? dl->max_delay : delay);
+    const double p = (double)(dl->write_pos + dl->capacity) - (double)n - delay;
+    const double ip = floor(p);
+    simde__m256d h[4];
+    interp_weights_pd(simde_mm256_set1_pd(p - ip), interpolation, h);
+    for (int k = 0; k < 4; ++k) {
+        h[k] = simde_mm256_mul_pd(h[k], simde_mm256_set1_pd(gain));
+    }
+    size_t start = ((size_t)ip - 1) & dl->mask;
+    for (size_t i = 0; i < n; i += 4) {
+        // start <= capacity - 1, so start + 6 stays inside the mirrored tail
+        const double* src = dl->buffer + start;
+        simde__m256d y = accumulate ? simde_mm256_load_pd(&result[i]) : simde_mm256_setzero_pd();
+        y = simde_mm256_fmadd_pd(h[0], simde_mm256_loadu_pd(src), y);
+        y = simde_mm256_fmadd_pd(h[1], simde_mm256_loadu_pd(src + 1), y);
+        y = simde_mm256_fmadd_pd(h[2], simde_mm256_loadu_pd(src + 2), y);
+        y = simde_mm256_fmadd_pd(h[3], simde_mm256_loadu_pd(src + 3), y);
+        simde_mm256_storeu_pd(&result[i], y);
+        start = (start + 4) & dl->mask;
+    }
+}
+
+/**
+ * Reads many taps with fixed fractional delays in one call, tap t goes to result[t * stride ...].
+ *
+ * @param dl The delay line.
+ * @param delays The delay in samples per tap.
+ * @param num_taps The number of taps.
+ * @param result The output buffer holding one row per tap, aligned to ALIGN.
+ * @param stride The distance between two rows, a multiple of 4 and at least n.
+ * @param n The number of samples, the size of the last written block.
+ * @param interpolation One of the DELAY_INTERP_* modes.
+ */
+__declspec(dllexport) void delay_line_read_taps(const delay_line* dl, const double* delays, size_t num_taps, double* result, size_t stride, size_t n, int interpolation) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t t = 0; t < num_taps; ++t) {
+        delay_line_tap_block(dl, delays[t], interpolation, 1.0, 0, _result + t * stride, n);
+    }
+}
+
+/**
+ * Reads many taps with fixed fractional delays and sums them with a gain per tap (tapped delay,
+ * early reflections).
+ *
+ * @param dl The delay line.
+ * @param delays The delay in samples per tap.
+ * @param gains The gain per tap.
+ * @param num_taps The number of taps.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of samples, the size of the last written block.
+ * @param interpolation One of the DELAY_INTERP_* modes.
+ */
+__declspec(dllexport) void delay_line_mix_taps(const delay_line* dl, const double* delays, const double* gains, size_t num_taps, double* result, size_t n, int interpolation) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    if (num_taps == 0) {
+        memset(_result, 0, n * sizeof(double));
+        return;
+    }
+    for (size_t t = 0; t < num_taps; ++t) {
+        delay_line_tap_block(dl, delays[t], interpolation, gains[t], t > 0, _result, n);
+    }
+}
+
+#define FDN_MAX_LINES 32
+#define FDN_MAX_MOD_DEPTH 32.0
+
+/**
+ * Feedback delay network reverb with 8, 16 or 32 lines. The lines map onto SIMD lanes: the delay
+ * memory is interleaved (one frame of all lines per time step), damping and decay run on whole
+ * vectors and the Hadamard feedback matrix is applied with butterflies, inside a vector by lane
+ * permutes and across vectors by add/sub pairs.
+ */
+typedef struct fdn_reverb {
+    size_t num_lines;
+    double sample_rate;
+    double* buffer;      // capacity frames of num_lines samples
+    size_t capacity;     // power of two
+    size_t mask;
+    size_t write_pos;
+    size_t max_delay;    // longest base delay in samples
+    double rt60;
+    double damping_hz;
+    double mod_depth;    // in samples
+    double mod_rate;     // in Hz
+    // per line, num_lines entries each
+    double* delay;       // base delay in samples
+    double* gain;        // decay gain for rt60, includes the 1/sqrt(N) Hadamard normalization
+    double* lowpass;     // damping filter state
+    double* lfo_sin;     // modulation phasor
+    double* lfo_cos;
+    double* lfo_rot_sin; // phasor rotation per sample
+    double* lfo_rot_cos;
+    double* tap_left;    // output and input distribution
+    double* tap_right;
+    double damping;      // one-pole coefficient
+} fdn_reverb;
+
+static size_t fdn_next_prime(size_t v) {
+    if (v < 2) {
+        return 2;
+    }
+    for (;; ++v) {
+        size_t d = 2;
+        while (d * d <= v && v % d != 0) {
+            ++d;
+        }
+        if (d * d > v) {
+            return v;
+        }
+    }
+}
+
+static void fdn_update_gains(fdn_reverb* fdn) {
+    const double norm = 1.0 / sqrt((double)fdn->num_lines);
+    for (size_t k = 0; k < fdn->num_lines; ++k) {
+        const double g = fdn->rt60 > 0.0 ? pow(10.0, -3.0 * fdn->delay[k] / (fdn->rt60 * fdn->sample_rate)) : 0.0;
+        fdn->gain[k] = g * norm;
+    }
+    fdn->damping = fdn->damping_hz > 0.0 && fdn->damping_hz < 0.5 * fdn->sample_rate
+                   ? exp(-2.0 * M_PI * fdn->damping_hz / fdn->sample_rate) : 0.0;
+}
+
+/**
+ * Sets the delay lengths, spread geometrically between the shortest and the longest and rounded
+ * to distinct primes so the echo patterns of the lines do not line up.
+ *
+ * @param fdn The reverb.
+ * @param min_ms The shortest delay in milliseconds.
+ * @param max_ms The longest delay in milliseconds, limited to the maximum given at creation.
+ */
+__declspec(dllexport) void fdn_reverb_set_delays(fdn_reverb* fdn, double min_ms, double max_ms) {
+    double lo = min_ms * 0.001 * fdn->sample_rate;
+    double hi = max_ms * 0.001 * fdn->sample_rate;
+    hi = hi > (double)fdn->max_delay ? (double)fdn->max_delay : hi;
+    lo = lo < FDN_MAX_MOD_DEPTH + 2.0 ? FDN_MAX_MOD_DEPTH + 2.0 : lo;
+    lo = lo > hi ? hi : lo;
+    size_t previous = 0;
+    for (size_t k = 0; k < fdn->num_lines; ++k) {
+        const double d = lo * pow(hi / lo, (double)k / (double)(fdn->num_lines - 1));
+        size_t prime = fdn_next_prime((size_t)d);
+        prime = prime <= previous ? fdn_next_prime(previous + 1) : prime;
+        fdn->delay[k] = (double)prime;
+        previous = prime;
+    }
+    fdn_update_gains(fdn);
+}
+
+/**
+ * Sets the reverb time and the high frequency damping.
+ *
+ * @param fdn The reverb.
+ * @param rt60 The time in seconds for the tail to decay by 60 dB.
+ * @param damping_hz The cutoff of the one-pole lowpass in every line, 0 disables damping.
+ */
+__declspec(dllexport) void fdn_reverb_set_decay(fdn_reverb* fdn, double rt60, double damping_hz) {
+    fdn->rt60 = rt60;
+    fdn->damping_hz = damping_hz;
+    fdn_update_gains(fdn);
+}
+
+/**
+ * Sets the delay modulation, every line gets its own sine LFO with a spread phase and rate.
+ *
+ * @param fdn The reverb.
+ * @param depth The modulation depth in samples, at most 32, 0 disables modulation.
+ * @param rate_hz The LFO rate in Hz.
+ */
+__declspec(dllexport) void fdn_reverb_set_modulation(fdn_reverb* fdn, double depth, double rate_hz) {
+    fdn->mod_depth = depth < 0.0 ? 0.0 : (depth > FDN_MAX_MOD_DEPTH ? FDN_MAX_MOD_DEPTH : depth);
+    fdn->mod_rate = rate_hz;
+    for (size_t k = 0; k < fdn->num_lines; ++k) {
+        const double rate = rate_hz * (1.0 + 0.37 * (double)k / (double)fdn->num_lines);
+        const double w = 2.0 * M_PI * rate / fdn->sample_rate;
+        fdn->lfo_rot_sin[k] = sin(w);
+        fdn->lfo_rot_cos[k] = cos(w);
+    }
+}
+
+/**
+ * Clears the delay memory and filter states.
+ *
+ * @param fdn The reverb.
+ */
+__declspec(dllexport) void fdn_reverb_reset(fdn_reverb* fdn) {
+    memset(fdn->buffer, 0, fdn->capacity * fdn->num_lines * sizeof(double));
+    for (size_t k = 0; k < fdn->num_lines; ++k) {
+        const double phase = 2.0 * M_PI * (double)k / (double)fdn->num_lines;
+        fdn->lowpass[k] = 0.0;
+        fdn->lfo_sin[k] = sin(phase);
+        fdn->lfo_cos[k] = cos(phase);
+    }
+}
+
+/**
+ * Frees a reverb created by fdn_reverb_create.
+ *
+ * @param fdn The reverb, may be NULL.
+ */
+__declspec(dllexport) void fdn_reverb_destroy(fdn_reverb* fdn) {
+    if (!fdn) {
+        return;
+    }
+    _mm_free(fdn->buffer);
+    _mm_free(fdn->delay);
+    _mm_free(fdn->gain);
+    _mm_free(fdn->lowpass);
+    _mm_free(fdn->lfo_sin);
+    _mm_free(fdn->lfo_cos);
+    _mm_free(fdn->lfo_rot_sin);
+    _mm_free(fdn->lfo_rot_cos);
+    _mm_free(fdn->tap_left);
+    _mm_free(fdn->tap_right);
+    free(fdn);
+}
+
+/**
+ * Creates a reverb. All memory is allocated here, processing does not allocate. The initial
+ * setting is delays from 30% of max_delay_ms to max_delay_ms, rt60 of 2 s, damping at 6 kHz and
+ * no modulation.
+ *
+ * @param num_lines The number of delay lines: 8, 16 or 32.
+ * @param sample_rate The sample rate in Hz.
+ * @param max_delay_ms The longest delay that fdn_reverb_set_delays may set, in milliseconds.
+ * @return The reverb, or NULL if num_lines is not supported or the allocation fails.
+ */
+__declspec(dllexport) fdn_reverb* fdn_reverb_create(size_t num_lines, double sample_rate, double max_delay_ms) {
+    if (num_lines != 8 && num_lines != 16 && num_lines != 32) {
+        return NULL;
+    }
+    fdn_reverb* fdn = (fdn_reverb*)calloc(1, sizeof(fdn_reverb));
+    if (!fdn) {
+        return NULL;
+    }
+    fdn->num_lines   = num_lines;
+    fdn->sample_rate = sample_rate;
+    fdn->max_delay   = (size_t)(max_delay_ms * 0.001 * sample_rate);
+    fdn->max_delay   = fdn->max_delay < 2 * (size_t)FDN_MAX_MOD_DEPTH + 4 * num_lines ? 2 * (size_t)FDN_MAX_MOD_DEPTH + 4 * num_lines : fdn->max_delay;
+    size_t capacity = 64;
+    while (capacity < 2 * fdn->max_delay + (size_t)FDN_MAX_MOD_DEPTH + 2) { // primes may round up
+        capacity <<= 1;
+    }
+    fdn->capacity = capacity;
+    fdn->mask     = capacity - 1;
+    fdn->buffer      = (double*)_mm_malloc(capacity * num_lines * sizeof(double), ALIGN);
+    fdn->delay       = (double*)_mm_malloc(num_lines * sizeof(double), ALIGN);
+    fdn->gain        = (double*)_mm_malloc(num_lines * sizeof(double), ALIGN);
+    fdn->lowpass     = (double*)_mm_malloc(num_lines * sizeof(double), ALIGN);
+    fdn->lfo_sin     = (double*)_mm_malloc(num_lines * sizeof(double), ALIGN);
+    fdn->lfo_cos     = (double*)_mm_malloc(num_lines * sizeof(double), ALIGN);
+    fdn->lfo_rot_sin = (double*)_mm_malloc(num_lines * sizeof(double), ALIGN);
+    fdn->lfo_rot_cos = (double*)_mm_malloc(num_lines * sizeof(double), ALIGN);
+    fdn->tap_left    = (double*)_mm_malloc(num_lines * sizeof(double), ALIGN);
+    fdn->tap_right   = (double*)_mm_malloc(num_lines * sizeof(double), ALIGN);
+    if (!fdn->buffer || !fdn->delay || !fdn->gain || !fdn->lowpass || !fdn->lfo_sin || !fdn->lfo_cos ||
+        !fdn->lfo_rot_sin || !fdn->lfo_rot_cos || !fdn->tap_left || !fdn->tap_right) {
+        fdn_reverb_destroy(fdn);
+        return NULL;
+    }
+    // even lines are fed by and feed the left channel, odd lines the right one
+    const double tap = 1.0 / sqrt(0.5 * (double)num_lines);
+    for (size_t k = 0; k < num_lines; ++k) {
+        fdn->tap_left[k]  = (k & 1) == 0 ? tap : 0.0;
+        fdn->tap_right[k] = (k & 1) == 1 ? tap : 0.0;
+    }
+    fdn->rt60 = 2.0;
+    fdn->damping_hz = 6000.0;
+    fdn_reverb_reset(fdn);
+    fdn_reverb_set_modulation(fdn, 0.0, 0.5);
+    fdn_reverb_set_delays(fdn, 0.3 * max_delay_ms, max_delay_ms);
+    return fdn;
+}
+
+// Hadamard butterflies inside one vector: [a b c d] -> [a+b+c+d, a-b+c-d, a+b-c-d, a-b-c+d]
+static inline simde__m256d hadamard4_pd(simde__m256d v) {
+    const simde__m256d p = simde_mm256_permute_pd(v, 0x5); // [b a d c]
+    v = simde_mm256_blend_pd(simde_mm256_add_pd(v, p), simde_mm256_sub_pd(p, v), 0xA);
+    const simde__m256d q = simde_mm256_permute2f128_pd(v, v, 0x01); // swap halves
+    return simde_mm256_blend_pd(simde_mm256_add_pd(v, q), simde_mm256_sub_pd(q, v), 0xC);
+}
+
+/**
+ * Renders the wet reverb signal for a stereo input. Runs with FTZ/DAZ enabled so the decaying
+ * tail never hits subnormal slow paths. Mono sources may pass the same pointer for both inputs.
+ *
+ * @param fdn The reverb.
+ * @param in_left The left input.
+ * @param in_right The right input.
+ * @param out_left The left wet output.
+ * @param out_right The right wet output.
+ * @param n The number of samples.
+ */
+__declspec(dllexport) void fdn_reverb_process(fdn_reverb* fdn, const double* in_left, const double* in_right, double* out_left, double* out_right, size_t n) {
+    const unsigned int saved_mode = ftz_daz_enter();
+    const size_t num_lines = fdn->num_lines;
+    const size_t nv = num_lines / 4;
+    const size_t mask = fdn->mask;
+    double* buffer = fdn->buffer;
+    const int modulated = fdn->mod_depth > 0.0;
+
+    simde__m256d base[FDN_MAX_LINES / 4], gain[FDN_MAX_LINES / 4], lowpass[FDN_MAX_LINES / 4];
+    simde__m256d lfo_sin[FDN_MAX_LINES / 4], lfo_cos[FDN_MAX_LINES / 4], rot_sin[FDN_MAX_LINES / 4], rot_cos[FDN_MAX_LINES / 4];
+    simde__m256d tap_left[FDN_MAX_LINES / 4], tap_right[FDN_MAX_LINES / 4];
+    simde__m128i line_index[FDN_MAX_LINES / 4];
+    simde__m256d v[FDN_MAX_LINES / 4];
+    for (size_t r = 0; r < nv; ++r) {
+        base[r]      = simde_mm256_load_pd(fdn->delay + 4 * r);
+        gain[r]      = simde_mm256_load_pd(fdn->gain + 4 * r);
+        lowpass[r]   = simde_mm256_load_pd(fdn->lowpass + 4 * r);
+        lfo_sin[r]   = simde_mm256_load_pd(fdn->lfo_sin + 4 * r);
+        lfo_cos[r]   = simde_mm256_load_pd(fdn->lfo_cos + 4 * r);
+        rot_sin[r]   = simde_mm256_load_pd(fdn->lfo_rot_sin + 4 * r);
+        rot_cos[r]   = simde_mm256_load_pd(fdn->lfo_rot_cos + 4 * r);
+        tap_left[r]  = simde_mm256_load_pd(fdn->tap_left + 4 * r);
+        tap_right[r] = simde_mm256_load_pd(fdn->tap_right + 4 * r);
+        line_index[r] = simde_mm_setr_epi32((int32_t)(4 * r), (int32_t)(4 * r + 1), (int32_t)(4 * r + 2), (int32_t)(4 * r + 3));
+    }
+    const simde__m256d vdamp  = simde_mm256_set1_pd(fdn->damping);
+    const simde__m256d vdepth = simde_mm256_set1_pd(fdn->mod_depth);
+    const simde__m128i vmask  = simde_mm_set1_epi32((int32_t)mask);
+    const simde__m128i vlines = simde_mm_set1_epi32((int32_t)num_lines);
+    const simde__m128i vone   = simde_mm_set1_epi32(1);
+    size_t w = fdn->write_pos;
+
+    for (size_t t = 0; t < n; ++t) {
+        const simde__m256d vpos = simde_mm256_set1_pd((double)(w + fdn->capacity));
+        simde__m256d acc_left = simde_mm256_setzero_pd();
+        simde__m256d acc_right = simde_mm256_setzero_pd();
+        for (size_t r = 0; r < nv; ++r) {
+            simde__m256d y;
+            if (modulated) {
+                const simde__m256d p = simde_mm256_sub_pd(vpos, simde_mm256_fmadd_pd(vdepth, lfo_sin[r], base[r]));
+                const simde__m256d ip = simde_mm256_floor_pd(p);
+                const simde__m256d f = simde_mm256_sub_pd(p, ip);
+                const simde__m128i i0 = simde_mm_and_si128(simde_mm256_cvttpd_epi32(ip), vmask);
+                const simde__m128i i1 = simde_mm_and_si128(simde_mm_add_epi32(i0, vone), vmask);
+                const simde__m256d x0 = simde_mm256_i32gather_pd(buffer, simde_mm_add_epi32(simde_mm_mullo_epi32(i0, vlines), line_index[r]), 8);
+                const simde__m256d x1 = simde_mm256_i32gather_pd(buffer, simde_mm_add_epi32(simde_mm_mullo_epi32(i1, vlines), line_index[r]), 8);
+                y = simde_mm256_fmadd_pd(f, simde_mm256_sub_pd(x1, x0), x0);
+                // advance the LFO phasor by one sample
+                const simde__m256d s = lfo_sin[r];
+                lfo_sin[r] = simde_mm256_fmadd_pd(s, rot_cos[r], simde_mm256_mul_pd(lfo_cos[r], rot_sin[r]));
+                lfo_cos[r] = simde_mm256_fmsub_pd(lfo_cos[r], rot_cos[r], simde_mm256_mul_pd(s, rot_sin[r]));
+            } else {
+                const simde__m128i i0 = simde_mm_and_si128(simde_mm256_cvttpd_epi32(simde_mm256_sub_pd(vpos, base[r])), vmask);
+                y = simde_mm256_i32gather_pd(buffer, simde_mm_add_epi32(simde_mm_mullo_epi32(i0, vlines), line_index[r]), 8);
+            }
+            lowpass[r] = simde_mm256_fmadd_pd(vdamp, simde_mm256_sub_pd(lowpass[r], y), y);
+            acc_left  = simde_mm256_fmadd_pd(lowpass[r], tap_left[r], acc_left);
+            acc_right = simde_mm256_fmadd_pd(lowpass[r], tap_right[r], acc_right);
+            v[r] = hadamard4_pd(simde_mm256_mul_pd(lowpass[r], gain[r]));
+        }
+        // Hadamard butterflies across vectors
+        for (size_t h = 1; h < nv; h <<= 1) {
+            for (size_t r = 0; r < nv; r += 2 * h) {
+                for (size_t j = r; j < r + h; ++j) {
+                    const simde__m256d a = v[j];
+                    v[j]     = simde_mm256_add_pd(a, v[j + h]);
+                    v[j + h] = simde_mm256_sub_pd(a, v[j + h]);
+                }
+            }
+        }
+        // inject the input and write the frame
+        const simde__m256d vin_left  = simde_mm256_set1_pd(in_left[t]);
+        const simde__m256d vin_right = simde_mm256_set1_pd(in_right[t]);
+        double* frame = buffer + w * num_lines;
+        for (size_t r = 0; r < nv; ++r) {
+            const simde__m256d x = simde_mm256_fmadd_pd(tap_left[r], vin_left, simde_mm256_fmadd_pd(tap_right[r], vin_right, v[r]));
+            simde_mm256_storeu_pd(frame + 4 * r, x);
+        }
+        // [L0+L1, R0+R1, L2+L3, R2+R3] -> [L, R]
+        const simde__m256d lr = simde_mm256_hadd_pd(acc_left, acc_right);
+        const simde__m128d sum = simde_mm_add_pd(simde_mm256_castpd256_pd128(lr), simde_mm256_extractf128_pd(lr, 1));
+        simde_mm_store_sd(&out_left[t], sum);
+        simde_mm_storeh_pd(&out_right[t], sum);
+        w = (w + 1) & mask;
+    }
+
+    fdn->write_pos = w;
+    for (size_t r = 0; r < nv; ++r) {
+        simde_mm256_storeu_pd(fdn->lowpass + 4 * r, lowpass[r]);
+        if (modulated) {
+            // renormalize the phasor against rounding drift
+            const simde__m256d len = simde_mm256_sqrt_pd(simde_mm256_fmadd_pd(lfo_sin[r], lfo_sin[r], simde_mm256_mul_pd(lfo_cos[r], lfo_cos[r])));
+            simde_mm256_storeu_pd(fdn->lfo_sin + 4 * r, simde_mm256_div_pd(lfo_sin[r], len));
+            simde_mm256_storeu_pd(fdn->lfo_cos + 4 * r, simde_mm256_div_pd(lfo_cos[r], len));
+        }
+    }
+    ftz_daz_leave(saved_mode);
+}
+
+/**
+ * Operations of the sliding window kernels.
+ */
+enum {
+    WINDOW_MAX = 0,
+    WINDOW_MIN = 1,
+    WINDOW_SUM = 2
+};
+
+static inline simde__m256d window_op_pd(int op, simde__m256d a, simde__m256d b) {
+    return op == WINDOW_MAX ? simde_mm256_max_pd(a, b) : (op == WINDOW_MIN ? simde_mm256_min_pd(a, b) : simde_mm256_add_pd(a, b));
+}
+
+static inline double window_op(int op, double a, double b) {
+    return op == WINDOW_MAX ? (a > b ? a : b) : (op == WINDOW_MIN ? (a < b ? a : b) : a + b);
+}
+
+/*
+ * Sliding windows after van Herk / Gil-Werman: the input is cut into segments of the window
+ * length, an inclusive prefix scan runs left to right inside every segment and a suffix scan right
+ * to left. A window starting at i spans at most two segments, so its result is
+ * op(suffix[i], prefix[i + window - 1]), a constant amount of work per sample whatever the window.
+ * For sums a window that starts on a segment boundary is exactly suffix[i].
+ *
+ * The scans are done 4 samples per step: two shift-and-combine steps inside the register, then the
+ * carry from the previous vector. Lane masks derived from the position inside the segment stop
+ * every step at segment boundaries, which needs window >= 4 so a vector holds at most one boundary.
+ */
+static inline void segmented_prefix_scan(int op, const double* input, size_t len, size_t window, double* prefix) {
+    const simde__m256d vlane   = simde_mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    const simde__m256d vwindow = simde_mm256_set1_pd((double)window);
+    const simde__m256d vlane1  = simde_mm256_cmp_pd(vlane, simde_mm256_set1_pd(1.0), SIMDE_CMP_GE_OQ); // lanes 1..3
+    const simde__m256d vlane2  = simde_mm256_cmp_pd(vlane, simde_mm256_set1_pd(2.0), SIMDE_CMP_GE_OQ); // lanes 2..3
+    simde__m256d carry = simde_mm256_setzero_pd();
+    size_t segment_pos = 0; // position of lane 0 inside its segment, kept scalar to stay off the vector dependency chain
+    for (size_t i = 0; i < len; i += 4) {
+        simde__m256d offset = simde_mm256_add_pd(simde_mm256_set1_pd((double)segment_pos), vlane);
+        offset = simde_mm256_sub_pd(offset, simde_mm256_and_pd(simde_mm256_cmp_pd(offset, vwindow, SIMDE_CMP_GE_OQ), vwindow));
+        simde__m256d v = simde_mm256_loadu_pd(&input[i]);
+        simde__m256d t = simde_mm256_permute4x64_pd(v, SIMDE_MM_SHUFFLE(2, 1, 0, 0));
+        v = simde_mm256_blendv_pd(v, window_op_pd(op, v, t), simde_mm256_and_pd(vlane1, simde_mm256_cmp_pd(offset, simde_mm256_set1_pd(1.0), SIMDE_CMP_GE_OQ)));
+        t = simde_mm256_permute4x64_pd(v, SIMDE_MM_SHUFFLE(1, 0, 0, 0));
+        v = simde_mm256_blendv_pd(v, window_op_pd(op, v, t), simde_mm256_and_pd(vlane2, simde_mm256_cmp_pd(offset, simde_mm256_set1_pd(2.0), SIMDE_CMP_GE_OQ)));
+        // the segment started before this vector where offset > lane
+        v = simde_mm256_blendv_pd(v, window_op_pd(op, v, carry), simde_mm256_cmp_pd(offset, vlane, SIMDE_CMP_GT_OQ));
+        simde_mm256_storeu_pd(&prefix[i], v);
+        carry = simde_mm256_permute4x64_pd(v, SIMDE_MM_SHUFFLE(3, 3, 3, 3));
+        segment_pos += 4;
+        segment_pos = segment_pos >= window ? segment_pos - window : segment_pos;
+    }
+}
+
+static inline void segmented_suffix_scan(int op, const double* input, size_t len, size_t window, double* suffix) {
+    const simde__m256d vlane   = simde_mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    const simde__m256d vlast   = simde_mm256_set1_pd((double)window - 1.0);
+    const simde__m256d vwindow = simde_mm256_set1_pd((double)window);
+    const simde__m256d vlane1  = simde_mm256_cmp_pd(vlane, simde_mm256_set1_pd(2.0), SIMDE_CMP_LE_OQ); // lanes 0..2
+    const simde__m256d vlane2  = simde_mm256_cmp_pd(vlane, simde_mm256_set1_pd(1.0), SIMDE_CMP_LE_OQ); // lanes 0..1
+    const simde__m256d vreach  = simde_mm256_set_pd(0.0, 1.0, 2.0, 3.0); // lanes left of the next vector
+    simde__m256d carry = simde_mm256_setzero_pd();
+    size_t segment_pos = (len - 4) % window;
+    for (size_t i = len; i > 0; i -= 4) {
+        simde__m256d offset = simde_mm256_add_pd(simde_mm256_set1_pd((double)segment_pos), vlane);
+        offset = simde_mm256_sub_pd(offset, simde_mm256_and_pd(simde_mm256_cmp_pd(offset, vwindow, SIMDE_CMP_GE_OQ), vwindow));
+        const simde__m256d remaining = simde_mm256_sub_pd(vlast, offset); // samples up to the segment end
+        simde__m256d v = simde_mm256_loadu_pd(&input[i - 4]);
+        simde__m256d t = simde_mm256_permute4x64_pd(v, SIMDE_MM_SHUFFLE(3, 3, 2, 1));
+        v = simde_mm256_blendv_pd(v, window_op_pd(op, v, t), simde_mm256_and_pd(vlane1, simde_mm256_cmp_pd(remaining, simde_mm256_set1_pd(1.0), SIMDE_CMP_GE_OQ)));
+        t = simde_mm256_permute4x64_pd(v, SIMDE_MM_SHUFFLE(3, 3, 3, 2));
+        v = simde_mm256_blendv_pd(v, window_op_pd(op, v, t), simde_mm256_and_pd(vlane2, simde_mm256_cmp_pd(remaining, simde_mm256_set1_pd(2.0), SIMDE_CMP_GE_OQ)));
+        // the segment continues into the next vector where remaining > 3 - lane
+        v = simde_mm256_blendv_pd(v, window_op_pd(op, v, carry), simde_mm256_cmp_pd(remaining, vreach, SIMDE_CMP_GT_OQ));
+        simde_mm256_storeu_pd(&suffix[i - 4], v);
+        carry = simde_mm256_permute4x64_pd(v, SIMDE_MM_SHUFFLE(0, 0, 0, 0));
+        segment_pos = segment_pos >= 4 ? segment_pos - 4 : segment_pos + window - 4;
+    }
+}
+
+/*
+ * result[k] = op over input[k * hop .. k * hop + window - 1] for every window inside n samples.
+ * The scans read n rounded up to a multiple of 4, prefix and suffix hold as many elements.
+ * Windows shorter than 4 are computed directly.
+ */
+static inline size_t sliding_window_core(int op, const double* input, size_t n, size_t window, size_t hop, double* prefix, double* suffix, double* result) {
+    if (window == 0 || hop == 0 || n < window) {
+        return 0;
+    }
+    const size_t count = (n - window) / hop + 1;
+    if (window < 4) {
+        for (size_t k = 0; k < count; ++k) {
+            double acc = input[k * hop];
+            for (size_t j = 1; j < window; ++j) {
+                acc = window_op(op, acc, input[k * hop + j]);
+            }
+            result[k] = acc;
+        }
+        return count;
+    }
+    const size_t len = (n + 3) & ~(size_t)3;
+    segmented_prefix_scan(op, input, len, window, prefix);
+    segmented_suffix_scan(op, input, len, window, suffix);
+
+    size_t k = 0;
+    if (hop == 1) {
+        const simde__m256d vwindow = simde_mm256_set1_pd((double)window);
+        const simde__m256d vlane = simde_mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+        size_t segment_pos = 0;
+        for (; k + 4 <= count; k += 4) {
+            simde__m256d tail = simde_mm256_loadu_pd(&prefix[k + window - 1]);
+            if (op == WINDOW_SUM) {
+                // a window starting on a segment boundary is the whole segment, already in suffix
+                simde__m256d offset = simde_mm256_add_pd(simde_mm256_set1_pd((double)segment_pos), vlane);
+                offset = simde_mm256_sub_pd(offset, simde_mm256_and_pd(simde_mm256_cmp_pd(offset, vwindow, SIMDE_CMP_GE_OQ), vwindow));
+                tail = simde_mm256_andnot_pd(simde_mm256_cmp_pd(offset, simde_mm256_setzero_pd(), SIMDE_CMP_EQ_OQ), tail);
+                segment_pos += 4;
+                segment_pos = segment_pos >= window ? segment_pos - window : segment_pos;
+            }
+            simde_mm256_storeu_pd(&result[k], window_op_pd(op, simde_mm256_loadu_pd(&suffix[k]), tail));
+        }
+    }
+    for (; k < count; ++k) {
+        const size_t i = k * hop;
+        result[k] = (op == WINDOW_SUM && i % window == 0) ? suffix[i] : window_op(op, suffix[i], prefix[i + window - 1]);
+    }
+    return count;
+}
+
+static size_t sliding_window_alloc(int op, const double* input, size_t n, size_t window, size_t hop, double* result) {
+    const size_t len = (n + 3) & ~(size_t)3;
+    double* scratch = (double*)_mm_malloc((2 * len + 8) * sizeof(double), ALIGN);
+    if (!scratch) {
+        return 0;
+    }
+    const size_t count = sliding_window_core(op, input, n, window, hop, scratch, scratch + len + 4, result);
+    _mm_free(scratch);
+    return count;
+}
+
+/**
+ * Computes the maximum of every window of the given length, moving by hop samples.
+ * The cost per sample does not depend on the window length.
+ *
+ * @param input The input vector, padded to a multiple of 4 like every vector from allocate_aligned_memory.
+ * @param n The number of elements in the input.
+ * @param window The window length.
+ * @param hop The distance between the starts of two windows, 1 for a moving maximum.
+ * @param result The output, room for (n - window) / hop + 1 elements.
+ * @return The number of windows written, 0 if n < window or on allocation failure.
+ */
+__declspec(dllexport) size_t sliding_max(const double* input, size_t n, size_t window, size_t hop, double* result) {
+    return sliding_window_alloc(WINDOW_MAX, input, n, window, hop, result);
+}
+
+/**
+ * Computes the minimum of every window of the given length, moving by hop samples.
+ *
+ * @param input The input vector, padded to a multiple of 4 like every vector from allocate_aligned_memory.
+ * @param n The number of elements in the input.
+ * @param window The window length.
+ * @param hop The distance between the starts of two windows, 1 for a moving minimum.
+ * @param result The output, room for (n - window) / hop + 1 elements.
+ * @return The number of windows written, 0 if n < window or on allocation failure.
+ */
+__declspec(dllexport) size_t sliding_min(const double* input, size_t n, size_t window, size_t hop, double* result) {
+    return sliding_window_alloc(WINDOW_MIN, input, n, window, hop, result);
+}
+
+/**
+ * Computes the sum of every window of the given length, moving by hop samples. Sums are built
+ * per segment, so there is no drift as with a running sum. Divide by window for a moving average.
+ *
+ * @param input The input vector, padded to a multiple of 4 like every vector from allocate_aligned_memory.
+ * @param n The number of elements in the input.
+ * @param window The window length.
+ * @param hop The distance between the starts of two windows, 1 for a moving sum.
+ * @param result The output, room for (n - window) / hop + 1 elements.
+ * @return The number of windows written, 0 if n < window or on allocation failure.
+ */
+__declspec(dllexport) size_t sliding_sum(const double* input, size_t n, size_t window, size_t hop, double* result) {
+    return sliding_window_alloc(WINDOW_SUM, input, n, window, hop, result);
+}
+
+/**
+ * Streaming state for sliding windows over a signal that arrives in blocks. Keeps the samples of
+ * the window in progress, so every window is reported exactly once whatever the block sizes.
+ */
+typedef struct sliding_window {
+    int op;
+    size_t window;
+    size_t hop;
+    size_t max_block;
+    double* buffer;  // the samples from the start of the next window on
+    double* prefix;
+    double* suffix;
+    size_t have;     // samples in buffer
+    size_t skip;     // input samples to drop before the next window starts, when hop > window
+} sliding_window;
+
+/**
+ * Frees a sliding window created by sliding_window_create.
+ *
+ * @param sw The sliding window, may be NULL.
+ */
+__declspec(dllexport) void sliding_window_destroy(sliding_window* sw) {
+    if (!sw) {
+        return;
+    }
+    _mm_free(sw->buffer);
+    _mm_free(sw->prefix);
+    _mm_free(sw->suffix);
+    free(sw);
+}
+
+/**
+ * Creates the streaming state for one of the sliding window operations.
+ *
+ * @param op WINDOW_MAX, WINDOW_MIN or WINDOW_SUM.
+ * @param window The window length.
+ * @param hop The distance between the starts of two windows.
+ * @param max_block The largest block size passed to sliding_window_process.
+ * @return The sliding window, or NULL if window or hop is 0 or the allocation fails.
+ */
+__declspec(dllexport) sliding_window* sliding_window_create(int op, size_t window, size_t hop, size_t max_block) {
+    if (window == 0 || hop == 0) {
+        return NULL;
+    }
+    sliding_window* sw = (sliding_window*)calloc(1, sizeof(sliding_window));
+    if (!sw) {
+        return NULL;
+    }
+    const size_t len = (window + max_block + 3) & ~(size_t)3;
+    sw->op        = op;
+    sw->window    = window;
+    sw->hop       = hop;
+    sw->max_block = max_block;
+    sw->buffer = (double*)_mm_malloc(len * sizeof(double), ALIGN);
+    sw->prefix = (double*)_mm_malloc(len * sizeof(double), ALIGN);
+    sw->suffix = (double*)_mm_malloc(len * sizeof(double), ALIGN);
+    if (!sw->buffer || !sw->prefix || !sw->suffix) {
+        sliding_window_destroy(sw);
+        return NULL;
+    }
+    memset(sw->buffer, 0, len * sizeof(double));
+    return sw;
+}
+
+/**
+ * Drops the window in progress, the next sample starts a new window.
+ *
+ * @param sw The sliding window.
+ */
+__declspec(dllexport) void sliding_window_reset(sliding_window* sw) {
+    sw->have = 0;
+    sw->skip = 0;
+}
+
+/**
+ * Feeds a block and writes the result of every window completed by it.
+ *
+ * @param sw The sliding window.
+ * @param input The new samples.
+ * @param n The number of new samples, at most max_block.
+ * @param result The output, room for max_block / hop + 1 elements.
+ * @return The number of windows written.
+ */
+__declspec(dllexport) size_t sliding_window_process(sliding_window* sw, const double* input, size_t n, double* result) {
+    if (sw->skip >= n) {
+        sw->skip -= n;
+        return 0;
+    }
+    input += sw->skip;
+    n -= sw->skip;
+    sw->skip = 0;
+    memcpy(sw->buffer + sw->have, input, n * sizeof(double));
+    sw->have += n;
+
+    const size_t count = sliding_window_core(sw->op, sw->buffer, sw->have, sw->window, sw->hop, sw->prefix, sw->suffix, result);
+    const size_t next = count * sw->hop;
+    if (next <= sw->have) {
+        memmove(sw->buffer, sw->buffer + next, (sw->have - next) * sizeof(double));
+        sw->have -= next;
+    } else {
+        sw->skip = next - sw->have;
+        sw->have = 0;
+    }
+    return count;
+}
+
+/**
+ * Lookahead brickwall limiter, linked over all channels. The gain path: peak of all channels per
+ * sample, sliding max over the lookahead window (van Herk / Gil-Werman), gain = ceiling / peak,
+ * instant attack with a one-pole release, and a moving average over the same window. Every gain in
+ * the average was computed from a window that contains the delayed sample, so the output never
+ * exceeds the ceiling and the attack is a smooth ramp over the lookahead time.
+ */
+typedef struct limiter {
+    size_t num_channels;
+    size_t lookahead;      // latency in samples, the window is lookahead + 1
+    size_t max_block;
+    size_t stride;         // row length of the history buffers, multiple of 8
+    double sample_rate;
+    double ceiling;
+    double release;        // one-pole coefficient
+    double release_state;  // last gain before the moving average
+    double last_gain;      // last applied gain, for metering
+    double* audio;         // num_channels rows: lookahead delayed samples, then the new block
+    double* peak;          // lookahead previous peaks, then the new block
+    double* gain;          // lookahead previous released gains, then the new block
+    double* prefix;        // scratch for the sliding max
+    double* suffix;
+    double* window_max;
+} limiter;
+
+/**
+ * Frees a limiter created by limiter_create.
+ *
+ * @param lim The limiter, may be NULL.
+ */
+__declspec(dllexport) void limiter_destroy(limiter* lim) {
+    if (!lim) {
+        return;
+    }
+    _mm_free(lim->audio);
+    _mm_free(lim->peak);
+    _mm_free(lim->gain);
+    _mm_free(lim->prefix);
+    _mm_free(lim->suffix);
+    _mm_free(lim->window_max);
+    free(lim);
+}
+
+/**
+ * Sets the release time.
+ *
+ * @param lim The limiter.
+ * @param release_ms The time constant of the gain recovery in milliseconds.
+ */
+__declspec(dllexport) void limiter_set_release(limiter* lim, double release_ms) {
+    lim->release = release_ms > 0.0 ? exp(-1000.0 / (release_ms * lim->sample_rate)) : 0.0;
+}
+
+/**
+ * Sets the ceiling.
+ *
+ * @param lim The limiter.
+ * @param ceiling The highest absolute output value, e.g. 0.989 for -0.1 dBFS.
+ */
+__declspec(dllexport) void limiter_set_ceiling(limiter* lim, double ceiling) {
+    lim->ceiling = ceiling;
+}
+
+/**
+ * Clears the lookahead delay and the gain state.
+ *
+ * @param lim The limiter.
+ */
+__declspec(dllexport) void limiter_reset(limiter* lim) {
+    memset(lim->audio, 0, lim->num_channels * lim->stride * sizeof(double));
+    for (size_t i = 0; i < lim->stride; ++i) {
+        lim->peak[i] = 0.0;
+        lim->gain[i] = 1.0;
+    }
+    lim->release_state = 1.0;
+    lim->last_gain = 1.0;
+}
+
+/**
+ * Creates a limiter. All buffers are allocated here, processing does not allocate.
+ *
+ * @param num_channels The number of linked channels.
+ * @param sample_rate The sample rate in Hz.
+ * @param lookahead_ms The lookahead time in milliseconds, this is also the latency.
+ * @param max_block The largest block size passed to limiter_process.
+ * @return The limiter with a ceiling of 1.0 and 50 ms release, or NULL if the allocation fails.
+ */
+__declspec(dllexport) limiter* limiter_create(size_t num_channels, double sample_rate, double lookahead_ms, size_t max_block) {
+    limiter* lim = (limiter*)calloc(1, sizeof(limiter));
+    if (!lim) {
+        return NULL;
+    }
+    lim->num_channels = num_channels;
+    lim->sample_rate  = sample_rate;
+    lim->lookahead    = (size_t)(lookahead_ms * 0.001 * sample_rate + 0.5);
+    lim->max_block    = max_block;
+    lim->stride       = (lim->lookahead + max_block + 3 + 7) & ~(size_t)7;
+    lim->audio      = (double*)_mm_malloc((num_channels > 0 ? num_channels : 1) * lim->stride * sizeof(double), ALIGN);
+    lim->peak       = (double*)_mm_malloc(lim->stride * sizeof(double), ALIGN);
+    lim->gain       = (double*)_mm_malloc(lim->stride * sizeof(double), ALIGN);
+    lim->prefix     = (double*)_mm_malloc(lim->stride * sizeof(double), ALIGN);
+    lim->suffix     = (double*)_mm_malloc(lim->stride * sizeof(double), ALIGN);
+    lim->window_max = (double*)_mm_malloc(lim->stride * sizeof(double), ALIGN);
+    if (!lim->audio || !lim->peak || !lim->gain || !lim->prefix || !lim->suffix || !lim->window_max) {
+        limiter_destroy(lim);
+        return NULL;
+    }
+    limiter_set_ceiling(lim, 1.0);
+    limiter_set_release(lim, 50.0);
+    limiter_reset(lim);
+    return lim;
+}
+
+/**
+ * Returns the latency of the limiter in samples.
+ *
+ * @param lim The limiter.
+ * @return The lookahead in samples.
+ */
+__declspec(dllexport) size_t limiter_get_latency(const limiter* lim) {
+    return lim->lookahead;
+}
+
+/**
+ * Returns the gain applied to the last sample of the last block, for gain reduction meters.
+ *
+ * @param lim The limiter.
+ * @return The linear gain, 1.0 without reduction.
+ */
+__declspec(dllexport) double limiter_get_gain(const limiter* lim) {
+    return lim->last_gain;
+}
+
+/**
+ * Limits a block of all channels in place, the output is delayed by limiter_get_latency samples.
+ *
+ * @param lim The limiter.
+ * @param channels num_channels pointers to the channel buffers, each aligned to ALIGN.
+ * @param n The number of samples per channel, a multiple of 4 and at most max_block.
+ */
+__declspec(dllexport) void limiter_process(limiter* lim, double* const* channels, size_t n) {
+    const size_t D = lim->lookahead;
+    const size_t window = D + 1;
+    double* peak = lim->peak;
+    double* gain = lim->gain;
+
+    // linked peak of the new block, written behind the D peaks of the previous blocks
+    const simde__m256d vsign = simde_mm256_set1_pd(-0.0);
+    for (size_t i = 0; i < n; i += 4) {
+        simde__m256d vpeak = simde_mm256_setzero_pd();
+        for (size_t c = 0; c < lim->num_channels; ++c) {
+            const double* in = __builtin_assume_aligned(channels[c], ALIGN);
+            const simde__m256d x = simde_mm256_load_pd(&in[i]);
+            vpeak = simde_mm256_max_pd(vpeak, simde_mm256_andnot_pd(vsign, x));
+            simde_mm256_storeu_pd(lim->audio + c * lim->stride + D + i, x);
+        }
+        simde_mm256_storeu_pd(&peak[D + i], vpeak);
+    }
+
+    // target gain from the sliding max, written over window_max
+    double* target = lim->window_max;
+    sliding_window_core(WINDOW_MAX, peak, n + D, window, 1, lim->prefix, lim->suffix, target);
+    const simde__m256d vceiling = simde_mm256_set1_pd(lim->ceiling);
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d m = simde_mm256_max_pd(simde_mm256_load_pd(&target[i]), vceiling);
+        simde_mm256_storeu_pd(&target[i], simde_mm256_div_pd(vceiling, m));
+    }
+
+    // instant attack, one-pole release
+    double state = lim->release_state;
+    const double release = lim->release;
+    for (size_t i = 0; i < n; ++i) {
+        const double g = target[i];
+        state = g < state ? g : g + release * (state - g);
+        gain[D + i] = state;
+    }
+    lim->release_state = state;
+
+    // moving average over the window, gain[i .. i + D] belongs to output sample i
+    double sum = 0.0;
+    for (size_t i = 0; i < D; ++i) {
+        sum += gain[i];
+    }
+    const double scale = 1.0 / (double)window;
+    for (size_t i = 0; i < n; ++i) {
+        sum += gain[i + D];
+        target[i] = sum * scale;
+        sum -= gain[i];
+    }
+    lim->last_gain = n > 0 ? target[n - 1] : lim->last_gain;
+
+    // apply to the delayed audio and keep the last D samples of everything for the next block
+    for (size_t c = 0; c < lim->num_channels; ++c) {
+        double* hist = lim->audio + c * lim->stride;
+        double* out = __builtin_assume_aligned(channels[c], ALIGN);
+        for (size_t i = 0; i < n; i += 4) {
+            simde_mm256_storeu_pd(&out[i], simde_mm256_mul_pd(simde_mm256_load_pd(&hist[i]), simde_mm256_load_pd(&target[i])));
+        }
+        memmove(hist, hist + n, D * sizeof(double));
+    }
+    memmove(peak, peak + n, D * sizeof(double));
+    memmove(gain, gain + n, D * sizeof(double));
+}
+
+/**
+ * Modes, detectors and channel linking of the dynamics processor.
+ */
+enum {
+    DYN_COMPRESSOR = 0,
+    DYN_EXPANDER   = 1, // downward expander below the threshold
+    DYN_GATE       = 2  // expander with a very steep ratio, attenuates by the range below the threshold
+};
+enum {
+    DYN_DETECT_PEAK = 0,
+    DYN_DETECT_RMS  = 1
+};
+enum {
+    DYN_LINK_NONE  = 0,
+    DYN_LINK_PAIRS = 1, // channels 0+1, 2+3, ... share one gain (stereo)
+    DYN_LINK_ALL   = 2
+};
+
+#define DYN_MAX_CHANNELS 64
+#define DYN_GATE_RATIO 1000.0
+#define DB_PER_NEPER 8.685889638065035 // 20 / ln(10)
+
+/**
+ * Compressor / expander / gate with the channels in SIMD lanes: samples of 4 channels are
+ * transposed into frames, so detection, the gain computer and the smoothing of 4 channels cost
+ * one vector operation each. The static curve is evaluated in dB with vectorized log and exp,
+ * the gain in dB is smoothed with separate attack and release time constants.
+ */
+typedef struct dynamics {
+    size_t num_channels;
+    size_t num_groups;     // vectors of 4 channels
+    double sample_rate;
+    int mode;
+    int detector;
+    int link;
+    double threshold_db;
+    double ratio;
+    double knee_db;
+    double range_db;
+    double makeup_db;
+    double attack;         // one-pole coefficients
+    double release;
+    double rms;
+    double* mean_square;   // RMS detector state per channel
+    double* gain_db;       // smoothed gain per channel
+    double* silence;       // zero block standing in for the padding lanes
+    size_t silence_len;
+} dynamics;
+
+static double dynamics_coeff(double sample_rate, double time_ms) {
+    return time_ms > 0.0 ? exp(-1000.0 / (time_ms * sample_rate)) : 0.0;
+}
+
+/**
+ * Frees a dynamics processor created by dynamics_create.
+ *
+ * @param dyn The dynamics processor, may be NULL.
+ */
+__declspec(dllexport) void dynamics_destroy(dynamics* dyn) {
+    if (!dyn) {
+        return;
+    }
+    _mm_free(dyn->mean_square);
+    _mm_free(dyn->gain_db);
+    _mm_free(dyn->silence);
+    free(dyn);
+}
+
+/**
+ * Clears the detector and gain states.
+ *
+ * @param dyn The dynamics processor.
+ */
+__declspec(dllexport) void dynamics_reset(dynamics* dyn) {
+    for (size_t c = 0; c < 4 * dyn->num_groups; ++c) {
+        dyn->mean_square[c] = 0.0;
+        dyn->gain_db[c] = 0.0;
+    }
+}
+
+/**
+ * Sets the mode of operation.
+ *
+ * @param dyn The dynamics processor.
+ * @param mode DYN_COMPRESSOR, DYN_EXPANDER or DYN_GATE.
+ */
+__declspec(dllexport) void dynamics_set_mode(dynamics* dyn, int mode) {
+    dyn->mode = mode;
+}
+
+/**
+ * Sets the level detector.
+ *
+ * @param dyn The dynamics processor.
+ * @param detector DYN_DETECT_PEAK or DYN_DETECT_RMS.
+ * @param rms_ms The averaging time of the RMS detector in milliseconds.
+ */
+__declspec(dllexport) void dynamics_set_detector(dynamics* dyn, int detector, double rms_ms) {
+    dyn->detector = detector;
+    dyn->rms = dynamics_coeff(dyn->sample_rate, rms_ms);
+}
+
+/**
+ * Sets the static curve.
+ *
+ * @param dyn The dynamics processor.
+ * @param threshold_db The threshold in dBFS.
+ * @param ratio The ratio, e.g. 4 for 4:1 compression or 1:4 expansion. Ignored by the gate.
+ * @param knee_db The width of the soft knee in dB, 0 for a hard knee.
+ * @param range_db The largest attenuation in dB.
+ */
+__declspec(dllexport) void dynamics_set_curve(dynamics* dyn, double threshold_db, double ratio, double knee_db, double range_db) {
+    dyn->threshold_db = threshold_db;
+    dyn->ratio = ratio < 1.0 ? 1.0 : ratio;
+    dyn->knee_db = knee_db < 0.0 ? 0.0 : knee_db;
+    dyn->range_db = range_db < 0.0 ? 0.0 : range_db;
+}
+
+/**
+ * Sets the attack and release times of the gain smoothing.
+ *
+ * @param dyn The dynamics processor.
+ * @param attack_ms The time constant while the attenuation grows, in milliseconds.
+ * @param release_ms The time constant while the attenuation shrinks, in milliseconds.
+ */
+__declspec(dllexport) void dynamics_set_times(dynamics* dyn, double attack_ms, double release_ms) {
+    dyn->attack = dynamics_coeff(dyn->sample_rate, attack_ms);
+    dyn->release = dynamics_coeff(dyn->sample_rate, release_ms);
+}
+
+/**
+ * Sets the makeup gain.
+ *
+ * @param dyn The dynamics processor.
+ * @param makeup_db The gain added after the gain computer, in dB.
+ */
+__declspec(dllexport) void dynamics_set_makeup(dynamics* dyn, double makeup_db) {
+    dyn->makeup_db = makeup_db;
+}
+
+/**
+ * Sets how channels share their gain.
+ *
+ * @param dyn The dynamics processor.
+ * @param link DYN_LINK_NONE, DYN_LINK_PAIRS (stereo) or DYN_LINK_ALL.
+ */
+__declspec(dllexport) void dynamics_set_link(dynamics* dyn, int link) {
+    dyn->link = link;
+}
+
+/**
+ * Returns the smoothed gain of a channel, for gain reduction meters.
+ *
+ * @param dyn The dynamics processor.
+ * @param channel The channel index.
+ * @return The gain in dB without makeup, 0 or negative.
+ */
+__declspec(dllexport) double dynamics_get_gain_db(const dynamics* dyn, size_t channel) {
+    return channel < dyn->num_channels ? dyn->gain_db[channel] : 0.0;
+}
+
+/**
+ * Creates a dynamics processor. The initial setting is a peak compressor at -18 dB, 4:1, 6 dB knee,
+ * 40 dB range, 5 ms attack, 100 ms release, 10 ms RMS time, no makeup, no linking.
+ *
+ * @param num_channels The number of channels, at most 64.
+ * @param sample_rate The sample rate in Hz.
+ * @param max_block The largest block size passed to dynamics_process.
+ * @return The dynamics processor, or NULL if num_channels is out of range or the allocation fails.
+ */
+__declspec(dllexport) dynamics* dynamics_create(size_t num_channels, double sample_rate, size_t max_block) {
+    if (num_channels == 0 || num_channels > DYN_MAX_CHANNELS) {
+        return NULL;
+    }
+    dynamics* dyn = (dynamics*)calloc(1, sizeof(dynamics));
+    if (!dyn) {
+        return NULL;
+    }
+    dyn->num_channels = num_channels;
+    dyn->num_groups   = (num_channels + 3) / 4;
+    dyn->sample_rate  = sample_rate;
+    dyn->silence_len  = (max_block + 3) & ~(size_t)3;
+    dyn->mean_square = (double*)_mm_malloc(4 * dyn->num_groups * sizeof(double), ALIGN);
+    dyn->gain_db     = (double*)_mm_malloc(4 * dyn->num_groups * sizeof(double), ALIGN);
+    dyn->silence     = (double*)_mm_malloc((dyn->silence_len > 0 ? dyn->silence_len : 4) * sizeof(double), ALIGN);
+    if (!dyn->mean_square || !dyn->gain_db || !dyn->silence) {
+        dynamics_destroy(dyn);
+        return NULL;
+    }
+    memset(dyn->silence, 0, (dyn->silence_len > 0 ? dyn->silence_len : 4) * sizeof(double));
+    dynamics_set_mode(dyn, DYN_COMPRESSOR);
+    dynamics_set_detector(dyn, DYN_DETECT_PEAK, 10.0);
+    dynamics_set_curve(dyn, -18.0, 4.0, 6.0, 40.0);
+    dynamics_set_times(dyn, 5.0, 100.0);
+    dynamics_set_makeup(dyn, 0.0);
+    dynamics_set_link(dyn, DYN_LINK_NONE);
+    dynamics_reset(dyn);
+    return dyn;
+}
+
+// Loads 4 samples of 4 channels and transposes them into 4 frames, lane c = channel c.
+static inline void load_frames_pd(const double* const* rows, size_t i, simde__m256d frames[4]) {
+    frames[0] = simde_mm256_load_pd(rows[0] + i);
+    frames[1] = simde_mm256_load_pd(rows[1] + i);
+    frames[2] = simde_mm256_load_pd(rows[2] + i);
+    frames[3] = simde_mm256_load_pd(rows[3] + i);
+    transpose4_pd(&frames[0], &frames[1], &frames[2], &frames[3]);
+}
+
+/**
+ * Processes a block of all channels in place.
+ *
+ * @param dyn The dynamics processor.
+ * @param channels num_channels pointers to the channel buffers, each aligned to ALIGN.
+ * @param sidechain NULL to detect on the channels themselves, or num_channels pointers to the
+ *                  sidechain buffers, each aligned to ALIGN.
+ * @param n The number of samples per channel, a multiple of 4 and at most max_block.
+ */
+__declspec(dllexport) void dynamics_process(dynamics* dyn, double* const* channels, const double* const* sidechain, size_t n) {
+    const size_t groups = dyn->num_groups;
+    const double* in_rows[DYN_MAX_CHANNELS];
+    const double* sc_rows[DYN_MAX_CHANNELS];
+    double* out_rows[DYN_MAX_CHANNELS];
+    for (size_t c = 0; c < 4 * groups; ++c) {
+        const int valid = c < dyn->num_channels;
+        in_rows[c]  = valid ? channels[c] : dyn->silence;
+        sc_rows[c]  = valid ? (sidechain ? sidechain[c] : channels[c]) : dyn->silence;
+        out_rows[c] = valid ? channels[c] : NULL;
+    }
+
+    const simde__m256d vsign    = simde_mm256_set1_pd(-0.0);
+    const simde__m256d vfloor   = simde_mm256_set1_pd(1e-30);
+    const simde__m256d vrms     = simde_mm256_set1_pd(dyn->rms);
+    const simde__m256d vattack  = simde_mm256_set1_pd(dyn->attack);
+    const simde__m256d vrelease = simde_mm256_set1_pd(dyn->release);
+    const simde__m256d vthresh  = simde_mm256_set1_pd(dyn->threshold_db);
+    const simde__m256d vrange   = simde_mm256_set1_pd(-dyn->range_db);
+    const simde__m256d vmakeup  = simde_mm256_set1_pd(dyn->makeup_db);
+    const double knee = dyn->knee_db > 1e-9 ? dyn->knee_db : 1e-9;
+    const simde__m256d vhalfknee = simde_mm256_set1_pd(0.5 * knee);
+    const simde__m256d vknee_scale = simde_mm256_set1_pd(1.0 / (2.0 * knee));
+    // gain slope beyond the knee: 1/R - 1 above the threshold for the compressor, R - 1 below it otherwise
+    const int compress = dyn->mode == DYN_COMPRESSOR;
+    const double ratio = dyn->mode == DYN_GATE ? DYN_GATE_RATIO : dyn->ratio;
+    const simde__m256d vslope = simde_mm256_set1_pd(compress ? 1.0 / ratio - 1.0 : ratio - 1.0);
+    const int rms = dyn->detector == DYN_DETECT_RMS;
+    // the detector works in nepers (natural log), the curve in dB
+    const simde__m256d vdb = simde_mm256_set1_pd(rms ? 0.5 * DB_PER_NEPER : DB_PER_NEPER);
+    const simde__m256d vneper = simde_mm256_set1_pd(1.0 / DB_PER_NEPER);
+
+    simde__m256d mean_square[DYN_MAX_CHANNELS / 4], gain_db[DYN_MAX_CHANNELS / 4];
+    for (size_t g = 0; g < groups; ++g) {
+        mean_square[g] = simde_mm256_load_pd(dyn->mean_square + 4 * g);
+        gain_db[g]     = simde_mm256_load_pd(dyn->gain_db + 4 * g);
+    }
+
+    simde__m256d x[DYN_MAX_CHANNELS / 4][4], sc[DYN_MAX_CHANNELS / 4][4];
+    simde__m256d level[DYN_MAX_CHANNELS / 4];
+    for (size_t i = 0; i < n; i += 4) {
+        for (size_t g = 0; g < groups; ++g) {
+            load_frames_pd(in_rows + 4 * g, i, x[g]);
+            if (sidechain) {
+                load_frames_pd(sc_rows + 4 * g, i, sc[g]);
+            }
+        }
+        for (int k = 0; k < 4; ++k) {
+            // detector level in dB
+            for (size_t g = 0; g < groups; ++g) {
+                const simde__m256d s = sidechain ? sc[g][k] : x[g][k];
+                simde__m256d e;
+                if (rms) {
+                    mean_square[g] = simde_mm256_fmadd_pd(vrms, simde_mm256_sub_pd(mean_square[g], simde_mm256_mul_pd(s, s)), simde_mm256_mul_pd(s, s));
+                    e = mean_square[g];
+                } else {
+                    e = simde_mm256_andnot_pd(vsign, s);
+                }
+                level[g] = simde_mm256_mul_pd(log_pd(simde_mm256_max_pd(e, vfloor)), vdb);
+            }
+            // linked channels follow the loudest one
+            if (dyn->link == DYN_LINK_PAIRS) {
+                for (size_t g = 0; g < groups; ++g) {
+                    level[g] = simde_mm256_max_pd(level[g], simde_mm256_permute_pd(level[g], 0x5));
+                }
+            } else if (dyn->link == DYN_LINK_ALL) {
+                simde__m256d m = level[0];
+                for (size_t g = 1; g < groups; ++g) {
+                    m = simde_mm256_max_pd(m, level[g]);
+                }
+                m = simde_mm256_max_pd(m, simde_mm256_permute_pd(m, 0x5));
+                m = simde_mm256_max_pd(m, simde_mm256_permute2f128_pd(m, m, 0x01));
+                for (size_t g = 0; g < groups; ++g) {
+                    level[g] = m;
+                }
+            }
+            for (size_t g = 0; g < groups; ++g) {
+                // soft knee static curve, gain in dB
+                const simde__m256d d = simde_mm256_sub_pd(level[g], vthresh);
+                const simde__m256d outside = simde_mm256_mul_pd(vslope, d);
+                simde__m256d target;
+                if (compress) {
+                    const simde__m256d t = simde_mm256_add_pd(d, vhalfknee);
+                    const simde__m256d in_knee = simde_mm256_mul_pd(simde_mm256_mul_pd(vslope, simde_mm256_mul_pd(t, t)), vknee_scale);
+                    target = simde_mm256_blendv_pd(in_knee, outside, simde_mm256_cmp_pd(d, vhalfknee, SIMDE_CMP_GE_OQ));
+                    target = simde_mm256_andnot_pd(simde_mm256_cmp_pd(t, simde_mm256_setzero_pd(), SIMDE_CMP_LE_OQ), target);
+                } else {
+                    const simde__m256d t = simde_mm256_sub_pd(d, vhalfknee);
+                    const simde__m256d in_knee = simde_mm256_mul_pd(simde_mm256_mul_pd(vslope, simde_mm256_mul_pd(t, t)), simde_mm256_xor_pd(vknee_scale, vsign));
+                    target = simde_mm256_blendv_pd(in_knee, outside, simde_mm256_cmp_pd(d, simde_mm256_sub_pd(simde_mm256_setzero_pd(), vhalfknee), SIMDE_CMP_LE_OQ));
+                    target = simde_mm256_andnot_pd(simde_mm256_cmp_pd(t, simde_mm256_setzero_pd(), SIMDE_CMP_GE_OQ), target);
+                }
+                target = simde_mm256_max_pd(target, vrange);
+                // attack while the attenuation grows, release while it shrinks
+                const simde__m256d coeff = simde_mm256_blendv_pd(vrelease, vattack, simde_mm256_cmp_pd(target, gain_db[g], SIMDE_CMP_LT_OQ));
+                gain_db[g] = simde_mm256_fmadd_pd(coeff, simde_mm256_sub_pd(gain_db[g], target), target);
+                const simde__m256d gain = exp_pd(simde_mm256_mul_pd(simde_mm256_add_pd(gain_db[g], vmakeup), vneper));
+                x[g][k] = simde_mm256_mul_pd(x[g][k], gain);
+            }
+        }
+        for (size_t g = 0; g < groups; ++g) {
+            transpose4_pd(&x[g][0], &x[g][1], &x[g][2], &x[g][3]);
+            for (int l = 0; l < 4; ++l) {
+                double* out = out_rows[4 * g + l];
+                if (out) {
+                    simde_mm256_storeu_pd(out + i, x[g][l]);
+                }
+            }
+        }
+    }
+
+    for (size_t g = 0; g < groups; ++g) {
+        simde_mm256_storeu_pd(dyn->mean_square + 4 * g, mean_square[g]);
+        simde_mm256_storeu_pd(dyn->gain_db + 4 * g, gain_db[g]);
+    }
+}
+
+/**
+ * Saturation curves, all odd, monotonic and bounded to [-1, 1].
+ */
+enum {
+    SAT_HARD  = 0, // clamp to [-1, 1]
+    SAT_CUBIC = 1, // 1.5 u - 0.5 u^3 inside [-1, 1], clamped outside
+    SAT_TANH  = 2, // tanh(u)
+    SAT_ATAN  = 3  // 2/pi atan(u)
+};
+
+// Differences of the ADAA input below this fall back to evaluating the curve at the midpoint.
+#define SAT_ADAA_EPS 1e-5
+
+// atan of any finite input, cephes style range reduction to |x| <= 0.66 plus a rational approximation.
+static inline simde__m256d atan_pd(simde__m256d x) {
+    const simde__m256d vsign = simde_mm256_set1_pd(-0.0);
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    const simde__m256d sign = simde_mm256_and_pd(x, vsign);
+    simde__m256d a = simde_mm256_andnot_pd(vsign, x);
+
+    const simde__m256d big = simde_mm256_cmp_pd(a, simde_mm256_set1_pd(2.41421356237309504880), SIMDE_CMP_GT_OQ);
+    const simde__m256d mid = simde_mm256_andnot_pd(big, simde_mm256_cmp_pd(a, simde_mm256_set1_pd(0.66), SIMDE_CMP_GT_OQ));
+    // a > tan(3 pi / 8): atan(a) = pi/2 - atan(1/a), 0.66 < a: atan(a) = pi/4 + atan((a - 1) / (a + 1))
+    const simde__m256d num = simde_mm256_blendv_pd(simde_mm256_blendv_pd(a, simde_mm256_sub_pd(a, one), mid), simde_mm256_xor_pd(one, vsign), big);
+    const simde__m256d den = simde_mm256_blendv_pd(simde_mm256_blendv_pd(one, simde_mm256_add_pd(a, one), mid), a, big);
+    a = simde_mm256_div_pd(num, den);
+    const simde__m256d offset = simde_mm256_or_pd(
+        simde_mm256_and_pd(big, simde_mm256_set1_pd(M_PI / 2 + 6.123233995736765886130e-17)),
+        simde_mm256_and_pd(mid, simde_mm256_set1_pd(M_PI / 4 + 0.5 * 6.123233995736765886130e-17)));
+
+    const simde__m256d z = simde_mm256_mul_pd(a, a);
+    simde__m256d p = simde_mm256_set1_pd(-8.750608600031904122785e-1);
+    p = simde_mm256_fmadd_pd(p, z, simde_mm256_set1_pd(-1.615753718733365076637e1));
+    p = simde_mm256_fmadd_pd(p, z, simde_mm256_set1_pd(-7.500855792314704667340e1));
+    p = simde_mm256_fmadd_pd(p, z, simde_mm256_set1_pd(-1.228866684490136173410e2));
+    p = simde_mm256_fmadd_pd(p, z, simde_mm256_set1_pd(-6.485021904942025371773e1));
+    simde__m256d q = simde_mm256_add_pd(z, simde_mm256_set1_pd(2.485846490142306297962e1));
+    q = simde_mm256_fmadd_pd(q, z, simde_mm256_set1_pd(1.650270098316988542046e2));
+    q = simde_mm256_fmadd_pd(q, z, simde_mm256_set1_pd(4.328810604912902668951e2));
+    q = simde_mm256_fmadd_pd(q, z, simde_mm256_set1_pd(4.853903996359136964868e2));
+    q = simde_mm256_fmadd_pd(q, z, simde_mm256_set1_pd(1.945506571482613964425e2));
+    const simde__m256d r = simde_mm256_fmadd_pd(simde_mm256_mul_pd(a, z), simde_mm256_div_pd(p, q), a);
+    return simde_mm256_or_pd(simde_mm256_add_pd(offset, r), sign);
+}
+
+// The saturation curve f(u).
+static inline simde__m256d saturate_curve_pd(int curve, simde__m256d u) {
+    const simde__m256d vsign = simde_mm256_set1_pd(-0.0);
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    const simde__m256d c = simde_mm256_max_pd(simde_mm256_min_pd(u, one), simde_mm256_xor_pd(one, vsign));
+    switch (curve) {
+    case SAT_CUBIC:
+        return simde_mm256_mul_pd(c, simde_mm256_fnmadd_pd(simde_mm256_set1_pd(0.5), simde_mm256_mul_pd(c, c), simde_mm256_set1_pd(1.5)));
+    case SAT_TANH: {
+        // tanh|u| = (1 - e) / (1 + e) with e = exp(-2|u|), the sign is copied back
+        const simde__m256d e = exp_pd(simde_mm256_mul_pd(simde_mm256_andnot_pd(vsign, u), simde_mm256_set1_pd(-2.0)));
+        const simde__m256d t = simde_mm256_div_pd(simde_mm256_sub_pd(one, e), simde_mm256_add_pd(one, e));
+        return simde_mm256_or_pd(t, simde_mm256_and_pd(u, vsign));
+    }
+    case SAT_ATAN:
+        return simde_mm256_mul_pd(atan_pd(u), simde_mm256_set1_pd(2.0 / M_PI));
+    default:
+        return c;
+    }
+}
+
+// The antiderivative F(u) of the saturation curve, F(0) = 0.
+static inline simde__m256d saturate_antiderivative_pd(int curve, simde__m256d u) {
+    const simde__m256d vsign = simde_mm256_set1_pd(-0.0);
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    const simde__m256d a = simde_mm256_andnot_pd(vsign, u);
+    const simde__m256d outside = simde_mm256_cmp_pd(a, one, SIMDE_CMP_GT_OQ);
+    switch (curve) {
+    case SAT_CUBIC: {
+        // 0.75 u^2 - 0.125 u^4 inside, |u| - 0.375 outside
+        const simde__m256d u2 = simde_mm256_mul_pd(u, u);
+        const simde__m256d inner = simde_mm256_mul_pd(u2, simde_mm256_fnmadd_pd(simde_mm256_set1_pd(0.125), u2, simde_mm256_set1_pd(0.75)));
+        return simde_mm256_blendv_pd(inner, simde_mm256_sub_pd(a, simde_mm256_set1_pd(0.375)), outside);
+    }
+    case SAT_TANH: {
+        // log cosh u = |u| + log(1 + exp(-2|u|)) - log 2
+        const simde__m256d e = exp_pd(simde_mm256_mul_pd(a, simde_mm256_set1_pd(-2.0)));
+        return simde_mm256_add_pd(a, simde_mm256_sub_pd(log_pd(simde_mm256_add_pd(one, e)), simde_mm256_set1_pd(0.69314718055994530942)));
+    }
+    case SAT_ATAN: {
+        // 2/pi (u atan u - log(1 + u^2) / 2)
+        const simde__m256d t = simde_mm256_mul_pd(u, atan_pd(u));
+        const simde__m256d l = log_pd(simde_mm256_fmadd_pd(u, u, one));
+        return simde_mm256_mul_pd(simde_mm256_fnmadd_pd(simde_mm256_set1_pd(0.5), l, t), simde_mm256_set1_pd(2.0 / M_PI));
+    }
+    default:
+        // u^2 / 2 inside, |u| - 1/2 outside
+        return simde_mm256_blendv_pd(simde_mm256_mul_pd(simde_mm256_mul_pd(u, u), simde_mm256_set1_pd(0.5)),
+                                     simde_mm256_sub_pd(a, simde_mm256_set1_pd(0.5)), outside);
+    }
+}
+
+/**
+ * Clamps each element of the input vector to [lo, hi].
+ *
+ * @param input The input vector, aligned to ALIGN.
+ * @param result The output vector, aligned to ALIGN. May be the input vector.
+ * @param n The number of elements in the input and output vectors.
+ * @param lo The lower bound.
+ * @param hi The upper bound.
+ */
+__declspec(dllexport) void clamp_vector(const double* input, double* result, size_t n, double lo, double hi) {
+    const double* _in     = __builtin_assume_aligned(input, ALIGN);
+          double* _result = __builtin_assume_aligned(result, ALIGN);
+    const simde__m256d vlo = simde_mm256_set1_pd(lo);
+    const simde__m256d vhi = simde_mm256_set1_pd(hi);
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d v = simde_mm256_load_pd(_in + i);
+        simde_mm256_storeu_pd(_result + i, simde_mm256_max_pd(simde_mm256_min_pd(v, vhi), vlo));
+    }
+}
+
+/**
+ * Waveshapes the input vector: result = f(drive * x + bias) - f(bias). A non-zero bias moves the
+ * operating point off the centre of the curve, which makes the shaping asymmetric (even harmonics);
+ * subtracting f(bias) keeps silence at zero.
+ *
+ * @param input The input vector, aligned to ALIGN.
+ * @param result The output vector, aligned to ALIGN. May be the input vector.
+ * @param n The number of elements in the input and output vectors.
+ * @param curve SAT_HARD, SAT_CUBIC, SAT_TANH or SAT_ATAN.
+ * @param drive The gain in front of the curve.
+ * @param bias The offset added in front of the curve.
+ */
+__declspec(dllexport) void saturate_vector(const double* input, double* result, size_t n, int curve, double drive, double bias) {
+    const double* _in     = __builtin_assume_aligned(input, ALIGN);
+          double* _result = __builtin_assume_aligned(result, ALIGN);
+    const simde__m256d vdrive = simde_mm256_set1_pd(drive);
+    const simde__m256d vbias  = simde_mm256_set1_pd(bias);
+    const simde__m256d vdc    = saturate_curve_pd(curve, vbias);
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d u = simde_mm256_fmadd_pd(simde_mm256_load_pd(_in + i), vdrive, vbias);
+        simde_mm256_storeu_pd(_result + i, simde_mm256_sub_pd(saturate_curve_pd(curve, u), vdc));
+    }
+}
+
+/**
+ * Saturator with first order antiderivative anti-aliasing (ADAA):
+ * y[n] = (F(u[n]) - F(u[n-1])) / (u[n] - u[n-1]) with u = drive * x + bias and F the antiderivative
+ * of the curve. This is the average of the curve over the segment between two samples, which
+ * suppresses the aliasing of the harmonics above Nyquist at the cost of a half sample delay and a
+ * gentle high frequency roll-off. The last input and its antiderivative are kept across blocks.
+ */
+typedef struct saturator {
+    int curve;
+    double drive;
+    double bias;
+    double last_u;         // drive * x + bias of the last sample of the previous block
+    double last_F;         // F(last_u)
+} saturator;
+
+/**
+ * Clears the ADAA state as if the input had been silent.
+ *
+ * @param sat The saturator.
+ */
+__declspec(dllexport) void saturator_reset(saturator* sat) {
+    sat->last_u = sat->bias;
+    sat->last_F = simde_mm256_cvtsd_f64(saturate_antiderivative_pd(sat->curve, simde_mm256_set1_pd(sat->bias)));
+}
+
+/**
+ * Sets the curve, drive and bias. A change of curve or bias resets the ADAA state.
+ *
+ * @param sat The saturator.
+ * @param curve SAT_HARD, SAT_CUBIC, SAT_TANH or SAT_ATAN.
+ * @param drive The gain in front of the curve.
+ * @param bias The offset added in front of the curve.
+ */
+__declspec(dllexport) void saturator_set(saturator* sat, int curve, double drive, double bias) {
+    const int changed = curve != sat->curve || bias != sat->bias;
+    sat->curve = curve;
+    sat->drive = drive;
+    sat->bias  = bias;
+    if (changed) {
+        saturator_reset(sat);
+    }
+}
+
+/**
+ * Creates an ADAA saturator.
+ *
+ * @param curve SAT_HARD, SAT_CUBIC, SAT_TANH or SAT_ATAN.
+ * @param drive The gain in front of the curve.
+ * @param bias The offset added in front of the curve.
+ * @return The saturator, or NULL if the allocation fails.
+ */
+__declspec(dllexport) saturator* saturator_create(int curve, double drive, double bias) {
+    saturator* sat = (saturator*)calloc(1, sizeof(saturator));
+    if (!sat) {
+        return NULL;
+    }
+    sat->curve = curve;
+    sat->drive = drive;
+    sat->bias  = bias;
+    saturator_reset(sat);
+    return sat;
+}
+
+/**
+ * Frees a saturator created by saturator_create.
+ *
+ * @param sat The saturator, may be NULL.
+ */
+__declspec(dllexport) void saturator_destroy(saturator* sat) {
+    free(sat);
+}
+
+/**
+ * Waveshapes a block with antiderivative anti-aliasing, result = ADAA f(drive * x + bias) - f(bias).
+ *
+ * @param sat The saturator.
+ * @param input The input vector, aligned to ALIGN.
+ * @param result The output vector, aligned to ALIGN. May be the input vector.
+ * @param n The number of elements, a multiple of 4.
+ */
+__declspec(dllexport) void saturator_process(saturator* sat, const double* input, double* result, size_t n) {
+    const double* _in     = __builtin_assume_aligned(input, ALIGN);
+          double* _result = __builtin_assume_aligned(result, ALIGN);
+    const int curve = sat->curve;
+    const simde__m256d vsign  = simde_mm256_set1_pd(-0.0);
+    const simde__m256d vdrive = simde_mm256_set1_pd(sat->drive);
+    const simde__m256d vbias  = simde_mm256_set1_pd(sat->bias);
+    const simde__m256d vdc    = saturate_curve_pd(curve, vbias);
+    const simde__m256d veps   = simde_mm256_set1_pd(SAT_ADAA_EPS);
+    const simde__m256d vhalf  = simde_mm256_set1_pd(0.5);
+    // rotated previous vectors, lane 0 holds the last sample of the previous block
+    simde__m256d rot_u = simde_mm256_set1_pd(sat->last_u);
+    simde__m256d rot_F = simde_mm256_set1_pd(sat->last_F);
+
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d u = simde_mm256_fmadd_pd(simde_mm256_load_pd(_in + i), vdrive, vbias);
+        const simde__m256d F = saturate_antiderivative_pd(curve, u);
+        // u[n-1] and F(u[n-1]): rotate right by one lane and pull lane 3 of the previous vector into lane 0
+        const simde__m256d cur_rot_u = simde_mm256_permute4x64_pd(u, SIMDE_MM_SHUFFLE(2, 1, 0, 3));
+        const simde__m256d cur_rot_F = simde_mm256_permute4x64_pd(F, SIMDE_MM_SHUFFLE(2, 1, 0, 3));
+        const simde__m256d prev_u = simde_mm256_blend_pd(cur_rot_u, rot_u, 0x1);
+        const simde__m256d prev_F = simde_mm256_blend_pd(cur_rot_F, rot_F, 0x1);
+        rot_u = cur_rot_u;
+        rot_F = cur_rot_F;
+
+        const simde__m256d du = simde_mm256_sub_pd(u, prev_u);
+        const simde__m256d small = simde_mm256_cmp_pd(simde_mm256_andnot_pd(vsign, du), veps, SIMDE_CMP_LT_OQ);
+        // nearly equal neighbours: the average over the segment is f at its midpoint
+        const simde__m256d safe_du = simde_mm256_blendv_pd(du, simde_mm256_set1_pd(1.0), small);
+        const simde__m256d slope = simde_mm256_div_pd(simde_mm256_sub_pd(F, prev_F), safe_du);
+        simde__m256d y = slope;
+        if (simde_mm256_movemask_pd(small)) {
+            const simde__m256d mid = saturate_curve_pd(curve, simde_mm256_mul_pd(simde_mm256_add_pd(u, prev_u), vhalf));
+            y = simde_mm256_blendv_pd(slope, mid, small);
+        }
+        simde_mm256_storeu_pd(_result + i, simde_mm256_sub_pd(y, vdc));
+    }
+    sat->last_u = simde_mm256_cvtsd_f64(rot_u);
+    sat->last_F = simde_mm256_cvtsd_f64(rot_F);
+}
+
+#define OS_MAX_STAGES 3
+#define OS_MAX_CHANNELS 64
+#define OS_KAISER_BETA 7.86 // about 80 dB stopband attenuation
+
+// Non-zero coefficient pairs of the halfband filter of each stage. The first stage needs the
+// sharpest transition (passband to 0.44 fs), later stages only have to reject the images above
+// the band the previous stages left, so they get much shorter.
+static const size_t os_stage_pairs[OS_MAX_STAGES] = { 20, 6, 4 };
+
+/**
+ * Callback run on the upsampled buffer of each channel by oversampler_process.
+ *
+ * @param x The upsampled channel, aligned to ALIGN, processed in place.
+ * @param n The number of upsampled samples.
+ * @param user The user pointer passed to oversampler_process.
+ */
+typedef void (*oversampler_kernel)(double* x, size_t n, void* user);
+
+/**
+ * 2x/4x/8x oversampler built from cascaded linear phase halfband FIR stages in polyphase form.
+ * Every other coefficient of a halfband filter is zero and the centre tap is 1/2, so the
+ * interpolator copies the delayed input into one phase and spends only `pairs` multiply-adds
+ * on the other, and the decimator only evaluates the kept outputs. Channels run in SIMD lanes:
+ * the filter state is a sequence of frames holding one sample of 4 channels, so each tap is one
+ * aligned load and one fma for 4 channels. The upsampled signal is handed out planar per channel
+ * so any elementwise kernel can run on it.
+ */
+typedef struct oversampler {
+    size_t num_channels;
+    size_t num_groups;                 // vectors of 4 channels
+    size_t factor;                     // 2, 4 or 8
+    size_t num_stages;                 // log2(factor)
+    size_t max_block;                  // at the base rate
+    double* coeffs[OS_MAX_STAGES];     // halfband coefficients h[c + 2k + 1], k < pairs
+    size_t up_stride[OS_MAX_STAGES];   // frames per group: history followed by the stage input
+    size_t down_stride[OS_MAX_STAGES];
+    size_t down_history[OS_MAX_STAGES]; // decimator history frames, also the round trip delay of the stage
+    double* up[OS_MAX_STAGES];         // interpolator input frames per group
+    double* down[OS_MAX_STAGES];       // decimator input frames per group
+    double* frames;                    // scratch frames, max_block * factor
+    double* buffers;                   // planar upsampled channels, 4 * num_groups rows
+    size_t buffer_stride;
+    double* silence;                   // zero row for the padding lanes
+    double* discard;                   // write-only row for the padding lanes
+} oversampler;
+
+// Modified Bessel function of the first kind, order 0, for the Kaiser window.
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 64 && term > 1e-17 * sum; ++k) {
+        const double t = x / (2.0 * k);
+        term *= t * t;
+        sum += term;
+    }
+    return sum;
+}
+
+// Kaiser windowed halfband sinc, normalized for unity gain at DC.
+static void design_halfband(double* g, size_t pairs) {
+    const double norm = bessel_i0(OS_KAISER_BETA);
+    double sum = 0.0;
+    for (size_t k = 0; k < pairs; ++k) {
+        const double d = (double)(2 * k + 1);
+        const double x = d / (double)(2 * pairs);
+        const double w = bessel_i0(OS_KAISER_BETA * sqrt(1.0 - x * x)) / norm;
+        g[k] = ((k & 1) ? -1.0 : 1.0) / (M_PI * d) * w;
+        sum += g[k];
+    }
+    // centre tap 1/2 plus both sides must sum to 1
+    for (size_t k = 0; k < pairs; ++k) {
+        g[k] *= 0.25 / sum;
+    }
+}
+
+// Transposes 4 planar rows into n frames.
+static inline void rows_to_frames(const double* const* rows, double* frames, size_t n) {
+    simde__m256d f[4];
+    for (size_t i = 0; i < n; i += 4) {
+        load_frames_pd(rows, i, f);
+        simde_mm256_storeu_pd(frames + 4 * i, f[0]);
+        simde_mm256_storeu_pd(frames + 4 * i + 4, f[1]);
+        simde_mm256_storeu_pd(frames + 4 * i + 8, f[2]);
+        simde_mm256_storeu_pd(frames + 4 * i + 12, f[3]);
+    }
+}
+
+// Transposes n frames into 4 planar rows.
+static inline void frames_to_rows(const double* frames, double* const* rows, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        simde__m256d f0 = simde_mm256_load_pd(frames + 4 * i);
+        simde__m256d f1 = simde_mm256_load_pd(frames + 4 * i + 4);
+        simde__m256d f2 = simde_mm256_load_pd(frames + 4 * i + 8);
+        simde__m256d f3 = simde_mm256_load_pd(frames + 4 * i + 12);
+        transpose4_pd(&f0, &f1, &f2, &f3);
+        simde_mm256_storeu_pd(rows[0] + i, f0);
+        simde_mm256_storeu_pd(rows[1] + i, f1);
+        simde_mm256_storeu_pd(rows[2] + i, f2);
+        simde_mm256_storeu_pd(rows[3] + i, f3);
+    }
+}
+
+// One 2x interpolator stage: history of 2 * pairs - 1 frames followed by n input frames, 2n output frames.
+static void halfband_up(double* in, double* out, const double* g, size_t pairs, size_t n) {
+    const size_t history = 2 * pairs - 1;
+    for (size_t m = 0; m < n; ++m) {
+        const double* x = in + 4 * (history + m - pairs); // x[m - pairs]
+        simde__m256d acc = simde_mm256_setzero_pd();
+        for (size_t k = 0; k < pairs; ++k) {
+            const simde__m256d pair = simde_mm256_add_pd(simde_mm256_load_pd(x + 4 * (1 + k)), simde_mm256_load_pd(x - 4 * k));
+            acc = simde_mm256_fmadd_pd(simde_mm256_set1_pd(2.0 * g[k]), pair, acc);
+        }
+        simde_mm256_storeu_pd(out + 8 * m, acc);
+        // the other phase only sees the centre tap: 2 * 1/2 * x[m - pairs + 1]
+        simde_mm256_storeu_pd(out + 8 * m + 4, simde_mm256_load_pd(x + 4));
+    }
+    memmove(in, in + 4 * n, 4 * history * sizeof(double));
+}
+
+// One 2x decimator stage: history frames followed by n input frames, n / 2 output frames. The
+// output is delayed by history - 2 * pairs + 1 input frames, the shortest is 2 * pairs - 2.
+static void halfband_down(double* in, double* out, const double* g, size_t pairs, size_t history, size_t n) {
+    const simde__m256d vhalf = simde_mm256_set1_pd(0.5);
+    for (size_t m = 0; m < n / 2; ++m) {
+        const double* v = in + 4 * (2 * m + 2 * pairs - 1); // centre tap, the oldest tap is in[2m]
+        simde__m256d acc = simde_mm256_mul_pd(vhalf, simde_mm256_load_pd(v));
+        for (size_t k = 0; k < pairs; ++k) {
+            const simde__m256d pair = simde_mm256_add_pd(simde_mm256_load_pd(v + 4 * (2 * k + 1)), simde_mm256_load_pd(v - 4 * (2 * k + 1)));
+            acc = simde_mm256_fmadd_pd(simde_mm256_set1_pd(g[k]), pair, acc);
+        }
+        simde_mm256_storeu_pd(out + 4 * m, acc);
+    }
+    memmove(in, in + 4 * n, 4 * history * sizeof(double));
+}
+
+/**
+ * Frees an oversampler created by oversampler_create.
+ *
+ * @param os The oversampler, may be NULL.
+ */
+__declspec(dllexport) void oversampler_destroy(oversampler* os) {
+    if (!os) {
+        return;
+    }
+    for (size_t s = 0; s < OS_MAX_STAGES; ++s) {
+        _mm_free(os->coeffs[s]);
+        _mm_free(os->up[s]);
+        _mm_free(os->down[s]);
+    }
+    _mm_free(os->frames);
+    _mm_free(os->buffers);
+    _mm_free(os->silence);
+    _mm_free(os->discard);
+    free(os);
+}
+
+/**
+ * Clears the filter histories.
+ *
+ * @param os The oversampler.
+ */
+__declspec(dllexport) void oversampler_reset(oversampler* os) {
+    for (size_t s = 0; s < os->num_stages; ++s) {
+        memset(os->up[s], 0, os->num_groups * os->up_stride[s] * 4 * sizeof(double));
+        memset(os->down[s], 0, os->num_groups * os->down_stride[s] * 4 * sizeof(double));
+    }
+}
+
+/**
+ * Creates an oversampler with preallocated buffers.
+ *
+ * @param num_channels The number of channels, at most 64.
+ * @param factor The oversampling factor, 2, 4 or 8.
+ * @param max_block The largest block size at the base rate, a multiple of 4.
+ * @return The oversampler, or NULL if an argument is out of range or the allocation fails.
+ */
+__declspec(dllexport) oversampler* oversampler_create(size_t num_channels, size_t factor, size_t max_block) {
+    if (num_channels == 0 || num_channels > OS_MAX_CHANNELS || (factor != 2 && factor != 4 && factor != 8)) {
+        return NULL;
+    }
+    oversampler* os = (oversampler*)calloc(1, sizeof(oversampler));
+    if (!os) {
+        return NULL;
+    }
+    os->num_channels  = num_channels;
+    os->num_groups    = (num_channels + 3) / 4;
+    os->factor        = factor;
+    os->num_stages    = factor == 2 ? 1 : factor == 4 ? 2 : 3;
+    os->max_block     = (max_block + 3) & ~(size_t)3;
+    os->buffer_stride = os->max_block * factor;
+    const size_t rows = 4 * os->num_groups;
+    // stage s delays by 4 * pairs - 3 samples at 2^(s+1) times the base rate, the last decimator
+    // waits a little longer so the round trip is a whole number of base rate samples
+    size_t round_trip = 0; // in 1 / factor samples
+    for (size_t s = 0; s < os->num_stages; ++s) {
+        os->down_history[s] = 4 * os_stage_pairs[s] - 3;
+        round_trip += os->down_history[s] << (os->num_stages - 1 - s);
+    }
+    os->down_history[os->num_stages - 1] += (factor - round_trip % factor) % factor;
+    int failed = 0;
+    for (size_t s = 0; s < os->num_stages; ++s) {
+        const size_t pairs = os_stage_pairs[s];
+        os->up_stride[s]   = 2 * pairs - 1 + (os->max_block << s);
+        os->down_stride[s] = os->down_history[s] + (os->max_block << (s + 1));
+        os->coeffs[s] = (double*)_mm_malloc(pairs * sizeof(double), ALIGN);
+        os->up[s]     = (double*)_mm_malloc(os->num_groups * os->up_stride[s] * 4 * sizeof(double), ALIGN);
+        os->down[s]   = (double*)_mm_malloc(os->num_groups * os->down_stride[s] * 4 * sizeof(double), ALIGN);
+        failed |= !os->coeffs[s] || !os->up[s] || !os->down[s];
+    }
+    os->frames  = (double*)_mm_malloc((os->buffer_stride + 4) * 4 * sizeof(double), ALIGN);
+    os->buffers = (double*)_mm_malloc((rows * os->buffer_stride + 4) * sizeof(double), ALIGN);
+    os->silence = (double*)_mm_malloc((os->max_block + 4) * sizeof(double), ALIGN);
+    os->discard = (double*)_mm_malloc((os->max_block + 4) * sizeof(double), ALIGN);
+    if (failed || !os->frames || !os->buffers || !os->silence || !os->discard) {
+        oversampler_destroy(os);
+        return NULL;
+    }
+    for (size_t s = 0; s < os->num_stages; ++s) {
+        design_halfband(os->coeffs[s], os_stage_pairs[s]);
+    }
+    memset(os->silence, 0, (os->max_block + 4) * sizeof(double));
+    memset(os->buffers, 0, (rows * os->buffer_stride + 4) * sizeof(double));
+    oversampler_reset(os);
+    return os;
+}
+
+/**
+ * Returns the round trip latency of upsampling and downsampling. Every stage adds
+ * 4 * pairs - 3 samples at its own rate and the last decimator stage adds up to factor - 1
+ * more, so the total is a whole number of samples at every factor (39, 44 and 46 for 2x, 4x
+ * and 8x) and can be used directly for delay compensation.
+ *
+ * @param os The oversampler.
+ * @return The latency in samples at the base rate.
+ */
+__declspec(dllexport) double oversampler_get_latency(const oversampler* os) {
+    double latency = 0.0;
+    for (size_t s = 0; s < os->num_stages; ++s) {
+        latency += (double)os->down_history[s] / (double)((size_t)2 << s); // interpolator 2 * pairs - 1, decimator the rest
+    }
+    return latency;
+}
+
+/**
+ * Returns the oversampling factor.
+ *
+ * @param os The oversampler.
+ * @return 2, 4 or 8.
+ */
+__declspec(dllexport) size_t oversampler_get_factor(const oversampler* os) {
+    return os->factor;
+}
+
+/**
+ * Returns the upsampled buffer of a channel, filled by oversampler_upsample and read by
+ * oversampler_downsample.
+ *
+ * @param os The oversampler.
+ * @param channel The channel index.
+ * @return The buffer of max_block * factor samples, aligned to ALIGN, or NULL if channel is out of range.
+ */
+__declspec(dllexport) double* oversampler_get_buffer(oversampler* os, size_t channel) {
+    return channel < os->num_channels ? os->buffers + channel * os->buffer_stride : NULL;
+}
+
+/**
+ * Upsamples a block of all channels into the internal buffers.
+ *
+ * @param os The oversampler.
+ * @param channels num_channels pointers to the channel buffers, each aligned to ALIGN.
+ * @param n The number of samples per channel at the base rate, a multiple of 4 and at most max_block.
+ * @return The number of upsampled samples per channel, n * factor.
+ */
+__declspec(dllexport) size_t oversampler_upsample(oversampler* os, const double* const* channels, size_t n) {
+    for (size_t g = 0; g < os->num_groups; ++g) {
+        const double* in_rows[4];
+        double* out_rows[4];
+        for (size_t l = 0; l < 4; ++l) {
+            const size_t c = 4 * g + l;
+            in_rows[l]  = c < os->num_channels ? channels[c] : os->silence;
+            out_rows[l] = os->buffers + c * os->buffer_stride;
+        }
+        rows_to_frames(in_rows, os->up[0] + 4 * (g * os->up_stride[0] + 2 * os_stage_pairs[0] - 1), n);
+        for (size_t s = 0; s < os->num_stages; ++s) {
+            const size_t pairs = os_stage_pairs[s];
+            double* out = s + 1 < os->num_stages
+                        ? os->up[s + 1] + 4 * (g * os->up_stride[s + 1] + 2 * os_stage_pairs[s + 1] - 1)
+                        : os->frames;
+            halfband_up(os->up[s] + 4 * g * os->up_stride[s], out, os->coeffs[s], pairs, n << s);
+        }
+        frames_to_rows(os->frames, out_rows, n * os->factor);
+    }
+    return n * os->factor;
+}
+
+/**
+ * Downsamples the internal buffers into the channels.
+ *
+ * @param os The oversampler.
+ * @param channels num_channels pointers to the channel buffers, each aligned to ALIGN. May be the
+ *                 buffers passed to oversampler_upsample.
+ * @param n The number of samples per channel at the base rate, a multiple of 4 and at most max_block.
+ */
+__declspec(dllexport) void oversampler_downsample(oversampler* os, double* const* channels, size_t n) {
+    const size_t last = os->num_stages - 1;
+    for (size_t g = 0; g < os->num_groups; ++g) {
+        const double* in_rows[4];
+        double* out_rows[4];
+        for (size_t l = 0; l < 4; ++l) {
+            const size_t c = 4 * g + l;
+            in_rows[l]  = os->buffers + c * os->buffer_stride;
+            out_rows[l] = c < os->num_channels ? channels[c] : os->discard;
+        }
+        rows_to_frames(in_rows, os->down[last] + 4 * (g * os->down_stride[last] + os->down_history[last]), n * os->factor);
+        for (size_t s = last + 1; s-- > 0;) {
+            const size_t pairs = os_stage_pairs[s];
+            double* out = s > 0
+                        ? os->down[s - 1] + 4 * (g * os->down_stride[s - 1] + os->down_history[s - 1])
+                        : os->frames;
+            halfband_down(os->down[s] + 4 * g * os->down_stride[s], out, os->coeffs[s], pairs, os->down_history[s], n << (s + 1));
+        }
+        frames_to_rows(os->frames, out_rows, n);
+    }
+}
+
+/**
+ * Runs an elementwise kernel at the oversampled rate: upsamples the channels, calls the kernel on
+ * each upsampled channel and downsamples the result back into the channels.
+ *
+ * @param os The oversampler.
+ * @param channels num_channels pointers to the channel buffers, each aligned to ALIGN, processed in place.
+ * @param n The number of samples per channel at the base rate, a multiple of 4 and at most max_block.
+ * @param kernel The kernel, called once per channel.
+ * @param user Passed through to the kernel.
+ */
+__declspec(dllexport) void oversampler_process(oversampler* os, double* const* channels, size_t n, oversampler_kernel kernel, void* user) {
+    const size_t up = oversampler_upsample(os, (const double* const*)channels, n);
+    for (size_t c = 0; c < os->num_channels; ++c) {
+        kernel(os->buffers + c * os->buffer_stride, up, user);
+    }
+    oversampler_downsample(os, channels, n);
+}
+
+/**
+ * Oversampled saturate_vector: the nonlinearity runs at factor times the sample rate, so the
+ * harmonics it creates above the base Nyquist are filtered out instead of aliasing.
+ *
+ * @param os The oversampler.
+ * @param channels num_channels pointers to the channel buffers, each aligned to ALIGN, processed in place.
+ * @param n The number of samples per channel at the base rate, a multiple of 4 and at most max_block.
+ * @param curve SAT_HARD, SAT_CUBIC, SAT_TANH or SAT_ATAN.
+ * @param drive The gain in front of the curve.
+ * @param bias The offset added in front of the curve.
+ */
+__declspec(dllexport) void oversampler_process_saturate(oversampler* os, double* const* channels, size_t n, int curve, double drive, double bias) {
+    const size_t up = oversampler_upsample(os, (const double* const*)channels, n);
+    for (size_t c = 0; c < os->num_channels; ++c) {
+        double* x = os->buffers + c * os->buffer_stride;
+        saturate_vector(x, x, up, curve, drive, bias);
+    }
+    oversampler_downsample(os, channels, n);
+}
+
+/**
+ * Built-in wavetable shapes.
+ */
+enum {
+    WT_SINE     = 0,
+    WT_SAW      = 1,
+    WT_SQUARE   = 2,
+    WT_TRIANGLE = 3
+};
+
+#define WT_KEY_LENGTH 64
+#define WT_GUARD 8 // row padding: x[N-1] in front, x[0..2] behind, rounded to keep rows aligned
+
+/**
+ * Mip-mapped band-limited wavetable. Level k holds the harmonics up to (size / 4) >> k of one
+ * cycle, so a voice whose highest harmonic would pass Nyquist switches to a level with fewer
+ * harmonics instead of aliasing. Every row has guard samples around the cycle so 4 point lookups
+ * never wrap. Tables are immutable once built and reference counted, so a cached table can be
+ * shared by all plugin instances in the process.
+ */
+typedef struct wavetable {
+    char key[WT_KEY_LENGTH]; // cache key, empty for private tables
+    size_t refcount;
+    struct wavetable* next;  // cache list
+    size_t size;             // samples per cycle, a power of two
+    size_t top_harmonic;     // harmonics of level 0
+    size_t num_levels;
+    size_t stride;           // size + WT_GUARD
+    double* data;            // num_levels rows
+} wavetable;
+
+static wavetable* wavetable_cache = NULL;
+static volatile char wavetable_cache_busy = 0;
+
+// Spin lock around the shared table cache, acquisition is rare and short.
+static inline void wavetable_cache_lock(void) {
+    while (__atomic_test_and_set(&wavetable_cache_busy, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static inline void wavetable_cache_unlock(void) {
+    __atomic_clear(&wavetable_cache_busy, __ATOMIC_RELEASE);
+}
+
+// Builds all levels from the cosine and sine amplitudes of harmonics 0..top (index 0 is DC).
+static wavetable* wavetable_build(const double* a, const double* b, size_t top, size_t size) {
+    wavetable* wt = (wavetable*)calloc(1, sizeof(wavetable));
+    double* sine = (double*)malloc(size * sizeof(double));
+    if (!wt || !sine) {
+        free(wt);
+        free(sine);
+        return NULL;
+    }
+    wt->refcount     = 1;
+    wt->size         = size;
+    wt->top_harmonic = size / 4;
+    wt->num_levels   = 1;
+    while ((wt->top_harmonic >> wt->num_levels) > 0) {
+        ++wt->num_levels;
+    }
+    wt->stride = size + WT_GUARD;
+    wt->data   = (double*)_mm_malloc(wt->num_levels * wt->stride * sizeof(double), ALIGN);
+    if (!wt->data) {
+        free(wt);
+        free(sine);
+        return NULL;
+    }
+    const size_t mask = size - 1;
+    for (size_t j = 0; j < size; ++j) {
+        sine[j] = sin(2.0 * M_PI * (double)j / (double)size);
+    }
+
+    // the coarsest level first, every finer level adds the harmonics the previous one left out
+    size_t done = 0;
+    double* previous = NULL;
+    for (size_t level = wt->num_levels; level-- > 0;) {
+        double* row = wt->data + level * wt->stride + 1;
+        const size_t limit = wt->top_harmonic >> level;
+        if (previous) {
+            memcpy(row, previous, size * sizeof(double));
+        } else {
+            for (size_t j = 0; j < size; ++j) {
+                row[j] = a[0];
+            }
+        }
+        for (size_t h = done + 1; h <= limit && h <= top; ++h) {
+            if (a[h] == 0.0 && b[h] == 0.0) {
+                continue;
+            }
+            // sin and cos of 2 pi h j / size from one table, (h j) mod size stays exact
+            for (size_t j = 0; j < size; ++j) {
+                const size_t k = (h * j) & mask;
+                row[j] += a[h] * sine[(k + size / 4) & mask] + b[h] * sine[k];
+            }
+        }
+        done = limit;
+        previous = row;
+        row[-1] = row[size - 1];
+        row[size] = row[0];
+        row[size + 1] = row[1];
+        row[size + 2] = row[2];
+        for (size_t j = size + 3; j < wt->stride - 1; ++j) {
+            row[j] = 0.0;
+        }
+    }
+    free(sine);
+    return wt;
+}
+
+// Rounds up to a power of two of at least 64 samples.
+static size_t wavetable_size(size_t table_size) {
+    size_t size = 64;
+    while (size < table_size && size < ((size_t)1 << 20)) {
+        size <<= 1;
+    }
+    return size;
+}
+
+// Looks up a cached table and takes a reference, the caller holds the cache lock.
+static wavetable* wavetable_cache_find(const char* key) {
+    for (wavetable* wt = wavetable_cache; wt; wt = wt->next) {
+        if (strncmp(wt->key, key, WT_KEY_LENGTH) == 0) {
+            ++wt->refcount;
+            return wt;
+        }
+    }
+    return NULL;
+}
+
+// Adds a freshly built table to the cache, or returns the one another thread built meanwhile.
+static wavetable* wavetable_cache_insert(const char* key, wavetable* built) {
+    wavetable_cache_lock();
+    wavetable* wt = wavetable_cache_find(key);
+    if (!wt && built) {
+        strncpy(built->key, key, WT_KEY_LENGTH - 1);
+        built->next = wavetable_cache;
+        wavetable_cache = built;
+        wt = built;
+        built = NULL;
+    }
+    wavetable_cache_unlock();
+    if (built) {
+        _mm_free(built->data);
+        free(built);
+    }
+    return wt;
+}
+
+/**
+ * Releases a reference to a wavetable. The table is freed (and leaves the cache) with its last reference.
+ *
+ * @param wt The wavetable, may be NULL.
+ */
+__declspec(dllexport) void wavetable_release(wavetable* wt) {
+    if (!wt) {
+        return;
+    }
+    wavetable_cache_lock();
+    const size_t remaining = --wt->refcount;
+    if (remaining == 0 && wt->key[0]) {
+        for (wavetable** link = &wavetable_cache; *link; link = &(*link)->next) {
+            if (*link == wt) {
+                *link = wt->next;
+                break;
+            }
+        }
+    }
+    wavetable_cache_unlock();
+    if (remaining == 0) {
+        _mm_free(wt->data);
+        free(wt);
+    }
+}
+
+/**
+ * Returns a mip-mapped wavetable of one cycle of samples. With a key the table is built once per
+ * process and shared: later calls with the same key return the cached table and ignore the samples.
+ *
+ * @param key The cache key, at most 63 characters, or NULL for a private table.
+ * @param cycle One cycle of the waveform.
+ * @param length The number of samples in the cycle, at least 2.
+ * @param table_size The samples per table row, rounded up to a power of two of at least 64.
+ * @return The wavetable, to be released with wavetable_release, or NULL if the allocation fails.
+ */
+__declspec(dllexport) wavetable* wavetable_acquire(const char* key, const double* cycle, size_t length, size_t table_size) {
+    if (key) {
+        wavetable_cache_lock();
+        wavetable* wt = wavetable_cache_find(key);
+        wavetable_cache_unlock();
+        if (wt) {
+            return wt;
+        }
+    }
+    if (!cycle || length < 2) {
+        return NULL;
+    }
+    const size_t size = wavetable_size(table_size);
+    size_t top = (length - 1) / 2;
+    if (top > size / 4) {
+        top = size / 4;
+    }
+    double* a = (double*)calloc(top + 1, sizeof(double));
+    double* b = (double*)calloc(top + 1, sizeof(double));
+    double* cosine = (double*)malloc(length * sizeof(double));
+    double* sine = (double*)malloc(length * sizeof(double));
+    wavetable* wt = NULL;
+    if (a && b && cosine && sine) {
+        // direct DFT, harmonic h of sample j uses the angle of (h j) mod length
+        for (size_t j = 0; j < length; ++j) {
+            cosine[j] = cos(2.0 * M_PI * (double)j / (double)length);
+            sine[j] = sin(2.0 * M_PI * (double)j / (double)length);
+        }
+        for (size_t h = 0; h <= top; ++h) {
+            double re = 0.0, im = 0.0;
+            for (size_t j = 0, k = 0; j < length; ++j, k = (k + h) % length) {
+                re += cycle[j] * cosine[k];
+                im += cycle[j] * sine[k];
+            }
+            a[h] = (h == 0 ? 1.0 : 2.0) * re / (double)length;
+            b[h] = 2.0 * im / (double)length;
+        }
+        wt = wavetable_build(a, b, top, size);
+    }
+    free(a);
+    free(b);
+    free(cosine);
+    free(sine);
+    return key && wt ? wavetable_cache_insert(key, wt) : wt;
+}
+
+/**
+ * Returns the shared mip-mapped wavetable of a built-in shape, built from its exact Fourier series.
+ *
+ * @param shape WT_SINE, WT_SAW (rising), WT_SQUARE or WT_TRIANGLE.
+ * @param table_size The samples per table row, rounded up to a power of two of at least 64.
+ * @return The wavetable, to be released with wavetable_release, or NULL on an unknown shape or allocation failure.
+ */
+__declspec(dllexport) wavetable* wavetable_acquire_shape(int shape, size_t table_size) {
+    if (shape < WT_SINE || shape > WT_TRIANGLE) {
+        return NULL;
+    }
+    const size_t size = wavetable_size(table_size);
+    char key[WT_KEY_LENGTH];
+    snprintf(key, sizeof(key), "#shape-%d-%zu", shape, size);
+    wavetable_cache_lock();
+    wavetable* wt = wavetable_cache_find(key);
+    wavetable_cache_unlock();
+    if (wt) {
+        return wt;
+    }
+
+    const size_t top = size / 4;
+    double* a = (double*)calloc(top + 1, sizeof(double));
+    double* b = (double*)calloc(top + 1, sizeof(double));
+    if (a && b) {
+        for (size_t h = 1; h <= top; ++h) {
+            const double k = (double)h;
+            switch (shape) {
+            case WT_SAW:
+                b[h] = -2.0 / (M_PI * k);
+                break;
+            case WT_SQUARE:
+                b[h] = (h & 1) ? 4.0 / (M_PI * k) : 0.0;
+                break;
+            case WT_TRIANGLE:
+                b[h] = (h & 1) ? ((h & 2) ? -8.0 : 8.0) / (M_PI * M_PI * k * k) : 0.0;
+                break;
+            default:
+                b[h] = h == 1 ? 1.0 : 0.0;
+                break;
+            }
+        }
+        wt = wavetable_build(a, b, top, size);
+    }
+    free(a);
+    free(b);
+    return wt ? wavetable_cache_insert(key, wt) : NULL;
+}
+
+/**
+ * Bank of wavetable oscillators running 4 voices per SIMD register. Each lane has its own phase,
+ * increment and table row (the mip level of its pitch), and the table is read with AVX2 gathers
+ * and linear or 4 point interpolation. The bank holds a reference to its wavetable.
+ */
+typedef struct wavetable_bank {
+    wavetable* table;
+    size_t num_voices;
+    size_t num_groups;     // vectors of 4 voices
+    double sample_rate;
+    int interpolation;     // DELAY_INTERP_*
+    double* phase;         // in cycles, [0, 1)
+    double* increment;     // cycles per sample
+    double* gain;
+    int32_t* row;          // offset of the selected level in table->data, for the gathers
+} wavetable_bank;
+
+/**
+ * Frees an oscillator bank and releases its wavetable.
+ *
+ * @param bank The oscillator bank, may be NULL.
+ */
+__declspec(dllexport) void wavetable_bank_destroy(wavetable_bank* bank) {
+    if (!bank) {
+        return;
+    }
+    wavetable_release(bank->table);
+    _mm_free(bank->phase);
+    _mm_free(bank->increment);
+    _mm_free(bank->gain);
+    _mm_free(bank->row);
+    free(bank);
+}
+
+/**
+ * Creates an oscillator bank. All voices start silent: frequency 0, phase 0, gain 1.
+ *
+ * @param table The wavetable, the bank takes its own reference.
+ * @param num_voices The number of voices.
+ * @param sample_rate The sample rate in Hz.
+ * @return The oscillator bank, or NULL if the allocation fails.
+ */
+__declspec(dllexport) wavetable_bank* wavetable_bank_create(wavetable* table, size_t num_voices, double sample_rate) {
+    if (!table || num_voices == 0) {
+        return NULL;
+    }
+    wavetable_bank* bank = (wavetable_bank*)calloc(1, sizeof(wavetable_bank));
+    if (!bank) {
+        return NULL;
+    }
+    bank->num_voices    = num_voices;
+    bank->num_groups    = (num_voices + 3) / 4;
+    bank->sample_rate   = sample_rate;
+    bank->interpolation = DELAY_INTERP_HERMITE;
+    const size_t lanes  = 4 * bank->num_groups;
+    bank->phase     = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->increment = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->gain      = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->row       = (int32_t*)_mm_malloc(lanes * sizeof(int32_t), ALIGN);
+    if (!bank->phase || !bank->increment || !bank->gain || !bank->row) {
+        wavetable_bank_destroy(bank);
+        return NULL;
+    }
+    wavetable_cache_lock();
+    ++table->refcount;
+    wavetable_cache_unlock();
+    bank->table = table;
+    for (size_t v = 0; v < lanes; ++v) {
+        bank->phase[v]     = 0.0;
+        bank->increment[v] = 0.0;
+        bank->gain[v]      = v < num_voices ? 1.0 : 0.0;
+        bank->row[v]       = 0;
+    }
+    return bank;
+}
+
+/**
+ * Sets the frequency of a voice and selects the mip level whose harmonics stay below Nyquist.
+ *
+ * @param bank The oscillator bank.
+ * @param voice The voice index.
+ * @param frequency The frequency in Hz, negative runs the cycle backwards.
+ */
+__declspec(dllexport) void wavetable_bank_set_frequency(wavetable_bank* bank, size_t voice, double frequency) {
+    if (voice >= bank->num_voices) {
+        return;
+    }
+    const wavetable* wt = bank->table;
+    const double increment = frequency / bank->sample_rate;
+    const double magnitude = fabs(increment);
+    size_t level = 0;
+    while (level + 1 < wt->num_levels && (double)(wt->top_harmonic >> level) * magnitude > 0.5) {
+        ++level;
+    }
+    bank->increment[voice] = increment;
+    bank->row[voice] = (int32_t)(level * wt->stride);
+}
+
+/**
+ * Sets the phase of a voice, e.g. to restart it on a note on.
+ *
+ * @param bank The oscillator bank.
+ * @param voice The voice index.
+ * @param phase The phase in cycles, wrapped to [0, 1).
+ */
+__declspec(dllexport) void wavetable_bank_set_phase(wavetable_bank* bank, size_t voice, double phase) {
+    if (voice < bank->num_voices) {
+        bank->phase[voice] = phase - floor(phase);
+    }
+}
+
+/**
+ * Sets the output gain of a voice.
+ *
+ * @param bank The oscillator bank.
+ * @param voice The voice index.
+ * @param gain The gain, 0 mutes the voice.
+ */
+__declspec(dllexport) void wavetable_bank_set_gain(wavetable_bank* bank, size_t voice, double gain) {
+    if (voice < bank->num_voices) {
+        bank->gain[voice] = gain;
+    }
+}
+
+/**
+ * Sets the table interpolation of all voices.
+ *
+ * @param bank The oscillator bank.
+ * @param interpolation DELAY_INTERP_LINEAR, DELAY_INTERP_HERMITE (default) or DELAY_INTERP_LAGRANGE.
+ */
+__declspec(dllexport) void wavetable_bank_set_interpolation(wavetable_bank* bank, int interpolation) {
+    bank->interpolation = interpolation;
+}
+
+// Renders 4 consecutive samples of the 4 voices of group g, y[t] holds sample t of every voice.
+static inline void wavetable_bank_render4(wavetable_bank* bank, size_t g, simde__m256d y[4]) {
+    const wavetable* wt = bank->table;
+    const double* data = wt->data + 1; // row[j] is x[j]
+    const simde__m256d vsize = simde_mm256_set1_pd((double)wt->size);
+    const simde__m256d vinc  = simde_mm256_load_pd(bank->increment + 4 * g);
+    const simde__m256d vgain = simde_mm256_load_pd(bank->gain + 4 * g);
+    const simde__m128i vrow  = simde_mm_load_si128((const simde__m128i*)(bank->row + 4 * g));
+    const simde__m128i vone  = simde_mm_set1_epi32(1);
+    simde__m256d phase = simde_mm256_load_pd(bank->phase + 4 * g);
+    for (int t = 0; t < 4; ++t) {
+        const simde__m256d pos = simde_mm256_mul_pd(phase, vsize);
+        const simde__m256d ip  = simde_mm256_floor_pd(pos);
+        const simde__m256d f   = simde_mm256_sub_pd(pos, ip);
+        const simde__m128i idx = simde_mm_add_epi32(simde_mm256_cvttpd_epi32(ip), vrow);
+        const simde__m256d x0 = simde_mm256_i32gather_pd(data, idx, 8);
+        const simde__m256d x1 = simde_mm256_i32gather_pd(data, simde_mm_add_epi32(idx, vone), 8);
+        simde__m256d v;
+        if (bank->interpolation == DELAY_INTERP_LINEAR) {
+            v = simde_mm256_fmadd_pd(f, simde_mm256_sub_pd(x1, x0), x0);
+        } else {
+            simde__m256d h[4];
+            interp_weights_pd(f, bank->interpolation, h);
+            const simde__m256d xm = simde_mm256_i32gather_pd(data, simde_mm_sub_epi32(idx, vone), 8);
+            const simde__m256d x2 = simde_mm256_i32gather_pd(data, simde_mm_add_epi32(idx, simde_mm_set1_epi32(2)), 8);
+            v = simde_mm256_mul_pd(h[0], xm);
+            v = simde_mm256_fmadd_pd(h[1], x0, v);
+            v = simde_mm256_fmadd_pd(h[2], x1, v);
+            v = simde_mm256_fmadd_pd(h[3], x2, v);
+        }
+        y[t] = simde_mm256_mul_pd(v, vgain);
+        phase = simde_mm256_add_pd(phase, vinc);
+        phase = simde_mm256_sub_pd(phase, simde_mm256_floor_pd(phase));
+    }
+    simde_mm256_storeu_pd(bank->phase + 4 * g, phase);
+}
+
+/**
+ * Renders every voice into its own row.
+ *
+ * @param bank The oscillator bank.
+ * @param result The output, voice v starts at result + v * stride. Aligned to ALIGN.
+ * @param stride The distance between the voice rows in samples, a multiple of 4.
+ * @param n The number of samples per voice, a multiple of 4.
+ */
+__declspec(dllexport) void wavetable_bank_process(wavetable_bank* bank, double* result, size_t stride, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t g = 0; g < bank->num_groups; ++g) {
+        const size_t voices = bank->num_voices - 4 * g < 4 ? bank->num_voices - 4 * g : 4;
+        for (size_t i = 0; i < n; i += 4) {
+            simde__m256d y[4];
+            wavetable_bank_render4(bank, g, y);
+            transpose4_pd(&y[0], &y[1], &y[2], &y[3]);
+            for (size_t l = 0; l < voices; ++l) {
+                simde_mm256_storeu_pd(_result + (4 * g + l) * stride + i, y[l]);
+            }
+        }
+    }
+}
+
+/**
+ * Renders the sum of all voices.
+ *
+ * @param bank The oscillator bank.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of samples, a multiple of 4.
+ */
+__declspec(dllexport) void wavetable_bank_process_mix(wavetable_bank* bank, double* result, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t i = 0; i < n; i += 4) {
+        simde_mm256_storeu_pd(_result + i, simde_mm256_setzero_pd());
+    }
+    for (size_t g = 0; g < bank->num_groups; ++g) {
+        for (size_t i = 0; i < n; i += 4) {
+            simde__m256d y[4];
+            wavetable_bank_render4(bank, g, y);
+            transpose4_pd(&y[0], &y[1], &y[2], &y[3]);
+            const simde__m256d sum = simde_mm256_add_pd(simde_mm256_add_pd(y[0], y[1]), simde_mm256_add_pd(y[2], y[3]));
+            simde_mm256_storeu_pd(_result + i, simde_mm256_add_pd(simde_mm256_load_pd(_result + i), sum));
+        }
+    }
+}
+
+/**
+ * Additive oscillator bank. Every partial is a unit phasor z = e^(i phi) advanced by a complex
+ * multiply with its rotor w = e^(i omega) per sample, its output is amplitude * Im(z), so a
+ * sinusoid costs two multiplies and two fmas per 4 partials instead of a sin call. Amplitudes and
+ * frequencies ramp linearly from their current values to the targets over each processed block;
+ * a frequency ramp rotates the rotor itself by e^(i d_omega) per sample. The phasors are
+ * renormalized after every block and the rotors re-derived from the targets, so rounding cannot
+ * accumulate into amplitude or pitch drift.
+ */
+typedef struct additive_bank {
+    size_t num_partials;
+    size_t num_groups;     // vectors of 4 partials
+    double sample_rate;
+    double* z_re;          // phasor
+    double* z_im;
+    double* w_re;          // rotor of the current frequency
+    double* w_im;
+    double* omega;         // current frequency in radians per sample
+    double* omega_target;
+    double* amplitude;
+    double* amplitude_target;
+} additive_bank;
+
+/**
+ * Frees an additive oscillator bank.
+ *
+ * @param bank The additive bank, may be NULL.
+ */
+__declspec(dllexport) void additive_bank_destroy(additive_bank* bank) {
+    if (!bank) {
+        return;
+    }
+    _mm_free(bank->z_re);
+    _mm_free(bank->z_im);
+    _mm_free(bank->w_re);
+    _mm_free(bank->w_im);
+    _mm_free(bank->omega);
+    _mm_free(bank->omega_target);
+    _mm_free(bank->amplitude);
+    _mm_free(bank->amplitude_target);
+    free(bank);
+}
+
+/**
+ * Restarts all partials at phase 0 with their target frequencies and amplitudes.
+ *
+ * @param bank The additive bank.
+ */
+__declspec(dllexport) void additive_bank_reset(additive_bank* bank) {
+    for (size_t k = 0; k < 4 * bank->num_groups; ++k) {
+        const simde_cfloat64 w = simde_math_cexp(SIMDE_MATH_CMPLX(0.0, bank->omega_target[k]));
+        bank->z_re[k] = 1.0;
+        bank->z_im[k] = 0.0;
+        bank->w_re[k] = simde_math_creal(w);
+        bank->w_im[k] = simde_math_cimag(w);
+        bank->omega[k] = bank->omega_target[k];
+        bank->amplitude[k] = bank->amplitude_target[k];
+    }
+}
+
+/**
+ * Creates an additive oscillator bank with all partials silent.
+ *
+ * @param num_partials The number of partials.
+ * @param sample_rate The sample rate in Hz.
+ * @return The additive bank, or NULL if the allocation fails.
+ */
+__declspec(dllexport) additive_bank* additive_bank_create(size_t num_partials, double sample_rate) {
+    if (num_partials == 0) {
+        return NULL;
+    }
+    additive_bank* bank = (additive_bank*)calloc(1, sizeof(additive_bank));
+    if (!bank) {
+        return NULL;
+    }
+    bank->num_partials = num_partials;
+    bank->num_groups   = (num_partials + 3) / 4;
+    bank->sample_rate  = sample_rate;
+    const size_t bytes = 4 * bank->num_groups * sizeof(double);
+    bank->z_re             = (double*)_mm_malloc(bytes, ALIGN);
+    bank->z_im             = (double*)_mm_malloc(bytes, ALIGN);
+    bank->w_re             = (double*)_mm_malloc(bytes, ALIGN);
+    bank->w_im             = (double*)_mm_malloc(bytes, ALIGN);
+    bank->omega            = (double*)_mm_malloc(bytes, ALIGN);
+    bank->omega_target     = (double*)_mm_malloc(bytes, ALIGN);
+    bank->amplitude        = (double*)_mm_malloc(bytes, ALIGN);
+    bank->amplitude_target = (double*)_mm_malloc(bytes, ALIGN);
+    if (!bank->z_re || !bank->z_im || !bank->w_re || !bank->w_im || !bank->omega ||
+        !bank->omega_target || !bank->amplitude || !bank->amplitude_target) {
+        additive_bank_destroy(bank);
+        return NULL;
+    }
+    memset(bank->omega_target, 0, bytes);
+    memset(bank->amplitude_target, 0, bytes);
+    additive_bank_reset(bank);
+    return bank;
+}
+
+/**
+ * Sets the target frequency and amplitude of a partial, reached by the end of the next block.
+ * Partials at or above Nyquist are silenced.
+ *
+ * @param bank The additive bank.
+ * @param partial The partial index.
+ * @param frequency The frequency in Hz.
+ * @param amplitude The peak amplitude.
+ */
+__declspec(dllexport) void additive_bank_set_partial(additive_bank* bank, size_t partial, double frequency, double amplitude) {
+    if (partial >= bank->num_partials) {
+        return;
+    }
+    const double omega = 2.0 * M_PI * frequency / bank->sample_rate;
+    const int audible = fabs(omega) < M_PI;
+    bank->omega_target[partial] = audible ? omega : 0.0;
+    bank->amplitude_target[partial] = audible ? amplitude : 0.0;
+}
+
+/**
+ * Sets the targets of the first count partials from arrays.
+ *
+ * @param bank The additive bank.
+ * @param frequencies The frequencies in Hz.
+ * @param amplitudes The peak amplitudes.
+ * @param count The number of partials to set, clamped to num_partials.
+ */
+__declspec(dllexport) void additive_bank_set_partials(additive_bank* bank, const double* frequencies, const double* amplitudes, size_t count) {
+    for (size_t k = 0; k < count && k < bank->num_partials; ++k) {
+        additive_bank_set_partial(bank, k, frequencies[k], amplitudes[k]);
+    }
+}
+
+/**
+ * Sets the phase of a partial immediately.
+ *
+ * @param bank The additive bank.
+ * @param partial The partial index.
+ * @param phase The phase in cycles, 0 starts the sine at zero.
+ */
+__declspec(dllexport) void additive_bank_set_phase(additive_bank* bank, size_t partial, double phase) {
+    if (partial < bank->num_partials) {
+        const simde_cfloat64 z = simde_math_cexp(SIMDE_MATH_CMPLX(0.0, 2.0 * M_PI * (phase - floor(phase))));
+        bank->z_re[partial] = simde_math_creal(z);
+        bank->z_im[partial] = simde_math_cimag(z);
+    }
+}
+
+/**
+ * Renders all partials and adds their sum to the result, ramping every partial linearly from its
+ * current frequency and amplitude to its target over the block.
+ *
+ * @param bank The additive bank.
+ * @param result The output vector accumulated into, aligned to ALIGN.
+ * @param n The number of samples, a multiple of 4.
+ */
+__declspec(dllexport) void additive_bank_process(additive_bank* bank, double* result, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    if (n == 0) {
+        return;
+    }
+    const simde__m256d vn = simde_mm256_set1_pd((double)n);
+    for (size_t g = 0; g < bank->num_groups; ++g) {
+        const size_t o = 4 * g;
+        simde__m256d z_re = simde_mm256_load_pd(bank->z_re + o);
+        simde__m256d z_im = simde_mm256_load_pd(bank->z_im + o);
+        simde__m256d w_re = simde_mm256_load_pd(bank->w_re + o);
+        simde__m256d w_im = simde_mm256_load_pd(bank->w_im + o);
+        simde__m256d amp  = simde_mm256_load_pd(bank->amplitude + o);
+        const simde__m256d amp_step = simde_mm256_div_pd(simde_mm256_sub_pd(simde_mm256_load_pd(bank->amplitude_target + o), amp), vn);
+
+        // rotor of the rotor for frequency ramps
+        int sweep = 0;
+        double d_re[4], d_im[4];
+        for (size_t l = 0; l < 4; ++l) {
+            const double step = (bank->omega_target[o + l] - bank->omega[o + l]) / (double)n;
+            const simde_cfloat64 d = simde_math_cexp(SIMDE_MATH_CMPLX(0.0, step));
+            d_re[l] = simde_math_creal(d);
+            d_im[l] = simde_math_cimag(d);
+            sweep |= step != 0.0;
+        }
+        const simde__m256d vd_re = simde_mm256_loadu_pd(d_re);
+        const simde__m256d vd_im = simde_mm256_loadu_pd(d_im);
+
+        for (size_t i = 0; i < n; i += 4) {
+            simde__m256d y[4];
+            for (int t = 0; t < 4; ++t) {
+                y[t] = simde_mm256_mul_pd(amp, z_im);
+                // z *= w
+                const simde__m256d re = simde_mm256_fmsub_pd(z_re, w_re, simde_mm256_mul_pd(z_im, w_im));
+                z_im = simde_mm256_fmadd_pd(z_re, w_im, simde_mm256_mul_pd(z_im, w_re));
+                z_re = re;
+                amp = simde_mm256_add_pd(amp, amp_step);
+                if (sweep) {
+                    // w *= d
+                    const simde__m256d wr = simde_mm256_fmsub_pd(w_re, vd_re, simde_mm256_mul_pd(w_im, vd_im));
+                    w_im = simde_mm256_fmadd_pd(w_re, vd_im, simde_mm256_mul_pd(w_im, vd_re));
+                    w_re = wr;
+                }
+            }
+            // lanes are partials: transpose to time and sum the 4 partials
+            transpose4_pd(&y[0], &y[1], &y[2], &y[3]);
+            const simde__m256d sum = simde_mm256_add_pd(simde_mm256_add_pd(y[0], y[1]), simde_mm256_add_pd(y[2], y[3]));
+            simde_mm256_storeu_pd(_result + i, simde_mm256_add_pd(simde_mm256_load_pd(_result + i), sum));
+        }
+
+        // one Newton step towards |z| = 1: z *= (3 - |z|^2) / 2
+        const simde__m256d norm = simde_mm256_fmadd_pd(z_re, z_re, simde_mm256_mul_pd(z_im, z_im));
+        const simde__m256d scale = simde_mm256_fnmadd_pd(simde_mm256_set1_pd(0.5), norm, simde_mm256_set1_pd(1.5));
+        simde_mm256_storeu_pd(bank->z_re + o, simde_mm256_mul_pd(z_re, scale));
+        simde_mm256_storeu_pd(bank->z_im + o, simde_mm256_mul_pd(z_im, scale));
+        for (size_t l = 0; l < 4; ++l) {
+            if (bank->omega[o + l] != bank->omega_target[o + l]) {
+                const simde_cfloat64 w = simde_math_cexp(SIMDE_MATH_CMPLX(0.0, bank->omega_target[o + l]));
+                bank->w_re[o + l] = simde_math_creal(w);
+                bank->w_im[o + l] = simde_math_cimag(w);
+                bank->omega[o + l] = bank->omega_target[o + l];
+            }
+            bank->amplitude[o + l] = bank->amplitude_target[o + l];
+        }
+    }
+}
+
+/**
+ * Waveforms of the polyBLEP oscillator bank.
+ */
+enum {
+    BLEP_SAW      = 0, // rising, -1 to 1
+    BLEP_SQUARE   = 1, // pulse, 1 for the first pulse width of the cycle and -1 after
+    BLEP_TRIANGLE = 2  // -1 at phase 0, 1 at phase 1/2
+};
+
+/**
+ * Bank of classic oscillators with 2 point polyBLEP (steps) and polyBLAMP (slope changes)
+ * correction, 4 voices per register. Every correction is evaluated for all lanes and selected
+ * with compare masks, so there are no per-sample branches. Hard sync runs a master phase per
+ * voice; when it will wrap before the next sample, the jump of the slave is known one sample
+ * ahead, so the current sample gets the pre-step half of the BLEP and the post-step half is kept
+ * for the next sample.
+ */
+typedef struct blep_bank {
+    size_t num_voices;
+    size_t num_groups;     // vectors of 4 voices
+    double sample_rate;
+    int shape;
+    double* phase;         // in cycles, [0, 1)
+    double* increment;     // cycles per sample, [0, 0.5)
+    double* pulse_width;
+    double* gain;
+    double* sync_phase;    // master phase of the hard sync
+    double* sync_increment; // 0 disables hard sync
+    double* pending;       // post-step half of a sync BLEP, added to the next sample
+    double* restarted;     // all bits set if the last sample restarted the phase by sync
+} blep_bank;
+
+/**
+ * Frees a polyBLEP oscillator bank.
+ *
+ * @param bank The oscillator bank, may be NULL.
+ */
+__declspec(dllexport) void blep_bank_destroy(blep_bank* bank) {
+    if (!bank) {
+        return;
+    }
+    _mm_free(bank->phase);
+    _mm_free(bank->increment);
+    _mm_free(bank->pulse_width);
+    _mm_free(bank->gain);
+    _mm_free(bank->sync_phase);
+    _mm_free(bank->sync_increment);
+    _mm_free(bank->pending);
+    _mm_free(bank->restarted);
+    free(bank);
+}
+
+/**
+ * Creates a polyBLEP oscillator bank. All voices start as a saw at frequency 0 (a constant),
+ * pulse width 1/2, gain 1, no sync.
+ *
+ * @param num_voices The number of voices.
+ * @param sample_rate The sample rate in Hz.
+ * @return The oscillator bank, or NULL if the allocation fails.
+ */
+__declspec(dllexport) blep_bank* blep_bank_create(size_t num_voices, double sample_rate) {
+    if (num_voices == 0) {
+        return NULL;
+    }
+    blep_bank* bank = (blep_bank*)calloc(1, sizeof(blep_bank));
+    if (!bank) {
+        return NULL;
+    }
+    bank->num_voices  = num_voices;
+    bank->num_groups  = (num_voices + 3) / 4;
+    bank->sample_rate = sample_rate;
+    bank->shape       = BLEP_SAW;
+    const size_t lanes = 4 * bank->num_groups;
+    bank->phase          = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->increment      = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->pulse_width    = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->gain           = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->sync_phase     = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->sync_increment = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->pending        = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->restarted      = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    if (!bank->phase || !bank->increment || !bank->pulse_width || !bank->gain ||
+        !bank->sync_phase || !bank->sync_increment || !bank->pending || !bank->restarted) {
+        blep_bank_destroy(bank);
+        return NULL;
+    }
+    for (size_t v = 0; v < lanes; ++v) {
+        bank->phase[v]          = 0.0;
+        bank->increment[v]      = 0.0;
+        bank->pulse_width[v]    = 0.5;
+        bank->gain[v]           = v < num_voices ? 1.0 : 0.0;
+        bank->sync_phase[v]     = 0.0;
+        bank->sync_increment[v] = 0.0;
+        bank->pending[v]        = 0.0;
+        bank->restarted[v]      = 0.0;
+    }
+    return bank;
+}
+
+/**
+ * Sets the waveform of all voices.
+ *
+ * @param bank The oscillator bank.
+ * @param shape BLEP_SAW, BLEP_SQUARE or BLEP_TRIANGLE.
+ */
+__declspec(dllexport) void blep_bank_set_shape(blep_bank* bank, int shape) {
+    bank->shape = shape;
+}
+
+// Clamps a frequency in Hz to an increment in [0, 0.5) cycles per sample.
+static double blep_increment(const blep_bank* bank, double frequency) {
+    const double increment = frequency / bank->sample_rate;
+    return increment < 0.0 ? 0.0 : increment > 0.499 ? 0.499 : increment;
+}
+
+/**
+ * Sets the frequency of a voice.
+ *
+ * @param bank The oscillator bank.
+ * @param voice The voice index.
+ * @param frequency The frequency in Hz, clamped to [0, Nyquist).
+ */
+__declspec(dllexport) void blep_bank_set_frequency(blep_bank* bank, size_t voice, double frequency) {
+    if (voice < bank->num_voices) {
+        bank->increment[voice] = blep_increment(bank, frequency);
+    }
+}
+
+/**
+ * Sets the phase of a voice and of its sync master, e.g. to restart it on a note on.
+ *
+ * @param bank The oscillator bank.
+ * @param voice The voice index.
+ * @param phase The phase in cycles, wrapped to [0, 1).
+ */
+__declspec(dllexport) void blep_bank_set_phase(blep_bank* bank, size_t voice, double phase) {
+    if (voice < bank->num_voices) {
+        bank->phase[voice] = phase - floor(phase);
+        bank->sync_phase[voice] = 0.0;
+        bank->pending[voice] = 0.0;
+        bank->restarted[voice] = 0.0;
+    }
+}
+
+/**
+ * Sets the pulse width of a voice, used by BLEP_SQUARE.
+ *
+ * @param bank The oscillator bank.
+ * @param voice The voice index.
+ * @param pulse_width The high part of the cycle, clamped to [0.01, 0.99].
+ */
+__declspec(dllexport) void blep_bank_set_pulse_width(blep_bank* bank, size_t voice, double pulse_width) {
+    if (voice < bank->num_voices) {
+        bank->pulse_width[voice] = pulse_width < 0.01 ? 0.01 : pulse_width > 0.99 ? 0.99 : pulse_width;
+    }
+}
+
+/**
+ * Enables hard sync of a voice: its phase restarts whenever a master oscillator at the given
+ * frequency starts a new cycle.
+ *
+ * @param bank The oscillator bank.
+ * @param voice The voice index.
+ * @param master_frequency The master frequency in Hz, 0 disables hard sync.
+ */
+__declspec(dllexport) void blep_bank_set_sync(blep_bank* bank, size_t voice, double master_frequency) {
+    if (voice < bank->num_voices) {
+        bank->sync_increment[voice] = blep_increment(bank, master_frequency);
+    }
+}
+
+/**
+ * Sets the output gain of a voice.
+ *
+ * @param bank The oscillator bank.
+ * @param voice The voice index.
+ * @param gain The gain, 0 mutes the voice.
+ */
+__declspec(dllexport) void blep_bank_set_gain(blep_bank* bank, size_t voice, double gain) {
+    if (voice < bank->num_voices) {
+        bank->gain[voice] = gain;
+    }
+}
+
+// Fractional part, x - floor(x).
+static inline simde__m256d frac_pd(simde__m256d x) {
+    return simde_mm256_sub_pd(x, simde_mm256_floor_pd(x));
+}
+
+// Residual of a unit step at phase 0: (1 + u)^2 / 2 in the sample before, -(1 - u)^2 / 2 in the sample after, u = distance in samples.
+static inline simde__m256d blep_residual_pd(simde__m256d t, simde__m256d dt, simde__m256d inv_dt) {
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    const simde__m256d half = simde_mm256_set1_pd(0.5);
+    const simde__m256d after = simde_mm256_cmp_pd(t, dt, SIMDE_CMP_LT_OQ);
+    const simde__m256d before = simde_mm256_cmp_pd(t, simde_mm256_sub_pd(one, dt), SIMDE_CMP_GT_OQ);
+    const simde__m256d a = simde_mm256_fnmadd_pd(t, inv_dt, one);                                 // 1 - u after
+    const simde__m256d b = simde_mm256_fmadd_pd(simde_mm256_sub_pd(t, one), inv_dt, one);         // 1 + u before
+    const simde__m256d ra = simde_mm256_mul_pd(simde_mm256_mul_pd(a, a), simde_mm256_xor_pd(half, simde_mm256_set1_pd(-0.0)));
+    const simde__m256d rb = simde_mm256_mul_pd(simde_mm256_mul_pd(b, b), half);
+    return simde_mm256_or_pd(simde_mm256_and_pd(after, ra), simde_mm256_and_pd(before, rb));
+}
+
+// Residual of a unit slope change at phase 0 (integrated BLEP): (1 + u)^3 / 6 before, (1 - u)^3 / 6 after, in samples.
+static inline simde__m256d blamp_residual_pd(simde__m256d t, simde__m256d dt, simde__m256d inv_dt) {
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    const simde__m256d sixth = simde_mm256_set1_pd(1.0 / 6.0);
+    const simde__m256d after = simde_mm256_cmp_pd(t, dt, SIMDE_CMP_LT_OQ);
+    const simde__m256d before = simde_mm256_cmp_pd(t, simde_mm256_sub_pd(one, dt), SIMDE_CMP_GT_OQ);
+    const simde__m256d a = simde_mm256_fnmadd_pd(t, inv_dt, one);
+    const simde__m256d b = simde_mm256_fmadd_pd(simde_mm256_sub_pd(t, one), inv_dt, one);
+    const simde__m256d ra = simde_mm256_mul_pd(simde_mm256_mul_pd(simde_mm256_mul_pd(a, a), a), sixth);
+    const simde__m256d rb = simde_mm256_mul_pd(simde_mm256_mul_pd(simde_mm256_mul_pd(b, b), b), sixth);
+    return simde_mm256_or_pd(simde_mm256_and_pd(after, ra), simde_mm256_and_pd(before, rb));
+}
+
+// The trivial (aliasing) waveform at phase t.
+static inline simde__m256d blep_naive_pd(int shape, simde__m256d t, simde__m256d pw) {
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    if (shape == BLEP_SQUARE) {
+        return simde_mm256_blendv_pd(simde_mm256_xor_pd(one, simde_mm256_set1_pd(-0.0)), one, simde_mm256_cmp_pd(t, pw, SIMDE_CMP_LT_OQ));
+    }
+    if (shape == BLEP_TRIANGLE) {
+        // 1 - 4 |t - 1/2|
+        const simde__m256d d = simde_mm256_andnot_pd(simde_mm256_set1_pd(-0.0), simde_mm256_sub_pd(t, simde_mm256_set1_pd(0.5)));
+        return simde_mm256_fnmadd_pd(simde_mm256_set1_pd(4.0), d, one);
+    }
+    return simde_mm256_fmsub_pd(simde_mm256_set1_pd(2.0), t, one);
+}
+
+// Renders 4 consecutive samples of the 4 voices of group g, y[t] holds sample t of every voice.
+static inline void blep_bank_render4(blep_bank* bank, size_t g, simde__m256d y[4]) {
+    const size_t o = 4 * g;
+    const int shape = bank->shape;
+    const simde__m256d one  = simde_mm256_set1_pd(1.0);
+    const simde__m256d half = simde_mm256_set1_pd(0.5);
+    const simde__m256d zero = simde_mm256_setzero_pd();
+    const simde__m256d dt   = simde_mm256_load_pd(bank->increment + o);
+    // silent voices get an infinite 1/dt, the masks keep it out of the result
+    const simde__m256d inv_dt = simde_mm256_div_pd(one, dt);
+    const simde__m256d pw   = simde_mm256_load_pd(bank->pulse_width + o);
+    const simde__m256d gain = simde_mm256_load_pd(bank->gain + o);
+    const simde__m256d sync_dt = simde_mm256_load_pd(bank->sync_increment + o);
+    const simde__m256d synced = simde_mm256_cmp_pd(sync_dt, zero, SIMDE_CMP_GT_OQ);
+    const simde__m256d head = blep_naive_pd(shape, zero, pw);
+    simde__m256d phase   = simde_mm256_load_pd(bank->phase + o);
+    simde__m256d master  = simde_mm256_load_pd(bank->sync_phase + o);
+    simde__m256d pending = simde_mm256_load_pd(bank->pending + o);
+    simde__m256d restarted = simde_mm256_load_pd(bank->restarted + o);
+
+    for (int s = 0; s < 4; ++s) {
+        // hard sync: will the master wrap before the next sample, and where
+        const simde__m256d master_next = simde_mm256_add_pd(master, sync_dt);
+        const simde__m256d reset = simde_mm256_and_pd(synced, simde_mm256_cmp_pd(master_next, one, SIMDE_CMP_GE_OQ));
+        const simde__m256d lead = simde_mm256_div_pd(simde_mm256_sub_pd(one, master), simde_mm256_blendv_pd(one, sync_dt, synced)); // samples until the reset
+        const simde__m256d lag = simde_mm256_sub_pd(one, lead);                                                                   // samples after it
+        const simde__m256d run_to = simde_mm256_fmadd_pd(lead, dt, phase);
+        const simde__m256d at_reset = frac_pd(run_to);
+
+        // the own step at phase 0 is void right after a restart, and when the restart comes before it
+        const simde__m256d early = simde_mm256_cmp_pd(phase, half, SIMDE_CMP_LT_OQ);
+        const simde__m256d void0 = simde_mm256_or_pd(simde_mm256_and_pd(restarted, early),
+            simde_mm256_andnot_pd(early, simde_mm256_and_pd(reset, simde_mm256_cmp_pd(run_to, one, SIMDE_CMP_LT_OQ))));
+
+        simde__m256d v = simde_mm256_add_pd(blep_naive_pd(shape, phase, pw), pending);
+        if (shape == BLEP_SQUARE) {
+            // up step of 2 at phase 0, down step of 2 at the pulse width
+            const simde__m256d up = simde_mm256_andnot_pd(void0, blep_residual_pd(phase, dt, inv_dt));
+            const simde__m256d down = blep_residual_pd(frac_pd(simde_mm256_sub_pd(phase, pw)), dt, inv_dt);
+            v = simde_mm256_fmadd_pd(simde_mm256_set1_pd(2.0), simde_mm256_sub_pd(up, down), v);
+        } else if (shape == BLEP_TRIANGLE) {
+            // slope changes of +8 and -8 per cycle at phase 0 and 1/2, 8 dt per sample
+            const simde__m256d bottom = simde_mm256_andnot_pd(void0, blamp_residual_pd(phase, dt, inv_dt));
+            const simde__m256d top = blamp_residual_pd(frac_pd(simde_mm256_add_pd(phase, half)), dt, inv_dt);
+            v = simde_mm256_fmadd_pd(simde_mm256_mul_pd(simde_mm256_set1_pd(8.0), dt), simde_mm256_sub_pd(bottom, top), v);
+        } else {
+            const simde__m256d wrap = simde_mm256_andnot_pd(void0, blep_residual_pd(phase, dt, inv_dt));
+            v = simde_mm256_fnmadd_pd(simde_mm256_set1_pd(2.0), wrap, v);
+        }
+
+        // the restart jumps from the value at the reset to the value at phase 0:
+        // (h / 2)(1 - lead)^2 before the step, -(h / 2)(1 - lag)^2 after it
+        const simde__m256d h = simde_mm256_sub_pd(head, blep_naive_pd(shape, at_reset, pw));
+        const simde__m256d hh = simde_mm256_mul_pd(h, half);
+        v = simde_mm256_add_pd(v, simde_mm256_and_pd(reset, simde_mm256_mul_pd(hh, simde_mm256_mul_pd(lag, lag))));
+        pending = simde_mm256_and_pd(reset, simde_mm256_mul_pd(simde_mm256_xor_pd(hh, simde_mm256_set1_pd(-0.0)), simde_mm256_mul_pd(lead, lead)));
+        restarted = reset;
+
+        y[s] = simde_mm256_mul_pd(v, gain);
+        phase = simde_mm256_blendv_pd(frac_pd(simde_mm256_add_pd(phase, dt)), simde_mm256_mul_pd(lag, dt), reset);
+        master = simde_mm256_blendv_pd(master_next, simde_mm256_sub_pd(master_next, one), reset);
+    }
+    simde_mm256_storeu_pd(bank->phase + o, phase);
+    simde_mm256_storeu_pd(bank->sync_phase + o, master);
+    simde_mm256_storeu_pd(bank->pending + o, pending);
+    simde_mm256_storeu_pd(bank->restarted + o, restarted);
+}
+
+/**
+ * Renders every voice into its own row.
+ *
+ * @param bank The oscillator bank.
+ * @param result The output, voice v starts at result + v * stride. Aligned to ALIGN.
+ * @param stride The distance between the voice rows in samples, a multiple of 4.
+ * @param n The number of samples per voice, a multiple of 4.
+ */
+__declspec(dllexport) void blep_bank_process(blep_bank* bank, double* result, size_t stride, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t g = 0; g < bank->num_groups; ++g) {
+        const size_t voices = bank->num_voices - 4 * g < 4 ? bank->num_voices - 4 * g : 4;
+        for (size_t i = 0; i < n; i += 4) {
+            simde__m256d y[4];
+            blep_bank_render4(bank, g, y);
+            transpose4_pd(&y[0], &y[1], &y[2], &y[3]);
+            for (size_t l = 0; l < voices; ++l) {
+                simde_mm256_storeu_pd(_result + (4 * g + l) * stride + i, y[l]);
+            }
+        }
+    }
+}
+
+/**
+ * Renders the sum of all voices.
+ *
+ * @param bank The oscillator bank.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of samples, a multiple of 4.
+ */
+__declspec(dllexport) void blep_bank_process_mix(blep_bank* bank, double* result, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t i = 0; i < n; i += 4) {
+        simde_mm256_storeu_pd(_result + i, simde_mm256_setzero_pd());
+    }
+    for (size_t g = 0; g < bank->num_groups; ++g) {
+        for (size_t i = 0; i < n; i += 4) {
+            simde__m256d y[4];
+            blep_bank_render4(bank, g, y);
+            transpose4_pd(&y[0], &y[1], &y[2], &y[3]);
+            const simde__m256d sum = simde_mm256_add_pd(simde_mm256_add_pd(y[0], y[1]), simde_mm256_add_pd(y[2], y[3]));
+            simde_mm256_storeu_pd(_result + i, simde_mm256_add_pd(simde_mm256_load_pd(_result + i), sum));
+        }
+    }
+}
+
+/**
+ * Lanes of the voice engine state, see voice_engine_get_field.
+ */
+enum {
+    VOICE_FIELD_PHASE     = 0, // oscillator phase in cycles, [0, 1)
+    VOICE_FIELD_INCREMENT = 1, // oscillator increment in cycles per sample, [0, 0.5)
+    VOICE_FIELD_GAIN      = 2, // velocity gain
+    VOICE_FIELD_CUTOFF    = 3, // one-pole filter coefficient g / (1 + g), g = tan(pi fc / fs)
+    VOICE_FIELD_LEVEL     = 4, // envelope level
+    VOICE_FIELD_STAGE     = 5, // envelope stage, VOICE_IDLE to VOICE_RELEASE
+    VOICE_FIELD_COUNT     = 6
+};
+
+/**
+ * Envelope stages of a voice. Decay and sustain share a stage: the level approaches the sustain
+ * level exponentially.
+ */
+enum {
+    VOICE_IDLE    = 0,
+    VOICE_ATTACK  = 1,
+    VOICE_DECAY   = 2,
+    VOICE_RELEASE = 3
+};
+
+#define VOICE_ATTACK_TARGET 1.2 // the attack aims past 1 and stops there, like an analog envelope
+#define VOICE_SILENCE 1e-4      // -80 dB, a releasing voice below this is finished
+
+/**
+ * Polyphonic voice container with the state of all voices in struct-of-arrays layout: a polyBLEP
+ * saw into a 2 pole (2 cascaded one-pole) lowpass, shaped by an exponential ADSR. Live voices are
+ * kept compacted in slots [0, active): a finished voice is replaced by the last live one, so every
+ * SIMD pass runs over (active + 3) / 4 registers and never touches dead lanes beyond the last
+ * register. Slots move on compaction, voices are addressed by the caller's id (e.g. a note number).
+ */
+typedef struct voice_engine {
+    size_t max_voices;
+    size_t active;           // live voices, in slots [0, active)
+    double sample_rate;
+    uint64_t clock;          // note on counter, orders the voices by age
+    double attack_coeff;     // per sample one-pole coefficients of the envelope segments
+    double decay_coeff;
+    double release_coeff;
+    double sustain;
+    int* id;                 // caller id of the voice in each slot
+    uint64_t* started;       // clock at note on
+    double* field[VOICE_FIELD_COUNT]; // SoA lanes, 4 * ceil(max_voices / 4) each
+    double* filter1;         // state of the first filter pole
+    double* filter2;         // state of the second filter pole
+} voice_engine;
+
+/**
+ * Frees a voice engine.
+ *
+ * @param engine The voice engine, may be NULL.
+ */
+__declspec(dllexport) void voice_engine_destroy(voice_engine* engine) {
+    if (!engine) {
+        return;
+    }
+    for (int f = 0; f < VOICE_FIELD_COUNT; ++f) {
+        _mm_free(engine->field[f]);
+    }
+    _mm_free(engine->filter1);
+    _mm_free(engine->filter2);
+    free(engine->id);
+    free(engine->started);
+    free(engine);
+}
+
+// Puts a slot into the silent idle state, so a padding lane contributes nothing.
+static void voice_engine_clear_slot(voice_engine* engine, size_t slot) {
+    engine->id[slot] = -1;
+    engine->started[slot] = 0;
+    engine->field[VOICE_FIELD_PHASE][slot]     = 0.0;
+    engine->field[VOICE_FIELD_INCREMENT][slot] = 0.0;
+    engine->field[VOICE_FIELD_GAIN][slot]      = 0.0;
+    engine->field[VOICE_FIELD_CUTOFF][slot]    = 0.5;
+    engine->field[VOICE_FIELD_LEVEL][slot]     = 0.0;
+    engine->field[VOICE_FIELD_STAGE][slot]     = VOICE_IDLE;
+    engine->filter1[slot] = 0.0;
+    engine->filter2[slot] = 0.0;
+}
+
+// Per sample coefficient of an exponential segment that covers a factor of `span` in time_ms.
+static double voice_engine_coeff(double sample_rate, double time_ms, double span) {
+    return time_ms > 0.0 ? 1.0 - exp(-log(span) * 1000.0 / (time_ms * sample_rate)) : 1.0;
+}
+
+/**
+ * Sets the envelope of all voices. Times are measured like on analog synths: the attack time
+ * reaches full level, decay and release times fall by 80 dB.
+ *
+ * @param engine The voice engine.
+ * @param attack_ms The attack time in milliseconds.
+ * @param decay_ms The decay time in milliseconds.
+ * @param sustain The sustain level, 0 to 1.
+ * @param release_ms The release time in milliseconds.
+ */
+__declspec(dllexport) void voice_engine_set_envelope(voice_engine* engine, double attack_ms, double decay_ms, double sustain, double release_ms) {
+    const double sr = engine->sample_rate;
+    engine->attack_coeff  = voice_engine_coeff(sr, attack_ms, VOICE_ATTACK_TARGET / (VOICE_ATTACK_TARGET - 1.0));
+    engine->decay_coeff   = voice_engine_coeff(sr, decay_ms, 1.0 / VOICE_SILENCE);
+    engine->release_coeff = voice_engine_coeff(sr, release_ms, 1.0 / VOICE_SILENCE);
+    engine->sustain       = sustain < 0.0 ? 0.0 : sustain > 1.0 ? 1.0 : sustain;
+}
+
+/**
+ * Creates a voice engine without live voices. The envelope defaults to 5 ms attack, 200 ms decay,
+ * sustain 0.7 and 300 ms release.
+ *
+ * @param max_voices The polyphony, further note ons steal a voice.
+ * @param sample_rate The sample rate in Hz.
+ * @return The voice engine, or NULL if the allocation fails.
+ */
+__declspec(dllexport) voice_engine* voice_engine_create(size_t max_voices, double sample_rate) {
+    if (max_voices == 0) {
+        return NULL;
+    }
+    voice_engine* engine = (voice_engine*)calloc(1, sizeof(voice_engine));
+    if (!engine) {
+        return NULL;
+    }
+    engine->max_voices  = max_voices;
+    engine->sample_rate = sample_rate;
+    const size_t lanes = (max_voices + 3) & ~(size_t)3;
+    int failed = 0;
+    for (int f = 0; f < VOICE_FIELD_COUNT; ++f) {
+        engine->field[f] = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+        failed |= !engine->field[f];
+    }
+    engine->filter1 = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    engine->filter2 = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    engine->id      = (int*)malloc(lanes * sizeof(int));
+    engine->started = (uint64_t*)malloc(lanes * sizeof(uint64_t));
+    if (failed || !engine->filter1 || !engine->filter2 || !engine->id || !engine->started) {
+        voice_engine_destroy(engine);
+        return NULL;
+    }
+    for (size_t v = 0; v < lanes; ++v) {
+        voice_engine_clear_slot(engine, v);
+    }
+    voice_engine_set_envelope(engine, 5.0, 200.0, 0.7, 300.0);
+    return engine;
+}
+
+/**
+ * Silences all voices at once.
+ *
+ * @param engine The voice engine.
+ */
+__declspec(dllexport) void voice_engine_reset(voice_engine* engine) {
+    for (size_t v = 0; v < engine->active; ++v) {
+        voice_engine_clear_slot(engine, v);
+    }
+    engine->active = 0;
+}
+
+// Removes the voice in slot by moving the last live voice into it.
+static void voice_engine_free_slot(voice_engine* engine, size_t slot) {
+    const size_t last = engine->active - 1;
+    if (slot != last) {
+        engine->id[slot] = engine->id[last];
+        engine->started[slot] = engine->started[last];
+        for (int f = 0; f < VOICE_FIELD_COUNT; ++f) {
+            engine->field[f][slot] = engine->field[f][last];
+        }
+        engine->filter1[slot] = engine->filter1[last];
+        engine->filter2[slot] = engine->filter2[last];
+    }
+    voice_engine_clear_slot(engine, last);
+    engine->active = last;
+}
+
+// Slot of the live voice with id, -1 if there is none.
+static ptrdiff_t voice_engine_find(const voice_engine* engine, int id) {
+    for (size_t v = 0; v < engine->active; ++v) {
+        if (engine->id[v] == id) {
+            return (ptrdiff_t)v;
+        }
+    }
+    return -1;
+}
+
+// The voice to steal: the oldest releasing voice, else the oldest voice.
+static size_t voice_engine_victim(const voice_engine* engine) {
+    size_t victim = 0;
+    int releasing = 0;
+    for (size_t v = 0; v < engine->active; ++v) {
+        const int r = engine->field[VOICE_FIELD_STAGE][v] == VOICE_RELEASE;
+        if ((r && !releasing) || (r == releasing && engine->started[v] < engine->started[victim])) {
+            victim = v;
+            releasing = r;
+        }
+    }
+    return victim;
+}
+
+// One-pole coefficient g / (1 + g) of a cutoff frequency, clamped below Nyquist.
+static double voice_engine_cutoff(const voice_engine* engine, double frequency) {
+    const double f = frequency < 1.0 ? 1.0 : frequency > 0.49 * engine->sample_rate ? 0.49 * engine->sample_rate : frequency;
+    const double g = tan(3.14159265358979323846 * f / engine->sample_rate);
+    return g / (1.0 + g);
+}
+
+// Oscillator increment of a frequency, clamped to [0, 0.5) cycles per sample.
+static double voice_engine_increment(const voice_engine* engine, double frequency) {
+    const double increment = frequency / engine->sample_rate;
+    return increment < 0.0 ? 0.0 : increment > 0.499 ? 0.499 : increment;
+}
+
+/**
+ * Starts a voice. A live voice with the same id is retriggered from its current level; otherwise
+ * a free slot is used, or, when all voices are busy, the oldest releasing voice (else the oldest
+ * voice) is stolen.
+ *
+ * @param engine The voice engine.
+ * @param id The caller's id of the voice, e.g. the note number, not -1.
+ * @param frequency The oscillator frequency in Hz.
+ * @param velocity The voice gain.
+ * @param cutoff The lowpass cutoff in Hz.
+ * @return The id of the stolen voice, or -1 if no voice was stolen.
+ */
+__declspec(dllexport) int voice_engine_note_on(voice_engine* engine, int id, double frequency, double velocity, double cutoff) {
+    int stolen = -1;
+    ptrdiff_t slot = voice_engine_find(engine, id);
+    if (slot < 0) {
+        if (engine->active == engine->max_voices) {
+            // the stolen voice restarts from silence, its own filter state would click anyway
+            slot = (ptrdiff_t)voice_engine_victim(engine);
+            stolen = engine->id[slot];
+            voice_engine_clear_slot(engine, (size_t)slot);
+        } else {
+            slot = (ptrdiff_t)engine->active++;
+        }
+    }
+    engine->id[slot] = id;
+    engine->started[slot] = ++engine->clock;
+    engine->field[VOICE_FIELD_INCREMENT][slot] = voice_engine_increment(engine, frequency);
+    engine->field[VOICE_FIELD_GAIN][slot]      = velocity;
+    engine->field[VOICE_FIELD_CUTOFF][slot]    = voice_engine_cutoff(engine, cutoff);
+    engine->field[VOICE_FIELD_STAGE][slot]     = VOICE_ATTACK;
+    return stolen;
+}
+
+/**
+ * Releases a voice, it is freed once the release has faded out.
+ *
+ * @param engine The voice engine.
+ * @param id The caller's id of the voice, unknown ids are ignored.
+ */
+__declspec(dllexport) void voice_engine_note_off(voice_engine* engine, int id) {
+    const ptrdiff_t slot = voice_engine_find(engine, id);
+    if (slot >= 0) {
+        engine->field[VOICE_FIELD_STAGE][slot] = VOICE_RELEASE;
+    }
+}
+
+/**
+ * Changes the frequency of a live voice, e.g. for pitch bend or glide.
+ *
+ * @param engine The voice engine.
+ * @param id The caller's id of the voice, unknown ids are ignored.
+ * @param frequency The oscillator frequency in Hz.
+ */
+__declspec(dllexport) void voice_engine_set_frequency(voice_engine* engine, int id, double frequency) {
+    const ptrdiff_t slot = voice_engine_find(engine, id);
+    if (slot >= 0) {
+        engine->field[VOICE_FIELD_INCREMENT][slot] = voice_engine_increment(engine, frequency);
+    }
+}
+
+/**
+ * Changes the lowpass cutoff of a live voice.
+ *
+ * @param engine The voice engine.
+ * @param id The caller's id of the voice, unknown ids are ignored.
+ * @param cutoff The cutoff in Hz.
+ */
+__declspec(dllexport) void voice_engine_set_cutoff(voice_engine* engine, int id, double cutoff) {
+    const ptrdiff_t slot = voice_engine_find(engine, id);
+    if (slot >= 0) {
+        engine->field[VOICE_FIELD_CUTOFF][slot] = voice_engine_cutoff(engine, cutoff);
+    }
+}
+
+/**
+ * Returns the number of live voices, they occupy slots [0, active).
+ *
+ * @param engine The voice engine.
+ * @return The number of live voices.
+ */
+__declspec(dllexport) size_t voice_engine_get_active(const voice_engine* engine) {
+    return engine->active;
+}
+
+/**
+ * Returns the id of the voice in a slot.
+ *
+ * @param engine The voice engine.
+ * @param slot The slot, below voice_engine_get_active.
+ * @return The caller's id, or -1 for a free slot.
+ */
+__declspec(dllexport) int voice_engine_get_id(const voice_engine* engine, size_t slot) {
+    return slot < engine->active ? engine->id[slot] : -1;
+}
+
+/**
+ * Returns one lane array of the voice state, so vector kernels can run across the voice dimension
+ * between blocks (e.g. mul_vectors on VOICE_FIELD_INCREMENT for vibrato). The array is aligned to
+ * ALIGN; the first 4 * ceil(active / 4) elements are what the engine processes. Padding lanes are
+ * idle and stay silent whatever is written to them. Slots move when voices finish, so the pointer
+ * is valid until the engine is destroyed but its contents only until the next engine call.
+ *
+ * @param engine The voice engine.
+ * @param field One of VOICE_FIELD_PHASE to VOICE_FIELD_STAGE.
+ * @return The lane array, or NULL for an invalid field.
+ */
+__declspec(dllexport) double* voice_engine_get_field(voice_engine* engine, int field) {
+    return field >= 0 && field < VOICE_FIELD_COUNT ? engine->field[field] : NULL;
+}
+
+// Advances the envelopes of 4 voices by one sample and returns the new levels.
+static inline simde__m256d voice_envelope_pd(simde__m256d* level, simde__m256d* stage, simde__m256d coeff[4], simde__m256d target[4]) {
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    simde__m256d c = coeff[VOICE_IDLE], t = target[VOICE_IDLE];
+    for (int s = VOICE_ATTACK; s <= VOICE_RELEASE; ++s) {
+        const simde__m256d in = simde_mm256_cmp_pd(*stage, simde_mm256_set1_pd((double)s), SIMDE_CMP_EQ_OQ);
+        c = simde_mm256_blendv_pd(c, coeff[s], in);
+        t = simde_mm256_blendv_pd(t, target[s], in);
+    }
+    simde__m256d l = simde_mm256_fmadd_pd(simde_mm256_sub_pd(t, *level), c, *level);
+
+    // attack reached full level: go on with the decay
+    const simde__m256d peak = simde_mm256_and_pd(simde_mm256_cmp_pd(*stage, simde_mm256_set1_pd(VOICE_ATTACK), SIMDE_CMP_EQ_OQ),
+                                                 simde_mm256_cmp_pd(l, one, SIMDE_CMP_GE_OQ));
+    l = simde_mm256_blendv_pd(l, one, peak);
+    *stage = simde_mm256_blendv_pd(*stage, simde_mm256_set1_pd(VOICE_DECAY), peak);
+
+    // release faded out: the voice is finished
+    const simde__m256d done = simde_mm256_and_pd(simde_mm256_cmp_pd(*stage, simde_mm256_set1_pd(VOICE_RELEASE), SIMDE_CMP_EQ_OQ),
+                                                 simde_mm256_cmp_pd(l, simde_mm256_set1_pd(VOICE_SILENCE), SIMDE_CMP_LT_OQ));
+    l = simde_mm256_andnot_pd(done, l);
+    *stage = simde_mm256_blendv_pd(*stage, simde_mm256_set1_pd(VOICE_IDLE), done);
+    *level = l;
+    return l;
+}
+
+/**
+ * Renders the sum of all live voices, then frees the voices whose release has finished and
+ * compacts the rest.
+ *
+ * @param engine The voice engine.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of samples, a multiple of 4.
+ */
+__declspec(dllexport) void voice_engine_process(voice_engine* engine, double* result, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    for (size_t i = 0; i < n; i += 4) {
+        simde_mm256_storeu_pd(_result + i, simde_mm256_setzero_pd());
+    }
+    const unsigned int saved_mode = ftz_daz_enter();
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    const simde__m256d two = simde_mm256_set1_pd(2.0);
+    simde__m256d coeff[4], target[4];
+    coeff[VOICE_IDLE]     = simde_mm256_setzero_pd();
+    coeff[VOICE_ATTACK]   = simde_mm256_set1_pd(engine->attack_coeff);
+    coeff[VOICE_DECAY]    = simde_mm256_set1_pd(engine->decay_coeff);
+    coeff[VOICE_RELEASE]  = simde_mm256_set1_pd(engine->release_coeff);
+    target[VOICE_IDLE]    = simde_mm256_setzero_pd();
+    target[VOICE_ATTACK]  = simde_mm256_set1_pd(VOICE_ATTACK_TARGET);
+    target[VOICE_DECAY]   = simde_mm256_set1_pd(engine->sustain);
+    target[VOICE_RELEASE] = simde_mm256_setzero_pd();
+
+    const size_t groups = (engine->active + 3) / 4;
+    for (size_t g = 0; g < groups; ++g) {
+        const size_t o = 4 * g;
+        const simde__m256d dt = simde_mm256_load_pd(engine->field[VOICE_FIELD_INCREMENT] + o);
+        const simde__m256d inv_dt = simde_mm256_div_pd(one, dt);
+        const simde__m256d gain = simde_mm256_load_pd(engine->field[VOICE_FIELD_GAIN] + o);
+        const simde__m256d G = simde_mm256_load_pd(engine->field[VOICE_FIELD_CUTOFF] + o);
+        simde__m256d phase = simde_mm256_load_pd(engine->field[VOICE_FIELD_PHASE] + o);
+        simde__m256d level = simde_mm256_load_pd(engine->field[VOICE_FIELD_LEVEL] + o);
+        simde__m256d stage = simde_mm256_load_pd(engine->field[VOICE_FIELD_STAGE] + o);
+        simde__m256d s1 = simde_mm256_load_pd(engine->filter1 + o);
+        simde__m256d s2 = simde_mm256_load_pd(engine->filter2 + o);
+
+        for (size_t i = 0; i < n; i += 4) {
+            simde__m256d y[4];
+            for (int s = 0; s < 4; ++s) {
+                // polyBLEP saw
+                const simde__m256d saw = simde_mm256_fnmadd_pd(two, blep_residual_pd(phase, dt, inv_dt), simde_mm256_fmsub_pd(two, phase, one));
+                phase = frac_pd(simde_mm256_add_pd(phase, dt));
+
+                // two TPT one-pole lowpass stages
+                const simde__m256d v1 = simde_mm256_mul_pd(simde_mm256_sub_pd(saw, s1), G);
+                const simde__m256d y1 = simde_mm256_add_pd(v1, s1);
+                s1 = simde_mm256_add_pd(y1, v1);
+                const simde__m256d v2 = simde_mm256_mul_pd(simde_mm256_sub_pd(y1, s2), G);
+                const simde__m256d y2 = simde_mm256_add_pd(v2, s2);
+                s2 = simde_mm256_add_pd(y2, v2);
+
+                y[s] = simde_mm256_mul_pd(y2, simde_mm256_mul_pd(gain, voice_envelope_pd(&level, &stage, coeff, target)));
+            }
+            transpose4_pd(&y[0], &y[1], &y[2], &y[3]);
+            const simde__m256d sum = simde_mm256_add_pd(simde_mm256_add_pd(y[0], y[1]), simde_mm256_add_pd(y[2], y[3]));
+            simde_mm256_storeu_pd(_result + i, simde_mm256_add_pd(simde_mm256_load_pd(_result + i), sum));
+        }
+        simde_mm256_storeu_pd(engine->field[VOICE_FIELD_PHASE] + o, phase);
+        simde_mm256_storeu_pd(engine->field[VOICE_FIELD_LEVEL] + o, level);
+        simde_mm256_storeu_pd(engine->field[VOICE_FIELD_STAGE] + o, stage);
+        simde_mm256_storeu_pd(engine->filter1 + o, s1);
+        simde_mm256_storeu_pd(engine->filter2 + o, s2);
+    }
+    ftz_daz_leave(saved_mode);
+
+    // compact: walk backwards so a voice moved into a freed slot has been checked already
+    for (size_t v = engine->active; v-- > 0;) {
+        if (engine->field[VOICE_FIELD_STAGE][v] == VOICE_IDLE) {
+            voice_engine_free_slot(engine, v);
+        }
+    }
+}
+
+#define ENV_MAX_SEGMENTS 8
+#define ENV_DONE -1 // stage after the last segment
+
+/**
+ * Bank of independent multi-segment envelopes, 4 envelopes per register. Every segment runs from
+ * the level it starts at to its target in a fixed time, either linear or exponential. Both are
+ * the affine recursion l = m * l + c per lane (exponential: l = b + (l0 - b) * a^k with the base b
+ * chosen so the target is hit exactly), so 4 samples follow in closed form from m^1..4 and
+ * c * (1 + .. + m^3). Only a quad in which some lane reaches the end of its segment is stepped
+ * sample by sample; the lanes that finish are picked by a compare mask and moved on to their next
+ * segment.
+ */
+typedef struct envelope_bank {
+    size_t num_envelopes;
+    size_t num_groups;      // vectors of 4 envelopes
+    double sample_rate;
+    double* level;          // current level per lane
+    double* mul;            // m of the current segment, 1 while holding
+    double* add;            // c of the current segment, 0 while holding
+    double* remaining;      // samples left in the current segment, infinity while holding
+    int* stage;             // current segment, ENV_DONE after the last one
+    int* num_segments;
+    int* sustain;           // segment held at its target until the gate closes, -1 for one-shots
+    double* seg_target;     // ENV_MAX_SEGMENTS per envelope
+    double* seg_length;     // in samples
+    double* seg_curve;      // 0 linear, > 0 fast start (exponential decay shape), < 0 slow start
+} envelope_bank;
+
+/**
+ * Frees an envelope bank.
+ *
+ * @param bank The envelope bank, may be NULL.
+ */
+__declspec(dllexport) void envelope_bank_destroy(envelope_bank* bank) {
+    if (!bank) {
+        return;
+    }
+    _mm_free(bank->level);
+    _mm_free(bank->mul);
+    _mm_free(bank->add);
+    _mm_free(bank->remaining);
+    free(bank->stage);
+    free(bank->num_segments);
+    free(bank->sustain);
+    free(bank->seg_target);
+    free(bank->seg_length);
+    free(bank->seg_curve);
+    free(bank);
+}
+
+// Holds a lane at its current level.
+static void envelope_hold(envelope_bank* bank, size_t e) {
+    bank->mul[e] = 1.0;
+    bank->add[e] = 0.0;
+    bank->remaining[e] = INFINITY;
+}
+
+// Starts segment s of envelope e from the current level, skipping segments of length 0.
+static void envelope_enter(envelope_bank* bank, size_t e, int s) {
+    for (; s < bank->num_segments[e]; ++s) {
+        const size_t k = e * ENV_MAX_SEGMENTS + (size_t)s;
+        const double target = bank->seg_target[k];
+        const double length = bank->seg_length[k];
+        if (length < 1.0) {
+            bank->level[e] = target;
+            if (s == bank->sustain[e]) {
+                break;
+            }
+            continue;
+        }
+        const double l0 = bank->level[e];
+        const double curve = bank->seg_curve[k];
+        bank->stage[e] = s;
+        bank->remaining[e] = length;
+        if (fabs(curve) < 1e-6) {
+            bank->mul[e] = 1.0;
+            bank->add[e] = (target - l0) / length;
+        } else {
+            const double a = exp(-curve / length);
+            const double aN = exp(-curve);
+            const double base = (target - l0 * aN) / (1.0 - aN);
+            bank->mul[e] = a;
+            bank->add[e] = base * (1.0 - a);
+        }
+        return;
+    }
+    // a zero length sustain segment holds right away, past the last segment the envelope is done
+    bank->stage[e] = s < bank->num_segments[e] ? s : ENV_DONE;
+    envelope_hold(bank, e);
+}
+
+// Called when envelope e has reached the target of its segment.
+static void envelope_finish_segment(envelope_bank* bank, size_t e) {
+    const int s = bank->stage[e];
+    bank->level[e] = bank->seg_target[e * ENV_MAX_SEGMENTS + (size_t)s];
+    if (s == bank->sustain[e]) {
+        envelope_hold(bank, e);
+    } else {
+        envelope_enter(bank, e, s + 1);
+    }
+}
+
+/**
+ * Creates an envelope bank. Every envelope starts done at level 0 with no segments.
+ *
+ * @param num_envelopes The number of envelopes.
+ * @param sample_rate The sample rate in Hz.
+ * @return The envelope bank, or NULL if the allocation fails.
+ */
+__declspec(dllexport) envelope_bank* envelope_bank_create(size_t num_envelopes, double sample_rate) {
+    if (num_envelopes == 0) {
+        return NULL;
+    }
+    envelope_bank* bank = (envelope_bank*)calloc(1, sizeof(envelope_bank));
+    if (!bank) {
+        return NULL;
+    }
+    bank->num_envelopes = num_envelopes;
+    bank->num_groups    = (num_envelopes + 3) / 4;
+    bank->sample_rate   = sample_rate;
+    const size_t lanes = 4 * bank->num_groups;
+    bank->level        = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->mul          = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->add          = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->remaining    = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->stage        = (int*)malloc(lanes * sizeof(int));
+    bank->num_segments = (int*)calloc(lanes, sizeof(int));
+    bank->sustain      = (int*)malloc(lanes * sizeof(int));
+    bank->seg_target   = (double*)calloc(lanes * ENV_MAX_SEGMENTS, sizeof(double));
+    bank->seg_length   = (double*)calloc(lanes * ENV_MAX_SEGMENTS, sizeof(double));
+    bank->seg_curve    = (double*)calloc(lanes * ENV_MAX_SEGMENTS, sizeof(double));
+    if (!bank->level || !bank->mul || !bank->add || !bank->remaining || !bank->stage || !bank->num_segments ||
+        !bank->sustain || !bank->seg_target || !bank->seg_length || !bank->seg_curve) {
+        envelope_bank_destroy(bank);
+        return NULL;
+    }
+    for (size_t e = 0; e < lanes; ++e) {
+        bank->level[e] = 0.0;
+        bank->stage[e] = ENV_DONE;
+        bank->sustain[e] = -1;
+        envelope_hold(bank, e);
+    }
+    return bank;
+}
+
+/**
+ * Defines one segment of an envelope. Takes effect the next time the segment is entered.
+ *
+ * @param bank The envelope bank.
+ * @param envelope The envelope index.
+ * @param segment The segment index, below ENV_MAX_SEGMENTS (8).
+ * @param target The level reached at the end of the segment.
+ * @param time_ms The duration in milliseconds, 0 jumps to the target.
+ * @param curve 0 for a linear segment; otherwise exponential, the distance to the far end shrinks
+ *              by exp(-curve) over the segment: > 0 starts fast (like an RC charge), < 0 starts slow.
+ */
+__declspec(dllexport) void envelope_bank_set_segment(envelope_bank* bank, size_t envelope, int segment, double target, double time_ms, double curve) {
+    if (envelope < bank->num_envelopes && segment >= 0 && segment < ENV_MAX_SEGMENTS) {
+        const size_t k = envelope * ENV_MAX_SEGMENTS + (size_t)segment;
+        bank->seg_target[k] = target;
+        bank->seg_length[k] = time_ms > 0.0 ? floor(time_ms * 0.001 * bank->sample_rate + 0.5) : 0.0;
+        bank->seg_curve[k]  = curve;
+    }
+}
+
+/**
+ * Sets how many segments an envelope has and which one sustains.
+ *
+ * @param bank The envelope bank.
+ * @param envelope The envelope index.
+ * @param num_segments The number of segments, up to ENV_MAX_SEGMENTS.
+ * @param sustain The segment whose target is held while the gate is open, -1 for a one-shot
+ *                envelope that ignores the gate closing.
+ */
+__declspec(dllexport) void envelope_bank_set_layout(envelope_bank* bank, size_t envelope, int num_segments, int sustain) {
+    if (envelope < bank->num_envelopes) {
+        bank->num_segments[envelope] = num_segments < 0 ? 0 : num_segments > ENV_MAX_SEGMENTS ? ENV_MAX_SEGMENTS : num_segments;
+        bank->sustain[envelope] = sustain < bank->num_segments[envelope] ? sustain : -1;
+    }
+}
+
+/**
+ * Shapes an envelope as a classic ADSR: linear attack to 1, exponential decay to the sustain
+ * level, exponential release to 0. Both exponential segments use curve 5 (-43 dB of the distance
+ * covered), and still end exactly on time.
+ *
+ * @param bank The envelope bank.
+ * @param envelope The envelope index.
+ * @param attack_ms The attack time in milliseconds.
+ * @param decay_ms The decay time in milliseconds.
+ * @param sustain The sustain level.
+ * @param release_ms The release time in milliseconds.
+ */
+__declspec(dllexport) void envelope_bank_set_adsr(envelope_bank* bank, size_t envelope, double attack_ms, double decay_ms, double sustain, double release_ms) {
+    envelope_bank_set_segment(bank, envelope, 0, 1.0, attack_ms, 0.0);
+    envelope_bank_set_segment(bank, envelope, 1, sustain, decay_ms, 5.0);
+    envelope_bank_set_segment(bank, envelope, 2, 0.0, release_ms, 5.0);
+    envelope_bank_set_layout(bank, envelope, 3, 1);
+}
+
+/**
+ * Opens or closes the gate of an envelope. Opening restarts the first segment from the current
+ * level, closing moves on to the segment after the sustain segment from the current level.
+ *
+ * @param bank The envelope bank.
+ * @param envelope The envelope index.
+ * @param on Non-zero opens the gate.
+ */
+__declspec(dllexport) void envelope_bank_gate(envelope_bank* bank, size_t envelope, int on) {
+    if (envelope >= bank->num_envelopes) {
+        return;
+    }
+    if (on) {
+        envelope_enter(bank, envelope, 0);
+    } else if (bank->sustain[envelope] >= 0 && bank->stage[envelope] != ENV_DONE && bank->stage[envelope] <= bank->sustain[envelope]) {
+        envelope_enter(bank, envelope, bank->sustain[envelope] + 1);
+    }
+}
+
+/**
+ * Jumps an envelope to a level and stops it.
+ *
+ * @param bank The envelope bank.
+ * @param envelope The envelope index.
+ * @param level The level held until the next gate.
+ */
+__declspec(dllexport) void envelope_bank_reset(envelope_bank* bank, size_t envelope, double level) {
+    if (envelope < bank->num_envelopes) {
+        bank->level[envelope] = level;
+        bank->stage[envelope] = ENV_DONE;
+        envelope_hold(bank, envelope);
+    }
+}
+
+/**
+ * Returns the segment an envelope is in, e.g. to free a voice once its envelope is done.
+ *
+ * @param bank The envelope bank.
+ * @param envelope The envelope index.
+ * @return The segment index, or ENV_DONE (-1) after the last segment and for an invalid index.
+ */
+__declspec(dllexport) int envelope_bank_get_stage(const envelope_bank* bank, size_t envelope) {
+    return envelope < bank->num_envelopes ? bank->stage[envelope] : ENV_DONE;
+}
+
+/**
+ * Returns the current level of an envelope, i.e. its last rendered sample.
+ *
+ * @param bank The envelope bank.
+ * @param envelope The envelope index.
+ * @return The level, 0 for an invalid index.
+ */
+__declspec(dllexport) double envelope_bank_get_level(const envelope_bank* bank, size_t envelope) {
+    return envelope < bank->num_envelopes ? bank->level[envelope] : 0.0;
+}
+
+/**
+ * Renders every envelope into its own row. With the same row layout as the oscillator banks the
+ * envelopes apply to all voices with a single mul_vectors over num_envelopes * stride samples.
+ *
+ * @param bank The envelope bank.
+ * @param result The output, envelope e starts at result + e * stride. Aligned to ALIGN.
+ * @param stride The distance between the envelope rows in samples, a multiple of 4.
+ * @param n The number of samples per envelope, a multiple of 4.
+ */
+__declspec(dllexport) void envelope_bank_process(envelope_bank* bank, double* result, size_t stride, size_t n) {
+    double* _result = __builtin_assume_aligned(result, ALIGN);
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    const simde__m256d four = simde_mm256_set1_pd(4.0);
+    for (size_t g = 0; g < bank->num_groups; ++g) {
+        const size_t o = 4 * g;
+        const size_t envelopes = bank->num_envelopes - o < 4 ? bank->num_envelopes - o : 4;
+        simde__m256d level = simde_mm256_load_pd(bank->level + o);
+        simde__m256d remaining = simde_mm256_load_pd(bank->remaining + o);
+        int fresh = 1;
+        simde__m256d m, c, m2, m3, m4, c2, c3, c4;
+        for (size_t i = 0; i < n; i += 4) {
+            if (fresh) {
+                // closed form coefficients of 1 to 4 steps, they only change at segment ends
+                m = simde_mm256_load_pd(bank->mul + o);
+                c = simde_mm256_load_pd(bank->add + o);
+                m2 = simde_mm256_mul_pd(m, m);
+                m3 = simde_mm256_mul_pd(m2, m);
+                m4 = simde_mm256_mul_pd(m2, m2);
+                c2 = simde_mm256_fmadd_pd(c, m, c);
+                c3 = simde_mm256_fmadd_pd(c2, m, c);
+                c4 = simde_mm256_fmadd_pd(c3, m, c);
+                fresh = 0;
+            }
+            simde__m256d y[4];
+            if (simde_mm256_movemask_pd(simde_mm256_cmp_pd(remaining, four, SIMDE_CMP_LE_OQ)) == 0) {
+                y[0] = simde_mm256_fmadd_pd(m, level, c);
+                y[1] = simde_mm256_fmadd_pd(m2, level, c2);
+                y[2] = simde_mm256_fmadd_pd(m3, level, c3);
+                y[3] = simde_mm256_fmadd_pd(m4, level, c4);
+                level = y[3];
+                remaining = simde_mm256_sub_pd(remaining, four);
+            } else {
+                // a segment ends within this quad: step and move the finished lanes on
+                for (int s = 0; s < 4; ++s) {
+                    level = simde_mm256_fmadd_pd(m, level, c);
+                    remaining = simde_mm256_sub_pd(remaining, one);
+                    const int done = simde_mm256_movemask_pd(simde_mm256_cmp_pd(remaining, one, SIMDE_CMP_LT_OQ));
+                    if (done) {
+                        simde_mm256_storeu_pd(bank->level + o, level);
+                        for (int l = 0; l < 4; ++l) {
+                            if (done & (1 << l)) {
+                                envelope_finish_segment(bank, o + (size_t)l);
+                            }
+                        }
+                        level = simde_mm256_load_pd(bank->level + o);
+                        // the lanes that did not finish keep their count
+                        remaining = simde_mm256_blendv_pd(remaining, simde_mm256_load_pd(bank->remaining + o),
+                                                          simde_mm256_cmp_pd(remaining, one, SIMDE_CMP_LT_OQ));
+                        m = simde_mm256_load_pd(bank->mul + o);
+                        c = simde_mm256_load_pd(bank->add + o);
+                        fresh = 1;
+                    }
+                    y[s] = level;
+                }
+            }
+            transpose4_pd(&y[0], &y[1], &y[2], &y[3]);
+            for (size_t l = 0; l < envelopes; ++l) {
+                simde_mm256_storeu_pd(_result + (o + l) * stride + i, y[l]);
+            }
+        }
+        simde_mm256_storeu_pd(bank->level + o, level);
+        simde_mm256_storeu_pd(bank->remaining + o, remaining);
+    }
+}
+
+// tan(x) for x in [0, pi/2), Lambert's continued fraction to x^7, relative error below 1e-7 up to 0.49 fs.
+static inline simde__m256d tan_pd(simde__m256d x) {
+    const simde__m256d x2 = simde_mm256_mul_pd(x, x);
+    simde__m256d num = simde_mm256_fmadd_pd(x2, simde_mm256_set1_pd(-1.0), simde_mm256_set1_pd(378.0));
+    num = simde_mm256_fmadd_pd(num, x2, simde_mm256_set1_pd(-17325.0));
+    num = simde_mm256_fmadd_pd(num, x2, simde_mm256_set1_pd(135135.0));
+    simde__m256d den = simde_mm256_fmadd_pd(x2, simde_mm256_set1_pd(-28.0), simde_mm256_set1_pd(3150.0));
+    den = simde_mm256_fmadd_pd(den, x2, simde_mm256_set1_pd(-62370.0));
+    den = simde_mm256_fmadd_pd(den, x2, simde_mm256_set1_pd(135135.0));
+    return simde_mm256_div_pd(simde_mm256_mul_pd(x, num), den);
+}
+
+/**
+ * Bank of zero-delay-feedback (TPT) state variable filters, 4 voices or channels per register.
+ * Cutoff and resonance may change every sample; the coefficients are then recomputed per sample
+ * with tan_pd. One pass yields lowpass, bandpass, highpass and notch.
+ */
+typedef struct svf_bank {
+    size_t num_voices;
+    size_t num_groups;   // vectors of 4 voices
+    double sample_rate;
+    double* cutoff;      // in Hz, used when no cutoff buffers are given
+    double* resonance;   // Q, used when no resonance buffers are given
+    double* ic1;         // integrator states
+    double* ic2;
+} svf_bank;
+
+/**
+ * Frees a state variable filter bank.
+ *
+ * @param bank The filter bank, may be NULL.
+ */
+__declspec(dllexport) void svf_bank_destroy(svf_bank* bank) {
+    if (!bank) {
+        return;
+    }
+    _mm_free(bank->cutoff);
+    _mm_free(bank->resonance);
+    _mm_free(bank->ic1);
+    _mm_free(bank->ic2);
+    free(bank);
+}
+
+/**
+ * Clears the integrator states of all filters.
+ *
+ * @param bank The filter bank.
+ */
+__declspec(dllexport) void svf_bank_reset(svf_bank* bank) {
+    for (size_t v = 0; v < 4 * bank->num_groups; ++v) {
+        bank->ic1[v] = 0.0;
+        bank->ic2[v] = 0.0;
+    }
+}
+
+/**
+ * Creates a state variable filter bank, all filters at 1 kHz with Q 0.707 (Butterworth).
+ *
+ * @param num_voices The number of filters.
+ * @param sample_rate The sample rate in Hz.
+ * @return The filter bank, or NULL if the allocation fails.
+ */
+__declspec(dllexport) svf_bank* svf_bank_create(size_t num_voices, double sample_rate) {
+    if (num_voices == 0) {
+        return NULL;
+    }
+    svf_bank* bank = (svf_bank*)calloc(1, sizeof(svf_bank));
+    if (!bank) {
+        return NULL;
+    }
+    bank->num_voices  = num_voices;
+    bank->num_groups  = (num_voices + 3) / 4;
+    bank->sample_rate = sample_rate;
+    const size_t lanes = 4 * bank->num_groups;
+    bank->cutoff    = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->resonance = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->ic1       = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    bank->ic2       = (double*)_mm_malloc(lanes * sizeof(double), ALIGN);
+    if (!bank->cutoff || !bank->resonance || !bank->ic1 || !bank->ic2) {
+        svf_bank_destroy(bank);
+        return NULL;
+    }
+    for (size_t v = 0; v < lanes; ++v) {
+        bank->cutoff[v]    = 1000.0;
+        bank->resonance[v] = 0.70710678118654752;
+    }
+    svf_bank_reset(bank);
+    return bank;
+}
+
+/**
+ * Sets the cutoff of a filter, used when svf_bank_process gets no cutoff buffers.
+ *
+ * @param bank The filter bank.
+ * @param voice The filter index.
+ * @param cutoff The cutoff in Hz, clamped to [1 Hz, 0.49 fs] when processing.
+ */
+__declspec(dllexport) void svf_bank_set_cutoff(svf_bank* bank, size_t voice, double cutoff) {
+    if (voice < bank->num_voices) {
+        bank->cutoff[voice] = cutoff;
+    }
+}
+
+/**
+ * Sets the resonance of a filter, used when svf_bank_process gets no resonance buffers.
+ *
+ * @param bank The filter bank.
+ * @param voice The filter index.
+ * @param q The quality factor, clamped to [0.05, 1000] when processing. 0.5 is critically damped,
+ *          0.707 Butterworth, higher values resonate.
+ */
+__declspec(dllexport) void svf_bank_set_resonance(svf_bank* bank, size_t voice, double q) {
+    if (voice < bank->num_voices) {
+        bank->resonance[voice] = q;
+    }
+}
+
+// SVF coefficients of 4 lanes: k = 1 / Q, a1 = 1 / (1 + g (g + k)), a2 = g a1, a3 = g a2.
+static inline void svf_coeffs_pd(simde__m256d cutoff, simde__m256d q, simde__m256d scale, simde__m256d nyquist,
+                                 simde__m256d* k, simde__m256d* a1, simde__m256d* a2, simde__m256d* a3) {
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    const simde__m256d f = simde_mm256_min_pd(simde_mm256_max_pd(cutoff, one), nyquist);
+    const simde__m256d g = tan_pd(simde_mm256_mul_pd(f, scale));
+    *k  = simde_mm256_div_pd(one, simde_mm256_min_pd(simde_mm256_max_pd(q, simde_mm256_set1_pd(0.05)), simde_mm256_set1_pd(1000.0)));
+    *a1 = simde_mm256_div_pd(one, simde_mm256_fmadd_pd(g, simde_mm256_add_pd(g, *k), one));
+    *a2 = simde_mm256_mul_pd(g, *a1);
+    *a3 = simde_mm256_mul_pd(g, *a2);
+}
+
+/**
+ * Filters a block of all voices. Every output set may be NULL when it is not needed; an output
+ * may be the input buffer itself.
+ *
+ * @param bank The filter bank.
+ * @param inputs num_voices pointers to the input buffers, each aligned to ALIGN.
+ * @param cutoff NULL for the cutoffs set with svf_bank_set_cutoff, or num_voices pointers to
+ *               per sample cutoffs in Hz, each aligned to ALIGN.
+ * @param resonance NULL for the values set with svf_bank_set_resonance, or num_voices pointers
+ *                  to per sample Q values, each aligned to ALIGN.
+ * @param lowpass NULL or num_voices pointers to the lowpass outputs, each aligned to ALIGN.
+ * @param bandpass NULL or num_voices pointers to the bandpass outputs (peak gain Q), each aligned to ALIGN.
+ * @param highpass NULL or num_voices pointers to the highpass outputs, each aligned to ALIGN.
+ * @param notch NULL or num_voices pointers to the notch outputs, each aligned to ALIGN.
+ * @param n The number of samples per voice, a multiple of 4.
+ */
+__declspec(dllexport) void svf_bank_process(svf_bank* bank, const double* const* inputs, const double* const* cutoff, const double* const* resonance,
+                                            double* const* lowpass, double* const* bandpass, double* const* highpass, double* const* notch, size_t n) {
+    const simde__m256d two = simde_mm256_set1_pd(2.0);
+    const simde__m256d scale = simde_mm256_set1_pd(3.14159265358979323846 / bank->sample_rate);
+    const simde__m256d nyquist = simde_mm256_set1_pd(0.49 * bank->sample_rate);
+    const unsigned int saved_mode = ftz_daz_enter();
+    for (size_t g = 0; g < bank->num_groups; ++g) {
+        const size_t o = 4 * g;
+        const size_t voices = bank->num_voices - o < 4 ? bank->num_voices - o : 4;
+        // padding lanes read the last voice again and are never stored
+        const double* in_rows[4];
+        const double* cut_rows[4];
+        const double* res_rows[4];
+        for (size_t l = 0; l < 4; ++l) {
+            const size_t v = o + (l < voices ? l : voices - 1);
+            in_rows[l]  = inputs[v];
+            cut_rows[l] = cutoff ? cutoff[v] : NULL;
+            res_rows[l] = resonance ? resonance[v] : NULL;
+        }
+        simde__m256d ic1 = simde_mm256_load_pd(bank->ic1 + o);
+        simde__m256d ic2 = simde_mm256_load_pd(bank->ic2 + o);
+        simde__m256d fc = simde_mm256_load_pd(bank->cutoff + o);
+        simde__m256d q  = simde_mm256_load_pd(bank->resonance + o);
+        simde__m256d k, a1, a2, a3;
+        svf_coeffs_pd(fc, q, scale, nyquist, &k, &a1, &a2, &a3);
+
+        for (size_t i = 0; i < n; i += 4) {
+            simde__m256d x[4], fcs[4], qs[4];
+            simde__m256d lp[4], bp[4], hp[4], no[4];
+            load_frames_pd(in_rows, i, x);
+            if (cutoff) {
+                load_frames_pd(cut_rows, i, fcs);
+            }
+            if (resonance) {
+                load_frames_pd(res_rows, i, qs);
+            }
+            for (int s = 0; s < 4; ++s) {
+                if (cutoff || resonance) {
+                    svf_coeffs_pd(cutoff ? fcs[s] : fc, resonance ? qs[s] : q, scale, nyquist, &k, &a1, &a2, &a3);
+                }
+                const simde__m256d v3 = simde_mm256_sub_pd(x[s], ic2);
+                const simde__m256d v1 = simde_mm256_fmadd_pd(a1, ic1, simde_mm256_mul_pd(a2, v3));
+                const simde__m256d v2 = simde_mm256_add_pd(ic2, simde_mm256_fmadd_pd(a2, ic1, simde_mm256_mul_pd(a3, v3)));
+                ic1 = simde_mm256_fmsub_pd(two, v1, ic1);
+                ic2 = simde_mm256_fmsub_pd(two, v2, ic2);
+                lp[s] = v2;
+                bp[s] = v1;
+                no[s] = simde_mm256_fnmadd_pd(k, v1, x[s]);
+                hp[s] = simde_mm256_sub_pd(no[s], v2);
+            }
+            if (lowpass) {
+                transpose4_pd(&lp[0], &lp[1], &lp[2], &lp[3]);
+                for (size_t l = 0; l < voices; ++l) {
+                    simde_mm256_storeu_pd(lowpass[o + l] + i, lp[l]);
+                }
+            }
+            if (bandpass) {
+                transpose4_pd(&bp[0], &bp[1], &bp[2], &bp[3]);
+                for (size_t l = 0; l < voices; ++l) {
+                    simde_mm256_storeu_pd(bandpass[o + l] + i, bp[l]);
+                }
+            }
+            if (highpass) {
+                transpose4_pd(&hp[0], &hp[1], &hp[2], &hp[3]);
+                for (size_t l = 0; l < voices; ++l) {
+                    simde_mm256_storeu_pd(highpass[o + l] + i, hp[l]);
+                }
+            }
+            if (notch) {
+                transpose4_pd(&no[0], &no[1], &no[2], &no[3]);
+                for (size_t l = 0; l < voices; ++l) {
+                    simde_mm256_storeu_pd(notch[o + l] + i, no[l]);
+                }
+            }
+        }
+        simde_mm256_storeu_pd(bank->ic1 + o, ic1);
+        simde_mm256_storeu_pd(bank->ic2 + o, ic2);
+    }
+    ftz_daz_leave(saved_mode);
+}
+
+/**
+ * Biquad responses of the RBJ audio EQ cookbook.
+ */
+enum {
+    BIQUAD_LOWPASS   = 0,
+    BIQUAD_HIGHPASS  = 1,
+    BIQUAD_BANDPASS  = 2, // 0 dB peak gain
+    BIQUAD_NOTCH     = 3,
+    BIQUAD_PEAK      = 4,
+    BIQUAD_LOWSHELF  = 5,
+    BIQUAD_HIGHSHELF = 6,
+    BIQUAD_ALLPASS   = 7
+};
+
+// RBJ coefficients of 4 filters, normalized to a0 = 1. Every response is computed and the one of each lane selected by mask.
+static inline void biquad_design4(simde__m256d type, simde__m256d frequency, simde__m256d q, simde__m256d gain_db, double sample_rate, simde__m256d c[5]) {
+    const simde__m256d one = simde_mm256_set1_pd(1.0);
+    const simde__m256d two = simde_mm256_set1_pd(2.0);
+    const simde__m256d neg = simde_mm256_set1_pd(-0.0);
+    const simde__m256d t = simde_mm256_min_pd(simde_mm256_max_pd(simde_mm256_mul_pd(frequency, simde_mm256_set1_pd(1.0 / sample_rate)),
+                                                                 simde_mm256_set1_pd(1e-6)), simde_mm256_set1_pd(0.499));
+    simde__m256d sn, cs;
+    sincos_2pi_pd(t, &sn, &cs);
+    const simde__m256d alpha = simde_mm256_div_pd(sn, simde_mm256_mul_pd(two, simde_mm256_max_pd(q, simde_mm256_set1_pd(1e-3))));
+    // A = 10^(gain / 40), sqrt(A) = 10^(gain / 80)
+    const simde__m256d sqrt_a = exp_pd(simde_mm256_mul_pd(gain_db, simde_mm256_set1_pd(0.028782313662425574)));
+    const simde__m256d a = simde_mm256_mul_pd(sqrt_a, sqrt_a);
+    const simde__m256d m2cs = simde_mm256_mul_pd(simde_mm256_set1_pd(-2.0), cs);
+    const simde__m256d one_m_cs = simde_mm256_sub_pd(one, cs);
+    const simde__m256d one_p_cs = simde_mm256_add_pd(one, cs);
+
+    // a0, a1, a2 shared by all but the peak and shelf responses, b per response
+    simde__m256d a0 = simde_mm256_add_pd(one, alpha);
+    simde__m256d a1 = m2cs;
+    simde__m256d a2 = simde_mm256_sub_pd(one, alpha);
+    simde__m256d b0 = simde_mm256_mul_pd(one_m_cs, simde_mm256_set1_pd(0.5)); // lowpass
+    simde__m256d b1 = one_m_cs;
+    simde__m256d b2 = b0;
+
+#define BIQUAD_SELECT(kind, v0, v1, v2) do { \
+        const simde__m256d is = simde_mm256_cmp_pd(type, simde_mm256_set1_pd((double)(kind)), SIMDE_CMP_EQ_OQ); \
+        b0 = simde_mm256_blendv_pd(b0, (v0), is); \
+        b1 = simde_mm256_blendv_pd(b1, (v1), is); \
+        b2 = simde_mm256_blendv_pd(b2, (v2), is); \
+    } while (0)
+    const simde__m256d hp0 = simde_mm256_mul_pd(one_p_cs, simde_mm256_set1_pd(0.5));
+    BIQUAD_SELECT(BIQUAD_HIGHPASS, hp0, simde_mm256_xor_pd(one_p_cs, neg), hp0);
+    BIQUAD_SELECT(BIQUAD_BANDPASS, alpha, simde_mm256_setzero_pd(), simde_mm256_xor_pd(alpha, neg));
+    BIQUAD_SELECT(BIQUAD_NOTCH, one, m2cs, one);
+    BIQUAD_SELECT(BIQUAD_ALLPASS, a2, m2cs, a0);
+    {
+        const simde__m256d alpha_a = simde_mm256_mul_pd(alpha, a);
+        const simde__m256d alpha_over_a = simde_mm256_div_pd(alpha, a);
+        const simde__m256d is = simde_mm256_cmp_pd(type, simde_mm256_set1_pd(BIQUAD_PEAK), SIMDE_CMP_EQ_OQ);
+        BIQUAD_SELECT(BIQUAD_PEAK, simde_mm256_add_pd(one, alpha_a), m2cs, simde_mm256_sub_pd(one, alpha_a));
+        a0 = simde_mm256_blendv_pd(a0, simde_mm256_add_pd(one, alpha_over_a), is);
+        a2 = simde_mm256_blendv_pd(a2, simde_mm256_sub_pd(one, alpha_over_a), is);
+    }
+    {
+        // shelves: with ap = A + 1, am = A - 1 and s = 2 sqrt(A) alpha
+        const simde__m256d ap = simde_mm256_add_pd(a, one);
+        const simde__m256d am = simde_mm256_sub_pd(a, one);
+        const simde__m256d s = simde_mm256_mul_pd(simde_mm256_mul_pd(two, sqrt_a), alpha);
+        const simde__m256d lo = simde_mm256_fnmadd_pd(am, cs, ap);   // (A + 1) - (A - 1) cos
+        const simde__m256d hi = simde_mm256_fmadd_pd(am, cs, ap);    // (A + 1) + (A - 1) cos
+        const simde__m256d lo1 = simde_mm256_fnmadd_pd(ap, cs, am);  // (A - 1) - (A + 1) cos
+        const simde__m256d hi1 = simde_mm256_fmadd_pd(ap, cs, am);   // (A - 1) + (A + 1) cos
+        const simde__m256d is_low = simde_mm256_cmp_pd(type, simde_mm256_set1_pd(BIQUAD_LOWSHELF), SIMDE_CMP_EQ_OQ);
+        const simde__m256d is_high = simde_mm256_cmp_pd(type, simde_mm256_set1_pd(BIQUAD_HIGHSHELF), SIMDE_CMP_EQ_OQ);
+        BIQUAD_SELECT(BIQUAD_LOWSHELF, simde_mm256_mul_pd(a, simde_mm256_add_pd(lo, s)), simde_mm256_mul_pd(simde_mm256_mul_pd(two, a), lo1),
+                      simde_mm256_mul_pd(a, simde_mm256_sub_pd(lo, s)));
+        BIQUAD_SELECT(BIQUAD_HIGHSHELF, simde_mm256_mul_pd(a, simde_mm256_add_pd(hi, s)), simde_mm256_mul_pd(simde_mm256_mul_pd(simde_mm256_set1_pd(-2.0), a), hi1),
+                      simde_mm256_mul_pd(a, simde_mm256_sub_pd(hi, s)));
+        a0 = simde_mm256_blendv_pd(a0, simde_mm256_add_pd(hi, s), is_low);
+        a1 = simde_mm256_blendv_pd(a1, simde_mm256_mul_pd(simde_mm256_set1_pd(-2.0), hi1), is_low);
+        a2 = simde_mm256_blendv_pd(a2, simde_mm256_sub_pd(hi, s), is_low);
+        a0 = simde_mm256_blendv_pd(a0, simde_mm256_add_pd(lo, s), is_high);
+        a1 = simde_mm256_blendv_pd(a1, simde_mm256_mul_pd(two, lo1), is_high);
+        a2 = simde_mm256_blendv_pd(a2, simde_mm256_sub_pd(lo, s), is_high);
+    }
+#undef BIQUAD_SELECT
+
+    const simde__m256d inv_a0 = simde_mm256_div_pd(one, a0);
+    c[0] = simde_mm256_mul_pd(b0, inv_a0);
+    c[1] = simde_mm256_mul_pd(b1, inv_a0);
+    c[2] = simde_mm256_mul_pd(b2, inv_a0);
+    c[3] = simde_mm256_mul_pd(a1, inv_a0);
+    c[4] = simde_mm256_mul_pd(a2, inv_a0);
+}
+
+/**
+ * Designs a batch of biquads from the RBJ audio EQ cookbook, 4 filters per register, with vector
+ * sin/cos and exp instead of per band libm calls. The coefficients are normalized to a0 = 1:
+ * y = b0 x + b1 x[-1] + b2 x[-2] - a1 y[-1] - a2 y[-2]. All double arrays are aligned to ALIGN.
+ *
+ * @param types count BIQUAD_* responses.
+ * @param frequencies count center or corner frequencies in Hz, clamped to (0, 0.499 fs].
+ * @param qs count quality factors (also for the shelves, 0.707 is the steepest without overshoot).
+ * @param gains_db count gains in dB, used by BIQUAD_PEAK and the shelves.
+ * @param count The number of filters.
+ * @param sample_rate The sample rate in Hz.
+ * @param b0 The output array of count b0 coefficients.
+ * @param b1 The output array of count b1 coefficients.
+ * @param b2 The output array of count b2 coefficients.
+ * @param a1 The output array of count a1 coefficients.
+ * @param a2 The output array of count a2 coefficients.
+ */
+__declspec(dllexport) void biquad_design(const int* types, const double* frequencies, const double* qs, const double* gains_db, size_t count, double sample_rate,
+                                         double* b0, double* b1, double* b2, double* a1, double* a2) {
+    double* out[5] = { b0, b1, b2, a1, a2 };
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        simde__m256d c[5];
+        const simde__m256d type = simde_mm256_cvtepi32_pd(simde_mm_loadu_si128((const simde__m128i*)(types + i)));
+        biquad_design4(type, simde_mm256_load_pd(frequencies + i), simde_mm256_load_pd(qs + i), simde_mm256_load_pd(gains_db + i), sample_rate, c);
+        for (int k = 0; k < 5; ++k) {
+            simde_mm256_storeu_pd(out[k] + i, c[k]);
+        }
+    }
+    if (i < count) {
+        // the tail is padded with 0 dB peaks
+        double t[4] = { BIQUAD_PEAK, BIQUAD_PEAK, BIQUAD_PEAK, BIQUAD_PEAK };
+        double f[4] = { 1000.0, 1000.0, 1000.0, 1000.0 }, q[4] = { 1.0, 1.0, 1.0, 1.0 }, g[4] = { 0.0, 0.0, 0.0, 0.0 };
+        for (size_t l = 0; i + l < count; ++l) {
+            t[l] = (double)types[i + l];
+            f[l] = frequencies[i + l];
+            q[l] = qs[i + l];
+            g[l] = gains_db[i + l];
+        }
+        simde__m256d c[5];
+        biquad_design4(simde_mm256_loadu_pd(t), simde_mm256_loadu_pd(f), simde_mm256_loadu_pd(q), simde_mm256_loadu_pd(g), sample_rate, c);
+        for (int k = 0; k < 5; ++k) {
+            double tail[4];
+            simde_mm256_storeu_pd(tail, c[k]);
+            for (size_t l = 0; i + l < count; ++l) {
+                out[k][i + l] = tail[l];
+            }
+        }
+    }
+}
+
+/**
+ * Cascades of biquads, one cascade per channel (or voice) and 4 channels per register, e.g. a
+ * 32 band EQ on every channel. Parameters are collected with biquad_bank_set and designed in one
+ * batch at the start of the next block; with smoothing the coefficients then move linearly from
+ * the old to the new set over the block. Linear steps keep every intermediate filter stable,
+ * since the stable (a1, a2) region is a triangle and thus convex.
+ * Coefficient arrays hold stage s of channel c at s * lanes + c.
+ */
+typedef struct biquad_bank {
+    size_t num_channels;
+    size_t num_stages;
+    size_t lanes;           // num_channels rounded up to 4
+    double sample_rate;
+    int smoothing;          // non-zero ramps the coefficients over a block
+    int dirty;              // parameters changed since the last design
+    int* type;              // parameters per filter
+    double* frequency;
+    double* q;
+    double* gain_db;
+    double* coeff[5];       // b0, b1, b2, a1, a2 in use at the end of the last block
+    double* target[5];      // designed from the parameters
+    double* z1;             // transposed direct form II states
+    double* z2;
+} biquad_bank;
+
+/**
+ * Frees a biquad bank.
+ *
+ * @param bank The biquad bank, may be NULL.
+ */
+__declspec(dllexport) void biquad_bank_destroy(biquad_bank* bank) {
+    if (!bank) {
+        return;
+    }
+    free(bank->type);
+    _mm_free(bank->frequency);
+    _mm_free(bank->q);
+    _mm_free(bank->gain_db);
+    for (int k = 0; k < 5; ++k) {
+        _mm_free(bank->coeff[k]);
+        _mm_free(bank->target[k]);
+    }
+    _mm_free(bank->z1);
+    _mm_free(bank->z2);
+    free(bank);
+}
+
+// Designs the targets from the parameters when they changed.
+static void biquad_bank_update(biquad_bank* bank) {
+    if (bank->dirty) {
+        biquad_design(bank->type, bank->frequency, bank->q, bank->gain_db, bank->num_stages * bank->lanes, bank->sample_rate,
+                      bank->target[0], bank->target[1], bank->target[2], bank->target[3], bank->target[4]);
+        bank->dirty = 0;
+    }
+}
+
+/**
+ * Clears the filter states and moves the coefficients to their targets without a ramp.
+ *
+ * @param bank The biquad bank.
+ */
+__declspec(dllexport) void biquad_bank_reset(biquad_bank* bank) {
+    biquad_bank_update(bank);
+    const size_t size = bank->num_stages * bank->lanes;
+    for (int k = 0; k < 5; ++k) {
+        memcpy(bank->coeff[k], bank->target[k], size * sizeof(double));
+    }
+    memset(bank->z1, 0, size * sizeof(double));
+    memset(bank->z2, 0, size * sizeof(double));
+}
+
+/**
+ * Creates a biquad bank with all filters at 0 dB peak (pass through) and smoothing on.
+ *
+ * @param num_channels The number of channels, each with its own cascade.
+ * @param num_stages The number of biquads in every cascade.
+ * @param sample_rate The sample rate in Hz.
+ * @return The biquad bank, or NULL if the allocation fails.
+ */
+__declspec(dllexport) biquad_bank* biquad_bank_create(size_t num_channels, size_t num_stages, double sample_rate) {
+    if (num_channels == 0 || num_stages == 0) {
+        return NULL;
+    }
+    biquad_bank* bank = (biquad_bank*)calloc(1, sizeof(biquad_bank));
+    if (!bank) {
+        return NULL;
+    }
+    bank->num_channels = num_channels;
+    bank->num_stages   = num_stages;
+    bank->lanes        = (num_channels + 3) & ~(size_t)3;
+    bank->sample_rate  = sample_rate;
+    bank->smoothing    = 1;
+    const size_t size = num_stages * bank->lanes;
+    int failed = 0;
+    bank->type      = (int*)malloc(size * sizeof(int));
+    bank->frequency = (double*)_mm_malloc(size * sizeof(double), ALIGN);
+    bank->q         = (double*)_mm_malloc(size * sizeof(double), ALIGN);
+    bank->gain_db   = (double*)_mm_malloc(size * sizeof(double), ALIGN);
+    for (int k = 0; k < 5; ++k) {
+        bank->coeff[k]  = (double*)_mm_malloc(size * sizeof(double), ALIGN);
+        bank->target[k] = (double*)_mm_malloc(size * sizeof(double), ALIGN);
+        failed |= !bank->coeff[k] || !bank->target[k];
+    }
+    bank->z1 = (double*)_mm_malloc(size * sizeof(double), ALIGN);
+    bank->z2 = (double*)_mm_malloc(size * sizeof(double), ALIGN);
+    if (failed || !bank->type || !bank->frequency || !bank->q || !bank->gain_db || !bank->z1 || !bank->z2) {
+        biquad_bank_destroy(bank);
+        return NULL;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        bank->type[i]      = BIQUAD_PEAK;
+        bank->frequency[i] = 1000.0;
+        bank->q[i]         = 0.70710678118654752;
+        bank->gain_db[i]   = 0.0;
+    }
+    bank->dirty = 1;
+    biquad_bank_reset(bank);
+    return bank;
+}
+
+/**
+ * Sets the parameters of one biquad, designed at the start of the next block.
+ *
+ * @param bank The biquad bank.
+ * @param channel The channel index.
+ * @param stage The position in the cascade.
+ * @param type A BIQUAD_* response.
+ * @param frequency The center or corner frequency in Hz.
+ * @param q The quality factor.
+ * @param gain_db The gain in dB for BIQUAD_PEAK and the shelves.
+ */
+__declspec(dllexport) void biquad_bank_set(biquad_bank* bank, size_t channel, size_t stage, int type, double frequency, double q, double gain_db) {
+    if (channel < bank->num_channels && stage < bank->num_stages) {
+        const size_t k = stage * bank->lanes + channel;
+        bank->type[k]      = type;
+        bank->frequency[k] = frequency;
+        bank->q[k]         = q;
+        bank->gain_db[k]   = gain_db;
+        bank->dirty = 1;
+    }
+}
+
+/**
+ * Enables or disables the per block coefficient ramps.
+ *
+ * @param bank The biquad bank.
+ * @param on Non-zero ramps to new coefficients over a block, 0 switches at the block start.
+ */
+__declspec(dllexport) void biquad_bank_set_smoothing(biquad_bank* bank, int on) {
+    bank->smoothing = on;
+}
+
+/**
+ * Filters a block of all channels in place through their cascades.
+ *
+ * @param bank The biquad bank.
+ * @param channels num_channels pointers to the channel buffers, each aligned to ALIGN.
+ * @param n The number of samples per channel, a multiple of 4.
+ */
+__declspec(dllexport) void biquad_bank_process(biquad_bank* bank, double* const* channels, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    biquad_bank_update(bank);
+    const size_t lanes = bank->lanes;
+    const size_t stages = bank->num_stages;
+    const simde__m256d inv_n = simde_mm256_set1_pd(bank->smoothing ? 1.0 / (double)n : 1.0);
+    const unsigned int saved_mode = ftz_daz_enter();
+    for (size_t o = 0; o < lanes; o += 4) {
+        const size_t valid = bank->num_channels - o < 4 ? bank->num_channels - o : 4;
+        // padding lanes read the last channel again and are never stored
+        const double* in_rows[4];
+        for (size_t l = 0; l < 4; ++l) {
+            in_rows[l] = channels[o + (l < valid ? l : valid - 1)];
+        }
+        for (size_t i = 0; i < n; i += 4) {
+            simde__m256d x[4];
+            load_frames_pd(in_rows, i, x);
+            for (size_t s = 0; s < stages; ++s) {
+                const size_t k = s * lanes + o;
+                simde__m256d c[5], step[5];
+                for (int j = 0; j < 5; ++j) {
+                    // the ramp restarts from the stored coefficients, i samples into the block
+                    const simde__m256d from = simde_mm256_load_pd(bank->coeff[j] + k);
+                    step[j] = simde_mm256_mul_pd(simde_mm256_sub_pd(simde_mm256_load_pd(bank->target[j] + k), from), inv_n);
+                    c[j] = bank->smoothing ? simde_mm256_fmadd_pd(step[j], simde_mm256_set1_pd((double)i), from)
+                                           : simde_mm256_load_pd(bank->target[j] + k);
+                }
+                simde__m256d z1 = simde_mm256_load_pd(bank->z1 + k);
+                simde__m256d z2 = simde_mm256_load_pd(bank->z2 + k);
+                for (int t = 0; t < 4; ++t) {
+                    if (bank->smoothing) {
+                        for (int j = 0; j < 5; ++j) {
+                            c[j] = simde_mm256_add_pd(c[j], step[j]);
+                        }
+                    }
+                    const simde__m256d y = simde_mm256_fmadd_pd(c[0], x[t], z1);
+                    z1 = simde_mm256_fnmadd_pd(c[3], y, simde_mm256_fmadd_pd(c[1], x[t], z2));
+                    z2 = simde_mm256_fnmadd_pd(c[4], y, simde_mm256_mul_pd(c[2], x[t]));
+                    x[t] = y;
+                }
+                simde_mm256_storeu_pd(bank->z1 + k, z1);
+                simde_mm256_storeu_pd(bank->z2 + k, z2);
+            }
+            transpose4_pd(&x[0], &x[1], &x[2], &x[3]);
+            for (size_t l = 0; l < valid; ++l) {
+                simde_mm256_storeu_pd(channels[o + l] + i, x[l]);
+            }
+        }
+    }
+    ftz_daz_leave(saved_mode);
+    // the block ends on the targets
+    for (int j = 0; j < 5; ++j) {
+        memcpy(bank->coeff[j], bank->target[j], stages * lanes * sizeof(double));
+    }
+}
+
+#define XO_MAX_BANDS 8
+
+/**
+ * Linkwitz-Riley (LR4) multiband crossover with 2 to 8 bands. Splitting the input at f0 < f1 < ..
+ * band by band gives band k = HP(f0) .. HP(f(k-1)) * LP(fk) * AP(f(k+1)) .. AP(f(N-2)), where the
+ * allpasses (LP + HP of the later crossovers) keep all bands phase aligned, so the bands sum to
+ * an allpass with a flat magnitude. Written this way every band is an independent cascade of
+ * biquads fed by the same input, so the bands run side by side in the lanes (4 per register),
+ * each cascade padded to 2 (N - 1) stages with pass through biquads.
+ * Coefficient and state arrays hold stage s of band b at s * lanes + b; states per channel.
+ */
+typedef struct crossover {
+    size_t num_channels;
+    size_t num_bands;
+    size_t num_stages;      // 2 (num_bands - 1)
+    size_t lanes;           // num_bands rounded up to 4
+    double sample_rate;
+    double frequency[XO_MAX_BANDS - 1];
+    double* coeff[5];       // b0, b1, b2, a1, a2
+    double* design;         // frequencies, Qs and gains handed to biquad_design
+    double* z1;             // transposed direct form II states, num_channels blocks
+    double* z2;
+} crossover;
+
+/**
+ * Frees a crossover.
+ *
+ * @param xo The crossover, may be NULL.
+ */
+__declspec(dllexport) void crossover_destroy(crossover* xo) {
+    if (!xo) {
+        return;
+    }
+    for (int k = 0; k < 5; ++k) {
+        _mm_free(xo->coeff[k]);
+    }
+    _mm_free(xo->design);
+    _mm_free(xo->z1);
+    _mm_free(xo->z2);
+    free(xo);
+}
+
+/**
+ * Clears the filter states.
+ *
+ * @param xo The crossover.
+ */
+__declspec(dllexport) void crossover_reset(crossover* xo) {
+    const size_t size = xo->num_channels * xo->num_stages * xo->lanes;
+    memset(xo->z1, 0, size * sizeof(double));
+    memset(xo->z2, 0, size * sizeof(double));
+}
+
+// Lays out the band cascades and designs all their biquads in one batch.
+static void crossover_design(crossover* xo) {
+    const size_t size = xo->num_stages * xo->lanes;
+    int types[2 * (XO_MAX_BANDS - 1) * XO_MAX_BANDS];
+    double* frequencies = xo->design;
+    double* qs = frequencies + size;
+    double* gains = qs + size;
+    for (size_t b = 0; b < xo->lanes; ++b) {
+        size_t s = 0;
+        // stage layout of band b: two highpasses per lower crossover, two lowpasses, one allpass per higher crossover
+        for (size_t j = 0; j < xo->num_bands - 1; ++j) {
+            int type = -1, count = 0;
+            if (b >= xo->num_bands) {
+                count = 0;
+            } else if (j < b) {
+                type = BIQUAD_HIGHPASS;
+                count = 2;
+            } else if (j == b) {
+                type = BIQUAD_LOWPASS;
+                count = 2;
+            } else {
+                type = BIQUAD_ALLPASS;
+                count = 1;
+            }
+            for (int c = 0; c < count; ++c, ++s) {
+                types[s * xo->lanes + b] = type;
+                frequencies[s * xo->lanes + b] = xo->frequency[j];
+            }
+        }
+        // pass through padding: a 0 dB peak, made exact below
+        for (; s < xo->num_stages; ++s) {
+            types[s * xo->lanes + b] = -1;
+            frequencies[s * xo->lanes + b] = 1000.0;
+        }
+    }
+    for (size_t k = 0; k < size; ++k) {
+        qs[k] = 0.70710678118654752; // Butterworth halves of the LR4 sections, their sum is the matching allpass
+        gains[k] = 0.0;
+    }
+    biquad_design(types, frequencies, qs, gains, size, xo->sample_rate, xo->coeff[0], xo->coeff[1], xo->coeff[2], xo->coeff[3], xo->coeff[4]);
+    for (size_t k = 0; k < size; ++k) {
+        if (types[k] < 0) {
+            xo->coeff[0][k] = 1.0;
+            xo->coeff[1][k] = xo->coeff[2][k] = xo->coeff[3][k] = xo->coeff[4][k] = 0.0;
+        }
+    }
+}
+
+/**
+ * Creates a crossover with the split frequencies spread logarithmically from 100 Hz to 10 kHz
+ * (1 kHz for 2 bands).
+ *
+ * @param num_channels The number of channels.
+ * @param num_bands The number of bands, 2 to 8.
+ * @param sample_rate The sample rate in Hz.
+ * @return The crossover, or NULL for an invalid band count or if the allocation fails.
+ */
+__declspec(dllexport) crossover* crossover_create(size_t num_channels, size_t num_bands, double sample_rate) {
+    if (num_channels == 0 || num_bands < 2 || num_bands > XO_MAX_BANDS) {
+        return NULL;
+    }
+    crossover* xo = (crossover*)calloc(1, sizeof(crossover));
+    if (!xo) {
+        return NULL;
+    }
+    xo->num_channels = num_channels;
+    xo->num_bands    = num_bands;
+    xo->num_stages   = 2 * (num_bands - 1);
+    xo->lanes        = (num_bands + 3) & ~(size_t)3;
+    xo->sample_rate  = sample_rate;
+    const size_t size = xo->num_stages * xo->lanes;
+    int failed = 0;
+    for (int k = 0; k < 5; ++k) {
+        xo->coeff[k] = (double*)_mm_malloc(size * sizeof(double), ALIGN);
+        failed |= !xo->coeff[k];
+    }
+    xo->design = (double*)_mm_malloc(3 * size * sizeof(double), ALIGN);
+    xo->z1 = (double*)_mm_malloc(num_channels * size * sizeof(double), ALIGN);
+    xo->z2 = (double*)_mm_malloc(num_channels * size * sizeof(double), ALIGN);
+    if (failed || !xo->design || !xo->z1 || !xo->z2) {
+        crossover_destroy(xo);
+        return NULL;
+    }
+    for (size_t j = 0; j < num_bands - 1; ++j) {
+        xo->frequency[j] = num_bands == 2 ? 1000.0 : 100.0 * pow(100.0, (double)j / (double)(num_bands - 2));
+    }
+    crossover_design(xo);
+    crossover_reset(xo);
+    return xo;
+}
+
+/**
+ * Moves one split frequency. The frequencies should stay in ascending order, band k lies between
+ * split k - 1 and split k. The filters switch at once, so automate it slowly or between notes.
+ *
+ * @param xo The crossover.
+ * @param index The split index, 0 to num_bands - 2.
+ * @param frequency The split frequency in Hz.
+ */
+__declspec(dllexport) void crossover_set_frequency(crossover* xo, size_t index, double frequency) {
+    if (index < xo->num_bands - 1) {
+        xo->frequency[index] = frequency;
+        crossover_design(xo);
+    }
+}
+
+/**
+ * Splits every channel into its bands.
+ *
+ * @param xo The crossover.
+ * @param inputs num_channels pointers to the input buffers, each aligned to ALIGN.
+ * @param bands num_channels * num_bands pointers to the band buffers, band b of channel c at
+ *              bands[c * num_bands + b], each aligned to ALIGN.
+ * @param n The number of samples per channel, a multiple of 4.
+ */
+__declspec(dllexport) void crossover_process(crossover* xo, const double* const* inputs, double* const* bands, size_t n) {
+    const size_t lanes = xo->lanes;
+    const size_t stages = xo->num_stages;
+    const unsigned int saved_mode = ftz_daz_enter();
+    for (size_t c = 0; c < xo->num_channels; ++c) {
+        const double* _in = __builtin_assume_aligned(inputs[c], ALIGN);
+        double* z1s = xo->z1 + c * stages * lanes;
+        double* z2s = xo->z2 + c * stages * lanes;
+        for (size_t o = 0; o < lanes; o += 4) {
+            const size_t valid = xo->num_bands - o < 4 ? xo->num_bands - o : 4;
+            for (size_t i = 0; i < n; i += 4) {
+                // every lane (band) starts from the same input sample
+                simde__m256d y[4];
+                for (int t = 0; t < 4; ++t) {
+                    y[t] = simde_mm256_set1_pd(_in[i + t]);
+                }
+                for (size_t s = 0; s < stages; ++s) {
+                    const size_t k = s * lanes + o;
+                    const simde__m256d b0 = simde_mm256_load_pd(xo->coeff[0] + k);
+                    const simde__m256d b1 = simde_mm256_load_pd(xo->coeff[1] + k);
+                    const simde__m256d b2 = simde_mm256_load_pd(xo->coeff[2] + k);
+                    const simde__m256d a1 = simde_mm256_load_pd(xo->coeff[3] + k);
+                    const simde__m256d a2 = simde_mm256_load_pd(xo->coeff[4] + k);
+                    simde__m256d z1 = simde_mm256_load_pd(z1s + k);
+                    simde__m256d z2 = simde_mm256_load_pd(z2s + k);
+                    for (int t = 0; t < 4; ++t) {
+                        const simde__m256d x = y[t];
+                        y[t] = simde_mm256_fmadd_pd(b0, x, z1);
+                        z1 = simde_mm256_fnmadd_pd(a1, y[t], simde_mm256_fmadd_pd(b1, x, z2));
+                        z2 = simde_mm256_fnmadd_pd(a2, y[t], simde_mm256_mul_pd(b2, x));
+                    }
+                    simde_mm256_storeu_pd(z1s + k, z1);
+                    simde_mm256_storeu_pd(z2s + k, z2);
+                }
+                transpose4_pd(&y[0], &y[1], &y[2], &y[3]);
+                for (size_t l = 0; l < valid; ++l) {
+                    simde_mm256_storeu_pd(bands[c * xo->num_bands + o + l] + i, y[l]);
+                }
+            }
+        }
+    }
+    ftz_daz_leave(saved_mode);
+}
+
+/**
+ * Sums the bands of every channel back into one signal, the counterpart of crossover_process.
+ * Without processing in between the result is the input through an allpass (flat magnitude).
+ *
+ * @param xo The crossover.
+ * @param bands num_channels * num_bands pointers to the band buffers, laid out as for crossover_process.
+ * @param gains NULL for unity, or num_bands linear gains applied to the bands while summing.
+ * @param outputs num_channels pointers to the output buffers, each aligned to ALIGN, not one of the bands.
+ * @param n The number of samples per channel, a multiple of 4.
+ */
+__declspec(dllexport) void crossover_recombine(const crossover* xo, const double* const* bands, const double* gains, double* const* outputs, size_t n) {
+    const double unity[XO_MAX_BANDS] = { 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+    for (size_t c = 0; c < xo->num_channels; ++c) {
+        mix_n_vectors_ex(bands + c * xo->num_bands, gains ? gains : unity, xo->num_bands, outputs[c], n, STORE_CACHED);
+    }
+}
+
+// atan2(y, x) in (-pi, pi]: atan of min / max in [0, 1], then unfolded by masks. Unlike libm the
+// signs of zeros are ignored: 0 for x = y = 0 and pi (not -pi) for y = -0, x < 0.
+static inline simde__m256d atan2_pd(simde__m256d y, simde__m256d x) {
+    const simde__m256d vsign = simde_mm256_set1_pd(-0.0);
+    const simde__m256d ax = simde_mm256_andnot_pd(vsign, x);
+    const simde__m256d ay = simde_mm256_andnot_pd(vsign, y);
+    const simde__m256d hi = simde_mm256_max_pd(ax, ay);
+    const simde__m256d lo = simde_mm256_min_pd(ax, ay);
+    const simde__m256d zero = simde_mm256_cmp_pd(hi, simde_mm256_setzero_pd(), SIMDE_CMP_EQ_OQ);
+    simde__m256d r = atan_pd(simde_mm256_andnot_pd(zero, simde_mm256_div_pd(lo, simde_mm256_blendv_pd(hi, simde_mm256_set1_pd(1.0), zero))));
+    r = simde_mm256_blendv_pd(r, simde_mm256_sub_pd(simde_mm256_set1_pd(M_PI / 2), r), simde_mm256_cmp_pd(ay, ax, SIMDE_CMP_GT_OQ));
+    r = simde_mm256_blendv_pd(r, simde_mm256_sub_pd(simde_mm256_set1_pd(M_PI), r), simde_mm256_cmp_pd(x, simde_mm256_setzero_pd(), SIMDE_CMP_LT_OQ));
+    const simde__m256d negative = simde_mm256_cmp_pd(y, simde_mm256_setzero_pd(), SIMDE_CMP_LT_OQ);
+    return simde_mm256_or_pd(r, simde_mm256_and_pd(negative, vsign));
+}
+
+// Splits 2 vectors of interleaved complex values z0..z3 into re = (r0, r2, r1, r3) and im = (i0, i2, i1, i3).
+static inline void complex_deinterleave_pd(simde__m256d v0, simde__m256d v1, simde__m256d* re, simde__m256d* im) {
+    *re = simde_mm256_unpacklo_pd(v0, v1);
+    *im = simde_mm256_unpackhi_pd(v0, v1);
+}
+
+// Interleaves re = (r0, r1, r2, r3) and im = (i0, i1, i2, i3) into 2 vectors of complex values z0..z3.
+static inline void complex_interleave_pd(simde__m256d re, simde__m256d im, simde__m256d* v0, simde__m256d* v1) {
+    // (r0 i0 r2 i2) and (r1 i1 r3 i3), then the 128 bit halves are regrouped
+    const simde__m256d lo = simde_mm256_unpacklo_pd(re, im);
+    const simde__m256d hi = simde_mm256_unpackhi_pd(re, im);
+    *v0 = simde_mm256_permute2f128_pd(lo, hi, 0x20);
+    *v1 = simde_mm256_permute2f128_pd(lo, hi, 0x31);
+}
+
+// a * b (conj = 0) or a * conj(b) (conj = 1) of 2 interleaved complex values.
+static inline simde__m256d complex_mul_interleaved_pd(simde__m256d a, simde__m256d b, int conj) {
+    const simde__m256d b_re = simde_mm256_movedup_pd(b);
+    const simde__m256d b_im = simde_mm256_permute_pd(b, 0xF);
+    const simde__m256d a_swap_b_im = simde_mm256_mul_pd(simde_mm256_permute_pd(a, 0x5), b_im);
+    // (ar br - ai bi, ai br + ar bi), conjugated: (ar br + ai bi, ai br - ar bi)
+    return conj ? simde_mm256_fmsubadd_pd(a, b_re, a_swap_b_im) : simde_mm256_fmaddsub_pd(a, b_re, a_swap_b_im);
+}
+
+/**
+ * Multiplies complex arrays in split layout (separate real and imaginary arrays): r = a * b.
+ * All arrays are aligned to ALIGN, the results may overwrite the inputs.
+ *
+ * @param a_re The real parts of a.
+ * @param a_im The imaginary parts of a.
+ * @param b_re The real parts of b.
+ * @param b_im The imaginary parts of b.
+ * @param r_re The real parts of the result.
+ * @param r_im The imaginary parts of the result.
+ * @param n The number of complex values, a multiple of 4.
+ */
+__declspec(dllexport) void complex_mul_split(const double* a_re, const double* a_im, const double* b_re, const double* b_im, double* r_re, double* r_im, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d ar = simde_mm256_load_pd(a_re + i), ai = simde_mm256_load_pd(a_im + i);
+        const simde__m256d br = simde_mm256_load_pd(b_re + i), bi = simde_mm256_load_pd(b_im + i);
+        simde_mm256_storeu_pd(r_re + i, simde_mm256_fmsub_pd(ar, br, simde_mm256_mul_pd(ai, bi)));
+        simde_mm256_storeu_pd(r_im + i, simde_mm256_fmadd_pd(ar, bi, simde_mm256_mul_pd(ai, br)));
+    }
+}
+
+/**
+ * Multiplies and accumulates complex arrays in split layout: r += a * b, e.g. for a frequency
+ * domain convolution summed over partitions.
+ *
+ * @param n The number of complex values, a multiple of 4. The other parameters as in complex_mul_split.
+ */
+__declspec(dllexport) void complex_mul_acc_split(const double* a_re, const double* a_im, const double* b_re, const double* b_im, double* r_re, double* r_im, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d ar = simde_mm256_load_pd(a_re + i), ai = simde_mm256_load_pd(a_im + i);
+        const simde__m256d br = simde_mm256_load_pd(b_re + i), bi = simde_mm256_load_pd(b_im + i);
+        simde_mm256_storeu_pd(r_re + i, simde_mm256_fnmadd_pd(ai, bi, simde_mm256_fmadd_pd(ar, br, simde_mm256_load_pd(r_re + i))));
+        simde_mm256_storeu_pd(r_im + i, simde_mm256_fmadd_pd(ai, br, simde_mm256_fmadd_pd(ar, bi, simde_mm256_load_pd(r_im + i))));
+    }
+}
+
+/**
+ * Multiplies by the conjugate in split layout: r = a * conj(b), e.g. for cross spectra and correlation.
+ *
+ * @param n The number of complex values, a multiple of 4. The other parameters as in complex_mul_split.
+ */
+__declspec(dllexport) void complex_conj_mul_split(const double* a_re, const double* a_im, const double* b_re, const double* b_im, double* r_re, double* r_im, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d ar = simde_mm256_load_pd(a_re + i), ai = simde_mm256_load_pd(a_im + i);
+        const simde__m256d br = simde_mm256_load_pd(b_re + i), bi = simde_mm256_load_pd(b_im + i);
+        simde_mm256_storeu_pd(r_re + i, simde_mm256_fmadd_pd(ar, br, simde_mm256_mul_pd(ai, bi)));
+        simde_mm256_storeu_pd(r_im + i, simde_mm256_fmsub_pd(ai, br, simde_mm256_mul_pd(ar, bi)));
+    }
+}
+
+/**
+ * Computes the squared magnitudes |z|^2 of complex values in split layout, e.g. a power spectrum.
+ *
+ * @param re The real parts, aligned to ALIGN.
+ * @param im The imaginary parts, aligned to ALIGN.
+ * @param result The output vector, aligned to ALIGN.
+ * @param n The number of complex values, a multiple of 4.
+ */
+__declspec(dllexport) void complex_magnitude_squared_split(const double* re, const double* im, double* result, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d r = simde_mm256_load_pd(re + i), m = simde_mm256_load_pd(im + i);
+        simde_mm256_storeu_pd(result + i, simde_mm256_fmadd_pd(r, r, simde_mm256_mul_pd(m, m)));
+    }
+}
+
+/**
+ * Computes the magnitudes |z| of complex values in split layout.
+ *
+ * @param n The number of complex values, a multiple of 4. The other parameters as in complex_magnitude_squared_split.
+ */
+__declspec(dllexport) void complex_magnitude_split(const double* re, const double* im, double* result, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d r = simde_mm256_load_pd(re + i), m = simde_mm256_load_pd(im + i);
+        simde_mm256_storeu_pd(result + i, simde_mm256_sqrt_pd(simde_mm256_fmadd_pd(r, r, simde_mm256_mul_pd(m, m))));
+    }
+}
+
+/**
+ * Computes the phases arg(z) of complex values in split layout with a vector atan2.
+ *
+ * @param n The number of complex values, a multiple of 4. The result is in (-pi, pi], 0 for z = 0 whatever the signs of its zero parts.
+ *          The other parameters as in complex_magnitude_squared_split.
+ */
+__declspec(dllexport) void complex_phase_split(const double* re, const double* im, double* result, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        simde_mm256_storeu_pd(result + i, atan2_pd(simde_mm256_load_pd(im + i), simde_mm256_load_pd(re + i)));
+    }
+}
+
+/**
+ * Converts complex values in split layout to magnitude and phase. The outputs may overwrite the inputs.
+ *
+ * @param re The real parts, aligned to ALIGN.
+ * @param im The imaginary parts, aligned to ALIGN.
+ * @param magnitude The magnitudes, aligned to ALIGN.
+ * @param phase The phases in (-pi, pi], aligned to ALIGN.
+ * @param n The number of complex values, a multiple of 4.
+ */
+__declspec(dllexport) void complex_to_polar_split(const double* re, const double* im, double* magnitude, double* phase, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d r = simde_mm256_load_pd(re + i), m = simde_mm256_load_pd(im + i);
+        simde_mm256_storeu_pd(magnitude + i, simde_mm256_sqrt_pd(simde_mm256_fmadd_pd(r, r, simde_mm256_mul_pd(m, m))));
+        simde_mm256_storeu_pd(phase + i, atan2_pd(m, r));
+    }
+}
+
+/**
+ * Converts magnitude and phase to complex values in split layout with a vector sincos. The outputs
+ * may overwrite the inputs.
+ *
+ * @param magnitude The magnitudes, aligned to ALIGN.
+ * @param phase The phases in radians, any range, aligned to ALIGN.
+ * @param re The real parts, aligned to ALIGN.
+ * @param im The imaginary parts, aligned to ALIGN.
+ * @param n The number of complex values, a multiple of 4.
+ */
+__declspec(dllexport) void complex_from_polar_split(const double* magnitude, const double* phase, double* re, double* im, size_t n) {
+    const simde__m256d turns = simde_mm256_set1_pd(1.0 / (2.0 * M_PI));
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d m = simde_mm256_load_pd(magnitude + i);
+        simde__m256d s, c;
+        sincos_2pi_pd(simde_mm256_mul_pd(simde_mm256_load_pd(phase + i), turns), &s, &c);
+        simde_mm256_storeu_pd(re + i, simde_mm256_mul_pd(m, c));
+        simde_mm256_storeu_pd(im + i, simde_mm256_mul_pd(m, s));
+    }
+}
+
+/**
+ * Multiplies complex arrays in interleaved layout (re, im, re, im, ..): r = a * b. All arrays hold
+ * 2 n doubles and are aligned to ALIGN, the result may overwrite an input.
+ *
+ * @param a The first input.
+ * @param b The second input.
+ * @param result The output.
+ * @param n The number of complex values, a multiple of 4.
+ */
+__declspec(dllexport) void complex_mul_interleaved(const double* a, const double* b, double* result, size_t n) {
+    for (size_t i = 0; i < 2 * n; i += 4) {
+        simde_mm256_storeu_pd(result + i, complex_mul_interleaved_pd(simde_mm256_load_pd(a + i), simde_mm256_load_pd(b + i), 0));
+    }
+}
+
+/**
+ * Multiplies and accumulates complex arrays in interleaved layout: r += a * b.
+ *
+ * @param n The number of complex values, a multiple of 4. The other parameters as in complex_mul_interleaved.
+ */
+__declspec(dllexport) void complex_mul_acc_interleaved(const double* a, const double* b, double* result, size_t n) {
+    for (size_t i = 0; i < 2 * n; i += 4) {
+        const simde__m256d p = complex_mul_interleaved_pd(simde_mm256_load_pd(a + i), simde_mm256_load_pd(b + i), 0);
+        simde_mm256_storeu_pd(result + i, simde_mm256_add_pd(simde_mm256_load_pd(result + i), p));
+    }
+}
+
+/**
+ * Multiplies by the conjugate in interleaved layout: r = a * conj(b).
+ *
+ * @param n The number of complex values, a multiple of 4. The other parameters as in complex_mul_interleaved.
+ */
+__declspec(dllexport) void complex_conj_mul_interleaved(const double* a, const double* b, double* result, size_t n) {
+    for (size_t i = 0; i < 2 * n; i += 4) {
+        simde_mm256_storeu_pd(result + i, complex_mul_interleaved_pd(simde_mm256_load_pd(a + i), simde_mm256_load_pd(b + i), 1));
+    }
+}
+
+/**
+ * Computes the squared magnitudes |z|^2 of complex values in interleaved layout.
+ *
+ * @param z The complex input, 2 n doubles aligned to ALIGN.
+ * @param result The output vector of n doubles, aligned to ALIGN.
+ * @param n The number of complex values, a multiple of 4.
+ */
+__declspec(dllexport) void complex_magnitude_squared_interleaved(const double* z, double* result, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d v0 = simde_mm256_load_pd(z + 2 * i), v1 = simde_mm256_load_pd(z + 2 * i + 4);
+        // pairwise sums come out as z0, z2, z1, z3
+        const simde__m256d p = simde_mm256_hadd_pd(simde_mm256_mul_pd(v0, v0), simde_mm256_mul_pd(v1, v1));
+        simde_mm256_storeu_pd(result + i, simde_mm256_permute4x64_pd(p, 0xD8));
+    }
+}
+
+/**
+ * Computes the magnitudes |z| of complex values in interleaved layout.
+ *
+ * @param n The number of complex values, a multiple of 4. The other parameters as in complex_magnitude_squared_interleaved.
+ */
+__declspec(dllexport) void complex_magnitude_interleaved(const double* z, double* result, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d v0 = simde_mm256_load_pd(z + 2 * i), v1 = simde_mm256_load_pd(z + 2 * i + 4);
+        const simde__m256d p = simde_mm256_hadd_pd(simde_mm256_mul_pd(v0, v0), simde_mm256_mul_pd(v1, v1));
+        simde_mm256_storeu_pd(result + i, simde_mm256_sqrt_pd(simde_mm256_permute4x64_pd(p, 0xD8)));
+    }
+}
+
+/**
+ * Computes the phases arg(z) of complex values in interleaved layout with a vector atan2.
+ *
+ * @param n The number of complex values, a multiple of 4. The result is in (-pi, pi], 0 for z = 0 whatever the signs of its zero parts.
+ *          The other parameters as in complex_magnitude_squared_interleaved.
+ */
+__declspec(dllexport) void complex_phase_interleaved(const double* z, double* result, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        simde__m256d re, im;
+        complex_deinterleave_pd(simde_mm256_load_pd(z + 2 * i), simde_mm256_load_pd(z + 2 * i + 4), &re, &im);
+        simde_mm256_storeu_pd(result + i, simde_mm256_permute4x64_pd(atan2_pd(im, re), 0xD8));
+    }
+}
+
+/**
+ * Converts complex values in interleaved layout to magnitude and phase.
+ *
+ * @param z The complex input, 2 n doubles aligned to ALIGN.
+ * @param magnitude The magnitudes, n doubles aligned to ALIGN.
+ * @param phase The phases in (-pi, pi], n doubles aligned to ALIGN.
+ * @param n The number of complex values, a multiple of 4.
+ */
+__declspec(dllexport) void complex_to_polar_interleaved(const double* z, double* magnitude, double* phase, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        simde__m256d re, im;
+        complex_deinterleave_pd(simde_mm256_load_pd(z + 2 * i), simde_mm256_load_pd(z + 2 * i + 4), &re, &im);
+        const simde__m256d m = simde_mm256_sqrt_pd(simde_mm256_fmadd_pd(re, re, simde_mm256_mul_pd(im, im)));
+        simde_mm256_storeu_pd(magnitude + i, simde_mm256_permute4x64_pd(m, 0xD8));
+        simde_mm256_storeu_pd(phase + i, simde_mm256_permute4x64_pd(atan2_pd(im, re), 0xD8));
+    }
+}
+
+/**
+ * Converts magnitude and phase to complex values in interleaved layout with a vector sincos.
+ *
+ * @param magnitude The magnitudes, n doubles aligned to ALIGN.
+ * @param phase The phases in radians, any range, n doubles aligned to ALIGN.
+ * @param z The complex output, 2 n doubles aligned to ALIGN.
+ * @param n The number of complex values, a multiple of 4.
+ */
+__declspec(dllexport) void complex_from_polar_interleaved(const double* magnitude, const double* phase, double* z, size_t n) {
+    const simde__m256d turns = simde_mm256_set1_pd(1.0 / (2.0 * M_PI));
+    for (size_t i = 0; i < n; i += 4) {
+        const simde__m256d m = simde_mm256_load_pd(magnitude + i);
+        simde__m256d s, c, v0, v1;
+        sincos_2pi_pd(simde_mm256_mul_pd(simde_mm256_load_pd(phase + i), turns), &s, &c);
+        complex_interleave_pd(simde_mm256_mul_pd(m, c), simde_mm256_mul_pd(m, s), &v0, &v1);
+        simde_mm256_storeu_pd(z + 2 * i, v0);
+        simde_mm256_storeu_pd(z + 2 * i + 4, v1);
+    }
+}
+
+/**
+ * Analysis windows of the STFT, periodic so that overlapping frames tile.
+ */
+enum {
+    STFT_WINDOW_HANN            = 0,
+    STFT_WINDOW_BLACKMAN_HARRIS = 1, // 4 term, about 92 dB sidelobes
+    STFT_WINDOW_KAISER          = 2  // shape set by beta
+};
+
+#define STFT_MIN_SIZE 16
+#define STFT_MAX_SIZE 65536
+
+/**
+ * Callback run on the spectrum of each channel by stft_process.
+ *
+ * @param re The real parts of the bins, aligned to ALIGN, processed in place.
+ * @param im The imaginary parts of the bins, aligned to ALIGN, processed in place.
+ * @param num_bins The number of bins, fft_size / 2 + 1. The arrays are zero padded to a multiple of 4.
+ * @param channel The channel index.
+ * @param user The user pointer passed to stft_process.
+ */
+typedef void (*stft_kernel)(double* re, double* im, size_t num_bins, size_t channel, void* user);
+
+/**
+ * Short-time Fourier transform with overlap-add resynthesis. Each channel collects its input in a
+ * frame of fft_size samples that advances by hop; every hop the frame is windowed and transformed
+ * into fft_size / 2 + 1 bins, the bins are handed out for processing, transformed back,
+ * windowed again and added to the output accumulator. The synthesis window is the analysis window
+ * divided by the overlapped sum of the squared window (the COLA sum), so unmodified bins
+ * reconstruct the input exactly for every window and hop, delayed by fft_size samples.
+ * The real FFT of size N runs as a complex FFT of size N / 2 on the even and odd samples,
+ * a radix-2 Stockham FFT on split re/im arrays that sorts itself, so no bit reversal is needed.
+ */
+typedef struct stft {
+    size_t num_channels;
+    size_t fft_size;        // N, a power of two
+    size_t half;            // M = N / 2, the size of the complex FFT
+    size_t hop;
+    size_t bin_stride;      // M + 4: bins 0 .. M and zero padding
+    size_t fill;            // samples of the current hop collected so far
+    int pending;            // an analysed frame waits for synthesis
+    double* window;         // analysis window, N
+    double* synthesis;      // window / (COLA sum * N), the inverse FFT scale included
+    double* tw_re;          // e^(-2 pi i j / M), j < M / 2
+    double* tw_im;
+    double* tw2_re;         // e^(-2 pi i 2j / M) twice each, for the second FFT stage
+    double* tw2_im;
+    double* rt_re;          // e^(-2 pi i k / N), k < M, to split the real FFT
+    double* rt_im;
+    double* z_re;           // complex FFT buffers, M + 4
+    double* z_im;
+    double* work_re;        // Stockham ping pong buffers, M
+    double* work_im;
+    double* input;          // input frames, N per channel
+    double* accum;          // overlap-add accumulators, N per channel
+    double* output;         // finished output of the current hop, hop per channel
+    double* bins_re;        // spectra, bin_stride per channel
+    double* bins_im;
+} stft;
+
+// Stockham radix-2 stage for s >= 4: butterflies of x[q + s p] and x[q + s (p + m)], p < m, into y[q + s 2p] and y[q + s (2p + 1)].
+static void fft_stage(const stft* st, const double* xr, const double* xi, double* yr, double* yi, size_t s) {
+    const size_t m = st->half / (2 * s);
+    for (size_t p = 0; p < m; ++p) {
+        // w_n^p with n = M / s is w_M^(p s)
+        const simde__m256d wr = simde_mm256_set1_pd(st->tw_re[p * s]);
+        const simde__m256d wi = simde_mm256_set1_pd(st->tw_im[p * s]);
+        const double* ar = xr + s * p;
+        const double* ai = xi + s * p;
+        double* sr = yr + 2 * s * p;
+        double* si = yi + 2 * s * p;
+        for (size_t q = 0; q < s; q += 4) {
+            const simde__m256d a_r = simde_mm256_load_pd(ar + q), a_i = simde_mm256_load_pd(ai + q);
+            const simde__m256d b_r = simde_mm256_load_pd(ar + s * m + q), b_i = simde_mm256_load_pd(ai + s * m + q);
+            const simde__m256d d_r = simde_mm256_sub_pd(a_r, b_r), d_i = simde_mm256_sub_pd(a_i, b_i);
+            simde_mm256_storeu_pd(sr + q, simde_mm256_add_pd(a_r, b_r));
+            simde_mm256_storeu_pd(si + q, simde_mm256_add_pd(a_i, b_i));
+            simde_mm256_storeu_pd(sr + s + q, simde_mm256_fmsub_pd(d_r, wr, simde_mm256_mul_pd(d_i, wi)));
+            simde_mm256_storeu_pd(si + s + q, simde_mm256_fmadd_pd(d_r, wi, simde_mm256_mul_pd(d_i, wr)));
+        }
+    }
+}
+
+// In place forward complex FFT of size M on split arrays, natural order in and out.
+static void fft_split(const stft* st, double* re, double* im) {
+    const size_t m = st->half / 2;
+    double* xr = re;
+    double* xi = im;
+    double* yr = st->work_re;
+    double* yi = st->work_im;
+    // s = 1: 4 butterflies per vector, sums and differences interleave into y[2p], y[2p + 1]
+    for (size_t p = 0; p < m; p += 4) {
+        const simde__m256d a_r = simde_mm256_load_pd(xr + p), a_i = simde_mm256_load_pd(xi + p);
+        const simde__m256d b_r = simde_mm256_load_pd(xr + m + p), b_i = simde_mm256_load_pd(xi + m + p);
+        const simde__m256d wr = simde_mm256_load_pd(st->tw_re + p), wi = simde_mm256_load_pd(st->tw_im + p);
+        const simde__m256d d_r = simde_mm256_sub_pd(a_r, b_r), d_i = simde_mm256_sub_pd(a_i, b_i);
+        simde__m256d v0, v1;
+        complex_interleave_pd(simde_mm256_add_pd(a_r, b_r), simde_mm256_fmsub_pd(d_r, wr, simde_mm256_mul_pd(d_i, wi)), &v0, &v1);
+        simde_mm256_storeu_pd(yr + 2 * p, v0);
+        simde_mm256_storeu_pd(yr + 2 * p + 4, v1);
+        complex_interleave_pd(simde_mm256_add_pd(a_i, b_i), simde_mm256_fmadd_pd(d_r, wi, simde_mm256_mul_pd(d_i, wr)), &v0, &v1);
+        simde_mm256_storeu_pd(yi + 2 * p, v0);
+        simde_mm256_storeu_pd(yi + 2 * p + 4, v1);
+    }
+    // s = 2: a vector holds q = 0, 1 of two butterflies, 128 bit halves regroup into y[4p + q], y[4p + 2 + q]
+    for (size_t j = 0; j < m; j += 4) {
+        const simde__m256d a_r = simde_mm256_load_pd(yr + j), a_i = simde_mm256_load_pd(yi + j);
+        const simde__m256d b_r = simde_mm256_load_pd(yr + m + j), b_i = simde_mm256_load_pd(yi + m + j);
+        const simde__m256d wr = simde_mm256_load_pd(st->tw2_re + j), wi = simde_mm256_load_pd(st->tw2_im + j);
+        const simde__m256d d_r = simde_mm256_sub_pd(a_r, b_r), d_i = simde_mm256_sub_pd(a_i, b_i);
+        const simde__m256d s_r = simde_mm256_add_pd(a_r, b_r), s_i = simde_mm256_add_pd(a_i, b_i);
+        const simde__m256d t_r = simde_mm256_fmsub_pd(d_r, wr, simde_mm256_mul_pd(d_i, wi));
+        const simde__m256d t_i = simde_mm256_fmadd_pd(d_r, wi, simde_mm256_mul_pd(d_i, wr));
+        simde_mm256_storeu_pd(xr + 2 * j, simde_mm256_permute2f128_pd(s_r, t_r, 0x20));
+        simde_mm256_storeu_pd(xr + 2 * j + 4, simde_mm256_permute2f128_pd(s_r, t_r, 0x31));
+        simde_mm256_storeu_pd(xi + 2 * j, simde_mm256_permute2f128_pd(s_i, t_i, 0x20));
+        simde_mm256_storeu_pd(xi + 2 * j + 4, simde_mm256_permute2f128_pd(s_i, t_i, 0x31));
+    }
+    // s >= 4: whole vectors of q, ping pong between the buffers
+    int in_work = 0;
+    for (size_t s = 4; s < st->half; s *= 2) {
+        if (in_work) {
+            fft_stage(st, yr, yi, xr, xi, s);
+        } else {
+            fft_stage(st, xr, xi, yr, yi, s);
+        }
+        in_work = !in_work;
+    }
+    if (in_work) {
+        memcpy(re, yr, st->half * sizeof(double));
+        memcpy(im, yi, st->half * sizeof(double));
+    }
+}
+
+// Windows the input frame, transforms it and writes bins 0 .. M of one channel.
+static void stft_analyze(stft* st, size_t channel) {
+    const size_t half = st->half;
+    const double* frame = st->input + channel * st->fft_size;
+    double* zr = st->z_re;
+    double* zi = st->z_im;
+    double* xr = st->bins_re + channel * st->bin_stride;
+    double* xi = st->bins_im + channel * st->bin_stride;
+    // even samples to the real parts, odd samples to the imaginary parts
+    for (size_t i = 0; i < st->fft_size; i += 8) {
+        simde__m256d re, im;
+        complex_deinterleave_pd(simde_mm256_mul_pd(simde_mm256_load_pd(frame + i), simde_mm256_load_pd(st->window + i)),
+                                simde_mm256_mul_pd(simde_mm256_load_pd(frame + i + 4), simde_mm256_load_pd(st->window + i + 4)), &re, &im);
+        simde_mm256_storeu_pd(zr + i / 2, simde_mm256_permute4x64_pd(re, 0xD8));
+        simde_mm256_storeu_pd(zi + i / 2, simde_mm256_permute4x64_pd(im, 0xD8));
+    }
+    fft_split(st, zr, zi);
+    // X[k] = (Z[k] + conj Z[M - k]) / 2 - i w^k (Z[k] - conj Z[M - k]) / 2, Z periodic
+    zr[half] = zr[0];
+    zi[half] = zi[0];
+    const simde__m256d vhalf = simde_mm256_set1_pd(0.5);
+    for (size_t k = 0; k < half; k += 4) {
+        const simde__m256d a_r = simde_mm256_load_pd(zr + k), a_i = simde_mm256_load_pd(zi + k);
+        // Z[M - k] .. Z[M - k - 3], reversed
+        const simde__m256d b_r = simde_mm256_permute4x64_pd(simde_mm256_loadu_pd(zr + half - k - 3), 0x1B);
+        const simde__m256d b_i = simde_mm256_permute4x64_pd(simde_mm256_loadu_pd(zi + half - k - 3), 0x1B);
+        const simde__m256d wr = simde_mm256_load_pd(st->rt_re + k), wi = simde_mm256_load_pd(st->rt_im + k);
+        // with B = conj Z[M - k]: S = A + B, D = A - B
+        const simde__m256d s_r = simde_mm256_add_pd(a_r, b_r), s_i = simde_mm256_sub_pd(a_i, b_i);
+        const simde__m256d d_r = simde_mm256_sub_pd(a_r, b_r), d_i = simde_mm256_add_pd(a_i, b_i);
+        // w (-i D) = w (d_i - i d_r)
+        const simde__m256d t_r = simde_mm256_fmadd_pd(wr, d_i, simde_mm256_mul_pd(wi, d_r));
+        const simde__m256d t_i = simde_mm256_fmsub_pd(wi, d_i, simde_mm256_mul_pd(wr, d_r));
+        simde_mm256_storeu_pd(xr + k, simde_mm256_mul_pd(vhalf, simde_mm256_add_pd(s_r, t_r)));
+        simde_mm256_storeu_pd(xi + k, simde_mm256_mul_pd(vhalf, simde_mm256_add_pd(s_i, t_i)));
+    }
+    xr[half] = zr[0] - zi[0];
+    xi[half] = 0.0;
+    xi[0] = 0.0;
+    memset(xr + half + 1, 0, 3 * sizeof(double));
+    memset(xi + half + 1, 0, 3 * sizeof(double));
+}
+
+// Transforms the bins of one channel back, windows the frame and adds it to the accumulator.
+static void stft_synthesize(stft* st, size_t channel) {
+    const size_t half = st->half;
+    const double* xr = st->bins_re + channel * st->bin_stride;
+    const double* xi = st->bins_im + channel * st->bin_stride;
+    double* zr = st->z_re;
+    double* zi = st->z_im;
+    double* acc = st->accum + channel * st->fft_size;
+    // Z[k] = E[k] + i O[k] with E = X[k] + conj X[M - k], O = conj(w^k) (X[k] - conj X[M - k]), both twice their size
+    for (size_t k = 0; k < half; k += 4) {
+        const simde__m256d a_r = simde_mm256_load_pd(xr + k), a_i = simde_mm256_load_pd(xi + k);
+        const simde__m256d b_r = simde_mm256_permute4x64_pd(simde_mm256_loadu_pd(xr + half - k - 3), 0x1B);
+        const simde__m256d b_i = simde_mm256_permute4x64_pd(simde_mm256_loadu_pd(xi + half - k - 3), 0x1B);
+        const simde__m256d wr = simde_mm256_load_pd(st->rt_re + k), wi = simde_mm256_load_pd(st->rt_im + k);
+        const simde__m256d e_r = simde_mm256_add_pd(a_r, b_r), e_i = simde_mm256_sub_pd(a_i, b_i);
+        const simde__m256d d_r = simde_mm256_sub_pd(a_r, b_r), d_i = simde_mm256_add_pd(a_i, b_i);
+        const simde__m256d o_r = simde_mm256_fmadd_pd(wr, d_r, simde_mm256_mul_pd(wi, d_i));
+        const simde__m256d o_i = simde_mm256_fmsub_pd(wr, d_i, simde_mm256_mul_pd(wi, d_r));
+        // the inverse FFT runs as a forward FFT with re and im swapped, so store them swapped
+        simde_mm256_storeu_pd(zi + k, simde_mm256_sub_pd(e_r, o_i));
+        simde_mm256_storeu_pd(zr + k, simde_mm256_add_pd(e_i, o_r));
+    }
+    fft_split(st, zr, zi);
+    // z_im now holds the even samples, z_re the odd ones
+    for (size_t i = 0; i < st->fft_size; i += 8) {
+        simde__m256d v0, v1;
+        complex_interleave_pd(simde_mm256_load_pd(zi + i / 2), simde_mm256_load_pd(zr + i / 2), &v0, &v1);
+        simde_mm256_storeu_pd(acc + i, simde_mm256_fmadd_pd(v0, simde_mm256_load_pd(st->synthesis + i), simde_mm256_load_pd(acc + i)));
+        simde_mm256_storeu_pd(acc + i + 4, simde_mm256_fmadd_pd(v1, simde_mm256_load_pd(st->synthesis + i + 4), simde_mm256_load_pd(acc + i + 4)));
+    }
+    // the first hop is finished
+    memcpy(st->output + channel * st->hop, acc, st->hop * sizeof(double));
+    memmove(acc, acc + st->hop, (st->fft_size - st->hop) * sizeof(double));
+    memset(acc + st->fft_size - st->hop, 0, st->hop * sizeof(double));
+}
+
+/**
+ * Frees an STFT.
+ *
+ * @param st The STFT, may be NULL.
+ */
+__declspec(dllexport) void stft_destroy(stft* st) {
+    if (!st) {
+        return;
+    }
+    _mm_free(st->window);
+    _mm_free(st->synthesis);
+    _mm_free(st->tw_re);
+    _mm_free(st->tw_im);
+    _mm_free(st->tw2_re);
+    _mm_free(st->tw2_im);
+    _mm_free(st->rt_re);
+    _mm_free(st->rt_im);
+    _mm_free(st->z_re);
+    _mm_free(st->z_im);
+    _mm_free(st->work_re);
+    _mm_free(st->work_im);
+    _mm_free(st->input);
+    _mm_free(st->accum);
+    _mm_free(st->output);
+    _mm_free(st->bins_re);
+    _mm_free(st->bins_im);
+    free(st);
+}
+
+/**
+ * Clears the input frames, the overlap-add accumulators and the bins.
+ *
+ * @param st The STFT.
+ */
+__declspec(dllexport) void stft_reset(stft* st) {
+    memset(st->input, 0, st->num_channels * st->fft_size * sizeof(double));
+    memset(st->accum, 0, st->num_channels * st->fft_size * sizeof(double));
+    memset(st->output, 0, st->num_channels * st->hop * sizeof(double));
+    memset(st->bins_re, 0, st->num_channels * st->bin_stride * sizeof(double));
+    memset(st->bins_im, 0, st->num_channels * st->bin_stride * sizeof(double));
+    st->fill = 0;
+    st->pending = 0;
+}
+
+// Fills the window tables and the synthesis window normalized by the overlapped squared window.
+static void stft_design(stft* st, int window, double beta) {
+    const size_t n = st->fft_size;
+    const double norm = bessel_i0(beta);
+    for (size_t i = 0; i < n; ++i) {
+        const double t = 2.0 * M_PI * (double)i / (double)n;
+        if (window == STFT_WINDOW_BLACKMAN_HARRIS) {
+            st->window[i] = 0.35875 - 0.48829 * cos(t) + 0.14128 * cos(2.0 * t) - 0.01168 * cos(3.0 * t);
+        } else if (window == STFT_WINDOW_KAISER) {
+            const double x = 2.0 * (double)i / (double)n - 1.0;
+            st->window[i] = bessel_i0(beta * sqrt(1.0 - x * x)) / norm;
+        } else {
+            st->window[i] = 0.5 - 0.5 * cos(t);
+        }
+    }
+    for (size_t j = 0; j < st->hop; ++j) {
+        double sum = 0.0;
+        for (size_t i = j; i < n; i += st->hop) {
+            sum += st->window[i] * st->window[i];
+        }
+        for (size_t i = j; i < n; i += st->hop) {
+            st->synthesis[i] = sum > 0.0 ? st->window[i] / (sum * (double)n) : 0.0;
+        }
+    }
+}
+
+/**
+ * Creates an STFT.
+ *
+ * @param num_channels The number of channels.
+ * @param fft_size The frame and FFT size, a power of two from 16 to 65536.
+ * @param hop The frame advance, a multiple of 4 that divides fft_size, at most fft_size / 2.
+ * @param window STFT_WINDOW_HANN, STFT_WINDOW_BLACKMAN_HARRIS or STFT_WINDOW_KAISER.
+ * @param beta The Kaiser shape, e.g. 8.6 for about 90 dB sidelobes; ignored by the other windows.
+ * @return The STFT, or NULL for invalid sizes or if the allocation fails.
+ */
+__declspec(dllexport) stft* stft_create(size_t num_channels, size_t fft_size, size_t hop, int window, double beta) {
+    if (num_channels == 0 || fft_size < STFT_MIN_SIZE || fft_size > STFT_MAX_SIZE || (fft_size & (fft_size - 1)) != 0
+        || hop == 0 || (hop & 3) != 0 || fft_size % hop != 0 || hop > fft_size / 2) {
+        return NULL;
+    }
+    stft* st = (stft*)calloc(1, sizeof(stft));
+    if (!st) {
+        return NULL;
+    }
+    const size_t half = fft_size / 2;
+    st->num_channels = num_channels;
+    st->fft_size     = fft_size;
+    st->half         = half;
+    st->hop          = hop;
+    st->bin_stride   = half + 4;
+    st->window    = (double*)_mm_malloc(fft_size * sizeof(double), ALIGN);
+    st->synthesis = (double*)_mm_malloc(fft_size * sizeof(double), ALIGN);
+    st->tw_re     = (double*)_mm_malloc(half / 2 * sizeof(double), ALIGN);
+    st->tw_im     = (double*)_mm_malloc(half / 2 * sizeof(double), ALIGN);
+    st->tw2_re    = (double*)_mm_malloc(half / 2 * sizeof(double), ALIGN);
+    st->tw2_im    = (double*)_mm_malloc(half / 2 * sizeof(double), ALIGN);
+    st->rt_re     = (double*)_mm_malloc(half * sizeof(double), ALIGN);
+    st->rt_im     = (double*)_mm_malloc(half * sizeof(double), ALIGN);
+    st->z_re      = (double*)_mm_malloc((half + 4) * sizeof(double), ALIGN);
+    st->z_im      = (double*)_mm_malloc((half + 4) * sizeof(double), ALIGN);
+    st->work_re   = (double*)_mm_malloc(half * sizeof(double), ALIGN);
+    st->work_im   = (double*)_mm_malloc(half * sizeof(double), ALIGN);
+    st->input     = (double*)_mm_malloc(num_channels * fft_size * sizeof(double), ALIGN);
+    st->accum     = (double*)_mm_malloc(num_channels * fft_size * sizeof(double), ALIGN);
+    st->output    = (double*)_mm_malloc(num_channels * hop * sizeof(double), ALIGN);
+    st->bins_re   = (double*)_mm_malloc(num_channels * st->bin_stride * sizeof(double), ALIGN);
+    st->bins_im   = (double*)_mm_malloc(num_channels * st->bin_stride * sizeof(double), ALIGN);
+    if (!st->window || !st->synthesis || !st->tw_re || !st->tw_im || !st->tw2_re || !st->tw2_im || !st->rt_re || !st->rt_im
+        || !st->z_re || !st->z_im || !st->work_re || !st->work_im || !st->input || !st->accum || !st->output || !st->bins_re || !st->bins_im) {
+        stft_destroy(st);
+        return NULL;
+    }
+    for (size_t j = 0; j < half / 2; ++j) {
+        st->tw_re[j] = cos(2.0 * M_PI * (double)j / (double)half);
+        st->tw_im[j] = -sin(2.0 * M_PI * (double)j / (double)half);
+        st->tw2_re[j] = st->tw_re[j & ~(size_t)1];
+        st->tw2_im[j] = st->tw_im[j & ~(size_t)1];
+    }
+    for (size_t k = 0; k < half; ++k) {
+        st->rt_re[k] = cos(2.0 * M_PI * (double)k / (double)fft_size);
+        st->rt_im[k] = -sin(2.0 * M_PI * (double)k / (double)fft_size);
+    }
+    memset(st->z_re, 0, (half + 4) * sizeof(double));
+    memset(st->z_im, 0, (half + 4) * sizeof(double));
+    stft_design(st, window, beta);
+    stft_reset(st);
+    return st;
+}
+
+/**
+ * Returns the delay from input to output, fft_size samples.
+ *
+ * @param st The STFT.
+ * @return The latency in samples.
+ */
+__declspec(dllexport) size_t stft_get_latency(const stft* st) {
+    return st->fft_size;
+}
+
+/**
+ * Returns the number of bins of a spectrum, fft_size / 2 + 1 from DC to Nyquist.
+ *
+ * @param st The STFT.
+ * @return The number of bins. The bin arrays are zero padded to a multiple of 4.
+ */
+__declspec(dllexport) size_t stft_get_num_bins(const stft* st) {
+    return st->half + 1;
+}
+
+/**
+ * Returns the real parts of the spectrum of a channel. Bin k is at k * sample_rate / fft_size Hz.
+ *
+ * @param st The STFT.
+ * @param channel The channel index.
+ * @return The bins, aligned to ALIGN, owned by the STFT.
+ */
+__declspec(dllexport) double* stft_get_real(stft* st, size_t channel) {
+    return st->bins_re + channel * st->bin_stride;
+}
+
+/**
+ * Returns the imaginary parts of the spectrum of a channel.
+ *
+ * @param st The STFT.
+ * @param channel The channel index.
+ * @return The bins, aligned to ALIGN, owned by the STFT.
+ */
+__declspec(dllexport) double* stft_get_imag(stft* st, size_t channel) {
+    return st->bins_im + channel * st->bin_stride;
+}
+
+/**
+ * Returns whether stft_feed stopped on an analysed frame whose bins may now be processed.
+ *
+ * @param st The STFT.
+ * @return 1 if a frame is pending, 0 otherwise.
+ */
+__declspec(dllexport) int stft_frame_pending(const stft* st) {
+    return st->pending;
+}
+
+/**
+ * Bin buffer interface for hosts that cannot take callbacks: consumes input samples from offset
+ * on and writes the matching output samples, stopping after the next frame boundary. When it
+ * stops there the new spectra are ready in the bins (stft_frame_pending returns 1) and may be
+ * modified until the next call, which resynthesizes them first. Call it with the returned offset
+ * until it returns n. Inputs and outputs may be the same buffers.
+ *
+ * @param st The STFT.
+ * @param inputs The input channels.
+ * @param outputs The output channels.
+ * @param offset The first sample to process.
+ * @param n The number of samples of the block.
+ * @return The offset of the next unprocessed sample.
+ */
+__declspec(dllexport) size_t stft_feed(stft* st, const double* const* inputs, double* const* outputs, size_t offset, size_t n) {
+    if (st->pending) {
+        for (size_t c = 0; c < st->num_channels; ++c) {
+            stft_synthesize(st, c);
+        }
+        st->pending = 0;
+    }
+    const size_t count = st->hop - st->fill < n - offset ? st->hop - st->fill : n - offset;
+    for (size_t c = 0; c < st->num_channels; ++c) {
+        // read the input first so in place processing works
+        memcpy(st->input + c * st->fft_size + st->fft_size - st->hop + st->fill, inputs[c] + offset, count * sizeof(double));
+        memcpy(outputs[c] + offset, st->output + c * st->hop + st->fill, count * sizeof(double));
+    }
+    st->fill += count;
+    if (st->fill == st->hop) {
+        for (size_t c = 0; c < st->num_channels; ++c) {
+            double* frame = st->input + c * st->fft_size;
+            stft_analyze(st, c);
+            memmove(frame, frame + st->hop, (st->fft_size - st->hop) * sizeof(double));
+        }
+        st->fill = 0;
+        st->pending = 1;
+    }
+    return offset + count;
+}
+
+/**
+ * Runs a block of any length through the STFT, calling the kernel on the spectra of every frame.
+ *
+ * @param st The STFT.
+ * @param inputs The input channels.
+ * @param outputs The output channels, may be the inputs.
+ * @param n The number of samples.
+ * @param kernel The spectral processing, NULL to pass the spectra through.
+ * @param user Passed to the kernel.
+ */
+__declspec(dllexport) void stft_process(stft* st, const double* const* inputs, double* const* outputs, size_t n, stft_kernel kernel, void* user) {
+    size_t offset = 0;
+    while (offset < n) {
+        offset = stft_feed(st, inputs, outputs, offset, n);
+        if (st->pending && kernel) {
+            for (size_t c = 0; c < st->num_channels; ++c) {
+                kernel(stft_get_real(st, c), stft_get_imag(st, c), st->half + 1, c, user);
+            }
+        }
     }
 }
 